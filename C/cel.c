@@ -51,6 +51,11 @@ const char *cel_errmsg[] = {
 /* Convenience macro for invoking wcserr_set(). */
 #define CEL_ERRMSG(status) WCSERR_SET(status), cel_errmsg[status]
 
+/* Number of coordinates projected and rotated together by celx2s() and
+   cels2x(), small enough that the intermediate native coordinates remain in
+   the level 1 cache. */
+#define CEL_NTILE 256
+
 /*--------------------------------------------------------------------------*/
 
 int celini(cel)
@@ -65,6 +70,7 @@ struct celprm *cel;
   cel->flag = 0;
 
   cel->offset = 0;
+  cel->fast   = 0;
   cel->phi0   = UNDEFINED;
   cel->theta0 = UNDEFINED;
   cel->ref[0] =   0.0;
@@ -112,6 +118,7 @@ const struct celprm *cel;
 
   wcsprintf("      flag: %d\n",  cel->flag);
   wcsprintf("     offset: %d\n",  cel->offset);
+  wcsprintf("       fast: %d\n",  cel->fast);
   if (undefined(cel->phi0)) {
     wcsprintf("       phi0: UNDEFINED\n");
   } else {
@@ -145,6 +152,12 @@ const struct celprm *cel;
     wcsprintf(" (UNDEFINED)\n");
   }
   wcsprintf("     isolat: %d\n", cel->isolat);
+  wcsprintf("       rmat:");
+  for (i = 0; i < 9; i++) {
+    if (i && i%3 == 0) wcsprintf("\n            ");
+    wcsprintf("  %- 11.5g", cel->rmat[i]);
+  }
+  wcsprintf("\n");
 
   WCSPRINTF_PTR("        err: ", cel->err, "\n");
   if (cel->err) {
@@ -187,6 +200,7 @@ struct celprm *cel;
     celprj->phi0   = UNDEFINED;
     celprj->theta0 = UNDEFINED;
   }
+  celprj->fast = cel->fast;
 
   if (prjset(celprj)) {
     return wcserr_set(CEL_ERRMSG(CELERR_BAD_PARAM));
@@ -392,6 +406,7 @@ struct celprm *cel;
   cel->euler[2] = phip;
   sincosd(cel->euler[1], &cel->euler[4], &cel->euler[3]);
   cel->isolat = (cel->euler[4] == 0.0);
+  sphmat(cel->euler, cel->rmat);
   cel->flag = CELSET;
 
   /* Check for ill-conditioned parameters. */
@@ -418,7 +433,9 @@ int stat[];
 {
   static const char *function = "celx2s";
 
-  int    nphi, status;
+  int    cylin, irow, istat, ix, iy, k, m, n, nrow, status;
+  double phib[CEL_NTILE], thetab[CEL_NTILE];
+  register double *phip, *thetap;
   struct prjprm *celprj;
   struct wcserr **err;
 
@@ -430,23 +447,63 @@ int stat[];
     if ((status = celset(cel))) return status;
   }
 
-  /* Apply spherical deprojection. */
   celprj = &(cel->prj);
-  if ((status = celprj->prjx2s(celprj, nx, ny, sxy, 1, x, y, phi, theta,
-                               stat))) {
-    if (status == PRJERR_BAD_PIX) {
-      status = CELERR_BAD_PIX;
-    }
 
-    wcserr_set(CEL_ERRMSG(status));
+  /* theta is constant along each row of a cylindrical grid. */
+  cylin = (ny > 0 && celprj->category == CYLINDRICAL);
+
+  /* Deproject and rotate tiles of whole rows of the grid, or of part of a
+     row if it is too long, a vector being treated as a single row. */
+  status = 0;
+  nrow = (ny > 0) ? ny : 1;
+  m = n = 1;
+  for (iy = 0; iy < nrow; iy += m) {
+    for (ix = 0; ix < nx; ix += n) {
+      if (nx <= CEL_NTILE) {
+        n = nx;
+        m = CEL_NTILE/nx;
+        if (m > nrow - iy) m = nrow - iy;
+      } else {
+        n = nx - ix;
+        if (n > CEL_NTILE) n = CEL_NTILE;
+        m = 1;
+      }
 
-    if (status != CELERR_BAD_PIX) return status;
-  }
+      k = iy*nx + ix;
+      phip   = phi   ? phi   + k : phib;
+      thetap = theta ? theta + k : thetab;
 
-  nphi = (ny > 0) ? (nx*ny) : nx;
+      /* Apply spherical deprojection. */
+      if (ny > 0) {
+        istat = celprj->prjx2s(celprj, n, m, sxy, 1, x + ix*sxy, y + iy*sxy,
+                               phip, thetap, stat + k);
+      } else {
+        istat = celprj->prjx2s(celprj, n, 0, sxy, 1, x + ix*sxy, y + ix*sxy,
+                               phip, thetap, stat + k);
+      }
+
+      if (istat) {
+        if (istat != PRJERR_BAD_PIX) {
+          return wcserr_set(CEL_ERRMSG(istat));
+        }
 
-  /* Compute celestial coordinates. */
-  sphx2s(cel->euler, nphi, 0, 1, sll, phi, theta, lng, lat);
+        status = CELERR_BAD_PIX;
+      }
+
+      /* Compute celestial coordinates. */
+      if (cylin) {
+        for (irow = 0; irow < m; irow++, k += n) {
+          sphfx2s(cel->fast, cel->euler, n, 1, 1, sll, phip + irow*n,
+                  thetap + irow*n, lng + k*sll, lat + k*sll);
+        }
+      } else {
+        sphfx2s(cel->fast, cel->euler, n*m, 0, 1, sll, phip, thetap,
+                lng + k*sll, lat + k*sll);
+      }
+    }
+  }
+
+  if (status) wcserr_set(CEL_ERRMSG(status));
 
   return status;
 }
@@ -465,7 +522,9 @@ int stat[];
 {
   static const char *function = "cels2x";
 
-  int    nphi, ntheta, status;
+  int    ilat, ilng, irow, istat, k, m, n, nrow, status;
+  double phib[CEL_NTILE], thetab[CEL_NTILE], thetar[CEL_NTILE];
+  register double *phip, *thetap;
   struct prjprm *celprj;
   struct wcserr **err;
 
@@ -477,28 +536,202 @@ int stat[];
     if ((status = celset(cel))) return status;
   }
 
-  /* Compute native coordinates. */
-  sphs2x(cel->euler, nlng, nlat, sll, 1, lng, lat, phi, theta);
+  celprj = &(cel->prj);
 
-  if (cel->isolat) {
-    /* Constant celestial latitude -> constant native latitude. */
-    nphi   = nlng;
-    ntheta = nlat;
-  } else {
-    nphi   = (nlat > 0) ? (nlng*nlat) : nlng;
-    ntheta = 0;
+  /* Rotate and project tiles of whole rows of the grid, or of part of a row
+     if it is too long, a vector being treated as a single row. */
+  status = 0;
+  nrow = (nlat > 0) ? nlat : 1;
+  m = n = 1;
+  for (ilat = 0; ilat < nrow; ilat += m) {
+    for (ilng = 0; ilng < nlng; ilng += n) {
+      if (nlng <= CEL_NTILE) {
+        n = nlng;
+        m = CEL_NTILE/nlng;
+        if (m > nrow - ilat) m = nrow - ilat;
+      } else {
+        n = nlng - ilng;
+        if (n > CEL_NTILE) n = CEL_NTILE;
+        m = 1;
+      }
+
+      k = ilat*nlng + ilng;
+      phip   = phi   ? phi   + k : phib;
+      thetap = theta ? theta + k : thetab;
+
+      /* Compute native coordinates. */
+      if (nlat > 0) {
+        sphfs2x(cel->fast, cel->euler, n, m, sll, 1, lng + ilng*sll,
+                lat + ilat*sll, phip, thetap);
+      } else {
+        sphfs2x(cel->fast, cel->euler, n, 0, sll, 1, lng + ilng*sll,
+                lat + ilng*sll, phip, thetap);
+      }
+
+      /* Apply the spherical projection. */
+      if (nlat > 0 && cel->isolat) {
+        /* Constant celestial latitude -> constant native latitude, and
+           native longitude is the same for each row. */
+        for (irow = 0; irow < m; irow++) {
+          thetar[irow] = thetap[irow*n];
+        }
+
+        istat = celprj->prjs2x(celprj, n, m, 1, sxy, phip, thetar,
+                               x + k*sxy, y + k*sxy, stat + k);
+      } else {
+        istat = celprj->prjs2x(celprj, n*m, 0, 1, sxy, phip, thetap,
+                               x + k*sxy, y + k*sxy, stat + k);
+      }
+
+      if (istat) {
+        if (istat == PRJERR_BAD_PARAM) {
+          return wcserr_set(CEL_ERRMSG(istat));
+        }
+
+        status = CELERR_BAD_WORLD;
+      }
+    }
+  }
+
+  if (status) wcserr_set(CEL_ERRMSG(status));
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int celx2v(cel, nx, ny, sxy, svec, x, y, phi, theta, vec, stat)
+
+struct celprm *cel;
+int nx, ny, sxy, svec;
+const double x[], y[];
+double phi[], theta[];
+double vec[];
+int stat[];
+
+{
+  static const char *function = "celx2v";
+
+  int    istat, ix, iy, k, m, n, nrow, status;
+  double phib[CEL_NTILE], thetab[CEL_NTILE];
+  register double *phip, *thetap;
+  struct prjprm *celprj;
+  struct wcserr **err;
+
+  /* Initialize. */
+  if (cel == 0x0) return CELERR_NULL_POINTER;
+  err = &(cel->err);
+
+  if (cel->flag != CELSET) {
+    if ((status = celset(cel))) return status;
   }
 
-  /* Apply the spherical projection. */
   celprj = &(cel->prj);
-  if ((status = celprj->prjs2x(celprj, nphi, ntheta, 1, sxy, phi, theta, x, y,
-                               stat))) {
-    if (status != PRJERR_BAD_PARAM) {
-      status = CELERR_BAD_WORLD;
+
+  /* Deproject and rotate in tiles, as for celx2s(). */
+  status = 0;
+  nrow = (ny > 0) ? ny : 1;
+  m = n = 1;
+  for (iy = 0; iy < nrow; iy += m) {
+    for (ix = 0; ix < nx; ix += n) {
+      if (nx <= CEL_NTILE) {
+        n = nx;
+        m = CEL_NTILE/nx;
+        if (m > nrow - iy) m = nrow - iy;
+      } else {
+        n = nx - ix;
+        if (n > CEL_NTILE) n = CEL_NTILE;
+        m = 1;
+      }
+
+      k = iy*nx + ix;
+      phip   = phi   ? phi   + k : phib;
+      thetap = theta ? theta + k : thetab;
+
+      /* Apply spherical deprojection. */
+      if (ny > 0) {
+        istat = celprj->prjx2s(celprj, n, m, sxy, 1, x + ix*sxy, y + iy*sxy,
+                               phip, thetap, stat + k);
+      } else {
+        istat = celprj->prjx2s(celprj, n, 0, sxy, 1, x + ix*sxy, y + ix*sxy,
+                               phip, thetap, stat + k);
+      }
+
+      if (istat) {
+        if (istat != PRJERR_BAD_PIX) {
+          return wcserr_set(CEL_ERRMSG(istat));
+        }
+
+        status = CELERR_BAD_PIX;
+      }
+
+      /* Compute celestial unit vectors. */
+      sphfx2v(cel->fast, cel->rmat, n*m, 1, svec, phip, thetap,
+              vec + k*svec);
     }
+  }
+
+  if (status) wcserr_set(CEL_ERRMSG(status));
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int celv2x(cel, nvec, svec, sxy, vec, phi, theta, x, y, stat)
 
-    return wcserr_set(CEL_ERRMSG(status));
+struct celprm *cel;
+int nvec, svec, sxy;
+const double vec[];
+double phi[], theta[];
+double x[], y[];
+int stat[];
+
+{
+  static const char *function = "celv2x";
+
+  int    istat, k, n, status;
+  double phib[CEL_NTILE], thetab[CEL_NTILE];
+  register double *phip, *thetap;
+  struct prjprm *celprj;
+  struct wcserr **err;
+
+  /* Initialize. */
+  if (cel == 0x0) return CELERR_NULL_POINTER;
+  err = &(cel->err);
+
+  if (cel->flag != CELSET) {
+    if ((status = celset(cel))) return status;
   }
 
-  return 0;
+  celprj = &(cel->prj);
+
+  /* Rotate and project in tiles, as for cels2x(). */
+  status = 0;
+  for (k = 0; k < nvec; k += n) {
+    n = nvec - k;
+    if (n > CEL_NTILE) n = CEL_NTILE;
+
+    phip   = phi   ? phi   + k : phib;
+    thetap = theta ? theta + k : thetab;
+
+    /* Compute native coordinates. */
+    sphfv2x(cel->fast, cel->rmat, n, svec, 1, vec + k*svec, phip, thetap);
+
+    /* Apply the spherical projection. */
+    istat = celprj->prjs2x(celprj, n, 0, 1, sxy, phip, thetap, x + k*sxy,
+                           y + k*sxy, stat + k);
+
+    if (istat) {
+      if (istat == PRJERR_BAD_PARAM) {
+        return wcserr_set(CEL_ERRMSG(istat));
+      }
+
+      status = CELERR_BAD_WORLD;
+    }
+  }
+
+  if (status) wcserr_set(CEL_ERRMSG(status));
+
+  return status;
 }
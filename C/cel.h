@@ -63,11 +63,18 @@
 * level spherical coordinate rotation and projection routines described in
 * sph.h and prj.h.
 *
+* celx2v() and celv2x() are the same except that the celestial coordinates
+* are Cartesian unit vectors (direction cosines) rather than longitude and
+* latitude.  This saves the inverse trigonometric functions in celx2v(), and
+* the trigonometric functions of (lng,lat) in celv2x(), for applications that
+* would otherwise convert to or from unit vectors.
+*
 *
 * celini() - Default constructor for the celprm struct
 * ----------------------------------------------------
 * celini() sets all members of a celprm struct to default values.  It should
-* be used to initialize every celprm struct.
+* be used to initialize every celprm struct.  celfree() must be invoked
+* first if a celprm struct that was set up is to be reinitialized.
 *
 * Returned:
 *   cel       struct celprm*
@@ -140,6 +147,15 @@
 * celx2s() transforms (x,y) coordinates in the plane of projection to
 * celestial coordinates (lng,lat).
 *
+* If ny > 0, x[] and y[] are taken as the coordinates of the columns and rows
+* of a grid of nx*ny points.  For the cylindrical projections, for which theta
+* is then constant along each row, the spherical rotation reuses the
+* trigonometric functions of theta for the whole row.
+*
+* The coordinates are deprojected and rotated in tiles of a few hundred at a
+* time so that the intermediate native coordinates, (phi,theta), remain in
+* cache.  They are returned only if phi[] and theta[] are non-null.
+*
 * Given and returned:
 *   cel       struct celprm*
 *                       Celestial transformation parameters.
@@ -154,7 +170,8 @@
 *
 * Returned:
 *   phi,theta double[]  Longitude and latitude (phi,theta) in the native
-*                       coordinate system of the projection [deg].
+*                       coordinate system of the projection [deg].  Either
+*                       may be given as a null pointer if not required.
 *
 *   lng,lat   double[]  Celestial longitude and latitude (lng,lat) of the
 *                       projected point [deg].
@@ -183,6 +200,11 @@
 * cels2x() transforms celestial coordinates (lng,lat) to (x,y) coordinates in
 * the plane of projection.
 *
+* If nlat > 0, lng[] and lat[] are taken as the coordinates of the columns and
+* rows of a grid of nlng*nlat points.  As for celx2s(), the coordinates are
+* rotated and projected in tiles, and the native coordinates, (phi,theta),
+* are returned only if phi[] and theta[] are non-null.
+*
 * Given and returned:
 *   cel       struct celprm*
 *                       Celestial transformation parameters.
@@ -198,7 +220,8 @@
 *
 * Returned:
 *   phi,theta double[]  Longitude and latitude (phi,theta) in the native
-*                       coordinate system of the projection [deg].
+*                       coordinate system of the projection [deg].  Either
+*                       may be given as a null pointer if not required.
 *
 *   x,y       double[]  Projected coordinates in pseudo "degrees".
 *
@@ -221,6 +244,79 @@
 *                       celprm::err if enabled, see wcserr_enable().
 *
 *
+* celx2v() - Pixel-to-world celestial transformation to unit vectors
+* -------------------------------------------------------------------
+* celx2v() transforms (x,y) coordinates in the plane of projection to
+* celestial Cartesian unit vectors.  It is the same as celx2s() in all
+* other respects.  The native coordinates are converted directly to unit
+* vectors and rotated by celprm::rmat, see sphx2v().
+*
+* Given and returned:
+*   cel       struct celprm*
+*                       Celestial transformation parameters.
+*
+* Given:
+*   nx,ny     int       Vector lengths, as for celx2s().
+*
+*   sxy       int       Stride of the x and y vectors.
+*
+*   svec      int       Stride of the unit vectors, the three components of
+*                       each being stored contiguously.
+*
+*   x,y       const double[]
+*                       Projected coordinates in pseudo "degrees".
+*
+* Returned:
+*   phi,theta double[]  Longitude and latitude (phi,theta) in the native
+*                       coordinate system of the projection [deg].  Either
+*                       may be given as a null pointer if not required.
+*
+*   vec       double[]  Celestial unit vectors of the projected points.
+*
+*   stat      int[]     Status return value for each vector element, as for
+*                       celx2s().
+*
+* Function return value:
+*             int       Status return value as for celx2s().
+*
+*
+* celv2x() - World-to-pixel celestial transformation from unit vectors
+* --------------------------------------------------------------------
+* celv2x() transforms celestial Cartesian unit vectors to (x,y) coordinates
+* in the plane of projection.  It is the same as cels2x() except that grid
+* mode is not supported.  The unit vectors are rotated by the transpose of
+* celprm::rmat and converted directly to native coordinates, see sphv2x().
+*
+* Given and returned:
+*   cel       struct celprm*
+*                       Celestial transformation parameters.
+*
+* Given:
+*   nvec      int       Number of unit vectors.
+*
+*   svec      int       Stride of the unit vectors, the three components of
+*                       each being stored contiguously.
+*
+*   sxy       int       Stride of the x and y vectors.
+*
+*   vec       const double[]
+*                       Celestial unit vectors.  These need not be
+*                       normalized.
+*
+* Returned:
+*   phi,theta double[]  Longitude and latitude (phi,theta) in the native
+*                       coordinate system of the projection [deg].  Either
+*                       may be given as a null pointer if not required.
+*
+*   x,y       double[]  Projected coordinates in pseudo "degrees".
+*
+*   stat      int[]     Status return value for each vector element, as for
+*                       cels2x().
+*
+* Function return value:
+*             int       Status return value as for cels2x().
+*
+*
 * celprm struct - Celestial transformation parameters
 * ---------------------------------------------------
 * The celprm struct contains information required to transform celestial
@@ -236,6 +332,7 @@
 *     following celprm struct members are set or changed:
 *
 *       - celprm::offset,
+*       - celprm::fast,
 *       - celprm::phi0,
 *       - celprm::theta0,
 *       - celprm::ref[4],
@@ -255,6 +352,14 @@
 *     force (x,y) = (0,0) at the fiducial point, (phi_0,theta_0).
 *     Default is 0 (false).
 *
+*   int fast
+*     (Given) If true (non-zero), the SIMD kernels for the projection and the
+*     spherical rotation evaluate the trigonometric functions with faster,
+*     reduced-accuracy approximations, see prjprm::fast and sphfx2s().
+*     celset() copies it to prjprm::fast.  The celestial coordinates are
+*     then accurate to within 1E-7 deg (WCS_FASTACC in wcs.h) rather than
+*     1E-10 deg.  Default is 0 (false).
+*
 *   double phi0
 *     (Given) The native longitude, phi_0 [deg], and ...
 *
@@ -328,6 +433,13 @@
 *     intermediate calculations common to all elements in a vector
 *     computation.
 *
+*   double rmat[9]
+*     (Returned) The spherical rotation expressed as a 3x3 matrix, stored in
+*     row-major order, that transforms a unit vector in native spherical
+*     coordinates to one in celestial spherical coordinates; its transpose
+*     effects the inverse.  Computed from the Euler angles by sphmat(), for
+*     use with sphrot().
+*
 *   struct wcserr *err
 *     (Returned) If enabled, when an error status is returned this struct
 *     contains detailed information about the error, see wcserr_enable().
@@ -376,6 +488,7 @@ struct celprm {
   /* Parameters to be provided (see the prologue above).                    */
   /*------------------------------------------------------------------------*/
   int    offset;		/* Force (x,y) = (0,0) at (phi_0,theta_0).  */
+  int    fast;			/* Use reduced-accuracy SIMD trig functions.*/
   double phi0, theta0;		/* Native coordinates of fiducial point.    */
   double ref[4];		/* Celestial coordinates of fiducial        */
                                 /* point and native coordinates of          */
@@ -388,6 +501,7 @@ struct celprm {
   double euler[5];		/* Euler angles and functions thereof.      */
   int    latpreq;		/* LATPOLEa requirement.                    */
   int    isolat;		/* True if |latitude| is preserved.         */
+  double rmat[9];		/* Native-to-celestial rotation matrix.     */
 
   /* Error handling                                                         */
   /*------------------------------------------------------------------------*/
@@ -420,6 +534,14 @@ int cels2x(struct celprm *cel, int nlng, int nlat, int sll, int sxy,
            double phi[], double theta[], double x[], double y[],
            int stat[]);
 
+int celx2v(struct celprm *cel, int nx, int ny, int sxy, int svec,
+           const double x[], const double y[],
+           double phi[], double theta[], double vec[], int stat[]);
+
+int celv2x(struct celprm *cel, int nvec, int svec, int sxy,
+           const double vec[], double phi[], double theta[],
+           double x[], double y[], int stat[]);
+
 
 /* Deprecated. */
 #define celini_errmsg cel_errmsg
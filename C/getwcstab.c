@@ -25,13 +25,41 @@
   $Id: getwcstab.c,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
 *===========================================================================*/
 
+#include <ctype.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include <fitsio.h>
 
 #include "getwcstab.h"
 
+#ifdef _POSIX_MAPPED_FILES
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+static int wcstab_mmap(fitsfile *fptr, int colnum, long row, long nelem,
+                       const char *cachedir, double **arrayp);
+static int wcstab_mapfile(const char *name, LONGLONG headstart,
+                          LONGLONG offset, long nelem, const char *cachedir,
+                          double **arrayp);
+static int wcstab_cache(int fd, const struct stat *st, LONGLONG offset,
+                        long nelem, int swap, const char *cachedir,
+                        double **arrayp);
+static void wcstab_order(const unsigned char *src, long nelem, int swap,
+                         double *dst);
+static long wcstab_nelem(const wtbarr *wtbp);
+#endif
+
+static int wcstab_read(fitsfile *fptr, int nwtb, wtbarr *wtb, int domap,
+                       const char *cachedir, int *status);
+
 /*--------------------------------------------------------------------------*/
 
 int fits_read_wcstab(
@@ -41,7 +69,69 @@ int fits_read_wcstab(
   int  *status)
 
 {
-  int  anynul, colnum, hdunum, iwtb, m, naxis, nostat;
+  return wcstab_read(fptr, nwtb, wtb, 0, 0x0, status);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int fits_map_wcstab(
+  fitsfile   *fptr,
+  int  nwtb,
+  wtbarr *wtb,
+  const char *cachedir,
+  int  *status)
+
+{
+  return wcstab_read(fptr, nwtb, wtb, 1, cachedir, status);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int fits_unmap_wcstab(
+  int  nwtb,
+  wtbarr *wtb)
+
+{
+#ifdef _POSIX_MAPPED_FILES
+  char *base, *endp;
+  int  iwtb;
+  long pagesz;
+  wtbarr *wtbp;
+
+  pagesz = sysconf(_SC_PAGESIZE);
+
+  wtbp = wtb;
+  for (iwtb = 0; iwtb < nwtb; iwtb++, wtbp++) {
+    if (wtbp->kind != 'C' && wtbp->kind != 'I') continue;
+
+    if (*wtbp->arrayp) {
+      /* The array lies within the first page of its mapping. */
+      endp = (char *)(*wtbp->arrayp + wcstab_nelem(wtbp));
+      base = (char *)*wtbp->arrayp;
+      base -= ((size_t)base) % pagesz;
+      munmap(base, endp - base);
+      *wtbp->arrayp = 0x0;
+    }
+
+    wtbp->kind = tolower(wtbp->kind);
+  }
+#endif
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcstab_read(
+  fitsfile   *fptr,
+  int  nwtb,
+  wtbarr *wtb,
+  int  domap,
+  const char *cachedir,
+  int  *status)
+
+{
+  int  anynul, colnum, hdunum, iwtb, m, mappable, naxis, nostat;
   long *naxes = 0, nelem;
   wtbarr *wtbp;
 
@@ -58,6 +148,7 @@ int fits_read_wcstab(
   wtbp = wtb;
   for (iwtb = 0; iwtb < nwtb; iwtb++, wtbp++) {
     *wtbp->arrayp = 0x0;
+    wtbp->kind = tolower(wtbp->kind);
   }
 
   /* Save HDU number so that we can move back to it later. */
@@ -111,6 +202,9 @@ int fits_read_wcstab(
         *(wtbp->dimlen + m) = naxes[m+1];
         nelem *= naxes[m+1];
       }
+
+      /* fits_unmap_wcstab() recovers the size from ndim and dimlen. */
+      mappable = (naxes[0] == wtbp->ndim - 1);
     } else {
       /* Index vector; check length. */
       if ((nelem = naxes[0]) != *(wtbp->dimlen)) {
@@ -118,11 +212,24 @@ int fits_read_wcstab(
         *status = BAD_TDIM;
         goto cleanup;
       }
+
+      mappable = 1;
     }
 
     free(naxes);
     naxes = 0;
 
+#ifdef _POSIX_MAPPED_FILES
+    /* Map the array from the file if possible. */
+    if (domap && mappable && nelem > 0 &&
+        !wcstab_mmap(fptr, colnum, wtbp->row, nelem, cachedir,
+                     wtbp->arrayp)) {
+      /* Upper case kind marks the array as mapped. */
+      wtbp->kind = toupper(wtbp->kind);
+      continue;
+    }
+#endif
+
     /* Allocate memory for the array. */
     if (!(*wtbp->arrayp = calloc((size_t)nelem, sizeof(double)))) {
       *status = MEMORY_ALLOCATION;
@@ -146,9 +253,296 @@ cleanup:
   if (*status) {
     wtbp = wtb;
     for (iwtb = 0; iwtb < nwtb; iwtb++, wtbp++) {
-      if (*wtbp->arrayp) free(*wtbp->arrayp);
+      if (wtbp->kind == 'c' || wtbp->kind == 'i') {
+        if (*wtbp->arrayp) free(*wtbp->arrayp);
+        *wtbp->arrayp = 0x0;
+      }
     }
+
+    fits_unmap_wcstab(nwtb, wtb);
   }
 
   return *status;
 }
+
+#ifdef _POSIX_MAPPED_FILES
+
+/*----------------------------------------------------------------------------
+* Map a column of a binary table in a disk file if it is stored as unscaled
+* doubles.  Returns 0 on success, otherwise the array must be read.
+*---------------------------------------------------------------------------*/
+
+int wcstab_mmap(
+  fitsfile   *fptr,
+  int  colnum,
+  long row,
+  long nelem,
+  const char *cachedir,
+  double **arrayp)
+
+{
+  char name[FLEN_FILENAME], urltype[FLEN_FILENAME];
+  int  mode, status = 0, typecode;
+  long repeat, width;
+  LONGLONG datastart, dataend, headstart, heapaddr, length, offset;
+  tcolumn *colptr;
+
+  /* Only a plain disk file may be mapped, not one uncompressed or otherwise
+     held in memory by CFITSIO. */
+  if (fits_url_type(fptr, urltype, &status) ||
+      strcmp(urltype, "file://")) {
+    return 1;
+  }
+
+  if (fits_file_name(fptr, name, &status)) return 1;
+
+  /* The column must hold unscaled doubles. */
+  if (fits_get_coltype(fptr, colnum, &typecode, &repeat, &width, &status)) {
+    return 1;
+  }
+
+  colptr = (fptr->Fptr)->tableptr + colnum - 1;
+  if (colptr->tscale != 1.0 || colptr->tzero != 0.0) return 1;
+
+  if (fits_get_hduaddrll(fptr, &headstart, &datastart, &dataend, &status)) {
+    return 1;
+  }
+
+  if (typecode == TDOUBLE) {
+    /* Fixed-length array stored in the row. */
+    if (repeat < nelem) return 1;
+    offset = datastart + (row - 1)*(fptr->Fptr)->rowlength + colptr->tbcol;
+
+  } else if (typecode == -TDOUBLE) {
+    /* Variable-length array stored in the heap. */
+    if (fits_read_descriptll(fptr, colnum, (LONGLONG)row, &length, &heapaddr,
+        &status)) {
+      return 1;
+    }
+
+    if (length < nelem) return 1;
+    offset = datastart + (fptr->Fptr)->heapstart + heapaddr;
+
+  } else {
+    return 1;
+  }
+
+  if (offset + nelem*(LONGLONG)sizeof(double) > dataend) return 1;
+
+  /* Changes not yet written would not be seen in the mapping. */
+  if (fits_file_mode(fptr, &mode, &status)) return 1;
+  if (mode == READWRITE && fits_flush_buffer(fptr, 0, &status)) return 1;
+
+  return wcstab_mapfile(name, headstart, offset, nelem, cachedir, arrayp);
+}
+
+/*----------------------------------------------------------------------------
+* Map nelem big-endian doubles at the given byte offset in the named file as
+* an array of native doubles.  On a big-endian host with the array suitably
+* aligned the file pages are mapped directly.  Otherwise, if cachedir is
+* given, the array is converted to a cache file in that directory which is
+* mapped in its place, so that processes mapping the same array share one
+* converted copy.  The mapped array always lies within the first page of its
+* mapping.  Returns 0 on success.
+*---------------------------------------------------------------------------*/
+
+int wcstab_mapfile(
+  const char *name,
+  LONGLONG headstart,
+  LONGLONG offset,
+  long nelem,
+  const char *cachedir,
+  double **arrayp)
+
+{
+  const unsigned char one[8] = {0x3f, 0xf0, 0, 0, 0, 0, 0, 0};
+  char card[8], *map;
+  int  fd, i, status, swap;
+  long pagesz;
+  size_t nbytes, skip;
+  struct stat st;
+  union {
+    double d;
+    unsigned char c[8];
+  } native;
+
+  /* FITS doubles are big-endian; determine what the host needs. */
+  native.d = 1.0;
+  if (memcmp(native.c, one, 8) == 0) {
+    swap = 0;
+  } else {
+    for (i = 0; i < 8; i++) {
+      if (native.c[i] != one[7-i]) return 1;
+    }
+    swap = 1;
+  }
+
+  if ((fd = open(name, O_RDONLY)) < 0) return 1;
+
+  status = 1;
+  nbytes = nelem*sizeof(double);
+  if (fstat(fd, &st) || (LONGLONG)st.st_size < offset + (LONGLONG)nbytes) {
+    goto cleanup;
+  }
+
+  /* Check that the file is the one CFITSIO is reading. */
+  if (pread(fd, card, 8, (off_t)headstart) != 8 ||
+      strncmp(card, "XTENSION", 8)) {
+    goto cleanup;
+  }
+
+  if (swap || offset%sizeof(double)) {
+    /* Needs conversion. */
+    if (cachedir) {
+      status = wcstab_cache(fd, &st, offset, nelem, swap, cachedir, arrayp);
+    }
+
+  } else {
+    /* Point straight at the file pages. */
+    pagesz = sysconf(_SC_PAGESIZE);
+    skip   = offset % pagesz;
+    map = mmap(0, skip + nbytes, PROT_READ, MAP_SHARED, fd,
+               (off_t)(offset - skip));
+    if (map != MAP_FAILED) {
+      *arrayp = (double *)(map + skip);
+      status = 0;
+    }
+  }
+
+cleanup:
+  close(fd);
+  return status;
+}
+
+/*----------------------------------------------------------------------------
+* Map an array converted to native byte order from a cache file, creating it
+* if necessary.  The file name is derived from the identity and modification
+* time of the FITS file and the location of the array within it.
+*---------------------------------------------------------------------------*/
+
+int wcstab_cache(
+  int  fd,
+  const struct stat *st,
+  LONGLONG offset,
+  long nelem,
+  int  swap,
+  const char *cachedir,
+  double **arrayp)
+
+{
+  char path[FLEN_FILENAME+128], tmppath[FLEN_FILENAME+160], *map, *src;
+  int  cfd, status;
+  long chunk, n, pagesz;
+  size_t maplen, nbytes, skip;
+  double buf[512];
+  struct stat cst;
+
+  if (strlen(cachedir) >= FLEN_FILENAME) return 1;
+
+  nbytes = nelem*sizeof(double);
+  sprintf(path, "%s/wcstab-%c-%lx-%lx-%lx-%lx-%lx-%lx.dbl", cachedir,
+    swap ? 'l' : 'b', (unsigned long)st->st_dev, (unsigned long)st->st_ino,
+    (unsigned long)st->st_size, (unsigned long)st->st_mtime,
+    (unsigned long)offset, nelem);
+
+  if ((cfd = open(path, O_RDONLY)) < 0) {
+    /* Not yet cached; convert the array to a temporary file then move it
+       into place so that other processes never see it incomplete. */
+    sprintf(tmppath, "%s.%ld", path, (long)getpid());
+    if ((cfd = open(tmppath, O_WRONLY | O_CREAT | O_EXCL, 0644)) < 0) {
+      return 1;
+    }
+
+    pagesz = sysconf(_SC_PAGESIZE);
+    skip   = offset % pagesz;
+    maplen = skip + nbytes;
+    map = mmap(0, maplen, PROT_READ, MAP_SHARED, fd, (off_t)(offset - skip));
+
+    status = (map == MAP_FAILED);
+    if (!status) {
+      src = map + skip;
+      for (n = 0; n < nelem; n += chunk) {
+        chunk = nelem - n;
+        if (chunk > 512) chunk = 512;
+
+        wcstab_order((unsigned char *)src, chunk, swap, buf);
+        if (write(cfd, buf, chunk*sizeof(double)) !=
+            (ssize_t)(chunk*sizeof(double))) {
+          status = 1;
+          break;
+        }
+
+        src += chunk*sizeof(double);
+      }
+
+      munmap(map, maplen);
+    }
+
+    if (close(cfd)) status = 1;
+    if (status || rename(tmppath, path)) {
+      unlink(tmppath);
+      return 1;
+    }
+
+    if ((cfd = open(path, O_RDONLY)) < 0) return 1;
+  }
+
+  status = 1;
+  if (fstat(cfd, &cst) == 0 && (size_t)cst.st_size == nbytes) {
+    map = mmap(0, nbytes, PROT_READ, MAP_SHARED, cfd, 0);
+    if (map != MAP_FAILED) {
+      *arrayp = (double *)map;
+      status = 0;
+    }
+  }
+
+  close(cfd);
+  return status;
+}
+
+/*----------------------------------------------------------------------------
+* Copy nelem big-endian doubles to native byte order; src and dst may
+* coincide.
+*---------------------------------------------------------------------------*/
+
+void wcstab_order(
+  const unsigned char *src,
+  long nelem,
+  int  swap,
+  double *dst)
+
+{
+  int  i;
+  long n;
+  unsigned char b[8];
+
+  for (n = 0; n < nelem; n++, src += 8) {
+    for (i = 0; i < 8; i++) {
+      b[i] = swap ? src[7-i] : src[i];
+    }
+    memcpy(dst + n, b, 8);
+  }
+}
+
+/*----------------------------------------------------------------------------
+* Number of elements in a mapped array.
+*---------------------------------------------------------------------------*/
+
+long wcstab_nelem(
+  const wtbarr *wtbp)
+
+{
+  int  m;
+  long nelem;
+
+  if (toupper(wtbp->kind) == 'I') return *(wtbp->dimlen);
+
+  nelem = wtbp->ndim - 1;
+  for (m = 0; m < wtbp->ndim - 1; m++) {
+    nelem *= wtbp->dimlen[m];
+  }
+
+  return nelem;
+}
+
+#endif /* _POSIX_MAPPED_FILES */
@@ -32,6 +32,10 @@
 * incorporated into CFITSIO as of v3.006 with the definitions in this file,
 * getwcstab.h, moved into fitsio.h.
 *
+* fits_map_wcstab() is a variant that memory-maps the arrays from the file
+* rather than copying them, and fits_unmap_wcstab() releases the mappings.
+* These are not part of CFITSIO.
+*
 * fits_read_wcstab() is not included in the WCSLIB object library but the
 * source code is presented here as it may be useful for programmers using an
 * older version of CFITSIO than 3.006, or as a programming template for
@@ -110,6 +114,83 @@
 *   typedef.
 *
 *
+* fits_map_wcstab() - Memory-map FITS 'TAB' arrays
+* ------------------------------------------------
+* fits_map_wcstab() is like fits_read_wcstab() except that, where possible,
+* it points the wtbarr arrays straight at the pages of the FITS file mapped
+* into memory, rather than allocating memory for them and reading them.  The
+* pages are shared between all processes that map the same file, and are
+* only read from disk as they are used, which may be advantageous for very
+* large lookup tables.
+*
+* An array may be mapped if the file is an uncompressed disk file and the
+* array is stored as unscaled double precision values ('D' format without
+* TSCALn or TZEROn), either in the row or in the heap.  However, FITS stores
+* its values in big-endian byte order.  On a big-endian host the file pages
+* themselves are mapped, but on a little-endian host, such as x86, the array
+* must be converted to native byte order.  If cachedir is given, the
+* converted array is written to a file in that directory, which is then
+* mapped instead.  Other processes mapping the same array will find and
+* share it.  The cache file name encodes the device, inode, size, and
+* modification time of the FITS file together with the location of the array
+* within it, so a modified FITS file simply acquires new cache files.
+* However, stale cache files are never removed - that is left to the user.
+*
+* Arrays that can not be mapped are read as by fits_read_wcstab().
+*
+* Given:
+*   fptr      fitsfile *
+*                       Pointer to the file handle returned, for example, by
+*                       the fits_open_file() routine in CFITSIO.
+*
+*   nwtb      int       Number of arrays to be read from the binary table(s).
+*
+*   cachedir  const char *
+*                       Directory in which to cache arrays converted to
+*                       native byte order.  If null, arrays that need
+*                       conversion are read rather than mapped.
+*
+* Given and returned:
+*   wtb       wtbarr *  Address of the first element of an array of wtbarr
+*                       typedefs, as for fits_read_wcstab().  On return,
+*                       wtbarr::kind is set to upper case, 'C' or 'I', for
+*                       each array that was mapped.  The mapped memory is
+*                       read-only.
+*
+* Returned:
+*   status    int *     CFITSIO status value.
+*
+* Function return value:
+*             int       CFITSIO status value.
+*
+* Notes:
+*   The mapped memory belongs to fits_map_wcstab(), not to WCSLIB.  wcsset()
+*   recognizes mapped arrays by their upper case wtbarr::kind and does not
+*   take control of them as it would for arrays read by fits_read_wcstab(),
+*   so that wcsfree() will not attempt to free them.  The mappings remain
+*   valid after the FITS file is closed, until fits_unmap_wcstab() is called.
+*
+*
+* fits_unmap_wcstab() - Release memory-mapped FITS 'TAB' arrays
+* -------------------------------------------------------------
+* fits_unmap_wcstab() releases the arrays mapped by fits_map_wcstab(),
+* leaving those that were read to be freed by WCSLIB.  It must be called
+* before the wcsprm struct that owns the wtbarr array is freed, and the
+* struct must not be used for tabular transformations thereafter.
+*
+* Given:
+*   nwtb      int       Number of arrays in the wtbarr array.
+*
+* Given and returned:
+*   wtb       wtbarr *  Address of the first element of an array of wtbarr
+*                       typedefs.  The array pointers of those that were
+*                       mapped are zeroed and wtbarr::kind restored to lower
+*                       case.
+*
+* Function return value:
+*             int       Status return value, always 0.
+*
+*
 * wtbarr typedef
 * --------------
 * The wtbarr typedef is defined as a struct containing the following members:
@@ -124,6 +205,7 @@
 *     Character identifying the array type:
 *       - c: coordinate array,
 *       - i: index vector.
+*     Set to upper case by fits_map_wcstab() if the array is memory-mapped.
 *
 *   char extnam[72]
 *     EXTNAME identifying the binary table extension.
@@ -166,7 +248,8 @@ extern "C" {
 typedef struct {
   int  i;			/* Image axis number.                       */
   int  m;			/* Array axis number for index vectors.     */
-  int  kind;			/* Array type, 'c' (coord) or 'i' (index).  */
+  int  kind;			/* Array type, 'c' (coord) or 'i' (index),  */
+				/* upper case if memory-mapped.             */
   char extnam[72];		/* EXTNAME of binary table extension.       */
   int  extver;			/* EXTVER  of binary table extension.       */
   int  extlev;			/* EXTLEV  of binary table extension.       */
@@ -181,6 +264,11 @@ typedef struct {
 
 int fits_read_wcstab(fitsfile *fptr, int nwtb, wtbarr *wtb, int *status);
 
+int fits_map_wcstab(fitsfile *fptr, int nwtb, wtbarr *wtb,
+                    const char *cachedir, int *status);
+
+int fits_unmap_wcstab(int nwtb, wtbarr *wtb);
+
 
 #ifdef __cplusplus
 }
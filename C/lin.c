@@ -40,11 +40,26 @@ const char *lin_errmsg[] = {
   "Success",
   "Null linprm pointer passed",
   "Memory allocation failed",
-  "PCi_ja matrix is singular"};
+  "PCi_ja matrix is singular",
+  "Invalid parameter value"};
 
 /* Convenience macro for invoking wcserr_set(). */
 #define LIN_ERRMSG(status) WCSERR_SET(status), lin_errmsg[status]
 
+/* Fixed-dimension forms of linp2x() and linx2p(), for internal use only. */
+static int lin_p2x2(const struct linprm *, int, int, const double[],
+                    double[]);
+static int lin_x2p2(const struct linprm *, int, int, const double[],
+                    double[]);
+static int lin_p2x3(const struct linprm *, int, int, const double[],
+                    double[]);
+static int lin_x2p3(const struct linprm *, int, int, const double[],
+                    double[]);
+static int lin_p2x4(const struct linprm *, int, int, const double[],
+                    double[]);
+static int lin_x2p4(const struct linprm *, int, int, const double[],
+                    double[]);
+
 /*--------------------------------------------------------------------------*/
 
 int linini(alloc, naxis, lin)
@@ -514,6 +529,16 @@ double imgcrd[];
     }
 
   } else {
+    /* The matrix elements are held in registers for two to four axes. */
+    switch (n) {
+    case 2:
+      return lin_p2x2(lin, ncoord, nelem, pixcrd, imgcrd);
+    case 3:
+      return lin_p2x3(lin, ncoord, nelem, pixcrd, imgcrd);
+    case 4:
+      return lin_p2x4(lin, ncoord, nelem, pixcrd, imgcrd);
+    }
+
     for (k = 0; k < ncoord; k++) {
       for (i = 0; i < n; i++) {
         img[i] = 0.0;
@@ -576,6 +601,15 @@ double pixcrd[];
     }
 
   } else {
+    switch (n) {
+    case 2:
+      return lin_x2p2(lin, ncoord, nelem, imgcrd, pixcrd);
+    case 3:
+      return lin_x2p3(lin, ncoord, nelem, imgcrd, pixcrd);
+    case 4:
+      return lin_x2p4(lin, ncoord, nelem, imgcrd, pixcrd);
+    }
+
     for (k = 0; k < ncoord; k++) {
       imgpix = lin->imgpix;
 
@@ -599,6 +633,212 @@ double pixcrd[];
 
 /*--------------------------------------------------------------------------*/
 
+int linp2xr(lin, ncoord, nelem, iaxis, pixcrd, imgcrd)
+
+struct linprm *lin;
+int ncoord, nelem, iaxis;
+const double pixcrd[];
+double imgcrd[];
+
+{
+  static const char *function = "linp2xr";
+
+  int i, j, k, n, status;
+  double crpix, pix0, temp;
+  register double *img;
+  register const double *piximg;
+  struct wcserr **err;
+
+
+  /* Initialize. */
+  if (lin == 0x0) return LINERR_NULL_POINTER;
+  err = &(lin->err);
+
+  if (lin->flag != LINSET) {
+    if ((status = linset(lin))) return status;
+  }
+
+  n = lin->naxis;
+  if (iaxis < 0 || iaxis >= n) {
+    return wcserr_set(WCSERR_SET(LINERR_BAD_PARAM),
+      "Invalid pixel axis, iaxis = %d, for naxis = %d", iaxis, n);
+  }
+
+  if (ncoord < 1) return 0;
+
+  pix0  = pixcrd[iaxis];
+  crpix = lin->crpix[iaxis];
+
+
+  /* The contribution of the other pixel axes is the same for every pixel */
+  /* in the row; it is stored in the first output vector, which is thus   */
+  /* computed last.                                                       */
+  if (lin->unity) {
+    for (i = 0; i < n; i++) {
+      if (i == iaxis) continue;
+      imgcrd[i] = lin->cdelt[i] * (pixcrd[i] - lin->crpix[i]);
+    }
+
+    img = imgcrd + (ncoord-1)*nelem;
+    for (k = ncoord-1; k >= 0; k--, img -= nelem) {
+      for (i = 0; i < n; i++) {
+        img[i] = imgcrd[i];
+      }
+
+      img[iaxis] = lin->cdelt[iaxis] * ((pix0 + k) - crpix);
+    }
+
+  } else {
+    piximg = lin->piximg;
+    for (i = 0; i < n; i++) {
+      temp = 0.0;
+      for (j = 0; j < n; j++, piximg++) {
+        if (j == iaxis) continue;
+        temp += *piximg * (pixcrd[j] - lin->crpix[j]);
+      }
+
+      imgcrd[i] = temp;
+    }
+
+    /* Each pixel is computed from the first rather than from its         */
+    /* predecessor, so rounding errors do not accumulate along the row.   */
+    img = imgcrd + (ncoord-1)*nelem;
+    for (k = ncoord-1; k >= 0; k--, img -= nelem) {
+      temp = (pix0 + k) - crpix;
+
+      piximg = lin->piximg + iaxis;
+      for (i = 0; i < n; i++, piximg += n) {
+        img[i] = imgcrd[i] + *piximg * temp;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int linp2xf(lin, ncoord, nelem, pixcrd, imgcrd)
+
+struct linprm *lin;
+int ncoord, nelem;
+const float pixcrd[];
+float imgcrd[];
+
+{
+  int i, j, k, n, status;
+  double temp;
+  register const float *pix;
+  register float *img;
+  register const double *piximg;
+
+
+  /* Initialize. */
+  if (lin == 0x0) return LINERR_NULL_POINTER;
+  if (lin->flag != LINSET) {
+    if ((status = linset(lin))) return status;
+  }
+
+  n = lin->naxis;
+
+
+  /* Convert pixel coordinates to intermediate world coordinates, */
+  /* accumulating each element in double precision.               */
+  pix = pixcrd;
+  img = imgcrd;
+
+  if (lin->unity) {
+    for (k = 0; k < ncoord; k++) {
+      for (i = 0; i < n; i++) {
+        *(img++) = (float)(lin->cdelt[i] * (*(pix++) - lin->crpix[i]));
+      }
+
+      pix += (nelem - n);
+      img += (nelem - n);
+    }
+
+  } else {
+    for (k = 0; k < ncoord; k++) {
+      piximg = lin->piximg;
+      for (i = 0; i < n; i++) {
+        temp = 0.0;
+        for (j = 0; j < n; j++) {
+          temp += *(piximg++) * (pix[j] - lin->crpix[j]);
+        }
+
+        img[i] = (float)temp;
+      }
+
+      pix += nelem;
+      img += nelem;
+    }
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int linx2pf(lin, ncoord, nelem, imgcrd, pixcrd)
+
+struct linprm *lin;
+int ncoord, nelem;
+const float imgcrd[];
+float pixcrd[];
+
+{
+  int i, j, k, n, status;
+  double temp;
+  register const float *img;
+  register float *pix;
+  register const double *imgpix;
+
+
+  /* Initialize. */
+  if (lin == 0x0) return LINERR_NULL_POINTER;
+  if (lin->flag != LINSET) {
+    if ((status = linset(lin))) return status;
+  }
+
+  n = lin->naxis;
+
+
+  /* Convert intermediate world coordinates to pixel coordinates. */
+  img = imgcrd;
+  pix = pixcrd;
+
+  if (lin->unity) {
+    for (k = 0; k < ncoord; k++) {
+      for (j = 0; j < n; j++) {
+        *(pix++) = (float)((*(img++) / lin->cdelt[j]) + lin->crpix[j]);
+      }
+
+      pix += (nelem - n);
+      img += (nelem - n);
+    }
+
+  } else {
+    for (k = 0; k < ncoord; k++) {
+      imgpix = lin->imgpix;
+      for (j = 0; j < n; j++) {
+        temp = 0.0;
+        for (i = 0; i < n; i++) {
+          temp += *(imgpix++) * img[i];
+        }
+
+        pix[j] = (float)(temp + lin->crpix[j]);
+      }
+
+      pix += nelem;
+      img += nelem;
+    }
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
 int matinv(int n, const double mat[], double inv[])
 
 {
@@ -747,3 +987,195 @@ int matinv(int n, const double mat[], double inv[])
 
    return 0;
 }
+
+/*--------------------------------------------------------------------------*/
+
+int lin_p2x2(lin, ncoord, nelem, pixcrd, imgcrd)
+
+const struct linprm *lin;
+int ncoord, nelem;
+const double pixcrd[];
+double imgcrd[];
+
+{
+  int i, k;
+  double c[2], m[4], t0, t1;
+  register const double *pix;
+  register double *img;
+
+  for (i = 0; i < 2; i++) c[i] = lin->crpix[i];
+  for (i = 0; i < 4; i++) m[i] = lin->piximg[i];
+
+  pix = pixcrd;
+  img = imgcrd;
+  for (k = 0; k < ncoord; k++, pix += nelem, img += nelem) {
+    t0 = pix[0] - c[0];
+    t1 = pix[1] - c[1];
+    img[0] = m[0]*t0 + m[1]*t1;
+    img[1] = m[2]*t0 + m[3]*t1;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int lin_x2p2(lin, ncoord, nelem, imgcrd, pixcrd)
+
+const struct linprm *lin;
+int ncoord, nelem;
+const double imgcrd[];
+double pixcrd[];
+
+{
+  int i, k;
+  double c[2], m[4], t0, t1;
+  register const double *img;
+  register double *pix;
+
+  for (i = 0; i < 2; i++) c[i] = lin->crpix[i];
+  for (i = 0; i < 4; i++) m[i] = lin->imgpix[i];
+
+  img = imgcrd;
+  pix = pixcrd;
+  for (k = 0; k < ncoord; k++, img += nelem, pix += nelem) {
+    t0 = img[0];
+    t1 = img[1];
+    pix[0] = (m[0]*t0 + m[1]*t1) + c[0];
+    pix[1] = (m[2]*t0 + m[3]*t1) + c[1];
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int lin_p2x3(lin, ncoord, nelem, pixcrd, imgcrd)
+
+const struct linprm *lin;
+int ncoord, nelem;
+const double pixcrd[];
+double imgcrd[];
+
+{
+  int i, k;
+  double c[3], m[9], t0, t1, t2;
+  register const double *pix;
+  register double *img;
+
+  for (i = 0; i < 3; i++) c[i] = lin->crpix[i];
+  for (i = 0; i < 9; i++) m[i] = lin->piximg[i];
+
+  pix = pixcrd;
+  img = imgcrd;
+  for (k = 0; k < ncoord; k++, pix += nelem, img += nelem) {
+    t0 = pix[0] - c[0];
+    t1 = pix[1] - c[1];
+    t2 = pix[2] - c[2];
+    img[0] = m[0]*t0 + m[1]*t1 + m[2]*t2;
+    img[1] = m[3]*t0 + m[4]*t1 + m[5]*t2;
+    img[2] = m[6]*t0 + m[7]*t1 + m[8]*t2;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int lin_x2p3(lin, ncoord, nelem, imgcrd, pixcrd)
+
+const struct linprm *lin;
+int ncoord, nelem;
+const double imgcrd[];
+double pixcrd[];
+
+{
+  int i, k;
+  double c[3], m[9], t0, t1, t2;
+  register const double *img;
+  register double *pix;
+
+  for (i = 0; i < 3; i++) c[i] = lin->crpix[i];
+  for (i = 0; i < 9; i++) m[i] = lin->imgpix[i];
+
+  img = imgcrd;
+  pix = pixcrd;
+  for (k = 0; k < ncoord; k++, img += nelem, pix += nelem) {
+    t0 = img[0];
+    t1 = img[1];
+    t2 = img[2];
+    pix[0] = (m[0]*t0 + m[1]*t1 + m[2]*t2) + c[0];
+    pix[1] = (m[3]*t0 + m[4]*t1 + m[5]*t2) + c[1];
+    pix[2] = (m[6]*t0 + m[7]*t1 + m[8]*t2) + c[2];
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int lin_p2x4(lin, ncoord, nelem, pixcrd, imgcrd)
+
+const struct linprm *lin;
+int ncoord, nelem;
+const double pixcrd[];
+double imgcrd[];
+
+{
+  int i, k;
+  double c[4], m[16], t0, t1, t2, t3;
+  register const double *pix;
+  register double *img;
+
+  for (i = 0; i < 4; i++) c[i] = lin->crpix[i];
+  for (i = 0; i < 16; i++) m[i] = lin->piximg[i];
+
+  pix = pixcrd;
+  img = imgcrd;
+  for (k = 0; k < ncoord; k++, pix += nelem, img += nelem) {
+    t0 = pix[0] - c[0];
+    t1 = pix[1] - c[1];
+    t2 = pix[2] - c[2];
+    t3 = pix[3] - c[3];
+    img[0] = m[0]*t0 + m[1]*t1 + m[2]*t2 + m[3]*t3;
+    img[1] = m[4]*t0 + m[5]*t1 + m[6]*t2 + m[7]*t3;
+    img[2] = m[8]*t0 + m[9]*t1 + m[10]*t2 + m[11]*t3;
+    img[3] = m[12]*t0 + m[13]*t1 + m[14]*t2 + m[15]*t3;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int lin_x2p4(lin, ncoord, nelem, imgcrd, pixcrd)
+
+const struct linprm *lin;
+int ncoord, nelem;
+const double imgcrd[];
+double pixcrd[];
+
+{
+  int i, k;
+  double c[4], m[16], t0, t1, t2, t3;
+  register const double *img;
+  register double *pix;
+
+  for (i = 0; i < 4; i++) c[i] = lin->crpix[i];
+  for (i = 0; i < 16; i++) m[i] = lin->imgpix[i];
+
+  img = imgcrd;
+  pix = pixcrd;
+  for (k = 0; k < ncoord; k++, img += nelem, pix += nelem) {
+    t0 = img[0];
+    t1 = img[1];
+    t2 = img[2];
+    t3 = img[3];
+    pix[0] = (m[0]*t0 + m[1]*t1 + m[2]*t2 + m[3]*t3) + c[0];
+    pix[1] = (m[4]*t0 + m[5]*t1 + m[6]*t2 + m[7]*t3) + c[1];
+    pix[2] = (m[8]*t0 + m[9]*t1 + m[10]*t2 + m[11]*t3) + c[2];
+    pix[3] = (m[12]*t0 + m[13]*t1 + m[14]*t2 + m[15]*t3) + c[3];
+  }
+
+  return 0;
+}
@@ -52,6 +52,9 @@
 * the explanation of linprm::flag.
 *
 * linp2x() and linx2p() implement the WCS linear transformations.
+* linp2xf() and linx2pf() are the same for coordinates stored in single
+* precision.  linp2xr() is a form of linp2x() for a row of pixels, evaluated
+* incrementally.
 *
 * An auxiliary matrix inversion routine, matinv(), is included.  It uses
 * LU-triangular factorization with scaled partial pivoting.
@@ -251,6 +254,87 @@
 *                       linprm::err if enabled, see wcserr_enable().
 *
 *
+* linp2xr() - Pixel-to-world linear transformation of a row of pixels
+* -------------------------------------------------------------------
+* linp2xr() transforms a row of ncoord pixels, in which pixel coordinate
+* iaxis increases by 1 from one pixel to the next starting from pixcrd, to
+* intermediate world coordinates.  The contribution of the other pixel axes
+* is computed only once for the row, after which each pixel costs a
+* multiply-add per element, the column of the pixel-to-image matrix for
+* iaxis being scaled by the offset of the pixel from CRPIXja.
+*
+* Each pixel is computed directly from the offset rather than by adding a
+* step to its predecessor, so there is no accumulation of rounding error
+* along the row.  The results differ from those of linp2x() for the same
+* pixels only in the order of summation, by no more than a few units in the
+* last place.  They are the same as those of linp2x() if the PCi_ja matrix
+* is unity.
+*
+* Given and returned:
+*   lin       struct linprm*
+*                       Linear transformation parameters.
+*
+* Given:
+*   ncoord    int       The number of pixels in the row.
+*
+*   nelem     int       Vector length of each coordinate, containing
+*                       lin.naxis coordinate elements.
+*
+*   iaxis     int       The pixel axis, 0-relative, that increases along the
+*                       row, 0 <= iaxis < lin.naxis.
+*
+*   pixcrd    const double[nelem]
+*                       Pixel coordinates of the first pixel in the row.
+*
+* Returned:
+*   imgcrd    double[ncoord][nelem]
+*                       Array of intermediate world coordinates.  It must
+*                       not overlap pixcrd.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null linprm pointer passed.
+*                         2: Memory allocation failed.
+*                         3: PCi_ja matrix is singular.
+*                         4: Invalid parameter value, iaxis out of range.
+*
+*                       For returns > 1, a detailed error message is set in
+*                       linprm::err if enabled, see wcserr_enable().
+*
+*
+* linp2xf(), linx2pf() - Single-precision linear transformations
+* --------------------------------------------------------------
+* linp2xf() and linx2pf() are the same as linp2x() and linx2p() except that
+* the pixel and intermediate world coordinates are of type float, halving
+* the memory they occupy.  The arithmetic is done in double precision and
+* the result rounded once on storage.
+*
+* Given and returned:
+*   lin       struct linprm*
+*                       Linear transformation parameters.
+*
+* Given:
+*   ncoord,
+*   nelem     int       The number of coordinates, each of vector length nelem
+*                       but containing lin.naxis coordinate elements.
+*
+*   pixcrd    const float[ncoord][nelem]
+*                       Array of pixel coordinates (linp2xf()), or ...
+*   imgcrd    const float[ncoord][nelem]
+*                       ... intermediate world coordinates (linx2pf()).
+*
+* Returned:
+*   imgcrd    float[ncoord][nelem]
+*                       Array of intermediate world coordinates (linp2xf()),
+*                       or ...
+*   pixcrd    float[ncoord][nelem]
+*                       ... pixel coordinates (linx2pf()).
+*
+* Function return value:
+*             int       Status return value, as for linp2x() and linx2p().
+*
+*
 * linprm struct - Linear transformation parameters
 * ------------------------------------------------
 * The linprm struct contains all of the information required to perform a
@@ -375,7 +459,8 @@ enum lin_errmsg_enum {
   LINERR_SUCCESS      = 0,	/* Success. */
   LINERR_NULL_POINTER = 1,	/* Null linprm pointer passed. */
   LINERR_MEMORY       = 2,	/* Memory allocation failed. */
-  LINERR_SINGULAR_MTX = 3 	/* PCi_ja matrix is singular. */
+  LINERR_SINGULAR_MTX = 3,	/* PCi_ja matrix is singular. */
+  LINERR_BAD_PARAM    = 4 	/* Invalid parameter value. */
 };
 
 struct linprm {
@@ -429,6 +514,15 @@ int linp2x(struct linprm *lin, int ncoord, int nelem, const double pixcrd[],
 int linx2p(struct linprm *lin, int ncoord, int nelem, const double imgcrd[],
            double pixcrd[]);
 
+int linp2xr(struct linprm *lin, int ncoord, int nelem, int iaxis,
+            const double pixcrd[], double imgcrd[]);
+
+int linp2xf(struct linprm *lin, int ncoord, int nelem, const float pixcrd[],
+            float imgcrd[]);
+
+int linx2pf(struct linprm *lin, int ncoord, int nelem, const float imgcrd[],
+            float pixcrd[]);
+
 int matinv(int n, const double mat[], double inv[]);
 
 
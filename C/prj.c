@@ -25,6 +25,7 @@
   $Id: prj.c,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
 *===========================================================================*/
 
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -33,6 +34,7 @@
 #include "wcserr.h"
 #include "wcsmath.h"
 #include "wcsprintf.h"
+#include "wcssimd.h"
 #include "wcstrig.h"
 #include "wcsutil.h"
 #include "prj.h"
@@ -115,6 +117,90 @@ const char *prj_errmsg[] = {
 
 #define copysign(X, Y) ((Y) < 0.0 ? -fabs(X) : fabs(X))
 
+/* Tolerance used by the projections with SIMD kernels for bounds checking
+   the native coordinates, relaxed for the reduced-accuracy trigonometric
+   functions, see prjprm::fast. */
+#define PRJ_BCHKTOL(prj) ((prj)->fast ? 1.0e-8 : 1.0e-13)
+
+/* Internal helper functions for the tabulated inverses of the ZPN, AIR, MOL
+   and PCO projections, not for general use.  A prj_tabf function computes
+   the tabulated function of its argument, returning its derivative via the
+   third argument. */
+typedef double prj_tabf(const struct prjprm *, double, double *);
+
+static void   prj_tab(struct prjprm *, double, prj_tabf *);
+static double prj_tabinv(const struct prjprm *, double, prj_tabf *);
+
+static prj_tabf zpn_r, air_r, mol_s;
+static double zpn_zd(const struct prjprm *, double);
+static void   pco_tab(struct prjprm *);
+static int    pco_tabinv(const struct prjprm *, double, double, double *,
+                         double *, double *);
+static double pco_the(const struct prjprm *, double, double, double *,
+                      double *);
+
+/* Internal helper functions for hpxs2p() and hpxp2s().  The floating point
+   stages, hpx_s2j() and hpx_q2t(), process arrays padded to a multiple of
+   HPX_NPAD elements. */
+#define HPX_NBLK 256
+#define HPX_NPAD 8
+
+/* Number of coordinates per block converted to double precision by
+   prjx2sf() and prjs2xf(). */
+#define PRJ_NFLT 256
+
+static int  hpx_chk(struct prjprm *, int, int, const char *);
+static void hpx_s2j(int, int, const double[], const double[], double[],
+                    double[], double[], double[]);
+static void hpx_q2t(int, const double[], const double[], double[]);
+static long hpx_xy2n(int, int);
+static void hpx_n2xy(long, int *, int *);
+static long hpx_isqrt(long);
+
+#ifdef WCSSIMD
+/* Number of coordinates per block processed by the SIMD kernels. */
+#define PRJ_NBLK (32*WCSSIMD_NLANE)
+
+/* Are the SIMD kernels enabled?  See prjsimd(). */
+static int prj_simd = 1;
+
+/* SIMD kernels for the x2s routines compute (phi,theta) and stat for blocks
+   of (x,y) offset by (x0,y0); theta[] also provides the value to be retained
+   for invalid coordinates that the scalar code would leave unchanged.  The
+   s2x kernels compute the radius, r, for a block of theta together with a
+   status value: 0 for success, 1 for invalid coordinates where (x,y) are
+   still computed, and 2 for invalid coordinates where (x,y) are zeroed. */
+typedef void prj_x2sk(const struct prjprm *, int, const double[],
+                      const double[], double[], double[], int[]);
+typedef void prj_s2xk(const struct prjprm *, int, const double[], double[],
+                      int[]);
+
+/* SIMD kernels for s2x routines that are not separable in phi and theta,
+   such as the quadcubes, are applied to blocks of (phi,theta) pairs given
+   as theta, sin(theta), and cos(theta).  On input x[] and y[] contain
+   cos(phi) and sin(phi) and on output the projected (x,y), with stat[] as
+   for the scalar routines. */
+typedef void prj_s2xpk(const struct prjprm *, int, const double[],
+                       const double[], const double[], double[], double[],
+                       int[]);
+
+static int prj_x2sv(struct prjprm *, int, int, int, int, const double[],
+                    const double[], double[], double[], int[], prj_x2sk *);
+static int prj_s2xv(struct prjprm *, int, int, int, int, const double[],
+                    const double[], double[], double[], int[], prj_s2xk *);
+static int prj_s2xp(struct prjprm *, int, int, int, int, const double[],
+                    const double[], double[], double[], int[], prj_s2xpk *);
+
+static int prj_fused(void);
+static wcsvd prj_qcx2s(wcsvd *, wcsvd *, int *);
+static wcsvd prj_qcs2x(wcsvd, wcsvd, wcsvd, wcsvd *);
+
+static prj_x2sk tanx2sv, stgx2sv, sinx2sv, arcx2sv, zeax2sv;
+static prj_s2xk tans2xv, stgs2xv, sins2xv, arcs2xv, zeas2xv;
+static prj_x2sk tscx2sv, qscx2sv;
+static prj_s2xpk tscs2xv, qscs2xv;
+#endif
+
 
 /*============================================================================
 * Generic routines:
@@ -122,13 +208,16 @@ const char *prj_errmsg[] = {
 * prjini initializes a prjprm struct to default values.
 *
 * prjfree frees any memory that may have been allocated to store an error
-*        message in the prjprm struct.
+*        message or a table of intermediate values in the prjprm struct.
 *
 * prjprt prints the contents of a prjprm struct.
 *
 * prjbchk performs bounds checking on the native coordinates returned by the
 *        *x2s() routines.
 *
+* prjsimd enables or disables the SIMD kernels used by some of the
+*        projection routines.
+*
 * prjset invokes the specific initialization routine based on the projection
 *        code in the prjprm struct.
 *
@@ -161,6 +250,7 @@ struct prjprm *prj;
   prj->phi0   = UNDEFINED;
   prj->theta0 = UNDEFINED;
   prj->bounds = 7;
+  prj->fast   = 0;
 
   strcpy(prj->name, "undefined");
   for (k = 9; k < 40; prj->name[k++] = '\0');
@@ -176,7 +266,7 @@ struct prjprm *prj;
 
   prj->err = 0x0;
 
-  prj->padding = 0x0;
+  prj->wtab = 0x0;
   for (k = 0; k < 10; prj->w[k++] = 0.0);
   prj->m = 0;
   prj->n = 0;
@@ -200,6 +290,11 @@ struct prjprm *prj;
     prj->err = 0x0;
   }
 
+  if (prj->wtab) {
+    free(prj->wtab);
+    prj->wtab = 0x0;
+  }
+
   return 0;
 }
 
@@ -255,6 +350,7 @@ const struct prjprm *prj;
     wcsprintf("     theta0: %9f\n", prj->theta0);
   }
   wcsprintf("     bounds: %d\n",  prj->bounds);
+  wcsprintf("       fast: %d\n",  prj->fast);
 
   wcsprintf("\n");
   wcsprintf("       name: \"%s\"\n", prj->name);
@@ -274,6 +370,7 @@ const struct prjprm *prj;
     wcserr_prt(prj->err, "             ");
   }
 
+  WCSPRINTF_PTR("       wtab: ", prj->wtab, "\n");
   wcsprintf("        w[]:");
   for (i = 0; i < 5; i++) {
     wcsprintf("  %- 11.5g", prj->w[i]);
@@ -351,6 +448,473 @@ int stat[];
 
 /*--------------------------------------------------------------------------*/
 
+int prjsimd(enable)
+
+int enable;
+
+{
+#ifdef WCSSIMD
+  int previous = prj_simd;
+
+  if (enable >= 0) prj_simd = (enable != 0);
+  return previous;
+#else
+  return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+
+#ifdef WCSSIMD
+
+/* Does the compiler contract x*x + y2 into a fused multiply-add?  The SIMD
+   kernels must compute the quantities used in bounds tests exactly as in the
+   scalar code, but this depends on compiler options such as -ffp-contract
+   that are not otherwise visible. */
+
+int prj_fused(void)
+
+{
+  volatile double a = 1.0 + 1.0/1073741824.0, b = -(1.0 + 1.0/536870912.0);
+  double x = a, y2 = b;
+
+  return (x*x + y2) != 0.0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int prj_x2sv(
+  struct prjprm *prj,
+  int nx,
+  int ny,
+  int sxy,
+  int spt,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[],
+  prj_x2sk *kernel)
+
+{
+  int grid, i, ix, k, mx, n, nbad, ntot, nv;
+  int sb[PRJ_NBLK];
+  double pb[PRJ_NBLK], tb[PRJ_NBLK], xb[PRJ_NBLK], yb[PRJ_NBLK];
+  register int *statp;
+  register const double *xp, *yp;
+  register double *phip, *thetap, *tp;
+
+  grid = (ny > 0);
+  if (grid) {
+    mx = nx;
+  } else {
+    mx = 1;
+    ny = nx;
+  }
+
+  ntot = mx*ny;
+  nbad = 0;
+
+  xp = x;
+  yp = y;
+  ix = 0;
+  phip   = phi;
+  thetap = theta;
+  statp  = stat;
+  for (k = 0; k < ntot; k += n) {
+    n = ntot - k;
+    if (n > PRJ_NBLK) n = PRJ_NBLK;
+
+    /* Gather a block of (x,y), padded to a whole number of vectors. */
+    tp = thetap;
+    for (i = 0; i < n; i++, tp += spt) {
+      xb[i] = *xp + prj->x0;
+      yb[i] = *yp + prj->y0;
+      tb[i] = *tp;
+
+      xp += sxy;
+      if (++ix == mx) {
+        ix = 0;
+        yp += sxy;
+        if (grid) xp = x;
+      }
+    }
+
+    nv = ((n + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      xb[i] = xb[0];
+      yb[i] = yb[0];
+      tb[i] = tb[0];
+    }
+
+    kernel(prj, nv, xb, yb, pb, tb, sb);
+
+    /* Scatter the results. */
+    for (i = 0; i < n; i++, phip += spt, thetap += spt) {
+      *phip   = pb[i];
+      *thetap = tb[i];
+      if ((*(statp++) = sb[i])) nbad++;
+    }
+  }
+
+  return nbad;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int prj_s2xv(
+  struct prjprm *prj,
+  int nphi,
+  int ntheta,
+  int spt,
+  int sxy,
+  const double phi[],
+  const double theta[],
+  double x[],
+  double y[],
+  int stat[],
+  prj_s2xk *kernel)
+
+{
+  int i, iphi, itheta, k, mphi, mtheta, n, nbad, nv, rowlen, rowoff;
+  int ib[PRJ_NBLK];
+  double cb[PRJ_NBLK], r, rb[PRJ_NBLK], sb[PRJ_NBLK], tb[PRJ_NBLK];
+  wcsvd cosphi, sinphi;
+  register int *statp;
+  register const double *phip, *thetap;
+  register double *xp, *yp;
+
+  if (ntheta > 0) {
+    mphi   = nphi;
+    mtheta = ntheta;
+  } else {
+    mphi   = 1;
+    mtheta = 1;
+    ntheta = nphi;
+  }
+
+
+  /* Do phi dependence. */
+  phip = phi;
+  rowoff = 0;
+  rowlen = nphi*sxy;
+  for (k = 0; k < nphi; k += n) {
+    n = nphi - k;
+    if (n > PRJ_NBLK) n = PRJ_NBLK;
+
+    for (i = 0; i < n; i++, phip += spt) {
+      tb[i] = *phip;
+    }
+
+    nv = ((n + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      tb[i] = 0.0;
+    }
+
+    for (i = 0; i < nv; i += WCSSIMD_NLANE) {
+      wcsv_fsincosd(prj->fast, wcsv_load(tb+i), &sinphi, &cosphi);
+      wcsv_store(sb+i, sinphi);
+      wcsv_store(cb+i, cosphi);
+    }
+
+    for (i = 0; i < n; i++, rowoff += sxy) {
+      xp = x + rowoff;
+      yp = y + rowoff;
+      for (itheta = 0; itheta < mtheta; itheta++) {
+        *xp = sb[i];
+        *yp = cb[i];
+        xp += rowlen;
+        yp += rowlen;
+      }
+    }
+  }
+
+
+  /* Do theta dependence. */
+  nbad = 0;
+  thetap = theta;
+  xp = x;
+  yp = y;
+  statp = stat;
+  for (k = 0; k < ntheta; k += n) {
+    n = ntheta - k;
+    if (n > PRJ_NBLK) n = PRJ_NBLK;
+
+    for (i = 0; i < n; i++, thetap += spt) {
+      tb[i] = *thetap;
+    }
+
+    nv = ((n + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      tb[i] = tb[0];
+    }
+
+    kernel(prj, nv, tb, rb, ib);
+
+    for (i = 0; i < n; i++) {
+      if (ib[i] == 2) {
+        for (iphi = 0; iphi < mphi; iphi++, xp += sxy, yp += sxy) {
+          *xp = 0.0;
+          *yp = 0.0;
+          *(statp++) = 1;
+        }
+
+      } else {
+        r = rb[i];
+        for (iphi = 0; iphi < mphi; iphi++, xp += sxy, yp += sxy) {
+          *xp =  r*(*xp) - prj->x0;
+          *yp = -r*(*yp) - prj->y0;
+          *(statp++) = ib[i];
+        }
+      }
+
+      if (ib[i]) nbad++;
+    }
+  }
+
+  return nbad;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int prj_s2xp(
+  struct prjprm *prj,
+  int nphi,
+  int ntheta,
+  int spt,
+  int sxy,
+  const double phi[],
+  const double theta[],
+  double x[],
+  double y[],
+  int stat[],
+  prj_s2xpk *kernel)
+
+{
+  int i, iphi, it, itheta, k, mphi, mtheta, n, nbad, nt, ntot, nv, rowlen,
+      rowoff;
+  int sb[PRJ_NBLK];
+  double cb[PRJ_NBLK], ctb[PRJ_NBLK], cthb[PRJ_NBLK], sinb[PRJ_NBLK],
+         stb[PRJ_NBLK], sthb[PRJ_NBLK], tb[PRJ_NBLK], ttb[PRJ_NBLK];
+  wcsvd cosphi, costhe, sinphi, sinthe;
+  register int *statp;
+  register const double *phip, *thetap;
+  register double *xp, *yp;
+
+  if (ntheta > 0) {
+    mphi   = nphi;
+    mtheta = ntheta;
+  } else {
+    mphi   = 1;
+    mtheta = 1;
+    ntheta = nphi;
+  }
+
+
+  /* Do phi dependence. */
+  phip = phi;
+  rowoff = 0;
+  rowlen = nphi*sxy;
+  for (k = 0; k < nphi; k += n) {
+    n = nphi - k;
+    if (n > PRJ_NBLK) n = PRJ_NBLK;
+
+    for (i = 0; i < n; i++, phip += spt) {
+      tb[i] = *phip;
+    }
+
+    nv = ((n + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      tb[i] = 0.0;
+    }
+
+    for (i = 0; i < nv; i += WCSSIMD_NLANE) {
+      wcsv_fsincosd(prj->fast, wcsv_load(tb+i), &sinphi, &cosphi);
+      wcsv_store(sinb+i, sinphi);
+      wcsv_store(cb+i, cosphi);
+    }
+
+    for (i = 0; i < n; i++, rowoff += sxy) {
+      xp = x + rowoff;
+      yp = y + rowoff;
+      for (itheta = 0; itheta < mtheta; itheta++) {
+        *xp = cb[i];
+        *yp = sinb[i];
+        xp += rowlen;
+        yp += rowlen;
+      }
+    }
+  }
+
+
+  /* Do (phi,theta) pairs in blocks, computing sin(theta) and cos(theta)
+     for blocks of theta as required. */
+  ntot = mphi*ntheta;
+  nbad = 0;
+  thetap = theta;
+  itheta = 0;
+  iphi = 0;
+  it = nt = 0;
+  xp = x;
+  yp = y;
+  statp = stat;
+  for (k = 0; k < ntot; k += n) {
+    n = ntot - k;
+    if (n > PRJ_NBLK) n = PRJ_NBLK;
+
+    for (i = 0; i < n; i++, xp += sxy, yp += sxy) {
+      if (it == nt) {
+        nt = ntheta - itheta;
+        if (nt > PRJ_NBLK) nt = PRJ_NBLK;
+
+        for (it = 0; it < nt; it++, thetap += spt) {
+          ttb[it] = *thetap;
+        }
+
+        nv = ((nt + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+        for (; it < nv; it++) {
+          ttb[it] = ttb[0];
+        }
+
+        for (it = 0; it < nv; it += WCSSIMD_NLANE) {
+          wcsv_fsincosd(prj->fast, wcsv_load(ttb+it), &sinthe, &costhe);
+          wcsv_store(stb+it, sinthe);
+          wcsv_store(ctb+it, costhe);
+        }
+
+        itheta += nt;
+        it = 0;
+      }
+
+      tb[i]   = ttb[it];
+      sthb[i] = stb[it];
+      cthb[i] = ctb[it];
+      cb[i]   = *xp;
+      sinb[i] = *yp;
+
+      if (++iphi == mphi) {
+        iphi = 0;
+        it++;
+      }
+    }
+
+    nv = ((n + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      tb[i]   = tb[0];
+      sthb[i] = sthb[0];
+      cthb[i] = cthb[0];
+      cb[i]   = cb[0];
+      sinb[i] = sinb[0];
+    }
+
+    kernel(prj, nv, tb, sthb, cthb, cb, sinb, sb);
+
+    xp -= n*sxy;
+    yp -= n*sxy;
+    for (i = 0; i < n; i++, xp += sxy, yp += sxy) {
+      *xp = cb[i];
+      *yp = sinb[i];
+      if ((*(statp++) = sb[i])) nbad++;
+    }
+  }
+
+  return nbad;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Quadcube face classification for the x2s kernels.  Given (xf,yf) in units
+   of the face half-width, flag coordinates outside the layout in bad, map
+   (xf,yf) to the face-centred frame, and return the face number, 0-5.  The
+   comparisons are those of the scalar code, made in the same order. */
+
+wcsvd prj_qcx2s(wcsvd *xf, wcsvd *yf, int *bad)
+
+{
+  wcsvd face, one;
+  wcsvm face0, face2, face3, face4, face5, inx;
+
+  one = wcsv_set1(1.0);
+
+  /* Bounds checking. */
+  inx  = wcsv_cmple(wcsv_abs(*xf), one);
+  *bad = wcsv_mbits(wcsv_mor(
+           wcsv_mand(inx, wcsv_cmpgt(wcsv_abs(*yf), wcsv_set1(3.0))),
+           wcsv_mand(wcsv_mnot(inx),
+             wcsv_mor(wcsv_cmpgt(wcsv_abs(*xf), wcsv_set1(7.0)),
+                      wcsv_cmpgt(wcsv_abs(*yf), one)))));
+
+  /* Map negative faces to the other side. */
+  *xf = wcsv_sel(wcsv_cmplt(*xf, wcsv_set1(-1.0)),
+                 wcsv_add(*xf, wcsv_set1(8.0)), *xf);
+
+  /* Determine the face. */
+  face4 = wcsv_cmpgt(*xf, wcsv_set1(5.0));
+  face3 = wcsv_cmpgt(*xf, wcsv_set1(3.0));
+  face2 = wcsv_cmpgt(*xf, one);
+  face0 = wcsv_mand(wcsv_mnot(face2), wcsv_cmpgt(*yf, one));
+  face5 = wcsv_mand(wcsv_mnot(wcsv_mor(face2, face0)),
+                    wcsv_cmplt(*yf, wcsv_set1(-1.0)));
+  face2 = wcsv_mand(face2, wcsv_mnot(face3));
+  face3 = wcsv_mand(face3, wcsv_mnot(face4));
+
+  *xf = wcsv_sel(face4, wcsv_sub(*xf, wcsv_set1(6.0)),
+        wcsv_sel(face3, wcsv_sub(*xf, wcsv_set1(4.0)),
+        wcsv_sel(face2, wcsv_sub(*xf, wcsv_set1(2.0)), *xf)));
+  *yf = wcsv_sel(face0, wcsv_sub(*yf, wcsv_set1(2.0)),
+        wcsv_sel(face5, wcsv_add(*yf, wcsv_set1(2.0)), *yf));
+
+  face = wcsv_sel(face4, wcsv_set1(4.0),
+         wcsv_sel(face3, wcsv_set1(3.0),
+         wcsv_sel(face2, wcsv_set1(2.0),
+         wcsv_sel(face0, wcsv_set1(0.0),
+         wcsv_sel(face5, wcsv_set1(5.0), one)))));
+
+  return face;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Quadcube face classification for the s2x kernels.  Return the face number
+   for direction cosines (l,m,n) as the first maximum of n, l, m, -l, -m, -n,
+   and its value in zeta. */
+
+wcsvd prj_qcs2x(wcsvd l, wcsvd m, wcsvd n, wcsvd *zeta)
+
+{
+  wcsvd face;
+  wcsvm over;
+
+  face  = wcsv_set1(0.0);
+  *zeta = n;
+
+  over  = wcsv_cmpgt(l, *zeta);
+  face  = wcsv_sel(over, wcsv_set1(1.0), face);
+  *zeta = wcsv_sel(over, l, *zeta);
+
+  over  = wcsv_cmpgt(m, *zeta);
+  face  = wcsv_sel(over, wcsv_set1(2.0), face);
+  *zeta = wcsv_sel(over, m, *zeta);
+
+  over  = wcsv_cmpgt(wcsv_neg(l), *zeta);
+  face  = wcsv_sel(over, wcsv_set1(3.0), face);
+  *zeta = wcsv_sel(over, wcsv_neg(l), *zeta);
+
+  over  = wcsv_cmpgt(wcsv_neg(m), *zeta);
+  face  = wcsv_sel(over, wcsv_set1(4.0), face);
+  *zeta = wcsv_sel(over, wcsv_neg(m), *zeta);
+
+  over  = wcsv_cmpgt(wcsv_neg(n), *zeta);
+  face  = wcsv_sel(over, wcsv_set1(5.0), face);
+  *zeta = wcsv_sel(over, wcsv_neg(n), *zeta);
+
+  return face;
+}
+
+#endif /* WCSSIMD */
+
+/*--------------------------------------------------------------------------*/
+
 int prjset(prj)
 
 struct prjprm *prj;
@@ -364,6 +928,13 @@ struct prjprm *prj;
   if (prj == 0x0) return PRJERR_NULL_POINTER;
   err = &(prj->err);
 
+  /* Release any table left by a previous set-up, whatever its projection. */
+  if (prj->wtab) {
+    free(prj->wtab);
+    prj->wtab = 0x0;
+  }
+  prj->m = 0;
+
   /* Invoke the relevant initialization routine. */
   prj->code[3] = '\0';
   if (strcmp(prj->code, "AZP") == 0) {
@@ -475,6 +1046,118 @@ int stat[];
   return prj->prjs2x(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat);
 }
 
+/*--------------------------------------------------------------------------*/
+
+int prjx2sf(prj, nx, ny, sxy, spt, x, y, phi, theta, stat)
+
+struct prjprm *prj;
+int nx, ny, sxy, spt;
+const float x[], y[];
+float phi[], theta[];
+int stat[];
+
+{
+  int i, istat, j, k, n, rowoff, status;
+  double phib[PRJ_NFLT], thetab[PRJ_NFLT], xb[PRJ_NFLT], yb[PRJ_NFLT];
+
+  /* Initialize. */
+  if (prj == 0x0) return PRJERR_NULL_POINTER;
+  if (prj->flag == 0) {
+    if ((status = prjset(prj))) return status;
+  }
+
+  /* A grid is processed a row at a time, with y[] of length one. */
+  status = 0;
+  for (j = 0; j < (ny > 0 ? ny : 1); j++) {
+    if (ny > 0) yb[0] = y[j*sxy];
+
+    rowoff = j*nx;
+    for (k = 0; k < nx; k += n) {
+      n = nx - k;
+      if (n > PRJ_NFLT) n = PRJ_NFLT;
+
+      for (i = 0; i < n; i++) {
+        xb[i] = x[(k+i)*sxy];
+        if (ny <= 0) yb[i] = y[(k+i)*sxy];
+
+        /* Retained for invalid coordinates. */
+        phib[i]   = phi[(rowoff+k+i)*spt];
+        thetab[i] = theta[(rowoff+k+i)*spt];
+      }
+
+      istat = prj->prjx2s(prj, n, (ny > 0), 1, 1, xb, yb, phib, thetab,
+                          stat + rowoff + k);
+      if (istat) {
+        if (istat != PRJERR_BAD_PIX) return istat;
+        status = PRJERR_BAD_PIX;
+      }
+
+      for (i = 0; i < n; i++) {
+        phi[(rowoff+k+i)*spt]   = (float)phib[i];
+        theta[(rowoff+k+i)*spt] = (float)thetab[i];
+      }
+    }
+  }
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int prjs2xf(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat)
+
+struct prjprm *prj;
+int nphi, ntheta, spt, sxy;
+const float phi[], theta[];
+float x[], y[];
+int stat[];
+
+{
+  int i, istat, j, k, n, rowoff, status;
+  double phib[PRJ_NFLT], thetab[PRJ_NFLT], xb[PRJ_NFLT], yb[PRJ_NFLT];
+
+  /* Initialize. */
+  if (prj == 0x0) return PRJERR_NULL_POINTER;
+  if (prj->flag == 0) {
+    if ((status = prjset(prj))) return status;
+  }
+
+  /* A grid is processed a row at a time, with theta[] of length one. */
+  status = 0;
+  for (j = 0; j < (ntheta > 0 ? ntheta : 1); j++) {
+    if (ntheta > 0) thetab[0] = theta[j*spt];
+
+    rowoff = j*nphi;
+    for (k = 0; k < nphi; k += n) {
+      n = nphi - k;
+      if (n > PRJ_NFLT) n = PRJ_NFLT;
+
+      for (i = 0; i < n; i++) {
+        phib[i] = phi[(k+i)*spt];
+        if (ntheta <= 0) thetab[i] = theta[(k+i)*spt];
+
+        /* Retained for invalid coordinates. */
+        xb[i] = x[(rowoff+k+i)*sxy];
+        yb[i] = y[(rowoff+k+i)*sxy];
+      }
+
+      istat = prj->prjs2x(prj, n, (ntheta > 0), 1, 1, phib, thetab, xb, yb,
+                          stat + rowoff + k);
+      if (istat) {
+        if (istat != PRJERR_BAD_WORLD) return istat;
+        status = PRJERR_BAD_WORLD;
+      }
+
+      for (i = 0; i < n; i++) {
+        x[(rowoff+k+i)*sxy] = (float)xb[i];
+        y[(rowoff+k+i)*sxy] = (float)yb[i];
+      }
+    }
+  }
+
+  return status;
+}
+
 /*============================================================================
 * Internal helper routine used by the *set() routines - not intended for
 * outside use.  It forces (x,y) = (0,0) at (phi0,theta0).
@@ -512,6 +1195,149 @@ const double phi0, theta0;
   return 0;
 }
 
+/*----------------------------------------------------------------------------
+* Internal helper routines used by the *set() and *x2s() routines of those
+* projections whose inverse requires the iterative solution of a monotonic
+* equation, r = f(z), where z is typically the zenith distance.
+*
+* prj_tab() tabulates z as a function of r as piecewise monotone cubic
+* Hermite interpolants on knots equispaced in z over [0,zmax], setting
+* prj->m and prj->wtab as described for zpnset().  The number of intervals is
+* doubled until all but the last few, which may be spoilt by a point of
+* inflection, reproduce z to within tabtol at their midpoints; only the
+* leading intervals that do so are retained.  If zmax is not positive, or
+* memory allocation fails, the table is simply omitted.
+*
+* prj_tabinv() interpolates in the table and applies one Newton-Raphson
+* correction.  It returns -1.0 if r is outside the table or the correction is
+* too large to be trusted, whence the caller should solve for z iteratively.
+*---------------------------------------------------------------------------*/
+
+void prj_tab(struct prjprm *prj, double zmax, prj_tabf *fn)
+
+{
+  int i, j, n, nok;
+  double a, b, d, d0, d1, e, r0, r1, *tab, tau, z0, z1;
+  const double tabtol = 1.0e-10;
+  const int nmax = 1024;
+
+  if (prj->wtab) {
+    free(prj->wtab);
+    prj->wtab = 0x0;
+  }
+  prj->m = 0;
+
+  if (zmax <= 0.0) return;
+
+  for (n = 16; n <= nmax; n *= 2) {
+    if (!(tab = calloc(7*n+3, sizeof(double)))) return;
+
+    z1 = 0.0;
+    r1 = fn(prj, z1, &d1);
+
+    nok = 0;
+    for (i = 0; i < n; i++) {
+      z0 = z1;
+      r0 = r1;
+      d0 = d1;
+
+      z1 = (i+1 < n) ? (i+1)*(zmax/n) : zmax;
+      r1 = fn(prj, z1, &d1);
+
+      if (r1 <= r0 || d0 <= 0.0 || d1 <= 0.0) break;
+
+      /* Hermite slopes with respect to u, limited for monotonicity. */
+      d = z1 - z0;
+      a = (r1 - r0)/d0;
+      b = (r1 - r0)/d1;
+      if ((e = (a*a + b*b)/(d*d)) > 9.0) {
+        tau = 3.0/sqrt(e);
+        a *= tau;
+        b *= tau;
+      }
+
+      tab[6*i]   = r0;
+      tab[6*i+1] = 1.0/(r1 - r0);
+      tab[6*i+2] = z0;
+      tab[6*i+3] = a;
+      tab[6*i+4] = 3.0*d - 2.0*a - b;
+      tab[6*i+5] = a + b - 2.0*d;
+      tab[6*i+6] = r1;
+
+      /* Check the interpolant at the midpoint in z. */
+      e = 0.5*(z0 + z1);
+      d = (fn(prj, e, &tau) - r0)*tab[6*i+1];
+      d = z0 + d*(a + d*(tab[6*i+4] + d*tab[6*i+5]));
+      if (fabs(d - e) > tabtol) break;
+
+      nok = i + 1;
+    }
+
+    if (nok >= n-2 || 2*n > nmax) {
+      if (nok) {
+        /* Index the intervals by buckets of equal width in r. */
+        tab[6*nok+1] = nok/(tab[6*nok] - tab[0]);
+        for (i = 0, j = 0; j < nok; j++) {
+          r0 = tab[0] + j/tab[6*nok+1];
+          while (i < nok-1 && tab[6*(i+1)] <= r0) i++;
+          tab[6*nok+2+j] = i;
+        }
+        tab[7*nok+2] = nok - 1;
+
+        prj->m = nok;
+        prj->wtab = tab;
+      } else {
+        free(tab);
+      }
+      return;
+    }
+
+    free(tab);
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+double prj_tabinv(const struct prjprm *prj, double r, prj_tabf *fn)
+
+{
+  int i, i1, i2, m;
+  double d, dr, u, z;
+  register const double *tab;
+
+  if ((m = prj->m) == 0 || r < prj->wtab[0] || r >= prj->wtab[6*m]) {
+    return -1.0;
+  }
+
+  /* Use the bucket index to narrow the search. */
+  tab = prj->wtab + 6*m + 1;
+  i = (int)((r - prj->wtab[0])*tab[0]);
+  if (i >= m) i = m - 1;
+  i1 = (int)tab[i+1];
+  i2 = (int)tab[i+2] + 1;
+  while (i2 - i1 > 1) {
+    i = (i1 + i2)/2;
+    if (r < prj->wtab[6*i]) {
+      i2 = i;
+    } else {
+      i1 = i;
+    }
+  }
+
+  tab = prj->wtab + 6*i1;
+  u = (r - tab[0])*tab[1];
+  z = tab[2] + u*(tab[3] + u*(tab[4] + u*tab[5]));
+
+  /* One Newton-Raphson step gives full precision. */
+  d = fn(prj, z, &dr) - r;
+  if (dr <= 0.0) return -1.0;
+  d /= dr;
+  if (fabs(d) >= 1.0e-8) return -1.0;
+
+  z -= d;
+  return (z < 0.0) ? 0.0 : z;
+}
+
 /*============================================================================
 *   AZP: zenithal/azimuthal perspective projection.
 *
@@ -1228,6 +2054,21 @@ int stat[];
     if ((status = tanset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    prj_x2sv(prj, nx, ny, sxy, spt, x, y, phi, theta, stat, tanx2sv);
+    status = 0;
+
+    my = (ny > 0) ? ny : 1;
+    if (prj->bounds&4 &&
+        prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
+      if (!status) status = PRJERR_BAD_PIX_SET("tanx2s");
+    }
+
+    return status;
+  }
+#endif
+
   if (ny > 0) {
     mx = nx;
     my = ny;
@@ -1281,7 +2122,8 @@ int stat[];
 
 
   /* Do bounds checking on the native coordinates. */
-  if (prj->bounds&4 && prjbchk(1.0e-13, nx, my, spt, phi, theta, stat)) {
+  if (prj->bounds&4 &&
+      prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
     if (!status) status = PRJERR_BAD_PIX_SET("tanx2s");
   }
 
@@ -1312,6 +2154,18 @@ int stat[];
     if ((status = tanset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    status = 0;
+    if (prj_s2xv(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat,
+                 tans2xv)) {
+      status = PRJERR_BAD_WORLD_SET("tans2x");
+    }
+
+    return status;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
@@ -1380,6 +2234,74 @@ int stat[];
   return status;
 }
 
+
+#ifdef WCSSIMD
+
+/*--------------------------------------------------------------------------*/
+
+void tanx2sv(
+  const struct prjprm *prj,
+  int n,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[])
+
+{
+  int fused, i, j;
+  wcsvd r, xj, yj, yj2, zero;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    xj = wcsv_load(x+i);
+    yj = wcsv_load(y+i);
+
+    yj2 = wcsv_mul(yj, yj);
+    r = wcsv_sqrt(fused ? wcsv_fma(xj, xj, yj2) :
+                          wcsv_add(wcsv_mul(xj, xj), yj2));
+    wcsv_store(phi+i, wcsv_sel(wcsv_cmpeq(r, zero), zero,
+                               wcsv_fatan2d(prj->fast, xj, wcsv_neg(yj))));
+    wcsv_store(theta+i, wcsv_fatan2d(prj->fast, wcsv_set1(prj->r0), r));
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = 0;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+void tans2xv(
+  const struct prjprm *prj,
+  int n,
+  const double theta[],
+  double r[],
+  int stat[])
+
+{
+  int bad, i, j, zero;
+  wcsvd costhe, s;
+
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    wcsv_fsincosd(prj->fast, wcsv_load(theta+i), &s, &costhe);
+    wcsv_store(r+i, wcsv_div(wcsv_mul(wcsv_set1(prj->r0), costhe), s));
+
+    zero = wcsv_mbits(wcsv_cmpeq(s, wcsv_set1(0.0)));
+    bad  = 0;
+    if (prj->bounds&1) {
+      bad = wcsv_mbits(wcsv_cmplt(s, wcsv_set1(0.0)));
+    }
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = ((zero >> j) & 1) ? 2 : ((bad >> j) & 1);
+    }
+  }
+}
+
+#endif
+
 /*============================================================================
 *   STG: stereographic projection.
 *
@@ -1457,6 +2379,14 @@ int stat[];
     if ((status = stgset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    prj_x2sv(prj, nx, ny, sxy, spt, x, y, phi, theta, stat, stgx2sv);
+
+    return 0;
+  }
+#endif
+
   if (ny > 0) {
     mx = nx;
     my = ny;
@@ -1533,6 +2463,18 @@ int stat[];
     if ((status = stgset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    status = 0;
+    if (prj_s2xv(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat,
+                 stgs2xv)) {
+      status = PRJERR_BAD_WORLD_SET("stgs2x");
+    }
+
+    return status;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
@@ -1592,6 +2534,72 @@ int stat[];
   return status;
 }
 
+
+#ifdef WCSSIMD
+
+/*--------------------------------------------------------------------------*/
+
+void stgx2sv(
+  const struct prjprm *prj,
+  int n,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[])
+
+{
+  int fused, i, j;
+  wcsvd r, xj, yj, yj2, zero;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    xj = wcsv_load(x+i);
+    yj = wcsv_load(y+i);
+
+    yj2 = wcsv_mul(yj, yj);
+    r = wcsv_sqrt(fused ? wcsv_fma(xj, xj, yj2) :
+                          wcsv_add(wcsv_mul(xj, xj), yj2));
+    wcsv_store(phi+i, wcsv_sel(wcsv_cmpeq(r, zero), zero,
+                               wcsv_fatan2d(prj->fast, xj, wcsv_neg(yj))));
+    wcsv_store(theta+i, wcsv_sub(wcsv_set1(90.0), wcsv_mul(wcsv_set1(2.0),
+                 wcsv_fatand(prj->fast,
+                   wcsv_mul(r, wcsv_set1(prj->w[1]))))));
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = 0;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+void stgs2xv(
+  const struct prjprm *prj,
+  int n,
+  const double theta[],
+  double r[],
+  int stat[])
+
+{
+  int i, j, zero;
+  wcsvd costhe, s, sinthe;
+
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    wcsv_fsincosd(prj->fast, wcsv_load(theta+i), &sinthe, &costhe);
+    s = wcsv_add(wcsv_set1(1.0), sinthe);
+    wcsv_store(r+i, wcsv_div(wcsv_mul(wcsv_set1(prj->w[0]), costhe), s));
+
+    zero = wcsv_mbits(wcsv_cmpeq(s, wcsv_set1(0.0)));
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = ((zero >> j) & 1) ? 2 : 0;
+    }
+  }
+}
+
+#endif
+
 /*============================================================================
 *   SIN: orthographic/synthesis projection.
 *
@@ -1679,6 +2687,24 @@ int stat[];
   xi  = prj->pv[1];
   eta = prj->pv[2];
 
+#ifdef WCSSIMD
+  if (prj_simd && prj->w[1] == 0.0) {
+    status = 0;
+    if (prj_x2sv(prj, nx, ny, sxy, spt, x, y, phi, theta, stat,
+                 sinx2sv)) {
+      status = PRJERR_BAD_PIX_SET("sinx2s");
+    }
+
+    my = (ny > 0) ? ny : 1;
+    if (prj->bounds&4 &&
+        prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
+      if (!status) status = PRJERR_BAD_PIX_SET("sinx2s");
+    }
+
+    return status;
+  }
+#endif
+
   if (ny > 0) {
     mx = nx;
     my = ny;
@@ -1808,7 +2834,8 @@ int stat[];
 
 
   /* Do bounds checking on the native coordinates. */
-  if (prj->bounds&4 && prjbchk(1.0e-13, nx, my, spt, phi, theta, stat)) {
+  if (prj->bounds&4 &&
+      prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
     if (!status) status = PRJERR_BAD_PIX_SET("sinx2s");
   }
 
@@ -1839,6 +2866,18 @@ int stat[];
     if ((status = sinset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd && prj->w[1] == 0.0) {
+    status = 0;
+    if (prj_s2xv(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat,
+                 sins2xv)) {
+      status = PRJERR_BAD_WORLD_SET("sins2x");
+    }
+
+    return status;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
@@ -1931,6 +2970,97 @@ int stat[];
   return status;
 }
 
+
+#ifdef WCSSIMD
+
+/*--------------------------------------------------------------------------*/
+
+/* Orthographic projection only. */
+
+void sinx2sv(
+  const struct prjprm *prj,
+  int n,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[])
+
+{
+  int bad, fused, i, j;
+  wcsvd one, r2, t, x0, y0, y02, zero;
+  wcsvm lt, mid;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  one  = wcsv_set1(1.0);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    x0 = wcsv_mul(wcsv_load(x+i), wcsv_set1(prj->w[0]));
+    y0 = wcsv_mul(wcsv_load(y+i), wcsv_set1(prj->w[0]));
+
+    y02 = wcsv_mul(y0, y0);
+    r2 = fused ? wcsv_fma(x0, x0, y02) : wcsv_add(wcsv_mul(x0, x0), y02);
+    wcsv_store(phi+i, wcsv_sel(wcsv_cmpne(r2, zero),
+                 wcsv_fatan2d(prj->fast, x0, wcsv_neg(y0)), zero));
+
+    /* Invalid coordinates leave theta unchanged. */
+    lt  = wcsv_cmplt(r2, wcsv_set1(0.5));
+    mid = wcsv_mand(wcsv_mnot(lt), wcsv_cmple(r2, one));
+    bad = wcsv_mbits(wcsv_mnot(wcsv_mor(lt, mid)));
+
+    t = wcsv_load(theta+i);
+    if (wcsv_mbits(lt)) {
+      t = wcsv_sel(lt, wcsv_facosd(prj->fast,
+                         wcsv_sqrt(wcsv_sel(lt, r2, zero))), t);
+    }
+    if (wcsv_mbits(mid)) {
+      t = wcsv_sel(mid, wcsv_fasind(prj->fast, wcsv_sqrt(wcsv_sub(one,
+                                     wcsv_sel(mid, r2, zero)))), t);
+    }
+    wcsv_store(theta+i, t);
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = (bad >> j) & 1;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Orthographic projection only. */
+
+void sins2xv(
+  const struct prjprm *prj,
+  int n,
+  const double theta[],
+  double r[],
+  int stat[])
+
+{
+  int bad, i, j;
+  wcsvd costhe, sinthe, t, thetav;
+
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    thetav = wcsv_load(theta+i);
+    wcsv_fsincosd(prj->fast, thetav, &sinthe, &costhe);
+
+    t = wcsv_d2r(wcsv_sub(wcsv_set1(90.0), wcsv_abs(thetav)));
+    costhe = wcsv_sel(wcsv_cmplt(t, wcsv_set1(1.0e-5)), t, costhe);
+    wcsv_store(r+i, wcsv_mul(wcsv_set1(prj->r0), costhe));
+
+    bad = 0;
+    if (prj->bounds&1) {
+      bad = wcsv_mbits(wcsv_cmplt(thetav, wcsv_set1(0.0)));
+    }
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = (bad >> j) & 1;
+    }
+  }
+}
+
+#endif
+
 /*============================================================================
 *   ARC: zenithal/azimuthal equidistant projection.
 *
@@ -2008,6 +3138,21 @@ int stat[];
     if ((status = arcset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    prj_x2sv(prj, nx, ny, sxy, spt, x, y, phi, theta, stat, arcx2sv);
+    status = 0;
+
+    my = (ny > 0) ? ny : 1;
+    if (prj->bounds&4 &&
+        prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
+      if (!status) status = PRJERR_BAD_PIX_SET("arcx2s");
+    }
+
+    return status;
+  }
+#endif
+
   if (ny > 0) {
     mx = nx;
     my = ny;
@@ -2062,7 +3207,8 @@ int stat[];
 
 
   /* Do bounds checking on the native coordinates. */
-  if (prj->bounds&4 && prjbchk(1.0e-13, nx, my, spt, phi, theta, stat)) {
+  if (prj->bounds&4 &&
+      prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
     if (!status) status = PRJERR_BAD_PIX_SET("arcx2s");
   }
 
@@ -2093,6 +3239,15 @@ int stat[];
     if ((status = arcset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    prj_s2xv(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat,
+             arcs2xv);
+
+    return 0;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
@@ -2136,9 +3291,69 @@ int stat[];
     }
   }
 
-  return 0;
+  return 0;
+}
+
+
+#ifdef WCSSIMD
+
+/*--------------------------------------------------------------------------*/
+
+void arcx2sv(
+  const struct prjprm *prj,
+  int n,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[])
+
+{
+  int fused, i, j;
+  wcsvd r, xj, yj, yj2, zero;
+  wcsvm pole;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    xj = wcsv_load(x+i);
+    yj = wcsv_load(y+i);
+
+    yj2 = wcsv_mul(yj, yj);
+    r = wcsv_sqrt(fused ? wcsv_fma(xj, xj, yj2) :
+                          wcsv_add(wcsv_mul(xj, xj), yj2));
+    pole = wcsv_cmpeq(r, zero);
+    wcsv_store(phi+i, wcsv_sel(pole, zero,
+                               wcsv_fatan2d(prj->fast, xj, wcsv_neg(yj))));
+    wcsv_store(theta+i, wcsv_sel(pole, wcsv_set1(90.0),
+      wcsv_sub(wcsv_set1(90.0), wcsv_mul(r, wcsv_set1(prj->w[1])))));
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = 0;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+void arcs2xv(
+  const struct prjprm *prj,
+  int n,
+  const double theta[],
+  double r[],
+  int stat[])
+
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    r[i] = prj->w[0]*(90.0 - theta[i]);
+    stat[i] = 0;
+  }
 }
 
+#endif
+
 /*============================================================================
 *   ZPN: zenithal/azimuthal polynomial projection.
 *
@@ -2158,6 +3373,19 @@ int stat[];
 *      prj->n       Degree of the polynomial, N.
 *      prj->w[0]    Co-latitude of the first point of inflection, radian.
 *      prj->w[1]    Radius of the first point of inflection (N > 1), radian.
+*      prj->m       Number of intervals in the inverse table (N > 2), zero
+*                   if there is none, in which case zpnx2s() solves for the
+*                   zenith distance iteratively.
+*      prj->wtab    Inverse table, for each interval i < m:
+*                     wtab[6*i]    Radius, r_i, at the start of the interval.
+*                     wtab[6*i+1]  1/(r_(i+1) - r_i).
+*                     wtab[6*i+2]  Coefficients of the cubic in
+*                       ...          u = (r - r_i)/(r_(i+1) - r_i)
+*                     wtab[6*i+5]  giving the zenith distance, radian.
+*                   followed by r_m at wtab[6*m], then m/(r_m - r_0) at
+*                   wtab[6*m+1], then for each of m+1 buckets of equal width
+*                   in r, the index of the interval containing its start, at
+*                   wtab[6*m+2+j].
 *      prj->prjx2s  Pointer to zpnx2s().
 *      prj->prjs2x  Pointer to zpns2x().
 *===========================================================================*/
@@ -2257,6 +3485,9 @@ struct prjprm *prj;
     prj->w[1] = r;
   }
 
+  /* Tabulate the inverse of higher order polynomials. */
+  prj_tab(prj, (k > 2) ? prj->w[0] : 0.0, zpn_r);
+
   prj->prjx2s = zpnx2s;
   prj->prjs2x = zpns2x;
 
@@ -2274,8 +3505,8 @@ double phi[], theta[];
 int stat[];
 
 {
-  int j, k, m, mx, my, rowlen, rowoff, status;
-  double a, b, c, d, lambda, r, r1, r2, rt, xj, yj, yj2, zd, zd1, zd2;
+  int k, mx, my, rowlen, rowoff, status;
+  double a, b, c, d, r, r1, r2, xj, yj, yj2, zd, zd1, zd2;
   const double tol = 1.0e-13;
   register int ix, iy, *statp;
   register const double *xp, *yp;
@@ -2405,33 +3636,12 @@ int stat[];
           }
           zd = zd2;
         } else {
-          /* Disect the interval. */
-          for (j = 0; j < 100; j++) {
-            lambda = (r2 - r)/(r2 - r1);
-            if (lambda < 0.1) {
-              lambda = 0.1;
-            } else if (lambda > 0.9) {
-              lambda = 0.9;
-            }
-
-            zd = zd2 - lambda*(zd2 - zd1);
-
-            rt = 0.0;
-            for (m = k; m >= 0; m--) {
-              rt = (rt * zd) + prj->pv[m];
-            }
+          /* Interpolate in the inverse table. */
+          zd = prj_tabinv(prj, r, zpn_r);
 
-            if (rt < r) {
-              if (r-rt < tol) break;
-              r1 = rt;
-              zd1 = zd;
-            } else {
-              if (rt-r < tol) break;
-              r2 = rt;
-              zd2 = zd;
-            }
-
-            if (fabs(zd2-zd1) < tol) break;
+          if (zd < 0.0) {
+            /* Disect the interval. */
+            zd = zpn_zd(prj, r);
           }
         }
       }
@@ -2615,6 +3825,24 @@ int stat[];
     if ((status = zeaset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    status = 0;
+    if (prj_x2sv(prj, nx, ny, sxy, spt, x, y, phi, theta, stat,
+                 zeax2sv)) {
+      status = PRJERR_BAD_PIX_SET("zeax2s");
+    }
+
+    my = (ny > 0) ? ny : 1;
+    if (prj->bounds&4 &&
+        prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
+      if (!status) status = PRJERR_BAD_PIX_SET("zeax2s");
+    }
+
+    return status;
+  }
+#endif
+
   if (ny > 0) {
     mx = nx;
     my = ny;
@@ -2681,7 +3909,8 @@ int stat[];
 
 
   /* Do bounds checking on the native coordinates. */
-  if (prj->bounds&4 && prjbchk(1.0e-13, nx, my, spt, phi, theta, stat)) {
+  if (prj->bounds&4 &&
+      prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
     if (!status) status = PRJERR_BAD_PIX_SET("zeax2s");
   }
 
@@ -2712,6 +3941,15 @@ int stat[];
     if ((status = zeaset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    prj_s2xv(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat,
+             zeas2xv);
+
+    return 0;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
@@ -2758,6 +3996,153 @@ int stat[];
   return 0;
 }
 
+
+#ifdef WCSSIMD
+
+/*--------------------------------------------------------------------------*/
+
+void zeax2sv(
+  const struct prjprm *prj,
+  int n,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[])
+
+{
+  int bad, fused, i, j;
+  const double tol = 1.0e-12;
+  wcsvd r, s, t, xj, yj, yj2, zero;
+  wcsvm big, pole;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    xj = wcsv_load(x+i);
+    yj = wcsv_load(y+i);
+
+    yj2 = wcsv_mul(yj, yj);
+    r = wcsv_sqrt(fused ? wcsv_fma(xj, xj, yj2) :
+                          wcsv_add(wcsv_mul(xj, xj), yj2));
+    wcsv_store(phi+i, wcsv_sel(wcsv_cmpeq(r, zero), zero,
+                               wcsv_fatan2d(prj->fast, xj, wcsv_neg(yj))));
+
+    s = wcsv_mul(r, wcsv_set1(prj->w[1]));
+    big  = wcsv_cmpgt(wcsv_abs(s), wcsv_set1(1.0));
+    pole = wcsv_mand(big, wcsv_cmplt(wcsv_abs(wcsv_sub(r,
+             wcsv_set1(prj->w[0]))), wcsv_set1(tol)));
+    bad  = wcsv_mbits(big) & ~wcsv_mbits(pole);
+
+    t = wcsv_sub(wcsv_set1(90.0), wcsv_mul(wcsv_set1(2.0),
+          wcsv_fasind(prj->fast, wcsv_sel(big, zero, s))));
+    t = wcsv_sel(big, wcsv_sel(pole, wcsv_set1(-90.0), zero), t);
+    wcsv_store(theta+i, t);
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = (bad >> j) & 1;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+void zeas2xv(
+  const struct prjprm *prj,
+  int n,
+  const double theta[],
+  double r[],
+  int stat[])
+
+{
+  int i, j;
+  wcsvd c, s;
+
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    wcsv_fsincosd(prj->fast,
+      wcsv_mul(wcsv_sub(wcsv_set1(90.0), wcsv_load(theta+i)), wcsv_set1(0.5)),
+      &s, &c);
+    wcsv_store(r+i, wcsv_mul(wcsv_set1(prj->w[0]), s));
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = 0;
+    }
+  }
+}
+
+#endif
+
+/*--------------------------------------------------------------------------*/
+
+/* Compute the radius for ZPN, and its derivative, given the zenith distance
+   in radians. */
+
+double zpn_r(const struct prjprm *prj, double zd, double *dr)
+
+{
+  int m;
+  double r;
+
+  r = 0.0;
+  *dr = 0.0;
+  for (m = prj->n; m >= 0; m--) {
+    *dr = (*dr)*zd + r;
+    r = r*zd + prj->pv[m];
+  }
+
+  return r;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Solve the ZPN polynomial for the zenith distance, zd, given a radius, r,
+   in the range prj->pv[0] to prj->w[1], by dissection. */
+
+double zpn_zd(const struct prjprm *prj, double r)
+
+{
+  int j, k, m;
+  double lambda, r1, r2, rt, zd, zd1, zd2;
+  const double tol = 1.0e-13;
+
+  k   = prj->n;
+  zd  = 0.0;
+  zd1 = 0.0;
+  r1  = prj->pv[0];
+  zd2 = prj->w[0];
+  r2  = prj->w[1];
+
+  for (j = 0; j < 100; j++) {
+    lambda = (r2 - r)/(r2 - r1);
+    if (lambda < 0.1) {
+      lambda = 0.1;
+    } else if (lambda > 0.9) {
+      lambda = 0.9;
+    }
+
+    zd = zd2 - lambda*(zd2 - zd1);
+
+    rt = 0.0;
+    for (m = k; m >= 0; m--) {
+      rt = (rt * zd) + prj->pv[m];
+    }
+
+    if (rt < r) {
+      if (r-rt < tol) break;
+      r1 = rt;
+      zd1 = zd;
+    } else {
+      if (rt-r < tol) break;
+      r2 = rt;
+      zd2 = zd;
+    }
+
+    if (fabs(zd2-zd1) < tol) break;
+  }
+
+  return zd;
+}
+
 /*============================================================================
 *   AIR: Airy's projection.
 *
@@ -2783,6 +4168,11 @@ int stat[];
 *                   radians.
 *      prj->w[5]    prj->w[2]*tol
 *      prj->w[6]    (180/pi)/prj->w[2]
+*      prj->m       Number of intervals in the inverse table, zero if there
+*                   is none, in which case airx2s() solves for xi = (90 -
+*                   theta)/2 iteratively.
+*      prj->wtab    Inverse table giving xi, in radians, as a function of
+*                   r/(2*r0), laid out as for ZPN.
 *      prj->prjx2s  Pointer to airx2s().
 *      prj->prjs2x  Pointer to airs2x().
 *===========================================================================*/
@@ -2829,6 +4219,9 @@ struct prjprm *prj;
   prj->w[5] = prj->w[2]*tol;
   prj->w[6] = R2D/prj->w[2];
 
+  /* Tabulate the inverse to within 2 degrees of the divergence. */
+  prj_tab(prj, 88.0*D2R, air_r);
+
   prj->prjx2s = airx2s;
   prj->prjs2x = airs2x;
 
@@ -2911,6 +4304,9 @@ int stat[];
         xi = 0.0;
       } else if (r < prj->w[5]) {
         xi = r*prj->w[6];
+      } else if ((xi = prj_tabinv(prj, r, air_r)) >= 0.0) {
+        /* Interpolated in the inverse table. */
+        xi *= R2D;
       } else {
         /* Find a solution interval. */
         x1 = x2 = 1.0;
@@ -3067,6 +4463,30 @@ int stat[];
   return status;
 }
 
+/*--------------------------------------------------------------------------*/
+
+/* Compute r/(2*r0) for AIR, and its derivative, given xi = (90 - theta)/2
+   in radians. */
+
+double air_r(const struct prjprm *prj, double xi, double *dr)
+
+{
+  double cosxi, logcos, sinxi, tanxi;
+
+  if (xi == 0.0) {
+    *dr = prj->w[2];
+    return 0.0;
+  }
+
+  sinxi  = sin(xi);
+  cosxi  = cos(xi);
+  tanxi  = sinxi/cosxi;
+  logcos = log(cosxi);
+
+  *dr = 1.0 + logcos/(sinxi*sinxi) - prj->w[1]/(cosxi*cosxi);
+  return -(logcos/tanxi + prj->w[1]*tanxi);
+}
+
 /*============================================================================
 *   CYP: cylindrical perspective projection.
 *
@@ -3190,17 +4610,19 @@ int stat[];
   status = 0;
 
 
-  /* Do x dependence. */
+  /* Do x dependence for the first row and replicate it row by row. */
   xp = x;
-  rowoff = 0;
-  rowlen = nx*spt;
-  for (ix = 0; ix < nx; ix++, rowoff += spt, xp += sxy) {
+  phip = phi;
+  for (ix = 0; ix < nx; ix++, phip += spt, xp += sxy) {
     s = prj->w[1]*(*xp + prj->x0);
+    *phip = s;
+  }
 
-    phip = phi + rowoff;
-    for (iy = 0; iy < my; iy++) {
-      *phip = s;
-      phip += rowlen;
+  rowlen = nx*spt;
+  for (iy = 1; iy < my; iy++) {
+    phip = phi + iy*rowlen;
+    for (rowoff = 0; rowoff < rowlen; rowoff += spt) {
+      phip[rowoff] = phi[rowoff];
     }
   }
 
@@ -3413,17 +4835,19 @@ int stat[];
   status = 0;
 
 
-  /* Do x dependence. */
+  /* Do x dependence for the first row and replicate it row by row. */
   xp = x;
-  rowoff = 0;
-  rowlen = nx*spt;
-  for (ix = 0; ix < nx; ix++, rowoff += spt, xp += sxy) {
+  phip = phi;
+  for (ix = 0; ix < nx; ix++, phip += spt, xp += sxy) {
     s = prj->w[1]*(*xp + prj->x0);
+    *phip = s;
+  }
 
-    phip = phi + rowoff;
-    for (iy = 0; iy < my; iy++) {
-      *phip = s;
-      phip += rowlen;
+  rowlen = nx*spt;
+  for (iy = 1; iy < my; iy++) {
+    phip = phi + iy*rowlen;
+    for (rowoff = 0; rowoff < rowlen; rowoff += spt) {
+      phip[rowoff] = phi[rowoff];
     }
   }
 
@@ -3617,17 +5041,19 @@ int stat[];
   status = 0;
 
 
-  /* Do x dependence. */
+  /* Do x dependence for the first row and replicate it row by row. */
   xp = x;
-  rowoff = 0;
-  rowlen = nx*spt;
-  for (ix = 0; ix < nx; ix++, rowoff += spt, xp += sxy) {
+  phip = phi;
+  for (ix = 0; ix < nx; ix++, phip += spt, xp += sxy) {
     s = prj->w[1]*(*xp + prj->x0);
+    *phip = s;
+  }
 
-    phip = phi + rowoff;
-    for (iy = 0; iy < my; iy++) {
-      *phip = s;
-      phip += rowlen;
+  rowlen = nx*spt;
+  for (iy = 1; iy < my; iy++) {
+    phip = phi + iy*rowlen;
+    for (rowoff = 0; rowoff < rowlen; rowoff += spt) {
+      phip[rowoff] = phi[rowoff];
     }
   }
 
@@ -3808,17 +5234,19 @@ int stat[];
   status = 0;
 
 
-  /* Do x dependence. */
+  /* Do x dependence for the first row and replicate it row by row. */
   xp = x;
-  rowoff = 0;
-  rowlen = nx*spt;
-  for (ix = 0; ix < nx; ix++, rowoff += spt, xp += sxy) {
+  phip = phi;
+  for (ix = 0; ix < nx; ix++, phip += spt, xp += sxy) {
     s = prj->w[1]*(*xp + prj->x0);
+    *phip = s;
+  }
 
-    phip = phi + rowoff;
-    for (iy = 0; iy < my; iy++) {
-      *phip = s;
-      phip += rowlen;
+  rowlen = nx*spt;
+  for (iy = 1; iy < my; iy++) {
+    phip = phi + iy*rowlen;
+    for (rowoff = 0; rowoff < rowlen; rowoff += spt) {
+      phip[rowoff] = phi[rowoff];
     }
   }
 
@@ -4009,17 +5437,19 @@ int stat[];
   status = 0;
 
 
-  /* Do x dependence. */
+  /* Do x dependence for the first row and replicate it row by row. */
   xp = x;
-  rowoff = 0;
-  rowlen = nx*spt;
-  for (ix = 0; ix < nx; ix++, rowoff += spt, xp += sxy) {
+  phip = phi;
+  for (ix = 0; ix < nx; ix++, phip += spt, xp += sxy) {
     s = prj->w[1]*(*xp + prj->x0);
+    *phip = s;
+  }
 
-    phip = phi + rowoff;
-    for (iy = 0; iy < my; iy++) {
-      *phip = s;
-      phip += rowlen;
+  rowlen = nx*spt;
+  for (iy = 1; iy < my; iy++) {
+    phip = phi + iy*rowlen;
+    for (rowoff = 0; rowoff < rowlen; rowoff += spt) {
+      phip[rowoff] = phi[rowoff];
     }
   }
 
@@ -4382,6 +5812,12 @@ int stat[];
 *      prj->w[1]    sqrt(2)*r0/90
 *      prj->w[2]    1/(sqrt(2)*r0)
 *      prj->w[3]    90/r0
+*      prj->m       Number of intervals in the inverse table, zero if there
+*                   is none, in which case mols2x() solves Kepler's equation,
+*                   v + sin(v) = pi*sin(theta), iteratively.
+*      prj->wtab    Inverse table giving w = pi - |v| as a function of
+*                   (w - sin(w))**(1/3), laid out as for ZPN.  This variable
+*                   removes the cube-root singularity at the poles.
 *      prj->prjx2s  Pointer to molx2s().
 *      prj->prjs2x  Pointer to mols2x().
 *===========================================================================*/
@@ -4413,6 +5849,8 @@ struct prjprm *prj;
   prj->w[3] = 90.0/prj->r0;
   prj->w[4] = 2.0/PI;
 
+  prj_tab(prj, PI, mol_s);
+
   prj->prjx2s = molx2s;
   prj->prjs2x = mols2x;
 
@@ -4567,7 +6005,7 @@ int stat[];
 
 {
   int k, mphi, mtheta, rowlen, rowoff, status;
-  double eta, gamma, resid, u, v, v0, v1, xi;
+  double eta, gamma, resid, s, u, v, v0, v1, w, xi;
   const double tol = 1.0e-13;
   register int iphi, itheta, *statp;
   register const double *phip, *thetap;
@@ -4611,6 +6049,8 @@ int stat[];
   yp = y;
   statp = stat;
   for (itheta = 0; itheta < ntheta; itheta++, thetap += spt) {
+    s = sind((90.0 - fabs(*thetap))/2.0);
+
     if (fabs(*thetap) == 90.0) {
       xi  = 0.0;
       eta = copysign(prj->w[0], *thetap);
@@ -4619,6 +6059,12 @@ int stat[];
       xi  = 1.0;
       eta = 0.0;
 
+    } else if ((w = prj_tabinv(prj, pow(2.0*PI*s*s, 1.0/3.0), mol_s))
+               >= 0.0) {
+      /* Interpolated in the inverse table, s = sin((90 - |theta|)/2). */
+      xi  = sin(w/2.0);
+      eta = copysign(prj->w[0]*cos(w/2.0), *thetap);
+
     } else {
       u  = PI*sind(*thetap);
       v0 = -PI;
@@ -4652,6 +6098,40 @@ int stat[];
   return 0;
 }
 
+/*--------------------------------------------------------------------------*/
+
+/* Compute (w - sin(w))**(1/3) for MOL, and its derivative, given w = pi - |v|
+   in radians.  A series is used for small w to avoid cancellation.  Being
+   independent of the projection parameters, it ignores prj. */
+
+double mol_s(const struct prjprm *prj, double w, double *ds)
+
+{
+  double f, s, w2;
+
+  (void)prj;
+
+  if (w == 0.0) {
+    *ds = pow(6.0, -1.0/3.0);
+    return 0.0;
+  }
+
+  if (w < 0.25) {
+    w2 = w*w;
+    f  = 1.0 - w2*(1.0 - w2/110.0)/72.0;
+    f  = 1.0 - w2*f/42.0;
+    f  = w*w2*(1.0 - w2*f/20.0)/6.0;
+  } else {
+    f  = w - sin(w);
+  }
+
+  s = pow(f, 1.0/3.0);
+  f = sin(w/2.0);
+  *ds = 2.0*f*f/(3.0*s*s);
+
+  return s;
+}
+
 /*============================================================================
 *   AIT: Hammer-Aitoff projection.
 *
@@ -6179,6 +7659,15 @@ int stat[];
 *      prj->w[1]    (180/pi)/r0
 *      prj->w[2]    2*r0
 *      prj->w[3]    (pi/180)/(2*r0)
+*      prj->m       Number of cells in x in the inverse table, zero if there
+*                   is none, in which case pcox2s() solves for theta
+*                   iteratively.
+*      prj->wtab    Inverse table giving theta, in radians, as a bicubic
+*                   Hermite interpolant over square cells of side h = pi/m
+*                   spanning 0 <= x/r0 <= pi, 0 <= y/r0 <= pi/2.  For each
+*                   node, (i,j) for x/r0 = i*h, y/r0 = j*h, wtab[4*(j*(m+1)+i)]
+*                   contains theta followed by h*dtheta/dx, h*dtheta/dy, and
+*                   h*h*d2theta/dxdy.
 *      prj->prjx2s  Pointer to pcox2s().
 *      prj->prjs2x  Pointer to pcos2x().
 *===========================================================================*/
@@ -6214,6 +7703,8 @@ struct prjprm *prj;
   }
   prj->w[3] = D2R/prj->w[2];
 
+  pco_tab(prj);
+
   prj->prjx2s = pcox2s;
   prj->prjs2x = pcos2x;
 
@@ -6232,10 +7723,9 @@ int stat[];
 
 {
   int mx, my, rowlen, rowoff, status;
-  double f, fneg, fpos, lambda, tanthe, the, theneg, thepos, w, x1, xj, xx,
-         yj, ymthe, y1;
+  double tanthe, the, w, x1, xj, yj, ymthe, y1;
   const double tol = 1.0e-12;
-  register int ix, iy, k, *statp;
+  register int ix, iy, *statp;
   register const double *xp, *yp;
   register double *phip, *thetap;
 
@@ -6300,44 +7790,9 @@ int stat[];
           ymthe  = yj - prj->w[0]*the;
           tanthe = tand(the);
 
-        } else {
+        } else if (pco_tabinv(prj, xj, yj, &the, &ymthe, &tanthe)) {
           /* Iterative solution using weighted division of the interval. */
-          thepos = yj / prj->w[0];
-          theneg = 0.0;
-
-          /* Setting fneg = -fpos halves the interval in the first iter. */
-          xx = xj*xj;
-          fpos  =  xx;
-          fneg  = -xx;
-
-          for (k = 0; k < 64; k++) {
-            /* Weighted division of the interval. */
-            lambda = fpos/(fpos-fneg);
-            if (lambda < 0.1) {
-              lambda = 0.1;
-            } else if (lambda > 0.9) {
-              lambda = 0.9;
-            }
-            the = thepos - lambda*(thepos-theneg);
-
-            /* Compute the residue. */
-            ymthe  = yj - prj->w[0]*the;
-            tanthe = tand(the);
-            f = xx + ymthe*(ymthe - prj->w[2]/tanthe);
-
-            /* Check for convergence. */
-            if (fabs(f) < tol) break;
-            if (fabs(thepos-theneg) < tol) break;
-
-            /* Redefine the interval. */
-            if (f > 0.0) {
-              thepos = the;
-              fpos = f;
-            } else {
-              theneg = the;
-              fneg = f;
-            }
-          }
+          the = pco_the(prj, xj, yj, &ymthe, &tanthe);
         }
 
         x1 = prj->r0 - ymthe*tanthe;
@@ -6448,6 +7903,209 @@ int stat[];
   return 0;
 }
 
+/*--------------------------------------------------------------------------*/
+
+/* Solve for theta for PCO, in degrees, given (x,y) offset by (x0,y0), using
+   weighted division of the interval.  Also returns y - r0*theta and
+   tan(theta) for the solution. */
+
+double pco_the(
+  const struct prjprm *prj,
+  double xj,
+  double yj,
+  double *ymthe,
+  double *tanthe)
+
+{
+  int k;
+  double f, fneg, fpos, lambda, the, theneg, thepos, xx;
+  const double tol = 1.0e-12;
+
+  thepos = yj / prj->w[0];
+  theneg = 0.0;
+
+  /* Setting fneg = -fpos halves the interval in the first iter. */
+  xx = xj*xj;
+  fpos  =  xx;
+  fneg  = -xx;
+
+  for (k = 0; k < 64; k++) {
+    /* Weighted division of the interval. */
+    lambda = fpos/(fpos-fneg);
+    if (lambda < 0.1) {
+      lambda = 0.1;
+    } else if (lambda > 0.9) {
+      lambda = 0.9;
+    }
+    the = thepos - lambda*(thepos-theneg);
+
+    /* Compute the residue. */
+    *ymthe  = yj - prj->w[0]*the;
+    *tanthe = tand(the);
+    f = xx + (*ymthe)*(*ymthe - prj->w[2]/(*tanthe));
+
+    /* Check for convergence. */
+    if (fabs(f) < tol) break;
+    if (fabs(thepos-theneg) < tol) break;
+
+    /* Redefine the interval. */
+    if (f > 0.0) {
+      thepos = the;
+      fpos = f;
+    } else {
+      theneg = the;
+      fneg = f;
+    }
+  }
+
+  return the;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Tabulate theta for PCO, as a function of (x,y)/r0 in the first quadrant,
+   as described for pcoset().  The partial derivatives at the nodes follow
+   from implicit differentiation of
+
+     F = x**2 + (y - theta)**2 - 2*(y - theta)*cot(theta) = 0
+
+   with limiting forms along the axes.  The interpolant is inaccurate near
+   the pole, where theta has a conical singularity, but there pco_tabinv()
+   rejects it.  If memory allocation fails the table is simply omitted. */
+
+void pco_tab(struct prjprm *prj)
+
+{
+  int i, j, m, nv;
+  double c, e, ft, ftt, h, *node, tanthe, tx, ty, x, y, ymthe;
+
+  if (prj->wtab) {
+    free(prj->wtab);
+    prj->wtab = 0x0;
+  }
+  prj->m = 0;
+
+  m  = 32;
+  nv = 25*m/32;
+  if (!(prj->wtab = calloc(4*(m+1)*(nv+1), sizeof(double)))) return;
+
+  h = PI/m;
+  node = prj->wtab;
+  for (j = 0; j <= nv; j++) {
+    y = j*h;
+    for (i = 0; i <= m; i++, node += 4) {
+      x = i*h;
+
+      if (j == 0) {
+        /* Along the equator theta ~ 2y/(2 + x**2). */
+        e = 2.0 + x*x;
+        node[0] = 0.0;
+        node[1] = 0.0;
+        node[2] = h*2.0/e;
+        node[3] = -h*h*4.0*x/(e*e);
+
+      } else if (i == 0) {
+        /* Along the central meridian theta = y. */
+        node[0] = y;
+        node[1] = 0.0;
+        node[2] = h;
+        node[3] = 0.0;
+
+      } else {
+        node[0] = D2R*pco_the(prj, x*prj->r0, y*prj->r0, &ymthe, &tanthe);
+
+        c  = 1.0/tan(node[0]);
+        e  = y - node[0];
+        ft = 2.0*c*(1.0 + e*c);
+        tx = -2.0*x/ft;
+        ty = 2.0*(c - e)/ft;
+        ftt = -2.0*(1.0 + c*c)*(1.0 + 2.0*e*c) - 2.0*c*c;
+
+        node[1] = h*tx;
+        node[2] = h*ty;
+        node[3] = h*h*2.0*x*(2.0*c*c + ftt*ty)/(ft*ft);
+      }
+    }
+  }
+
+  prj->m = m;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Interpolate theta for PCO, in degrees, in the table computed by pco_tab()
+   given (x,y) offset by (x0,y0), and apply one Newton-Raphson correction.
+   Also returns y - r0*theta and tan(theta) for the solution.  Returns 1 if
+   (x,y) is outside the table or the correction is too large to be trusted,
+   whence the caller should solve for theta iteratively. */
+
+int pco_tabinv(
+  const struct prjprm *prj,
+  double xj,
+  double yj,
+  double *the,
+  double *ymthe,
+  double *tanthe)
+
+{
+  int i, j, k, l, m;
+  double a[2], b[2], c[2], d, df, f, u, v, w[2];
+  register const double *node;
+
+  if ((m = prj->m) == 0) return 1;
+
+  u = fabs(xj)/prj->r0*(m/PI);
+  v = fabs(yj)/prj->r0*(m/PI);
+  if (u >= m || v >= 25*m/32) return 1;
+
+  i = (int)u;
+  j = (int)v;
+  u -= i;
+  v -= j;
+
+  /* Hermite basis functions for value and slope at each end. */
+  a[0] = (1.0 + 2.0*u)*(1.0 - u)*(1.0 - u);
+  a[1] = u*u*(3.0 - 2.0*u);
+  b[0] = u*(1.0 - u)*(1.0 - u);
+  b[1] = u*u*(u - 1.0);
+  c[0] = (1.0 + 2.0*v)*(1.0 - v)*(1.0 - v);
+  c[1] = v*v*(3.0 - 2.0*v);
+  w[0] = v*(1.0 - v)*(1.0 - v);
+  w[1] = v*v*(v - 1.0);
+
+  f = 0.0;
+  for (l = 0; l < 2; l++) {
+    node = prj->wtab + 4*((j+l)*(m+1) + i);
+    for (k = 0; k < 2; k++, node += 4) {
+      f += (node[0]*a[k] + node[1]*b[k])*c[l] +
+           (node[2]*a[k] + node[3]*b[k])*w[l];
+    }
+  }
+
+  *the = copysign(f*R2D, yj);
+
+  /* Two Newton-Raphson steps give full precision. */
+  for (k = 0; k < 2; k++) {
+    *ymthe  = yj - prj->w[0]*(*the);
+    *tanthe = tand(*the);
+    f  = xj*xj + (*ymthe)*(*ymthe - prj->w[2]/(*tanthe));
+    df = (*ymthe)*prj->w[2]*D2R*(1.0 + 1.0/((*tanthe)*(*tanthe))) -
+         prj->w[0]*(2.0*(*ymthe) - prj->w[2]/(*tanthe));
+    d  = f/df;
+    *the -= d;
+  }
+
+  /* Reject unconverged or spurious solutions. */
+  if (!(fabs(d) < 1.0e-8*R2D) || fabs(*the) >= 90.0 || (*the)*yj <= 0.0) {
+    return 1;
+  }
+
+  *ymthe  = yj - prj->w[0]*(*the);
+  *tanthe = tand(*the);
+
+  return 0;
+}
+
 /*============================================================================
 *   TSC: tangential spherical cube projection.
 *
@@ -6525,6 +8183,24 @@ int stat[];
     if ((status = tscset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    status = 0;
+    if (prj_x2sv(prj, nx, ny, sxy, spt, x, y, phi, theta, stat,
+                 tscx2sv)) {
+      status = PRJERR_BAD_PIX_SET("tscx2s");
+    }
+
+    my = (ny > 0) ? ny : 1;
+    if (prj->bounds&4 &&
+        prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
+      if (!status) status = PRJERR_BAD_PIX_SET("tscx2s");
+    }
+
+    return status;
+  }
+#endif
+
   if (ny > 0) {
     mx = nx;
     my = ny;
@@ -6636,7 +8312,8 @@ int stat[];
 
 
   /* Do bounds checking on the native coordinates. */
-  if (prj->bounds&4 && prjbchk(1.0e-13, nx, my, spt, phi, theta, stat)) {
+  if (prj->bounds&4 &&
+      prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
     if (!status) status = PRJERR_BAD_PIX_SET("tscx2s");
   }
 
@@ -6667,6 +8344,18 @@ int stat[];
     if ((status = tscset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    status = 0;
+    if (prj_s2xp(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat,
+                 tscs2xv)) {
+      status = PRJERR_BAD_WORLD_SET("tscs2x");
+    }
+
+    return status;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
@@ -6789,15 +8478,164 @@ int stat[];
         yf = copysign(1.0, yf);
       }
 
-      *xp = prj->w[0]*(xf + x0) - prj->x0;
-      *yp = prj->w[0]*(yf + y0) - prj->y0;
-      *(statp++) = istat;
+      *xp = prj->w[0]*(xf + x0) - prj->x0;
+      *yp = prj->w[0]*(yf + y0) - prj->y0;
+      *(statp++) = istat;
+    }
+  }
+
+  return status;
+}
+
+
+#ifdef WCSSIMD
+
+/*--------------------------------------------------------------------------*/
+
+void tscx2sv(
+  const struct prjprm *prj,
+  int n,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[])
+
+{
+  int bad, fused, i, j;
+  wcsvd face, l, m, nu, one, p, q, t, w1, xf, yf, zero;
+  wcsvm face0, face2, face3, face4, face5, lmzero;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  one  = wcsv_set1(1.0);
+  w1   = wcsv_set1(prj->w[1]);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    xf = wcsv_mul(wcsv_load(x+i), w1);
+    yf = wcsv_mul(wcsv_load(y+i), w1);
+    face = prj_qcx2s(&xf, &yf, &bad);
+
+    face0 = wcsv_cmpeq(face, zero);
+    face2 = wcsv_cmpeq(face, wcsv_set1(2.0));
+    face3 = wcsv_cmpeq(face, wcsv_set1(3.0));
+    face4 = wcsv_cmpeq(face, wcsv_set1(4.0));
+    face5 = wcsv_cmpeq(face, wcsv_set1(5.0));
+
+    if (fused) {
+      t = wcsv_fma(yf, yf, wcsv_fma(xf, xf, one));
+    } else {
+      t = wcsv_add(wcsv_add(one, wcsv_mul(xf, xf)), wcsv_mul(yf, yf));
+    }
+    t = wcsv_div(one, wcsv_sqrt(t));
+
+    /* The direction cosines on each face are t, t*xf, and t*yf with a sign
+       change; these are exactly the products formed by the scalar code. */
+    p = wcsv_mul(t, xf);
+    q = wcsv_mul(t, yf);
+
+    l = wcsv_sel(face2, wcsv_neg(p),
+        wcsv_sel(face3, wcsv_neg(t),
+        wcsv_sel(face4, p,
+        wcsv_sel(face0, wcsv_neg(q),
+        wcsv_sel(face5, q, t)))));
+    m = wcsv_sel(face2, t,
+        wcsv_sel(face3, wcsv_neg(p),
+        wcsv_sel(face4, wcsv_neg(t), p)));
+    nu = wcsv_sel(face0, t,
+         wcsv_sel(face5, wcsv_neg(t), q));
+
+    lmzero = wcsv_mand(wcsv_cmpeq(l, zero), wcsv_cmpeq(m, zero));
+    wcsv_store(phi+i, wcsv_sel(lmzero, zero, wcsv_fatan2d(prj->fast, m, l)));
+    wcsv_store(theta+i, wcsv_fasind(prj->fast, nu));
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      if ((stat[i+j] = (bad >> j) & 1)) {
+        phi[i+j]   = 0.0;
+        theta[i+j] = 0.0;
+      }
     }
   }
+}
 
-  return status;
+/*--------------------------------------------------------------------------*/
+
+void tscs2xv(
+  const struct prjprm *prj,
+  int n,
+  const double theta[],
+  const double sinthe[],
+  const double costhe[],
+  double x[],
+  double y[],
+  int stat[])
+
+{
+  int bad, fused, i, j;
+  wcsvd cthe, face, l, m, nu, one, tol, w0, xf, x0, yf, y0, zeta;
+  wcsvm face0, face2, face3, face4, face5;
+
+  /* Only the sine and cosine of theta are needed here, unlike qscs2xv(). */
+  (void)theta;
+
+  fused = prj_fused();
+  one = wcsv_set1(1.0);
+  tol = wcsv_set1(1.0 + 1.0e-12);
+  w0  = wcsv_set1(prj->w[0]);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    cthe = wcsv_load(costhe+i);
+    l  = wcsv_mul(cthe, wcsv_load(x+i));
+    m  = wcsv_mul(cthe, wcsv_load(y+i));
+    nu = wcsv_load(sinthe+i);
+
+    face = prj_qcs2x(l, m, nu, &zeta);
+
+    face0 = wcsv_cmpeq(face, wcsv_set1(0.0));
+    face2 = wcsv_cmpeq(face, wcsv_set1(2.0));
+    face3 = wcsv_cmpeq(face, wcsv_set1(3.0));
+    face4 = wcsv_cmpeq(face, wcsv_set1(4.0));
+    face5 = wcsv_cmpeq(face, wcsv_set1(5.0));
+
+    xf = wcsv_sel(face2, wcsv_neg(l),
+         wcsv_sel(face3, wcsv_neg(m),
+         wcsv_sel(face4, l, m)));
+    yf = wcsv_sel(face5, l,
+         wcsv_sel(face0, wcsv_neg(l), nu));
+    xf = wcsv_div(xf, zeta);
+    yf = wcsv_div(yf, zeta);
+
+    x0 = wcsv_sel(face2, wcsv_set1(2.0),
+         wcsv_sel(face3, wcsv_set1(4.0),
+         wcsv_sel(face4, wcsv_set1(6.0), wcsv_set1(0.0))));
+    y0 = wcsv_sel(face5, wcsv_set1(-2.0),
+         wcsv_sel(face0, wcsv_set1(2.0), wcsv_set1(0.0)));
+
+    bad = wcsv_mbits(wcsv_mor(wcsv_cmpgt(wcsv_abs(xf), tol),
+                              wcsv_cmpgt(wcsv_abs(yf), tol)));
+    xf = wcsv_sel(wcsv_cmpgt(wcsv_abs(xf), one),
+                  wcsv_sel(wcsv_cmplt(xf, wcsv_set1(0.0)), wcsv_neg(one), one),
+                  xf);
+    yf = wcsv_sel(wcsv_cmpgt(wcsv_abs(yf), one),
+                  wcsv_sel(wcsv_cmplt(yf, wcsv_set1(0.0)), wcsv_neg(one), one),
+                  yf);
+
+    if (fused) {
+      wcsv_store(x+i, wcsv_fma(w0, wcsv_add(xf, x0), wcsv_set1(-prj->x0)));
+      wcsv_store(y+i, wcsv_fma(w0, wcsv_add(yf, y0), wcsv_set1(-prj->y0)));
+    } else {
+      wcsv_store(x+i, wcsv_sub(wcsv_mul(w0, wcsv_add(xf, x0)),
+                               wcsv_set1(prj->x0)));
+      wcsv_store(y+i, wcsv_sub(wcsv_mul(w0, wcsv_add(yf, y0)),
+                               wcsv_set1(prj->y0)));
+    }
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = (bad >> j) & 1;
+    }
+  }
 }
 
+#endif
+
 /*============================================================================
 *   CSC: COBE quadrilateralized spherical cube projection.
 *
@@ -7336,6 +9174,24 @@ int stat[];
     if ((status = qscset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    status = 0;
+    if (prj_x2sv(prj, nx, ny, sxy, spt, x, y, phi, theta, stat,
+                 qscx2sv)) {
+      status = PRJERR_BAD_PIX_SET("qscx2s");
+    }
+
+    my = (ny > 0) ? ny : 1;
+    if (prj->bounds&4 &&
+        prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
+      if (!status) status = PRJERR_BAD_PIX_SET("qscx2s");
+    }
+
+    return status;
+  }
+#endif
+
   if (ny > 0) {
     mx = nx;
     my = ny;
@@ -7551,7 +9407,8 @@ int stat[];
 
 
   /* Do bounds checking on the native coordinates. */
-  if (prj->bounds&4 && prjbchk(1.0e-13, nx, my, spt, phi, theta, stat)) {
+  if (prj->bounds&4 &&
+      prjbchk(PRJ_BCHKTOL(prj), nx, my, spt, phi, theta, stat)) {
     if (!status) status = PRJERR_BAD_PIX_SET("qscx2s");
   }
 
@@ -7584,6 +9441,18 @@ int stat[];
     if ((status = qscset(prj))) return status;
   }
 
+#ifdef WCSSIMD
+  if (prj_simd) {
+    status = 0;
+    if (prj_s2xp(prj, nphi, ntheta, spt, sxy, phi, theta, x, y, stat,
+                 qscs2xv)) {
+      status = PRJERR_BAD_WORLD_SET("qscs2x");
+    }
+
+    return status;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
@@ -7785,6 +9654,261 @@ int stat[];
   return status;
 }
 
+
+#ifdef WCSSIMD
+
+/*--------------------------------------------------------------------------*/
+
+void qscx2sv(
+  const struct prjprm *prj,
+  int n,
+  const double x[],
+  const double y[],
+  double phi[],
+  double theta[],
+  int stat[])
+
+{
+  int bad, fused, i, j;
+  const double tol = 1.0e-12;
+  wcsvd a, b, cosw, den, face, l, m, nu, num, omega, one, sinw, tau, u, v,
+        w, w1, xf, yf, zeco, zero, zeta;
+  wcsvm direct, face0, face023, face2, face3, face4, face5, flat, flip,
+        lmzero, pole;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  one  = wcsv_set1(1.0);
+  w1   = wcsv_set1(prj->w[1]);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    xf = wcsv_mul(wcsv_load(x+i), w1);
+    yf = wcsv_mul(wcsv_load(y+i), w1);
+    face = prj_qcx2s(&xf, &yf, &bad);
+
+    face0 = wcsv_cmpeq(face, zero);
+    face2 = wcsv_cmpeq(face, wcsv_set1(2.0));
+    face3 = wcsv_cmpeq(face, wcsv_set1(3.0));
+    face4 = wcsv_cmpeq(face, wcsv_set1(4.0));
+    face5 = wcsv_cmpeq(face, wcsv_set1(5.0));
+
+    /* The direct and indirect cases differ only in the roles of xf and
+       yf. */
+    direct = wcsv_cmpgt(wcsv_abs(xf), wcsv_abs(yf));
+    num = wcsv_sel(direct, yf, xf);
+    den = wcsv_sel(direct, xf, yf);
+    flat = wcsv_cmpeq(den, zero);
+
+    w = wcsv_div(wcsv_mul(wcsv_set1(15.0), num), wcsv_sel(flat, one, den));
+    wcsv_fsincosd(prj->fast, w, &sinw, &cosw);
+    omega = wcsv_div(sinw, wcsv_sub(cosw, wcsv_set1(SQRT2INV)));
+    tau = fused ? wcsv_fma(omega, omega, one) :
+                  wcsv_add(one, wcsv_mul(omega, omega));
+    zeco = wcsv_mul(wcsv_mul(den, den),
+             wcsv_sub(one, wcsv_div(one, wcsv_sqrt(wcsv_add(one, tau)))));
+
+    omega = wcsv_sel(flat, zero, omega);
+    tau   = wcsv_sel(flat, one,  tau);
+    zeco  = wcsv_sel(flat, zero, zeco);
+    zeta  = wcsv_sub(one, zeco);
+
+    pole = wcsv_cmplt(zeta, wcsv_set1(-1.0));
+    bad |= wcsv_mbits(wcsv_cmplt(zeta, wcsv_set1(-1.0-tol)));
+    w = wcsv_sqrt(wcsv_div(wcsv_mul(zeco, wcsv_sub(wcsv_set1(2.0), zeco)),
+                           tau));
+    zeta = wcsv_sel(pole, wcsv_set1(-1.0), zeta);
+    w    = wcsv_sel(pole, zero, w);
+
+    /* a is w with the sign of xf (direct) or yf (indirect) reversed on some
+       faces, and b = +/-a*omega is the remaining direction cosine. */
+    face023 = wcsv_mor(wcsv_mor(face2, face3), face0);
+    flip = wcsv_mor(
+      wcsv_mand(direct, wcsv_mor(
+        wcsv_mand(wcsv_mor(face2, face3), wcsv_cmpgt(xf, zero)),
+        wcsv_mand(wcsv_mnot(wcsv_mor(face2, face3)), wcsv_cmplt(xf, zero)))),
+      wcsv_mand(wcsv_mnot(direct), wcsv_mor(
+        wcsv_mand(face0, wcsv_cmpgt(yf, zero)),
+        wcsv_mand(wcsv_mnot(face0), wcsv_cmplt(yf, zero)))));
+    a = wcsv_sel(flip, wcsv_neg(w), w);
+    b = wcsv_mul(a, omega);
+    b = wcsv_sel(face023, wcsv_neg(b), b);
+
+    /* Assign them to (l,m,n) according to the face. */
+    u = wcsv_sel(direct, a, b);
+    v = wcsv_sel(direct, b, a);
+    l = wcsv_sel(face2, u,
+        wcsv_sel(face3, wcsv_neg(zeta),
+        wcsv_sel(face4, u,
+        wcsv_sel(wcsv_mor(face5, face0), v, zeta))));
+    m = wcsv_sel(face2, zeta,
+        wcsv_sel(face4, wcsv_neg(zeta), u));
+    nu = wcsv_sel(face5, wcsv_neg(zeta),
+         wcsv_sel(face0, zeta, v));
+
+    lmzero = wcsv_mand(wcsv_cmpeq(l, zero), wcsv_cmpeq(m, zero));
+    wcsv_store(phi+i, wcsv_sel(lmzero, zero, wcsv_fatan2d(prj->fast, m, l)));
+    wcsv_store(theta+i, wcsv_fasind(prj->fast, nu));
+
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      if ((stat[i+j] = (bad >> j) & 1)) {
+        phi[i+j]   = 0.0;
+        theta[i+j] = 0.0;
+      }
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+void qscs2xv(
+  const struct prjprm *prj,
+  int n,
+  const double theta[],
+  const double sinthe[],
+  const double costhe[],
+  double x[],
+  double y[],
+  int stat[])
+
+{
+  int bad, fused, i, j, small;
+  const double tol = 1.0e-12;
+  double fc[WCSSIMD_NLANE], p, t, zc[WCSSIMD_NLANE];
+  wcsvd cthe, den, eta, face, l, m, nu, num, omega, one, other, tau,
+        thetaj, w0, xf, x0, xi, yf, y0, zeco, zero, zeta;
+  wcsvm face0, face2, face3, face4, face5, horiz, pole, valid;
+
+  fused = prj_fused();
+  zero = wcsv_set1(0.0);
+  one  = wcsv_set1(1.0);
+  w0   = wcsv_set1(prj->w[0]);
+  for (i = 0; i < n; i += WCSSIMD_NLANE) {
+    thetaj = wcsv_load(theta+i);
+    cthe = wcsv_load(costhe+i);
+    l  = wcsv_mul(cthe, wcsv_load(x+i));
+    m  = wcsv_mul(cthe, wcsv_load(y+i));
+    nu = wcsv_load(sinthe+i);
+
+    face = prj_qcs2x(l, m, nu, &zeta);
+    face0 = wcsv_cmpeq(face, zero);
+    face2 = wcsv_cmpeq(face, wcsv_set1(2.0));
+    face3 = wcsv_cmpeq(face, wcsv_set1(3.0));
+    face4 = wcsv_cmpeq(face, wcsv_set1(4.0));
+    face5 = wcsv_cmpeq(face, wcsv_set1(5.0));
+
+    xi = wcsv_sel(face2, wcsv_neg(l),
+         wcsv_sel(face3, wcsv_neg(m),
+         wcsv_sel(face4, l, m)));
+    eta = wcsv_sel(face5, l,
+          wcsv_sel(face0, wcsv_neg(l), nu));
+    x0 = wcsv_sel(face2, wcsv_set1(2.0),
+         wcsv_sel(face3, wcsv_set1(4.0),
+         wcsv_sel(face4, wcsv_set1(6.0), zero)));
+    y0 = wcsv_sel(face5, wcsv_set1(-2.0),
+         wcsv_sel(face0, wcsv_set1(2.0), zero));
+
+    zeco = wcsv_sub(one, zeta);
+
+    /* The small angle formulae are needed too rarely to be worth
+       vectorizing. */
+    small = wcsv_mbits(wcsv_cmplt(zeco, wcsv_set1(1.0e-8)));
+    if (small) {
+      wcsv_store(fc, face);
+      wcsv_store(zc, zeco);
+      for (j = 0; j < WCSSIMD_NLANE; j++) {
+        if (!((small >> j) & 1)) continue;
+
+        t = theta[i+j]*D2R;
+        switch ((int)fc[j]) {
+        case 1:
+          p = atan2(y[i+j], x[i+j]);
+          zc[j] = (p*p + t*t)/2.0;
+          break;
+        case 2:
+          p = atan2(y[i+j], x[i+j]) - PI/2.0;
+          zc[j] = (p*p + t*t)/2.0;
+          break;
+        case 3:
+          p = atan2(y[i+j], x[i+j]);
+          p -= copysign(PI, p);
+          zc[j] = (p*p + t*t)/2.0;
+          break;
+        case 4:
+          p = atan2(y[i+j], x[i+j]) + PI/2.0;
+          zc[j] = (p*p + t*t)/2.0;
+          break;
+        case 5:
+          t = (theta[i+j] + 90.0)*D2R;
+          zc[j] = t*t/2.0;
+          break;
+        default:
+          t = (90.0 - theta[i+j])*D2R;
+          zc[j] = t*t/2.0;
+          break;
+        }
+      }
+      zeco = wcsv_load(zc);
+    }
+
+    /* The horizontal and vertical cases differ only in the roles of xi and
+       eta. */
+    horiz = wcsv_mor(wcsv_cmpgt(wcsv_neg(xi), wcsv_abs(eta)),
+                     wcsv_cmpgt(xi, wcsv_abs(eta)));
+    valid = wcsv_mand(
+              wcsv_mor(wcsv_cmpne(xi, zero), wcsv_cmpne(eta, zero)),
+              wcsv_mor(horiz, wcsv_mor(
+                wcsv_cmpge(wcsv_neg(eta), wcsv_abs(xi)),
+                wcsv_cmpge(eta, wcsv_abs(xi)))));
+    num = wcsv_sel(horiz, eta, xi);
+    den = wcsv_sel(horiz, xi, eta);
+
+    omega = wcsv_div(num, wcsv_sel(valid, den, one));
+    tau = fused ? wcsv_fma(omega, omega, one) :
+                  wcsv_add(one, wcsv_mul(omega, omega));
+    xf = wcsv_sqrt(wcsv_div(zeco,
+           wcsv_sub(one, wcsv_div(one, wcsv_sqrt(wcsv_add(one, tau))))));
+    xf = wcsv_sel(wcsv_cmplt(den, zero), wcsv_neg(xf), xf);
+    other = wcsv_mul(wcsv_div(xf, wcsv_set1(15.0)),
+              wcsv_sub(wcsv_fatand(prj->fast, omega),
+                wcsv_fasind(prj->fast,
+                  wcsv_div(omega, wcsv_sqrt(wcsv_add(tau, tau))))));
+
+    yf = wcsv_sel(valid, wcsv_sel(horiz, other, xf), zero);
+    xf = wcsv_sel(valid, wcsv_sel(horiz, xf, other), zero);
+
+    bad = wcsv_mbits(wcsv_mor(wcsv_cmpgt(wcsv_abs(xf), wcsv_set1(1.0+tol)),
+                              wcsv_cmpgt(wcsv_abs(yf), wcsv_set1(1.0+tol))));
+    xf = wcsv_sel(wcsv_cmpgt(wcsv_abs(xf), one),
+                  wcsv_sel(wcsv_cmplt(xf, zero), wcsv_neg(one), one), xf);
+    yf = wcsv_sel(wcsv_cmpgt(wcsv_abs(yf), one),
+                  wcsv_sel(wcsv_cmplt(yf, zero), wcsv_neg(one), one), yf);
+
+    if (fused) {
+      xf = wcsv_fma(w0, wcsv_add(xf, x0), wcsv_set1(-prj->x0));
+      yf = wcsv_fma(w0, wcsv_add(yf, y0), wcsv_set1(-prj->y0));
+    } else {
+      xf = wcsv_sub(wcsv_mul(w0, wcsv_add(xf, x0)), wcsv_set1(prj->x0));
+      yf = wcsv_sub(wcsv_mul(w0, wcsv_add(yf, y0)), wcsv_set1(prj->y0));
+    }
+
+    /* The poles. */
+    pole = wcsv_cmpeq(wcsv_abs(thetaj), wcsv_set1(90.0));
+    xf = wcsv_sel(pole, wcsv_set1(-prj->x0), xf);
+    yf = wcsv_sel(pole, wcsv_sub(
+           wcsv_sel(wcsv_cmplt(thetaj, zero), wcsv_set1(-2.0*prj->w[0]),
+                                              wcsv_set1(2.0*prj->w[0])),
+           wcsv_set1(prj->y0)), yf);
+    bad &= ~wcsv_mbits(pole);
+
+    wcsv_store(x+i, xf);
+    wcsv_store(y+i, yf);
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      stat[i+j] = (bad >> j) & 1;
+    }
+  }
+}
+
+#endif
+
 /*============================================================================
 *   HPX: HEALPix projection.
 *
@@ -8480,3 +10604,567 @@ int stat[];
 
   return 0;
 }
+
+/*============================================================================
+*   HEALPix pixel indices.
+*
+*   hpxs2p() and hpxp2s() compute NESTED and RING pixel indices directly from
+*   native spherical coordinates, and vice versa, for the standard HEALPix
+*   grid with H = 4 and K = 3.  The floating point stages are vectorized,
+*   the integer stages use the algorithms of Gorski et al. (2005, ApJ, 622,
+*   759) with table lookup for interleaving the bits of NESTED indices.
+*===========================================================================*/
+
+/* Spread the bits of a byte into the even bits of a short, and compact the
+   even and odd bits of a byte into the low and high nibbles of the low and
+   high bytes of a short. */
+
+#define HPX_U0(a) 0x##a##0, 0x##a##1, 0x##a##4, 0x##a##5
+#define HPX_U1(a) HPX_U0(a##0), HPX_U0(a##1), HPX_U0(a##4), HPX_U0(a##5)
+#define HPX_U2(a) HPX_U1(a##0), HPX_U1(a##1), HPX_U1(a##4), HPX_U1(a##5)
+static const unsigned short hpx_utab[256] = {
+  HPX_U2(0), HPX_U2(1), HPX_U2(4), HPX_U2(5)};
+#undef HPX_U0
+#undef HPX_U1
+#undef HPX_U2
+
+#define HPX_C0(a) a, a+1, a+256, a+257
+#define HPX_C1(a) HPX_C0(a), HPX_C0(a+2), HPX_C0(a+512), HPX_C0(a+514)
+#define HPX_C2(a) HPX_C1(a), HPX_C1(a+4), HPX_C1(a+1024), HPX_C1(a+1028)
+static const unsigned short hpx_ctab[256] = {
+  HPX_C2(0), HPX_C2(8), HPX_C2(2048), HPX_C2(2056)};
+#undef HPX_C0
+#undef HPX_C1
+#undef HPX_C2
+
+/* Ring number of the southern corner, and longitude of the centre in units
+   of 45 deg, of each base-resolution pixel. */
+static const int hpx_jrll[12] = {2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4};
+static const int hpx_jpll[12] = {1, 3, 5, 7, 0, 2, 4, 6, 1, 3, 5, 7};
+
+/*--------------------------------------------------------------------------*/
+
+int hpxs2p(prj, nside, nested, nphi, ntheta, spt, spix, phi, theta, ipix,
+           stat)
+
+struct prjprm *prj;
+int nside, nested, nphi, ntheta, spt, spix;
+const double phi[], theta[];
+long ipix[];
+int stat[];
+
+{
+  static const char *function = "hpxs2p";
+
+  int face, grid, i, iphi, ix, iy, k, n, nbad, ntot, nv, order, status;
+  int bad[HPX_NBLK];
+  long ifm, ifp, ijm, ijp, ip, ir, ncap, nl4, npface, npix, nsidel;
+  double jmb[HPX_NBLK], jpb[HPX_NBLK], pb[HPX_NBLK], rb[HPX_NBLK],
+         tb[HPX_NBLK], ttb[HPX_NBLK];
+  register int *statp;
+  register const double *phip, *thetap;
+  register long *pixp;
+
+
+  /* Initialize. */
+  if (prj == 0x0) return PRJERR_NULL_POINTER;
+  if ((status = hpx_chk(prj, nside, nested, function))) return status;
+
+  for (order = 0; (1 << order) < nside; order++);
+  nsidel = nside;
+  npface = nsidel*nsidel;
+  npix   = 12*npface;
+  ncap   = 2*nsidel*(nsidel - 1);
+  nl4    = 4*nsidel;
+
+  grid = (ntheta > 0);
+  ntot = grid ? nphi*ntheta : nphi;
+
+  nbad = 0;
+  iphi = 0;
+  phip   = phi;
+  thetap = theta;
+  pixp   = ipix;
+  statp  = stat;
+  for (k = 0; k < ntot; k += n) {
+    n = ntot - k;
+    if (n > HPX_NBLK) n = HPX_NBLK;
+
+    /* Gather a block of (phi,theta), flagging invalid values. */
+    for (i = 0; i < n; i++) {
+      pb[i] = *phip;
+      tb[i] = *thetap;
+
+      bad[i] = !(fabs(tb[i]) <= 90.0) || (pb[i] - pb[i] != 0.0);
+      if (bad[i]) {
+        pb[i] = 0.0;
+        tb[i] = 0.0;
+      } else if (fabs(pb[i]) > 360.0) {
+        pb[i] = fmod(pb[i], 360.0);
+      }
+
+      phip += spt;
+      if (grid) {
+        if (++iphi == nphi) {
+          iphi = 0;
+          phip = phi;
+          thetap += spt;
+        }
+      } else {
+        thetap += spt;
+      }
+    }
+
+    nv = ((n + HPX_NPAD - 1)/HPX_NPAD)*HPX_NPAD;
+    for (; i < nv; i++) {
+      pb[i] = 0.0;
+      tb[i] = 0.0;
+    }
+
+    hpx_s2j(nside, nv, pb, tb, ttb, jpb, jmb, rb);
+
+    /* Compute the pixel indices from the edge line indices. */
+    for (i = 0; i < n; i++, pixp += spix) {
+      if (bad[i]) {
+        *pixp = -1;
+        *(statp++) = 1;
+        nbad++;
+        continue;
+      }
+
+      ijp = (long)jpb[i];
+      ijm = (long)jmb[i];
+
+      if (nested) {
+        if (rb[i] == 0.0) {
+          /* Equatorial region. */
+          ifp = ijp >> order;
+          ifm = ijm >> order;
+          if (ifp == ifm) {
+            face = (int)(ifp & 3) | 4;
+          } else if (ifp < ifm) {
+            face = (int)(ifp & 3);
+          } else {
+            face = (int)(ifm & 3) + 8;
+          }
+
+          ix = (int)(ijm & (nsidel - 1));
+          iy = (int)(nsidel - (ijp & (nsidel - 1)) - 1);
+
+        } else {
+          /* Polar caps. */
+          if (ijp > nsidel - 1) ijp = nsidel - 1;
+          if (ijm > nsidel - 1) ijm = nsidel - 1;
+
+          if (rb[i] > 0.0) {
+            face = (int)rb[i] - 1;
+            ix = (int)(nsidel - ijm - 1);
+            iy = (int)(nsidel - ijp - 1);
+          } else {
+            face = (int)(-rb[i]) + 7;
+            ix = (int)ijp;
+            iy = (int)ijm;
+          }
+        }
+
+        *pixp = face*npface + hpx_xy2n(ix, iy);
+
+      } else {
+        if (rb[i] == 0.0) {
+          /* Equatorial region. */
+          ir = nsidel + 1 + ijp - ijm;
+          ip = (ijp + ijm - nsidel + 2 - (ir & 1) + 2*nl4) >> 1;
+          *pixp = ncap + (ir - 1)*nl4 + ip%nl4;
+
+        } else {
+          /* Polar caps. */
+          ir = ijp + ijm + 1;
+          ip = (long)(ttb[i]*ir);
+          if (ip > 4*ir - 1) ip = 4*ir - 1;
+
+          if (rb[i] > 0.0) {
+            *pixp = 2*ir*(ir - 1) + ip;
+          } else {
+            *pixp = npix - 2*ir*(ir + 1) + ip;
+          }
+        }
+      }
+
+      *(statp++) = 0;
+    }
+  }
+
+  status = 0;
+  if (nbad) status = PRJERR_BAD_WORLD_SET("hpxs2p");
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int hpxp2s(prj, nside, nested, npix, spix, spt, ipix, phi, theta, stat)
+
+struct prjprm *prj;
+int nside, nested, npix, spix, spt;
+const long ipix[];
+double phi[], theta[];
+int stat[];
+
+{
+  static const char *function = "hpxp2s";
+  const double sqrt6 = 2.449489742783178;
+
+  int face, i, ix, iy, k, n, nbad, nv, order, status;
+  int bad[HPX_NBLK];
+  long iphi, ip, ir, jp, jr, kshift, ncap, nl4, npface, nr, nsidel, ntot,
+       pix;
+  double mb[HPX_NBLK], pb[HPX_NBLK], qb[HPX_NBLK], tb[HPX_NBLK];
+  register int *statp;
+  register const long *pixp;
+  register double *phip, *thetap;
+
+
+  /* Initialize. */
+  if (prj == 0x0) return PRJERR_NULL_POINTER;
+  if ((status = hpx_chk(prj, nside, nested, function))) return status;
+
+  for (order = 0; (1 << order) < nside; order++);
+  nsidel = nside;
+  npface = nsidel*nsidel;
+  ntot   = 12*npface;
+  ncap   = 2*nsidel*(nsidel - 1);
+  nl4    = 4*nsidel;
+
+  nbad = 0;
+  pixp   = ipix;
+  phip   = phi;
+  thetap = theta;
+  statp  = stat;
+  for (k = 0; k < npix; k += n) {
+    n = npix - k;
+    if (n > HPX_NBLK) n = HPX_NBLK;
+
+    /* Compute the longitude and either z = sin(theta) in the equatorial
+       region, or sin((90 - |theta|)/2) in the polar caps. */
+    for (i = 0; i < n; i++, pixp += spix) {
+      pix = *pixp;
+      if ((bad[i] = (pix < 0 || ntot <= pix))) {
+        pb[i] = 0.0;
+        qb[i] = 0.0;
+        mb[i] = 0.0;
+        continue;
+      }
+
+      if (nested) {
+        face = (int)(pix >> (2*order));
+        hpx_n2xy(pix & (npface - 1), &ix, &iy);
+
+        jr = hpx_jrll[face]*nsidel - ix - iy - 1;
+        if (jr < nsidel) {
+          nr = jr;
+          qb[i] = nr/(nsidel*sqrt6);
+          mb[i] = 1.0;
+          kshift = 0;
+        } else if (jr > 3*nsidel) {
+          nr = nl4 - jr;
+          qb[i] = nr/(nsidel*sqrt6);
+          mb[i] = -1.0;
+          kshift = 0;
+        } else {
+          nr = nsidel;
+          qb[i] = (2*(2*nsidel - jr))/(3.0*nsidel);
+          mb[i] = 0.0;
+          kshift = (jr - nsidel) & 1;
+        }
+
+        jp = (hpx_jpll[face]*nr + ix - iy + 1 + kshift)/2;
+        if (jp > nl4) {
+          jp -= nl4;
+        } else if (jp < 1) {
+          jp += nl4;
+        }
+
+        pb[i] = ((2*jp - kshift - 1)*45.0)/nr;
+
+      } else {
+        if (pix < ncap) {
+          /* North polar cap. */
+          ir = (1 + hpx_isqrt(1 + 2*pix)) >> 1;
+          iphi = pix + 1 - 2*ir*(ir - 1);
+          qb[i] = ir/(nsidel*sqrt6);
+          mb[i] = 1.0;
+          pb[i] = ((2*iphi - 1)*45.0)/ir;
+
+        } else if (pix < ntot - ncap) {
+          /* Equatorial region. */
+          ip = pix - ncap;
+          ir = ip/nl4 + nsidel;
+          iphi = ip%nl4 + 1;
+          qb[i] = (2*(2*nsidel - ir))/(3.0*nsidel);
+          mb[i] = 0.0;
+          pb[i] = ((2*iphi - ((ir + nsidel) & 1 ? 2 : 1))*45.0)/nsidel;
+
+        } else {
+          /* South polar cap. */
+          ip = ntot - pix;
+          ir = (1 + hpx_isqrt(2*ip - 1)) >> 1;
+          iphi = 4*ir + 1 - (ip - 2*ir*(ir - 1));
+          qb[i] = ir/(nsidel*sqrt6);
+          mb[i] = -1.0;
+          pb[i] = ((2*iphi - 1)*45.0)/ir;
+        }
+      }
+
+      if (pb[i] > 180.0) pb[i] -= 360.0;
+    }
+
+    nv = ((n + HPX_NPAD - 1)/HPX_NPAD)*HPX_NPAD;
+    for (; i < nv; i++) {
+      qb[i] = 0.0;
+      mb[i] = 0.0;
+    }
+
+    hpx_q2t(nv, mb, qb, tb);
+
+    for (i = 0; i < n; i++, phip += spt, thetap += spt) {
+      if (bad[i]) {
+        *phip   = 0.0;
+        *thetap = 0.0;
+        *(statp++) = 1;
+        nbad++;
+      } else {
+        *phip   = pb[i];
+        *thetap = tb[i];
+        *(statp++) = 0;
+      }
+    }
+  }
+
+  status = 0;
+  if (nbad) status = PRJERR_BAD_PIX_SET("hpxp2s");
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Check that prj is set up for HPX with H = 4 and K = 3, or XPH, and that
+   nside is valid for the indexing scheme. */
+
+int hpx_chk(struct prjprm *prj, int nside, int nested, const char *function)
+
+{
+  int status;
+  struct wcserr **err = &(prj->err);
+
+  if (prj->flag != HPX && prj->flag != XPH) {
+    if (strcmp(prj->code, "HPX") && strcmp(prj->code, "XPH")) {
+      return wcserr_set(WCSERR_SET(PRJERR_BAD_PARAM),
+        "HEALPix pixel indices require the HPX or XPH projection, not %s",
+        prj->code);
+    }
+
+    if ((status = prjset(prj))) return status;
+  }
+
+  if (prj->flag == HPX && (prj->pv[1] != 4.0 || prj->pv[2] != 3.0)) {
+    return wcserr_set(WCSERR_SET(PRJERR_BAD_PARAM),
+      "HEALPix pixel indices require H = 4 and K = 3 for HPX");
+  }
+
+  if (nside < 1 || (1 << 29) < nside || (nested && (nside & (nside - 1))) ||
+      (double)LONG_MAX < 12.0*nside*nside) {
+    return wcserr_set(WCSERR_SET(PRJERR_BAD_PARAM),
+      "Invalid nside for %s HEALPix pixel indices: %d",
+      nested ? "NESTED" : "RING", nside);
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Compute the indices (jp,jm) of the edge lines of the HEALPix grid that
+   bound (phi,theta) to the south-east and south-west, and the longitude, tt,
+   in units of 90 deg.  The region, reg, is 0 in the equatorial region and
+   +/-(1 + the base-resolution pixel column) in the north/south polar caps.
+   In the polar caps, sqrt(3*(1 - |z|)) is computed as sqrt(6)*sin of half
+   the colatitude to retain precision near the poles. */
+
+void hpx_s2j(
+  int nside,
+  int n,
+  const double phi[],
+  const double theta[],
+  double tt[],
+  double jp[],
+  double jm[],
+  double reg[])
+
+{
+  const double sqrt6 = 2.449489742783178;
+  int i;
+  double ntt, t, t1, t2, tmp, tp, z;
+
+#ifdef WCSSIMD
+  if (prj_simd) {
+    int polar;
+    wcsvd c, ns, s, thetaj, ttj, vjm, vjp, vntt, vreg, vtmp, vtp, zj;
+    wcsvm eq;
+
+    ns = wcsv_set1((double)nside);
+    for (i = 0; i < n; i += WCSSIMD_NLANE) {
+      ttj = wcsv_div(wcsv_load(phi+i), wcsv_set1(90.0));
+      ttj = wcsv_sub(ttj, wcsv_mul(wcsv_set1(4.0),
+                          wcsv_floor(wcsv_mul(ttj, wcsv_set1(0.25)))));
+      ttj = wcsv_sel(wcsv_cmpge(ttj, wcsv_set1(4.0)),
+                     wcsv_sub(ttj, wcsv_set1(4.0)), ttj);
+
+      thetaj = wcsv_load(theta+i);
+      wcsv_sincosd(thetaj, &zj, &c);
+
+      vjp = wcsv_mul(ns, wcsv_add(wcsv_set1(0.5), ttj));
+      vtmp = wcsv_mul(ns, wcsv_mul(zj, wcsv_set1(0.75)));
+      vjm = wcsv_floor(wcsv_add(vjp, vtmp));
+      vjp = wcsv_floor(wcsv_sub(vjp, vtmp));
+      vreg = wcsv_set1(0.0);
+
+      eq = wcsv_cmple(wcsv_abs(zj), wcsv_set1(2.0/3.0));
+      polar = wcsv_mbits(wcsv_mnot(eq));
+      if (polar) {
+        wcsv_sincosd(wcsv_mul(wcsv_sub(wcsv_set1(90.0), wcsv_abs(thetaj)),
+                              wcsv_set1(0.5)), &s, &c);
+        vtmp = wcsv_mul(ns, wcsv_mul(wcsv_set1(sqrt6), s));
+        vntt = wcsv_floor(ttj);
+        vtp  = wcsv_sub(ttj, vntt);
+
+        vjp = wcsv_sel(eq, vjp, wcsv_floor(wcsv_mul(vtp, vtmp)));
+        vjm = wcsv_sel(eq, vjm, wcsv_floor(wcsv_mul(
+                                  wcsv_sub(wcsv_set1(1.0), vtp), vtmp)));
+
+        vntt = wcsv_add(vntt, wcsv_set1(1.0));
+        vreg = wcsv_sel(eq, vreg,
+                 wcsv_sel(wcsv_cmpgt(thetaj, vreg), vntt, wcsv_neg(vntt)));
+      }
+
+      wcsv_store(tt+i,  ttj);
+      wcsv_store(jp+i,  vjp);
+      wcsv_store(jm+i,  vjm);
+      wcsv_store(reg+i, vreg);
+    }
+
+    return;
+  }
+#endif
+
+  for (i = 0; i < n; i++) {
+    t = phi[i]/90.0;
+    t -= 4.0*floor(t*0.25);
+    if (t >= 4.0) t -= 4.0;
+    tt[i] = t;
+
+    z = sind(theta[i]);
+    if (fabs(z) <= 2.0/3.0) {
+      /* Equatorial region. */
+      t1 = nside*(0.5 + t);
+      t2 = nside*(z*0.75);
+      jp[i]  = floor(t1 - t2);
+      jm[i]  = floor(t1 + t2);
+      reg[i] = 0.0;
+
+    } else {
+      /* Polar caps. */
+      tmp = nside*(sqrt6*sind((90.0 - fabs(theta[i]))*0.5));
+      ntt = floor(t);
+      tp  = t - ntt;
+      jp[i]  = floor(tp*tmp);
+      jm[i]  = floor((1.0 - tp)*tmp);
+      reg[i] = (theta[i] > 0.0) ? ntt + 1.0 : -(ntt + 1.0);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Compute theta from q = z = sin(theta) in the equatorial region (mode 0),
+   or q = sin((90 - |theta|)/2) in the north (mode 1) or south (mode -1)
+   polar caps. */
+
+void hpx_q2t(int n, const double mode[], const double q[], double theta[])
+
+{
+  int i;
+  double t;
+
+#ifdef WCSSIMD
+  if (prj_simd) {
+    wcsvd a, m;
+
+    for (i = 0; i < n; i += WCSSIMD_NLANE) {
+      m = wcsv_load(mode+i);
+      a = wcsv_asind(wcsv_load(q+i));
+      wcsv_store(theta+i, wcsv_sel(wcsv_cmpeq(m, wcsv_set1(0.0)), a,
+        wcsv_mul(m, wcsv_sub(wcsv_set1(90.0), wcsv_add(a, a)))));
+    }
+
+    return;
+  }
+#endif
+
+  for (i = 0; i < n; i++) {
+    t = asind(q[i]);
+    if (mode[i] != 0.0) t = mode[i]*(90.0 - (t + t));
+    theta[i] = t;
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Interleave the bits of (ix,iy), ix in the even bits. */
+
+long hpx_xy2n(int ix, int iy)
+
+{
+  int  i;
+  long n = 0;
+
+  for (i = 0; ix || iy; i += 16, ix >>= 8, iy >>= 8) {
+    n |= (long)(hpx_utab[ix & 0xff] | (hpx_utab[iy & 0xff] << 1)) << i;
+  }
+
+  return n;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* The inverse of hpx_xy2n(). */
+
+void hpx_n2xy(long n, int *ix, int *iy)
+
+{
+  int c, i;
+
+  *ix = 0;
+  *iy = 0;
+  for (i = 0; n; i += 4, n >>= 8) {
+    c = hpx_ctab[n & 0xff];
+    *ix |= (c & 0xf) << i;
+    *iy |= (c >> 8) << i;
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Integer square root. */
+
+long hpx_isqrt(long v)
+
+{
+  long r;
+
+  r = (long)sqrt((double)v);
+  while (r*r > v) r--;
+  while ((r + 1)*(r + 1) <= v) r++;
+
+  return r;
+}
@@ -49,7 +49,8 @@
 * Routine prjini() is provided to initialize the prjprm struct with default
 * values, prjfree() reclaims any memory that may have been allocated to store
 * an error message, and prjprt() prints its contents.  prjbchk() performs
-* bounds checking on native spherical coordinates.
+* bounds checking on native spherical coordinates, and prjsimd() controls the
+* use of SIMD vector instructions.
 *
 * Setup routines for each projection with names of the form ???set(), where
 * "???" is the down-cased three-letter projection code, compute intermediate
@@ -63,15 +64,19 @@
 *
 * A set of driver routines, prjset(), prjx2s(), and prjs2x(), provides a
 * generic interface to the specific projection routines which they invoke
-* via pointers-to-functions stored in the prjprm struct.
+* via pointers-to-functions stored in the prjprm struct.  prjx2sf() and
+* prjs2xf() do likewise for coordinates stored in single precision.
 *
 * In summary, the routines are:
 *   - prjini()                Initialization routine for the prjprm struct.
-*   - prjfree()               Reclaim memory allocated for error messages.
+*   - prjfree()               Reclaim memory allocated for error messages
+*                               and tables.
 *   - prjprt()                Print the prjprm struct.
 *   - prjbchk()               Bounds checking on native coordinates.
+*   - prjsimd()               Enable or disable the SIMD kernels.
 *
 *   - prjset(), prjx2s(), prjs2x():   Generic driver routines
+*   - prjx2sf(), prjs2xf():           Single-precision driver routines
 *
 *   - azpset(), azpx2s(), azps2x():   AZP (zenithal/azimuthal perspective)
 *   - szpset(), szpx2s(), szps2x():   SZP (slant zenithal perspective)
@@ -102,6 +107,10 @@
 *   - hpxset(), hpxx2s(), hpxs2x():   HPX (HEALPix)
 *   - xphset(), xphx2s(), xphs2x():   XPH (HEALPix polar, aka "butterfly")
 *
+* hpxs2p() and hpxp2s() convert between native spherical coordinates and the
+* NESTED and RING pixel indices of the HEALPix grid defined by the HPX and XPH
+* projections.
+*
 * Argument checking (projection routines):
 * ----------------------------------------
 * The values of phi and theta (the native longitude and latitude) normally lie
@@ -139,12 +148,54 @@
 * diverge).  Refer to the tprj1.c and tprj2.c test routines that accompany
 * this software.
 *
+* SIMD kernels:
+* -------------
+* When WCSLIB is compiled for an x86-64 processor the TAN, STG, SIN, ARC,
+* ZEA, TSC, and QSC routines (SIN only for the orthographic case) use SIMD
+* vector instructions to process 2, 4, or 8 coordinates at a time according
+* to whether SSE2, AVX2 (e.g. CFLAGS="-O2 -mavx2 -mfma"), or AVX-512
+* (-mavx512f) is enabled at compile time.  They honour the same vector
+* lengths and strides as the scalar code, and all tests that determine the
+* stat[] values are made on quantities computed exactly as in the scalar
+* code, so stat[] is identical.  The exception is QSC, where tests of
+* tolerance-based limits may involve trigonometric functions.  For the
+* quadcubes, the face is determined for all coordinates in a vector by the
+* same comparisons, made in the same order, as in the scalar code.  The
+* trigonometric functions are evaluated inline, with the same special-case
+* handling as in wcstrig.c, and agree with those used by the scalar code to
+* within 3 ulp.  Consequently (phi,theta) typically agree to within 1E-13
+* deg, and (x,y) to within a few ulp except where the projection is
+* ill-conditioned, e.g. STG near theta = -90 deg.  The SIMD kernels may be
+* disabled via prjsimd().  Setting prjprm::fast selects faster, reduced-
+* accuracy trigonometric functions within the kernels.
+*
+*
+* prjsimd() - Enable or disable the SIMD kernels
+* ----------------------------------------------
+* prjsimd() enables or disables the SIMD kernels, described above, for all
+* subsequent calls to the projection routines.  They are enabled by default.
+* This is a global setting; it is intended mainly for testing and should not
+* be changed while other threads are using the projection routines.
+*
+* Given:
+*   enable    int       If zero, disable the SIMD kernels; if positive,
+*                       enable them; if negative, leave the setting unchanged.
+*
+* Function return value:
+*             int       The previous setting: 1 if the SIMD kernels were
+*                       enabled, else 0.  Always 0 if WCSLIB was compiled
+*                       without support for them.
+*
 *
 * prjini() - Default constructor for the prjprm struct
 * ----------------------------------------------------
 * prjini() sets all members of a prjprm struct to default values.  It should
 * be used to initialize every prjprm struct.
 *
+* prjini() does not free memory allocated for an error message or a table of
+* intermediate values by a previous set-up; prjfree() must be invoked first
+* if a prjprm struct is to be reinitialized.
+*
 * Returned:
 *   prj       struct prjprm*
 *                       Projection parameters.
@@ -158,7 +209,7 @@
 * prjfree() - Destructor for the prjprm struct
 * --------------------------------------------
 * prjfree() frees any memory that may have been allocated to store an error
-* message in the prjprm struct.
+* message or a table of intermediate values in the prjprm struct.
 *
 * Given:
 *   prj       struct prjprm*
@@ -331,6 +382,45 @@
 *                       prjprm::err if enabled, see wcserr_enable().
 *
 *
+* prjx2sf(), prjs2xf() - Single-precision driver routines
+* -------------------------------------------------------
+* prjx2sf() and prjs2xf() are the same as prjx2s() and prjs2x() except that
+* the coordinates are of type float.  They are converted to double precision
+* in blocks of 256 coordinates which are passed to the projection routine,
+* and the results rounded to float, so that the projection is computed at
+* full accuracy while the arrays occupy half the memory.  A grid (ny or
+* ntheta > 0) is processed a row at a time.
+*
+* Given and returned:
+*   prj       struct prjprm*
+*                       Projection parameters.
+*
+* Given:
+*   nx,ny     int       Vector lengths (prjx2sf()), or ...
+*   nphi,
+*   ntheta    int       ... (prjs2xf()).
+*
+*   sxy,spt   int       Vector strides.
+*
+*   x,y       const float[]
+*                       Projected coordinates (prjx2sf()), or ...
+*   phi,theta const float[]
+*                       ... native spherical coordinates [deg] (prjs2xf()).
+*
+* Returned:
+*   phi,theta float[]   Native spherical coordinates [deg] (prjx2sf()), or
+*                       ...
+*   x,y       float[]   ... projected coordinates (prjs2xf()).  Elements
+*                       for invalid coordinates are as for prjx2s() and
+*                       prjs2x().
+*
+*   stat      int[]     Status value for each vector element, as for
+*                       prjx2s() and prjs2x().
+*
+* Function return value:
+*             int       Status return value, as for prjx2s() and prjs2x().
+*
+*
 * ???set() - Specific setup routines for the prjprm struct
 * --------------------------------------------------------
 * Set up a prjprm struct for a particular projection according to information
@@ -425,6 +515,123 @@
 *                       prjprm::err if enabled, see wcserr_enable().
 *
 *
+* hpxs2p() - HEALPix pixel indices of native spherical coordinates
+* ----------------------------------------------------------------
+* hpxs2p() computes the HEALPix pixel indices, in the NESTED or RING scheme,
+* of the pixels that contain the given native spherical coordinates.  The
+* grid is that of the HPX projection with H = 4 and K = 3, or of the XPH
+* projection; prjprm::pv[] for HPX must be set accordingly.  Only the
+* projection code and parameters are used, so the reference point, scale and
+* offsets have no effect.
+*
+* RING indices run from 0 at the north pole to 12*nside*nside - 1 at the
+* south pole, in order of decreasing latitude and, within each ring of
+* pixels, of increasing longitude starting from phi = 0.  NESTED indices are
+* face*nside*nside plus the bit-interleaved (x,y) index of the pixel within
+* one of the 12 base-resolution pixels, numbered 0 to 3 from west to east in
+* the north polar cap, 4 to 7 in the equatorial region, and 8 to 11 in the
+* south polar cap.
+*
+* These conventions are those of Gorski et al. (2005, ApJ, 622, 759), with
+* the HEALPix longitude and colatitude taken as the native longitude, phi,
+* and 90 - theta.
+*
+* Given and returned:
+*   prj       struct prjprm*
+*                       Projection parameters.  prjset() will be invoked if
+*                       required.
+*
+* Given:
+*   nside     int       Number of pixels along the side of each
+*                       base-resolution pixel, in the range 1 to 2^29.  It
+*                       must be a power of 2 for the NESTED scheme.  Values
+*                       for which 12*nside*nside exceeds LONG_MAX are
+*                       rejected.
+*
+*   nested    int       If non-zero, use the NESTED scheme, else RING.
+*
+*   nphi,
+*   ntheta    int       Vector lengths.  If ntheta is zero then phi[] and
+*                       theta[] are treated as vectors of length nphi,
+*                       otherwise they define a grid of nphi*ntheta points
+*                       with phi varying fastest, as for the ???s2x()
+*                       routines.
+*
+*   spt,spix  int       Vector strides.
+*
+*   phi,theta const double[]
+*                       Native longitude and latitude (phi,theta) [deg].
+*                       Any finite value of phi is accepted.
+*
+* Returned:
+*   ipix      long[]    Pixel indices, set to -1 for invalid (phi,theta).
+*
+*   stat      int[]     Status value for each vector element:
+*                         0: Success.
+*                         1: Invalid value of (phi,theta), i.e. |theta| > 90
+*                            or either coordinate not finite.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null prjprm pointer passed.
+*                         2: Invalid projection parameters, including an
+*                            invalid value of nside.
+*                         4: One or more of the (phi,theta) coordinates
+*                            were, invalid, as indicated by the stat vector.
+*
+*                       For returns > 1, a detailed error message is set in
+*                       prjprm::err if enabled, see wcserr_enable().
+*
+*
+* hpxp2s() - Native spherical coordinates of HEALPix pixel centres
+* ----------------------------------------------------------------
+* hpxp2s() computes the native spherical coordinates of the centres of the
+* HEALPix pixels with the given NESTED or RING pixel indices.  The pixel
+* numbering and the requirements on prj and nside are those described for
+* hpxs2p().
+*
+* Given and returned:
+*   prj       struct prjprm*
+*                       Projection parameters.  prjset() will be invoked if
+*                       required.
+*
+* Given:
+*   nside     int       Number of pixels along the side of each
+*                       base-resolution pixel.
+*
+*   nested    int       If non-zero, use the NESTED scheme, else RING.
+*
+*   npix      int       Vector length.
+*
+*   spix,spt  int       Vector strides.
+*
+*   ipix      const long[]
+*                       Pixel indices.
+*
+* Returned:
+*   phi,theta double[]  Native longitude and latitude (phi,theta) of the pixel
+*                       centres [deg], with phi in the range (-180,180].  Set
+*                       to zero for invalid pixel indices.
+*
+*   stat      int[]     Status value for each vector element:
+*                         0: Success.
+*                         1: Invalid pixel index, i.e. outside the range 0
+*                            to 12*nside*nside - 1.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null prjprm pointer passed.
+*                         2: Invalid projection parameters, including an
+*                            invalid value of nside.
+*                         3: One or more of the pixel indices were invalid,
+*                            as indicated by the stat vector.
+*
+*                       For returns > 1, a detailed error message is set in
+*                       prjprm::err if enabled, see wcserr_enable().
+*
+*
 * prjprm struct - Projection parameters
 * -------------------------------------
 * The prjprm struct contains all information needed to project or deproject
@@ -447,7 +654,8 @@
 *     recompute the returned members of the prjprm struct.  flag will then be
 *     reset to indicate that this has been done.
 *
-*     Note that flag need not be reset when prjprm::bounds is changed.
+*     Note that flag need not be reset when prjprm::bounds or prjprm::fast is
+*     changed.
 *
 *   char code[4]
 *     (Given) Three-letter projection code defined by the FITS standard.
@@ -486,6 +694,19 @@
 *     to suit each projection.  bounds is set to 7 by prjini() by default
 *     which enables all checks.  Zero it to disable all checking.
 *
+*   int fast
+*     (Given) If non-zero, the SIMD kernels (see above) evaluate the
+*     trigonometric functions with the reduced-accuracy approximations in
+*     wcssimd.h, with maximum error WCSSIMD_FASTERR (1E-10 in the sine and
+*     cosine and 1E-10 radian in the inverse functions), rather than to within
+*     a few ulp.  Closure is then typically to 1E-8 deg, and within 1E-7
+*     deg except where the projection is ill-conditioned, e.g. SIN near the
+*     horizon.  The tolerance for bounds checking the native coordinates is
+*     relaxed to 1E-8 deg for the projections with SIMD kernels, and for the
+*     quadcubes the face chosen for points on a face boundary may differ.
+*     The scalar code is unaffected.  fast is set to zero by prjini().  Like
+*     bounds, it may be changed without resetting flag.
+*
 * The remaining members of the prjprm struct are maintained by the setup
 * routines and must not be modified elsewhere:
 *
@@ -560,8 +781,13 @@
 *     (Returned) If enabled, when an error status is returned this struct
 *     contains detailed information about the error, see wcserr_enable().
 *
-*   void *padding
-*     (An unused variable inserted for alignment purposes only.)
+*   double *wtab
+*     (Returned) Table of intermediate values derived from the projection
+*     parameters by those projections that need more than w[] provides,
+*     currently ZPN, AIR, MOL and PCO, which use it to tabulate the solution
+*     of an equation that would otherwise be solved iteratively.  Memory
+*     allocated for it by the initialization routine is freed by prjfree(),
+*     or by prjset() before it sets up the struct afresh.
 *
 *   double w[10]
 *     (Returned) Intermediate floating-point values derived from the
@@ -570,9 +796,10 @@
 *     Usage of the w[] array as it applies to each projection is described in
 *     the prologue to each trio of projection routines in prj.c.
 *
+*   int m
 *   int n
-*     (Returned) Intermediate integer value (used only for the ZPN and HPX
-*     projections).
+*     (Returned) Intermediate integer values (used only for the ZPN, AIR,
+*     MOL, PCO and HPX projections).
 *
 *   int (*prjx2s)(PRJX2S_ARGS)
 *     (Returned) Pointer to the projection ...
@@ -647,6 +874,7 @@ struct prjprm {
   double pv[PVN];		/* Projection parameters.                   */
   double phi0, theta0;		/* Fiducial native coordinates.             */
   int    bounds;		/* Controls bounds checking.                */
+  int    fast;		/* Use reduced-accuracy SIMD trig functions.*/
 
   /* Information derived from the parameters supplied.                      */
   /*------------------------------------------------------------------------*/
@@ -666,7 +894,7 @@ struct prjprm {
 
   /* Private                                                                */
   /*------------------------------------------------------------------------*/
-  void   *padding;		/* (Dummy inserted for alignment purposes.) */
+  double *wtab;			/* Table of intermediate values.            */
   double w[10];			/* Intermediate values.                     */
   int    m, n;			/* Intermediate values.                     */
 
@@ -684,10 +912,17 @@ int prjfree(struct prjprm *prj);
 int prjprt(const struct prjprm *prj);
 int prjbchk(double tol, int nx, int ny, int spt, double phi[], double theta[],
            int stat[]);
+int prjsimd(int enable);
 
 int prjset(struct prjprm *prj);
 int prjx2s(PRJX2S_ARGS);
 int prjs2x(PRJS2X_ARGS);
+int prjx2sf(struct prjprm *prj, int nx, int ny, int sxy, int spt,
+            const float x[], const float y[], float phi[], float theta[],
+            int stat[]);
+int prjs2xf(struct prjprm *prj, int nphi, int ntheta, int spt, int sxy,
+            const float phi[], const float theta[], float x[], float y[],
+            int stat[]);
 
 int azpset(struct prjprm *prj);
 int azpx2s(PRJX2S_ARGS);
@@ -801,6 +1036,13 @@ int xphset(struct prjprm *prj);
 int xphx2s(PRJX2S_ARGS);
 int xphs2x(PRJS2X_ARGS);
 
+int hpxs2p(struct prjprm *prj, int nside, int nested, int nphi, int ntheta,
+           int spt, int spix, const double phi[], const double theta[],
+           long ipix[], int stat[]);
+int hpxp2s(struct prjprm *prj, int nside, int nested, int npix, int spix,
+           int spt, const long ipix[], double phi[], double theta[],
+           int stat[]);
+
 
 /* Deprecated. */
 #define prjini_errmsg prj_errmsg
@@ -26,13 +26,63 @@
 *===========================================================================*/
 
 #include <math.h>
+#include <stdlib.h>
 #include "wcstrig.h"
+#include "wcssimd.h"
+#include "wcsutil.h"
 #include "sph.h"
 
 #define copysign(X, Y) ((Y) < 0.0 ? -fabs(X) : fabs(X))
 
 #define tol 1.0e-5
 
+/* Reference points per task, and field points per tile, for sphdpam() and
+   sphcone(); a tile of field unit vectors occupies 48kiB. */
+#define SPH_NREF  16
+#define SPH_NTILE 2048
+
+/* Work shared by the tasks of sphdpam() and sphcone(). */
+struct sph_job {
+  int    nref, nfield;
+  const double *lng0, *lat0, *lng, *lat;
+  const double *fv;
+  const int *ic;
+  double chord2, chord;
+  int    *icen;
+  double *dist, *pa;
+};
+
+/* A centre for sphcone(), with the z-component of its unit vector. */
+struct sph_cen {
+  double z;
+  int    i;
+};
+
+static void sph_dpak(const double basis[9], int n, const double fx[],
+                     const double fy[], const double fz[], double dist[],
+                     double pa[]);
+static void sph_dpatask(void *job, int itask);
+static void sph_conetask(void *job, int itask);
+static int  sph_zcmp(const void *a, const void *b);
+
+#ifdef WCSSIMD
+/* Number of coordinates per block processed by the SIMD kernel. */
+#define SPH_NBLK (32*WCSSIMD_NLANE)
+
+/* Is the SIMD kernel enabled?  See sphsimd(). */
+static int sph_simd = 1;
+
+static void sph_rotv(const double eul[5], int fast, int s2x, int nlon,
+                     int nlat, int stin, int stout, const double lon[],
+                     const double lat[], double lonout[], double latout[]);
+static void sph_x2vv(const double rmat[9], int fast, int n, int spt,
+                     int svec, const double phi[], const double theta[],
+                     double vec[]);
+static void sph_v2xv(const double rmat[9], int fast, int n, int svec,
+                     int spt, const double vec[], double phi[],
+                     double theta[]);
+#endif
+
 /*--------------------------------------------------------------------------*/
 
 int sphx2s(
@@ -47,20 +97,32 @@ int sphx2s(
   double lat[])
 
 {
-  int mphi, mtheta, rowlen, rowoff;
+  int mphi, mtheta, rowlen, rowoff, sptrow;
   double cosphi, costhe, costhe3, costhe4, dlng, dphi, sinphi, sinthe,
          sinthe3, sinthe4, x, y, z;
   register int iphi, itheta;
   register const double *phip, *thetap;
   register double *latp, *lngp;
 
+#ifdef WCSSIMD
+  /* Use the SIMD kernel except for a simple change in the origin of
+     longitude, and for single points, as when the kernel defers to the
+     scalar code. */
+  if (sph_simd && eul[4] != 0.0 && (ntheta > 1 || nphi > 1)) {
+    sph_rotv(eul, 0, 0, nphi, ntheta, spt, sll, phi, theta, lng, lat);
+    return 0;
+  }
+#endif
+
   if (ntheta > 0) {
     mphi   = nphi;
     mtheta = ntheta;
+    sptrow = 0;
   } else {
     mphi   = 1;
     mtheta = 1;
     ntheta = nphi;
+    sptrow = spt;
   }
 
 
@@ -71,9 +133,9 @@ int sphx2s(
 
       lngp = lng;
       latp = lat;
-      phip   = phi;
-      thetap = theta;
       for (itheta = 0; itheta < ntheta; itheta++) {
+        phip   = phi + itheta*sptrow;
+        thetap = theta + itheta*spt;
         for (iphi = 0; iphi < mphi; iphi++) {
           *lngp = *phip + dlng;
           *latp = *thetap;
@@ -94,7 +156,6 @@ int sphx2s(
           lngp   += sll;
           latp   += sll;
           phip   += spt;
-          thetap += spt;
         }
       }
 
@@ -103,9 +164,9 @@ int sphx2s(
 
       lngp = lng;
       latp = lat;
-      phip   = phi;
-      thetap = theta;
       for (itheta = 0; itheta < ntheta; itheta++) {
+        phip   = phi + itheta*sptrow;
+        thetap = theta + itheta*spt;
         for (iphi = 0; iphi < mphi; iphi++) {
           *lngp = dlng - *phip;
           *latp = -(*thetap);
@@ -126,7 +187,6 @@ int sphx2s(
           lngp   += sll;
           latp   += sll;
           phip   += spt;
-          thetap += spt;
         }
       }
     }
@@ -134,7 +194,6 @@ int sphx2s(
     return 0;
   }
 
-
   /* Do phi dependency. */
   phip = phi;
   rowoff = 0;
@@ -232,20 +291,29 @@ int sphs2x(
   double theta[])
 
 {
-  int mlat, mlng, rowlen, rowoff;
+  int mlat, mlng, rowlen, rowoff, sllrow;
   double coslat, coslat3, coslat4, coslng, dlng, dphi, sinlat, sinlat3,
          sinlat4, sinlng, x, y, z;
   register int ilat, ilng;
   register const double *latp, *lngp;
   register double *phip, *thetap;
 
+#ifdef WCSSIMD
+  if (sph_simd && eul[4] != 0.0 && (nlat > 1 || nlng > 1)) {
+    sph_rotv(eul, 0, 1, nlng, nlat, sll, spt, lng, lat, phi, theta);
+    return 0;
+  }
+#endif
+
   if (nlat > 0) {
     mlng = nlng;
     mlat = nlat;
+    sllrow = 0;
   } else {
     mlng = 1;
     mlat = 1;
     nlat = nlng;
+    sllrow = sll;
   }
 
 
@@ -254,11 +322,11 @@ int sphs2x(
     if (eul[1] == 0.0) {
       dphi = fmod(eul[2] - 180.0 - eul[0], 360.0);
 
-      lngp = lng;
-      latp = lat;
       phip   = phi;
       thetap = theta;
       for (ilat = 0; ilat < nlat; ilat++) {
+        lngp = lng + ilat*sllrow;
+        latp = lat + ilat*sll;
         for (ilng = 0; ilng < mlng; ilng++) {
           *phip = fmod(*lngp + dphi, 360.0);
           *thetap = *latp;
@@ -273,18 +341,17 @@ int sphs2x(
           phip   += spt;
           thetap += spt;
           lngp   += sll;
-          latp   += sll;
         }
       }
 
     } else {
       dphi = fmod(eul[2] + eul[0], 360.0);
 
-      lngp = lng;
-      latp = lat;
       phip   = phi;
       thetap = theta;
       for (ilat = 0; ilat < nlat; ilat++) {
+        lngp = lng + ilat*sllrow;
+        latp = lat + ilat*sll;
         for (ilng = 0; ilng < mlng; ilng++) {
           *phip = fmod(dphi - *lngp, 360.0);
           *thetap = -(*latp);
@@ -299,7 +366,6 @@ int sphs2x(
           phip   += spt;
           thetap += spt;
           lngp   += sll;
-          latp   += sll;
         }
       }
     }
@@ -307,7 +373,6 @@ int sphs2x(
     return 0;
   }
 
-
   /* Do lng dependency. */
   lngp = lng;
   rowoff = 0;
@@ -458,3 +523,923 @@ int sphpad(
 
   return 0;
 }
+
+/*--------------------------------------------------------------------------*/
+
+int sphdpam(
+  int nref,
+  const double lng0[],
+  const double lat0[],
+  int nfield,
+  const double lng[],
+  const double lat[],
+  int nthread,
+  double dist[],
+  double pa[])
+
+{
+  int i;
+  double coslat, *fv;
+  struct sph_job job;
+
+  if (nref < 1 || nfield < 1) return 0;
+
+  /* Offsets into dist[] and pa[] are computed as size_t, which must be
+     able to address nref*nfield doubles. */
+  if ((size_t)nfield > ((size_t)-1)/sizeof(double)/3 ||
+      (size_t)nref   > ((size_t)-1)/sizeof(double)/nfield) {
+    return 2;
+  }
+
+  /* Unit vectors of the field points, stored by component. */
+  if (!(fv = malloc(3*(size_t)nfield*sizeof(double)))) {
+    return 1;
+  }
+
+  for (i = 0; i < nfield; i++) {
+    sincosd(lat[i], fv + 2*nfield + i, &coslat);
+    sincosd(lng[i], fv + nfield + i, fv + i);
+    fv[i] *= coslat;
+    fv[nfield + i] *= coslat;
+  }
+
+  job.nref   = nref;
+  job.nfield = nfield;
+  job.lng0   = lng0;
+  job.lat0   = lat0;
+  job.fv     = fv;
+  job.dist   = dist;
+  job.pa     = pa;
+
+  if (nthread < 1) nthread = wcsutil_ncpu();
+  wcsutil_pool(nthread, nref/SPH_NREF + (nref%SPH_NREF != 0), sph_dpatask,
+               &job);
+
+  free(fv);
+  return 0;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Compute the distances and position angles for a block of SPH_NREF
+   reference points, a tile of field points at a time. */
+
+void sph_dpatask(
+  void *arg,
+  int itask)
+
+{
+  int i, iref0, k, n, nfield, nref;
+  size_t offset;
+  double basis[SPH_NREF][9], coslat, coslng, sinlat, sinlng, *pa;
+  const double *fv;
+  struct sph_job *job = (struct sph_job *)arg;
+
+  nfield = job->nfield;
+  fv = job->fv;
+
+  iref0 = itask*SPH_NREF;
+  nref  = job->nref - iref0;
+  if (nref > SPH_NREF) nref = SPH_NREF;
+
+  /* The unit vector of each reference point, followed by those directed
+     east and north in its tangent plane. */
+  for (i = 0; i < nref; i++) {
+    sincosd(job->lat0[iref0+i], &sinlat, &coslat);
+    sincosd(job->lng0[iref0+i], &sinlng, &coslng);
+    basis[i][0] =  coslat*coslng;
+    basis[i][1] =  coslat*sinlng;
+    basis[i][2] =  sinlat;
+    basis[i][3] = -sinlng;
+    basis[i][4] =  coslng;
+    basis[i][5] =  0.0;
+    basis[i][6] = -sinlat*coslng;
+    basis[i][7] = -sinlat*sinlng;
+    basis[i][8] =  coslat;
+  }
+
+  for (k = 0; k < nfield; k += n) {
+    n = nfield - k;
+    if (n > SPH_NTILE) n = SPH_NTILE;
+
+    for (i = 0; i < nref; i++) {
+      /* Row-major offset, which may exceed the range of an int. */
+      offset = (size_t)(iref0 + i)*nfield + k;
+      pa = job->pa ? job->pa + offset : 0x0;
+      sph_dpak(basis[i], n, fv + k, fv + nfield + k,
+               fv + 2*(size_t)nfield + k, job->dist + offset, pa);
+    }
+  }
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Distance and position angle kernel.  The distance is obtained from the
+   magnitudes of the scalar and vector products of the unit vectors, which is
+   accurate at all separations, and the position angle from the components of
+   the field vector directed east and north at the reference point. */
+
+void sph_dpak(
+  const double basis[9],
+  int n,
+  const double fx[],
+  const double fy[],
+  const double fz[],
+  double dist[],
+  double pa[])
+
+{
+  int i;
+  double cx, cy, cz, d, e, u, v, w;
+
+  i = 0;
+
+#ifdef WCSSIMD
+  if (sph_simd) {
+    wcsvd b[9], vcx, vcy, vcz, vd, ve, vn, vu, vv, vw;
+
+    for (i = 0; i < 9; i++) {
+      b[i] = wcsv_set1(basis[i]);
+    }
+
+    for (i = 0; i + WCSSIMD_NLANE <= n; i += WCSSIMD_NLANE) {
+      vu = wcsv_load(fx+i);
+      vv = wcsv_load(fy+i);
+      vw = wcsv_load(fz+i);
+
+      vd  = wcsv_add(wcsv_add(wcsv_mul(b[0], vu), wcsv_mul(b[1], vv)),
+                     wcsv_mul(b[2], vw));
+      vcx = wcsv_sub(wcsv_mul(b[1], vw), wcsv_mul(b[2], vv));
+      vcy = wcsv_sub(wcsv_mul(b[2], vu), wcsv_mul(b[0], vw));
+      vcz = wcsv_sub(wcsv_mul(b[0], vv), wcsv_mul(b[1], vu));
+      vcx = wcsv_sqrt(wcsv_add(wcsv_add(wcsv_mul(vcx, vcx),
+                      wcsv_mul(vcy, vcy)), wcsv_mul(vcz, vcz)));
+      wcsv_store(dist+i, wcsv_atan2d(vcx, vd));
+
+      if (pa) {
+        ve = wcsv_add(wcsv_mul(b[3], vu), wcsv_mul(b[4], vv));
+        vn = wcsv_add(wcsv_add(wcsv_mul(b[6], vu), wcsv_mul(b[7], vv)),
+                      wcsv_mul(b[8], vw));
+        wcsv_store(pa+i, wcsv_atan2d(ve, vn));
+      }
+    }
+  }
+#endif
+
+  for (; i < n; i++) {
+    u = fx[i];
+    v = fy[i];
+    w = fz[i];
+
+    d  = basis[0]*u + basis[1]*v + basis[2]*w;
+    cx = basis[1]*w - basis[2]*v;
+    cy = basis[2]*u - basis[0]*w;
+    cz = basis[0]*v - basis[1]*u;
+    dist[i] = atan2d(sqrt(cx*cx + cy*cy + cz*cz), d);
+
+    if (pa) {
+      e = basis[3]*u + basis[4]*v;
+      d = basis[6]*u + basis[7]*v + basis[8]*w;
+      pa[i] = atan2d(e, d);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Centres are sorted by the z-component of their unit vectors. */
+
+int sph_zcmp(
+  const void *a,
+  const void *b)
+
+{
+  const struct sph_cen *ca = (const struct sph_cen *)a;
+  const struct sph_cen *cb = (const struct sph_cen *)b;
+
+  if (ca->z < cb->z) return -1;
+  if (ca->z > cb->z) return  1;
+  return ca->i - cb->i;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphcone(
+  int ncen,
+  const double lngc[],
+  const double latc[],
+  double radius,
+  int nfield,
+  const double lng[],
+  const double lat[],
+  int nthread,
+  int icen[],
+  double dist[])
+
+{
+  int i, *ic;
+  double coslat, *cv, s;
+  struct sph_cen *cen;
+  struct sph_job job;
+
+  if (nfield < 1) return 0;
+
+  if (ncen < 1 || radius < 0.0) {
+    for (i = 0; i < nfield; i++) {
+      icen[i] = -1;
+    }
+    return 0;
+  }
+
+  /* Unit vectors of the centres, sorted by z and stored by component. */
+  cv  = malloc(3*ncen*sizeof(double));
+  ic  = malloc(ncen*sizeof(int));
+  cen = malloc(ncen*sizeof(struct sph_cen));
+  if (!cv || !ic || !cen) {
+    free(cv);
+    free(ic);
+    free(cen);
+    return 1;
+  }
+
+  for (i = 0; i < ncen; i++) {
+    cen[i].z = sind(latc[i]);
+    cen[i].i = i;
+  }
+
+  qsort(cen, ncen, sizeof(struct sph_cen), sph_zcmp);
+
+  for (i = 0; i < ncen; i++) {
+    ic[i] = cen[i].i;
+    sincosd(lngc[ic[i]], cv + ncen + i, cv + i);
+    coslat = cosd(latc[ic[i]]);
+    cv[i] *= coslat;
+    cv[ncen + i] *= coslat;
+    cv[2*ncen + i] = cen[i].z;
+  }
+
+  free(cen);
+
+  /* A point lies within the radius of a centre iff the chord between them
+     is no longer than that subtended by the radius. */
+  if (radius >= 180.0) {
+    /* Allow for rounding error at the antipode. */
+    job.chord2 = 4.5;
+  } else {
+    s = 2.0*sind(radius/2.0);
+    job.chord2 = s*s;
+  }
+  job.chord = sqrt(job.chord2);
+
+  job.nref   = ncen;
+  job.nfield = nfield;
+  job.lng    = lng;
+  job.lat    = lat;
+  job.fv     = cv;
+  job.ic     = ic;
+  job.icen   = icen;
+  job.dist   = dist;
+
+  if (nthread < 1) nthread = wcsutil_ncpu();
+  wcsutil_pool(nthread, (nfield + SPH_NTILE - 1)/SPH_NTILE, sph_conetask,
+               &job);
+
+  free(cv);
+  free(ic);
+  return 0;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Match a tile of field points.  The chord length to a centre is at least
+   the difference in the z-components, so only the centres in a band of z
+   need be considered. */
+
+void sph_conetask(
+  void *arg,
+  int itask)
+
+{
+  int i, ibest, j, jbest, k, lo, hi, mid, n, ncen;
+  double best, coslat, d2, dx, dy, dz, u, v, w;
+  const double *cx, *cy, *cz;
+  struct sph_job *job = (struct sph_job *)arg;
+
+  ncen = job->nref;
+  cx = job->fv;
+  cy = cx + ncen;
+  cz = cy + ncen;
+
+  k = itask*SPH_NTILE;
+  n = job->nfield - k;
+  if (n > SPH_NTILE) n = SPH_NTILE;
+
+  for (i = k; i < k + n; i++) {
+    sincosd(job->lat[i], &w, &coslat);
+    sincosd(job->lng[i], &v, &u);
+    u *= coslat;
+    v *= coslat;
+
+    /* First centre with z >= w - chord. */
+    lo = 0;
+    hi = ncen;
+    while (lo < hi) {
+      mid = (lo + hi)/2;
+      if (cz[mid] < w - job->chord) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+
+    /* Nearest centre within the radius, the lowest index if tied. */
+    best  = job->chord2;
+    ibest = -1;
+    jbest = -1;
+    for (j = lo; j < ncen && cz[j] <= w + job->chord; j++) {
+      dx = u - cx[j];
+      dy = v - cy[j];
+      dz = w - cz[j];
+      d2 = dx*dx + dy*dy + dz*dz;
+
+      if (d2 < best || (d2 == best && (ibest < 0 || job->ic[j] < ibest))) {
+        best  = d2;
+        ibest = job->ic[j];
+        jbest = j;
+      }
+    }
+
+    job->icen[i] = ibest;
+    if (job->dist && jbest >= 0) {
+      /* Angle subtended by the chord. */
+      d2 = sqrt(best)/2.0;
+      job->dist[i] = (d2 < 1.0) ? 2.0*asind(d2) : 180.0;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphmat(
+  const double eul[5],
+  double rmat[9])
+
+{
+  double cos0, cos2, sin0, sin2;
+
+  sincosd(eul[0], &sin0, &cos0);
+  sincosd(eul[2], &sin2, &cos2);
+
+  /* Rotate by -eul[2] about the native pole, then by eul[1] about the
+     new y-axis with the sense of the axes reversed as for sphx2s(), then by
+     eul[0] about the celestial pole. */
+  rmat[0] = -cos0*eul[3]*cos2 - sin0*sin2;
+  rmat[1] = -cos0*eul[3]*sin2 + sin0*cos2;
+  rmat[2] =  cos0*eul[4];
+  rmat[3] = -sin0*eul[3]*cos2 + cos0*sin2;
+  rmat[4] = -sin0*eul[3]*sin2 - cos0*cos2;
+  rmat[5] =  sin0*eul[4];
+  rmat[6] =  eul[4]*cos2;
+  rmat[7] =  eul[4]*sin2;
+  rmat[8] =  eul[3];
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphrot(
+  const double rmat[9],
+  int inverse,
+  int nvec,
+  int svec,
+  const double vin[],
+  double vout[])
+
+{
+  int i;
+  double u, v, w;
+  register const double *vinp;
+  register double *voutp;
+
+  vinp  = vin;
+  voutp = vout;
+  if (inverse) {
+    for (i = 0; i < nvec; i++, vinp += svec, voutp += svec) {
+      u = vinp[0];
+      v = vinp[1];
+      w = vinp[2];
+      voutp[0] = rmat[0]*u + rmat[3]*v + rmat[6]*w;
+      voutp[1] = rmat[1]*u + rmat[4]*v + rmat[7]*w;
+      voutp[2] = rmat[2]*u + rmat[5]*v + rmat[8]*w;
+    }
+
+  } else {
+    for (i = 0; i < nvec; i++, vinp += svec, voutp += svec) {
+      u = vinp[0];
+      v = vinp[1];
+      w = vinp[2];
+      voutp[0] = rmat[0]*u + rmat[1]*v + rmat[2]*w;
+      voutp[1] = rmat[3]*u + rmat[4]*v + rmat[5]*w;
+      voutp[2] = rmat[6]*u + rmat[7]*v + rmat[8]*w;
+    }
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphx2v(
+  const double rmat[9],
+  int nvec,
+  int spt,
+  int svec,
+  const double phi[],
+  const double theta[],
+  double vec[])
+
+{
+  int i;
+  double cosphi, costhe, sinphi, sinthe, u, v, w;
+  register const double *phip, *thetap;
+  register double *vecp;
+
+#ifdef WCSSIMD
+  if (sph_simd && nvec > 1) {
+    sph_x2vv(rmat, 0, nvec, spt, svec, phi, theta, vec);
+    return 0;
+  }
+#endif
+
+  phip   = phi;
+  thetap = theta;
+  vecp   = vec;
+  for (i = 0; i < nvec; i++, phip += spt, thetap += spt, vecp += svec) {
+    sincosd(*thetap, &sinthe, &costhe);
+    sincosd(*phip, &sinphi, &cosphi);
+
+    /* Native direction cosines rotated into the celestial system. */
+    u = costhe*cosphi;
+    v = costhe*sinphi;
+    w = sinthe;
+    vecp[0] = rmat[0]*u + rmat[1]*v + rmat[2]*w;
+    vecp[1] = rmat[3]*u + rmat[4]*v + rmat[5]*w;
+    vecp[2] = rmat[6]*u + rmat[7]*v + rmat[8]*w;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphv2x(
+  const double rmat[9],
+  int nvec,
+  int svec,
+  int spt,
+  const double vec[],
+  double phi[],
+  double theta[])
+
+{
+  int i;
+  double u, v, w, x, y, z;
+  register const double *vecp;
+  register double *phip, *thetap;
+
+#ifdef WCSSIMD
+  if (sph_simd && nvec > 1) {
+    sph_v2xv(rmat, 0, nvec, svec, spt, vec, phi, theta);
+    return 0;
+  }
+#endif
+
+  vecp   = vec;
+  phip   = phi;
+  thetap = theta;
+  for (i = 0; i < nvec; i++, vecp += svec, phip += spt, thetap += spt) {
+    u = vecp[0];
+    v = vecp[1];
+    w = vecp[2];
+
+    /* Celestial direction cosines rotated into the native system. */
+    x = rmat[0]*u + rmat[3]*v + rmat[6]*w;
+    y = rmat[1]*u + rmat[4]*v + rmat[7]*w;
+    z = rmat[2]*u + rmat[5]*v + rmat[8]*w;
+
+    /* The vector need not be normalized. */
+    *phip   = atan2d(y, x);
+    *thetap = atan2d(z, sqrt(x*x + y*y));
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphfx2s(
+  int fast,
+  const double eul[5],
+  int nphi,
+  int ntheta,
+  int spt,
+  int sll,
+  const double phi[],
+  const double theta[],
+  double lng[],
+  double lat[])
+
+{
+#ifdef WCSSIMD
+  if (fast && sph_simd && eul[4] != 0.0 && (ntheta > 1 || nphi > 1)) {
+    sph_rotv(eul, 1, 0, nphi, ntheta, spt, sll, phi, theta, lng, lat);
+    return 0;
+  }
+#endif
+
+  return sphx2s(eul, nphi, ntheta, spt, sll, phi, theta, lng, lat);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphfs2x(
+  int fast,
+  const double eul[5],
+  int nlng,
+  int nlat,
+  int sll,
+  int spt,
+  const double lng[],
+  const double lat[],
+  double phi[],
+  double theta[])
+
+{
+#ifdef WCSSIMD
+  if (fast && sph_simd && eul[4] != 0.0 && (nlat > 1 || nlng > 1)) {
+    sph_rotv(eul, 1, 1, nlng, nlat, sll, spt, lng, lat, phi, theta);
+    return 0;
+  }
+#endif
+
+  return sphs2x(eul, nlng, nlat, sll, spt, lng, lat, phi, theta);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphfx2v(
+  int fast,
+  const double rmat[9],
+  int nvec,
+  int spt,
+  int svec,
+  const double phi[],
+  const double theta[],
+  double vec[])
+
+{
+#ifdef WCSSIMD
+  if (fast && sph_simd && nvec > 1) {
+    sph_x2vv(rmat, 1, nvec, spt, svec, phi, theta, vec);
+    return 0;
+  }
+#endif
+
+  return sphx2v(rmat, nvec, spt, svec, phi, theta, vec);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphfv2x(
+  int fast,
+  const double rmat[9],
+  int nvec,
+  int svec,
+  int spt,
+  const double vec[],
+  double phi[],
+  double theta[])
+
+{
+#ifdef WCSSIMD
+  if (fast && sph_simd && nvec > 1) {
+    sph_v2xv(rmat, 1, nvec, svec, spt, vec, phi, theta);
+    return 0;
+  }
+#endif
+
+  return sphv2x(rmat, nvec, svec, spt, vec, phi, theta);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int sphsimd(
+  int enable)
+
+{
+#ifdef WCSSIMD
+  int previous = sph_simd;
+
+  if (enable >= 0) sph_simd = (enable != 0);
+  return previous;
+#else
+  return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+
+#ifdef WCSSIMD
+
+/* SIMD kernel for sphx2s() (s2x == 0) and sphs2x() (s2x != 0), which share
+   the same formulae with the roles of (phi,theta) and (lng,lat), and eul[0]
+   and eul[2], interchanged.  The direction cosines of each point, rotated by
+   eul[1] about the y-axis, are computed for a vector of points at a time.
+   Points for which the scalar code takes a special branch, i.e. where the
+   longitude offset is a multiple of 180 deg or the x-component is small, are
+   passed back to the scalar code one at a time. */
+
+void sph_rotv(
+  const double eul[5],
+  int fast,
+  int s2x,
+  int nlon,
+  int nlat,
+  int stin,
+  int stout,
+  const double lon[],
+  const double lat[],
+  double lonout[],
+  double latout[])
+
+{
+  int fix, grid, i, ilon, j, k, mlon, n, ntot, nv;
+  int fb[SPH_NBLK];
+  double ab[SPH_NBLK], bb[SPH_NBLK], lb[SPH_NBLK], mb[SPH_NBLK];
+  register const double *lonp, *latp;
+  register double *lonop, *latop;
+  wcsvd a, b, ca, cb, d, e0, e2, e3, e4, lo, la, sa, sb, x, y, z, alt;
+  wcsvm m, p;
+
+  grid = (nlat > 0);
+  if (grid) {
+    mlon = nlon;
+  } else {
+    mlon = 1;
+    nlat = nlon;
+  }
+
+  ntot = mlon*nlat;
+
+  /* Offset applied to the input longitude and that applied to the output. */
+  e0 = wcsv_set1(s2x ? eul[0] : eul[2]);
+  e2 = wcsv_set1(s2x ? eul[2] : eul[0]);
+  e3 = wcsv_set1(eul[3]);
+  e4 = wcsv_set1(eul[4]);
+
+  lonp = lon;
+  latp = lat;
+  ilon = 0;
+  lonop = lonout;
+  latop = latout;
+  for (k = 0; k < ntot; k += n) {
+    n = ntot - k;
+    if (n > SPH_NBLK) n = SPH_NBLK;
+
+    /* Gather a block of (lon,lat), padded to a whole number of vectors. */
+    for (i = 0; i < n; i++) {
+      ab[i] = *lonp;
+      bb[i] = *latp;
+
+      lonp += stin;
+      if (++ilon == mlon) {
+        ilon = 0;
+        latp += stin;
+        if (grid) lonp = lon;
+      }
+    }
+
+    nv = ((n + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      ab[i] = ab[0];
+      bb[i] = bb[0];
+    }
+
+    for (i = 0; i < nv; i += WCSSIMD_NLANE) {
+      a = wcsv_sub(wcsv_load(ab+i), e0);
+      b = wcsv_load(bb+i);
+
+      wcsv_fsincosd(fast, b, &sb, &cb);
+      wcsv_fsincosd(fast, a, &sa, &ca);
+
+      x = wcsv_sub(wcsv_mul(sb, e4), wcsv_mul(wcsv_mul(cb, e3), ca));
+      y = wcsv_neg(wcsv_mul(cb, sa));
+      z = wcsv_add(wcsv_mul(sb, e3), wcsv_mul(wcsv_mul(cb, e4), ca));
+
+      /* Special cases, including offsets too large for the test for a
+         multiple of 180 deg. */
+      m = wcsv_mor(wcsv_cmplt(wcsv_abs(x), wcsv_set1(tol)),
+                   wcsv_cmpge(wcsv_abs(a), wcsv_set1(WCSSIMD_TRIGMAX)));
+      m = wcsv_mor(m, wcsv_cmpeq(a, wcsv_mul(wcsv_set1(180.0),
+            wcsv_rint(wcsv_mul(a, wcsv_set1(1.0/180.0))))));
+
+      /* Longitude. */
+      d = wcsv_fatan2d(fast, y, x);
+      lo = wcsv_add(e2, d);
+      if (s2x) {
+        /* fmod(eul[2] + dphi, 360) is an identity unless |lo| >= 360. */
+        m = wcsv_mor(m, wcsv_cmpge(wcsv_abs(lo), wcsv_set1(360.0)));
+        lo = wcsv_sel(wcsv_cmpgt(lo, wcsv_set1(180.0)),
+                      wcsv_sub(lo, wcsv_set1(360.0)), lo);
+        lo = wcsv_sel(wcsv_cmplt(lo, wcsv_set1(-180.0)),
+                      wcsv_add(lo, wcsv_set1(360.0)), lo);
+      } else {
+        if (eul[0] >= 0.0) {
+          lo = wcsv_sel(wcsv_cmplt(lo, wcsv_set1(0.0)),
+                        wcsv_add(lo, wcsv_set1(360.0)), lo);
+        } else {
+          lo = wcsv_sel(wcsv_cmpgt(lo, wcsv_set1(0.0)),
+                        wcsv_sub(lo, wcsv_set1(360.0)), lo);
+        }
+
+        lo = wcsv_sel(wcsv_cmpgt(lo, wcsv_set1(360.0)),
+                      wcsv_sub(lo, wcsv_set1(360.0)), lo);
+        lo = wcsv_sel(wcsv_cmplt(lo, wcsv_set1(-360.0)),
+                      wcsv_add(lo, wcsv_set1(360.0)), lo);
+      }
+
+      /* Latitude, near the poles from the alternative formula. */
+      la = wcsv_fasind(fast, z);
+      p  = wcsv_cmpgt(wcsv_abs(z), wcsv_set1(0.99));
+      if (wcsv_mbits(p)) {
+        alt = wcsv_facosd(fast,
+                wcsv_sqrt(wcsv_add(wcsv_mul(x, x), wcsv_mul(y, y))));
+        alt = wcsv_sel(wcsv_cmplt(z, wcsv_set1(0.0)), wcsv_neg(alt), alt);
+        la  = wcsv_sel(p, alt, la);
+      }
+
+      wcsv_store(lb+i, lo);
+      wcsv_store(mb+i, la);
+
+      fix = wcsv_mbits(m);
+      for (j = 0; j < WCSSIMD_NLANE; j++) {
+        fb[i+j] = (fix >> j) & 1;
+      }
+    }
+
+    /* Scatter the results, deferring special cases to the scalar code. */
+    for (i = 0; i < n; i++, lonop += stout, latop += stout) {
+      if (fb[i]) {
+        if (s2x) {
+          sphs2x(eul, 1, 0, 1, 1, ab+i, bb+i, lonop, latop);
+        } else {
+          sphx2s(eul, 1, 0, 1, 1, ab+i, bb+i, lonop, latop);
+        }
+      } else {
+        *lonop = lb[i];
+        *latop = mb[i];
+      }
+    }
+  }
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* SIMD kernel for sphx2v(). */
+
+void sph_x2vv(
+  const double rmat[9],
+  int fast,
+  int n,
+  int spt,
+  int svec,
+  const double phi[],
+  const double theta[],
+  double vec[])
+
+{
+  int i, k, nb, nv;
+  double ab[SPH_NBLK], bb[SPH_NBLK], ub[SPH_NBLK], vb[SPH_NBLK],
+         wb[SPH_NBLK];
+  register const double *phip, *thetap;
+  register double *vecp;
+  wcsvd ca, cb, r[9], sa, sb, u, v, w;
+
+  for (i = 0; i < 9; i++) {
+    r[i] = wcsv_set1(rmat[i]);
+  }
+
+  phip   = phi;
+  thetap = theta;
+  vecp   = vec;
+  for (k = 0; k < n; k += nb) {
+    nb = n - k;
+    if (nb > SPH_NBLK) nb = SPH_NBLK;
+
+    for (i = 0; i < nb; i++, phip += spt, thetap += spt) {
+      ab[i] = *phip;
+      bb[i] = *thetap;
+    }
+
+    nv = ((nb + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      ab[i] = ab[0];
+      bb[i] = bb[0];
+    }
+
+    for (i = 0; i < nv; i += WCSSIMD_NLANE) {
+      wcsv_fsincosd(fast, wcsv_load(bb+i), &sb, &cb);
+      wcsv_fsincosd(fast, wcsv_load(ab+i), &sa, &ca);
+
+      u = wcsv_mul(cb, ca);
+      v = wcsv_mul(cb, sa);
+      w = sb;
+
+      wcsv_store(ub+i, wcsv_add(wcsv_add(wcsv_mul(r[0], u), wcsv_mul(r[1], v)),
+                                wcsv_mul(r[2], w)));
+      wcsv_store(vb+i, wcsv_add(wcsv_add(wcsv_mul(r[3], u), wcsv_mul(r[4], v)),
+                                wcsv_mul(r[5], w)));
+      wcsv_store(wb+i, wcsv_add(wcsv_add(wcsv_mul(r[6], u), wcsv_mul(r[7], v)),
+                                wcsv_mul(r[8], w)));
+    }
+
+    for (i = 0; i < nb; i++, vecp += svec) {
+      vecp[0] = ub[i];
+      vecp[1] = vb[i];
+      vecp[2] = wb[i];
+    }
+  }
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* SIMD kernel for sphv2x(). */
+
+void sph_v2xv(
+  const double rmat[9],
+  int fast,
+  int n,
+  int svec,
+  int spt,
+  const double vec[],
+  double phi[],
+  double theta[])
+
+{
+  int i, k, nb, nv;
+  double ab[SPH_NBLK], bb[SPH_NBLK], ub[SPH_NBLK], vb[SPH_NBLK],
+         wb[SPH_NBLK];
+  register const double *vecp;
+  register double *phip, *thetap;
+  wcsvd r[9], u, v, w, x, y, z;
+
+  for (i = 0; i < 9; i++) {
+    r[i] = wcsv_set1(rmat[i]);
+  }
+
+  vecp   = vec;
+  phip   = phi;
+  thetap = theta;
+  for (k = 0; k < n; k += nb) {
+    nb = n - k;
+    if (nb > SPH_NBLK) nb = SPH_NBLK;
+
+    for (i = 0; i < nb; i++, vecp += svec) {
+      ub[i] = vecp[0];
+      vb[i] = vecp[1];
+      wb[i] = vecp[2];
+    }
+
+    nv = ((nb + WCSSIMD_NLANE - 1)/WCSSIMD_NLANE)*WCSSIMD_NLANE;
+    for (; i < nv; i++) {
+      ub[i] = ub[0];
+      vb[i] = vb[0];
+      wb[i] = wb[0];
+    }
+
+    for (i = 0; i < nv; i += WCSSIMD_NLANE) {
+      u = wcsv_load(ub+i);
+      v = wcsv_load(vb+i);
+      w = wcsv_load(wb+i);
+
+      x = wcsv_add(wcsv_add(wcsv_mul(r[0], u), wcsv_mul(r[3], v)),
+                   wcsv_mul(r[6], w));
+      y = wcsv_add(wcsv_add(wcsv_mul(r[1], u), wcsv_mul(r[4], v)),
+                   wcsv_mul(r[7], w));
+      z = wcsv_add(wcsv_add(wcsv_mul(r[2], u), wcsv_mul(r[5], v)),
+                   wcsv_mul(r[8], w));
+
+      wcsv_store(ab+i, wcsv_fatan2d(fast, y, x));
+      wcsv_store(bb+i, wcsv_fatan2d(fast, z,
+        wcsv_sqrt(wcsv_add(wcsv_mul(x, x), wcsv_mul(y, y)))));
+    }
+
+    for (i = 0; i < nb; i++, phip += spt, thetap += spt) {
+      *phip   = ab[i];
+      *thetap = bb[i];
+    }
+  }
+}
+
+#endif
@@ -44,12 +44,37 @@
 * The WCS spherical coordinate transformations are implemented via separate
 * functions, sphx2s() and sphs2x(), for the transformation in each direction.
 *
+* sphmat() computes the equivalent rotation matrix, and sphrot() applies it,
+* or its inverse, to Cartesian unit vectors (direction cosines), for which no
+* trigonometric functions need be evaluated.  sphx2v() and sphv2x() combine
+* the rotation with the conversion between native spherical coordinates and
+* celestial unit vectors, for applications that work with the latter.
+*
+* When WCSLIB is compiled for an x86-64 processor, sphx2s() and sphs2x() use
+* SIMD vector instructions, as described for the projection routines in
+* prj.h, to evaluate the rotation for several coordinates at a time.  Points
+* for which the scalar code uses special formulae, namely those whose
+* longitude offset is a multiple of 180 deg or for which the rotated x-
+* component is small, are computed by the scalar code, as are single points
+* and simple changes in the origin of longitude.  The results agree
+* with those of the scalar code to within a few ulp of the trigonometric
+* functions.  sphx2v() and sphv2x() are vectorized likewise.  sphsimd()
+* enables or disables the SIMD kernels.  sphfx2s(), sphfs2x(), sphfx2v(), and
+* sphfv2x() take an additional argument that selects faster, reduced-accuracy
+* trigonometric functions within the kernels.
+*
 * A utility function, sphdpa(), computes the angular distances and position
 * angles from a given point on the sky to a number of other points.  sphpad()
 * does the complementary operation - computes the coordinates of points offset
 * by the given angular distances and position angles from a given point on the
 * sky.
 *
+* sphdpam() computes the angular distances and position angles between each
+* of a number of reference points and each of a number of field points, and
+* sphcone() finds the field points that lie within a given radius of any of a
+* number of centres.  Both work with Cartesian unit vectors and divide the
+* work between threads, see wcsp2st() in wcs.h.
+*
 *
 * sphx2s() - Rotation in the pixel-to-world direction
 * ---------------------------------------------------
@@ -117,6 +142,159 @@
 *                         0: Success.
 *
 *
+* sphmat() - Rotation matrix for the spherical coordinate transformation
+* -----------------------------------------------------------------------
+* sphmat() computes the matrix that rotates the Cartesian unit vector of a
+* point in the native coordinate system of a projection,
+*
+=     (cos(theta)*cos(phi), cos(theta)*sin(phi), sin(theta)),
+*
+* to that of the same point in celestial coordinates, i.e. the matrix
+* equivalent of sphx2s().  Its transpose is the equivalent of sphs2x().
+*
+* Given:
+*   eul       const double[5]
+*                       Euler angles for the transformation, as for
+*                       sphx2s().
+*
+* Returned:
+*   rmat      double[9] Rotation matrix, stored by rows.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*
+*
+* sphrot() - Rotate Cartesian unit vectors
+* ----------------------------------------
+* sphrot() applies the rotation matrix computed by sphmat(), or its inverse,
+* to a vector of Cartesian unit vectors (direction cosines).
+*
+* Given:
+*   rmat      const double[9]
+*                       Rotation matrix, as computed by sphmat().
+*
+*   inverse   int       If zero, rotate native to celestial unit vectors, as
+*                       for sphx2s(), else celestial to native, as for
+*                       sphs2x().
+*
+*   nvec      int       Number of unit vectors.
+*
+*   svec      int       Vector stride, the three components of each unit
+*                       vector being stored contiguously.
+*
+*   vin       const double[]
+*                       Unit vectors to be rotated.
+*
+* Returned:
+*   vout      double[]  Rotated unit vectors.  These may refer to the same
+*                       storage as vin.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*
+*
+* sphx2v() - Native spherical coordinates to celestial unit vectors
+* -----------------------------------------------------------------
+* sphx2v() transforms native coordinates of a projection to celestial
+* Cartesian unit vectors, thereby avoiding the inverse trigonometric functions
+* that sphx2s() evaluates to obtain celestial longitude and latitude.
+*
+* Given:
+*   rmat      const double[9]
+*                       Rotation matrix, as computed by sphmat().
+*
+*   nvec      int       Number of coordinates.
+*
+*   spt       int       Stride of the phi and theta vectors.
+*
+*   svec      int       Stride of the unit vectors, the three components of
+*                       each being stored contiguously.
+*
+*   phi,theta const double[]
+*                       Longitude and latitude in the native coordinate
+*                       system of the projection [deg].
+*
+* Returned:
+*   vec       double[]  Celestial unit vectors.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*
+*
+* sphv2x() - Celestial unit vectors to native spherical coordinates
+* -----------------------------------------------------------------
+* sphv2x() transforms celestial Cartesian unit vectors to native coordinates
+* of a projection, thereby avoiding the trigonometric functions that sphs2x()
+* evaluates for the celestial longitude and latitude.
+*
+* Given:
+*   rmat      const double[9]
+*                       Rotation matrix, as computed by sphmat().
+*
+*   nvec      int       Number of coordinates.
+*
+*   svec      int       Stride of the unit vectors, the three components of
+*                       each being stored contiguously.
+*
+*   spt       int       Stride of the phi and theta vectors.
+*
+*   vec       const double[]
+*                       Celestial unit vectors.  These need not be
+*                       normalized.
+*
+* Returned:
+*   phi,theta double[]  Longitude and latitude in the native coordinate
+*                       system of the projection [deg], with phi in the range
+*                       [-180,180].  phi is zero at the native poles.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*
+*
+* sphfx2s(), sphfs2x(), sphfx2v(), sphfv2x() - Selectable accuracy
+* ----------------------------------------------------------------
+* These are the same as sphx2s(), sphs2x(), sphx2v(), and sphv2x(), with
+* the same arguments preceded by
+*
+* Given:
+*   fast      int       If non-zero, the SIMD kernels evaluate the
+*                       trigonometric functions with the reduced-accuracy
+*                       approximations in wcssimd.h, for which the maximum
+*                       error is WCSSIMD_FASTERR (1E-10 in the sine and cosine,
+*                       1E-10 radian in the inverse functions).  The rotated
+*                       coordinates are then typically accurate to 1E-8 deg.
+*                       Points passed back to the scalar code, and all points
+*                       if the SIMD kernels are disabled or not compiled, are
+*                       computed to full accuracy.  If zero, the result is
+*                       identical to that of the corresponding function.
+*
+* They are used by celx2s(), cels2x(), celx2v(), and celv2x() when
+* celprm::fast is set.
+*
+*
+* sphsimd() - Enable or disable the SIMD kernels
+* ----------------------------------------------
+* sphsimd() enables or disables the SIMD kernels, described above, for all
+* subsequent calls to sphx2s(), sphs2x(), sphx2v(), sphv2x(), and the
+* corresponding selectable-accuracy functions.  They are
+* enabled by default.  This is a global setting; it is intended mainly for
+* testing and should not be changed while other threads are using these
+* routines.
+*
+* Given:
+*   enable    int       If zero, disable the SIMD kernels; if positive,
+*                       enable them; if negative, leave the setting unchanged.
+*
+* Function return value:
+*             int       The previous setting: 1 if the SIMD kernels were
+*                       enabled, else 0.  Always 0 if WCSLIB was compiled
+*                       without support for them.
+*
+*
 * sphdpa() - Compute angular distance and position angle
 * ------------------------------------------------------
 * sphdpa() computes the angular distance and generalized position angle (see
@@ -217,6 +395,101 @@
 *   Applying sphpad() with the distances and position angles computed by
 *   sphdpa() should return the original field points.
 *
+*
+* sphdpam() - Angular distances and position angles for many reference points
+* ----------------------------------------------------------------------------
+* sphdpam() computes the angular distance and generalized position angle from
+* each of nref reference points to each of nfield field points, as sphdpa()
+* does for a single reference point.
+*
+* The distance is computed from the scalar and vector products of the unit
+* vectors of the two points, and the position angle from the components of
+* the unit vector of the field point directed east and north at the reference
+* point.  The results agree with those of sphdpa() to within rounding error,
+* including for reference points at the poles, except that the position angle
+* returned for coincident or antipodal points is 0 or 180.  The field points
+* are processed in tiles, which are computed with SIMD vector instructions if
+* available, see sphsimd().  Blocks of reference points are distributed
+* between threads.
+*
+* Given:
+*   nref      int       The number of reference points.
+*
+*   lng0,lat0 const double[nref]
+*                       Spherical coordinates of the reference points [deg].
+*
+*   nfield    int       The number of field points.
+*
+*   lng,lat   const double[nfield]
+*                       Spherical coordinates of the field points [deg].
+*
+*   nthread   int       Maximum number of threads to use, including the
+*                       calling thread.  If less than 1, the number of
+*                       processors online is used.
+*
+* Returned:
+*   dist      double[nref][nfield]
+*                       Angular distances [deg].  The arrays are indexed
+*                       with size_t, so nref*nfield may exceed the range of
+*                       an int.
+*
+*   pa        double[nref][nfield]
+*                       Position angles [deg], in the range (-180,180].  May
+*                       be given as a null pointer if not required.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Memory allocation failed.
+*                         2: nref*nfield doubles, or 3*nfield, exceed the
+*                            range of size_t.
+*
+*
+* sphcone() - Find field points within a radius of any of a set of centres
+* -------------------------------------------------------------------------
+* sphcone() finds, for each of a number of field points, the nearest of a set
+* of centres that lies within the given angular radius of it, if any.
+*
+* The test is made on the length of the chord between the unit vectors of
+* the two points, which requires no trigonometric functions and is accurate
+* for small radii.  Since this is at least the difference in the z-components
+* of the unit vectors (i.e. in the sines of the latitudes), the centres are
+* sorted by z and only those in the corresponding band need be tested for
+* each field point.  Tiles of field points are distributed between threads.
+*
+* Given:
+*   ncen      int       The number of centres.
+*
+*   lngc,latc const double[ncen]
+*                       Spherical coordinates of the centres [deg].
+*
+*   radius    double    Angular radius [deg].
+*
+*   nfield    int       The number of field points.
+*
+*   lng,lat   const double[nfield]
+*                       Spherical coordinates of the field points [deg].
+*
+*   nthread   int       Maximum number of threads to use, as for sphdpam().
+*
+* Returned:
+*   icen      int[nfield]
+*                       Index of the nearest centre within the radius of each
+*                       field point, the lowest if more than one are at the
+*                       same distance, or -1 if there is none.  A point at
+*                       a distance equal to the radius, within rounding
+*                       error, may or may not be included.
+*
+*   dist      double[nfield]
+*                       Angular distance to that centre [deg], or unchanged
+*                       if there is none.  May be given as a null pointer if
+*                       not required.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Memory allocation failed.
+*
 *===========================================================================*/
 
 #ifndef WCSLIB_SPH
@@ -235,6 +508,33 @@ int sphs2x(const double eul[5], int nlng, int nlat, int sll , int spt,
            const double lng[], const double lat[],
            double phi[], double theta[]);
 
+int sphmat(const double eul[5], double rmat[9]);
+
+int sphrot(const double rmat[9], int inverse, int nvec, int svec,
+           const double vin[], double vout[]);
+
+int sphx2v(const double rmat[9], int nvec, int spt, int svec,
+           const double phi[], const double theta[], double vec[]);
+
+int sphv2x(const double rmat[9], int nvec, int svec, int spt,
+           const double vec[], double phi[], double theta[]);
+
+int sphfx2s(int fast, const double eul[5], int nphi, int ntheta, int spt,
+            int sxy, const double phi[], const double theta[],
+            double lng[], double lat[]);
+
+int sphfs2x(int fast, const double eul[5], int nlng, int nlat, int sll,
+            int spt, const double lng[], const double lat[],
+            double phi[], double theta[]);
+
+int sphfx2v(int fast, const double rmat[9], int nvec, int spt, int svec,
+            const double phi[], const double theta[], double vec[]);
+
+int sphfv2x(int fast, const double rmat[9], int nvec, int svec, int spt,
+            const double vec[], double phi[], double theta[]);
+
+int sphsimd(int enable);
+
 int sphdpa(int nfield, double lng0, double lat0,
            const double lng[], const double lat[],
            double dist[], double pa[]);
@@ -243,6 +543,14 @@ int sphpad(int nfield, double lng0, double lat0,
            const double dist[], const double pa[],
            double lng[], double lat[]);
 
+int sphdpam(int nref, const double lng0[], const double lat0[], int nfield,
+            const double lng[], const double lat[], int nthread,
+            double dist[], double pa[]);
+
+int sphcone(int ncen, const double lngc[], const double latc[],
+            double radius, int nfield, const double lng[], const double lat[],
+            int nthread, int icen[], double dist[]);
+
 
 #ifdef __cplusplus
 }
@@ -25,16 +25,29 @@
   $Id: tab.c,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
 *===========================================================================*/
 
+#include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "wcsconfig.h"
 #include "wcserr.h"
 #include "wcsmath.h"
 #include "wcsprintf.h"
 #include "tab.h"
 
+#if !defined(__GNUC__) && defined(HAVE_PTHREAD)
+#include <pthread.h>
+#endif
+
+/* tabshr() shares arrays only if their reference count can be updated
+   atomically, otherwise it copies them. */
+#if defined(__GNUC__) || defined(HAVE_PTHREAD)
+#define TAB_SHARE
+#endif
+
 const int TABSET = 137;
 
 /* Map status return value to message. */
@@ -49,6 +62,30 @@ const char *tab_errmsg[] = {
 /* Convenience macro for invoking wcserr_set(). */
 #define TAB_ERRMSG(status) WCSERR_SET(status), tab_errmsg[status]
 
+/* Maximum M for which the coordinate array may be extrapolated. */
+#define TAB_XMAX 8
+
+static int tab_cell(const double Psi[], int K, int sense, double psi_m,
+                    int hint);
+static int tab_grid(struct tabprm *tab);
+static int tab_vbox(const struct tabprm *tab, int ic, int *p0,
+                    double **tabcoord, double *lo, double *hi, double *xcrd,
+                    double *vmin, double *vmax);
+static int tab_bucket(const struct tabprm *tab, const double *wp,
+                      const int **vlist);
+static int tab_p0(const struct tabprm *tab, int ic, int *p0);
+static void tab_vcrd(const struct tabprm *tab, const int *p0,
+                     double **tabcoord);
+static int tab_xvox(const struct tabprm *tab, const int *p0,
+                    double *const *tabcoord, double *lo, double *hi,
+                    double *xcrd);
+static int tab_xtrap(const struct tabprm *tab, const double *wp,
+                     const int *vlist, int nvl, int *p0, double *delta,
+                     double **tabcoord);
+static void tab_lerp(const struct tabprm *tab, const int *p0,
+                     const double *delta, double *wp);
+static int tab_refs(int *refs, int incr);
+
 /*--------------------------------------------------------------------------*/
 
 int tabini(int alloc, int M, const int K[], struct tabprm *tab)
@@ -106,6 +143,7 @@ int tabini(int alloc, int M, const int K[], struct tabprm *tab)
     tab->m_index = 0x0;
     tab->m_indxs = 0x0;
     tab->m_coord = 0x0;
+    tab->m_refs  = 0x0;
 
   } else {
     /* Clear any outstanding signals set by wcstab(). */
@@ -114,6 +152,11 @@ int tabini(int alloc, int M, const int K[], struct tabprm *tab)
     }
 
     if (tab->m_coord == (double *)0x1) tab->m_coord = 0x0;
+
+    /* Arrays shared with a copy must not be overwritten. */
+    if (tab->m_refs && tab_refs(tab->m_refs, 0) > 1) {
+      tabfree(tab);
+    }
   }
 
   if (tab->flag == -1) {
@@ -121,6 +164,8 @@ int tabini(int alloc, int M, const int K[], struct tabprm *tab)
     tab->p0      = 0x0;
     tab->delta   = 0x0;
     tab->extrema = 0x0;
+    tab->grid    = 0x0;
+    tab->gridbox = 0x0;
     tab->set_M   = 0;
   }
 
@@ -206,6 +251,12 @@ int tabini(int alloc, int M, const int K[], struct tabprm *tab)
           return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
         }
 
+        /* Count the structs using the index and coordinate arrays. */
+        if (!(tab->m_refs = malloc(sizeof(int)))) {
+          return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
+        }
+        *(tab->m_refs) = 1;
+
         /* Recall that calloc() initializes these pointers to zero. */
         if (K) {
           for (m = 0; m < M; m++) {
@@ -410,6 +461,157 @@ int tabcpy(int alloc, const struct tabprm *tabsrc, struct tabprm *tabdst)
 
 /*--------------------------------------------------------------------------*/
 
+int tabshr(const struct tabprm *tabsrc, struct tabprm *tabdst)
+
+{
+  static const char *function = "tabshr";
+
+  int m, M, N, share, status;
+  struct wcserr **err;
+
+  if (tabsrc == 0x0) return TABERR_NULL_POINTER;
+  if (tabdst == 0x0) return TABERR_NULL_POINTER;
+  err = &(tabdst->err);
+
+  M = tabsrc->M;
+  if (M <= 0) {
+    return wcserr_set(WCSERR_SET(TABERR_BAD_PARAMS),
+      "M must be positive, got %d", M);
+  }
+
+  /* The index and coordinate arrays may be shared if tabsrc owns them. */
+  share = 0;
+#ifdef TAB_SHARE
+  share = tabsrc->m_flag == TABSET && tabsrc->m_refs && tabsrc->coord &&
+          tabsrc->coord == tabsrc->m_coord &&
+          tabsrc->index == tabsrc->m_index;
+  for (m = 0; share && m < M; m++) {
+    share = (tabsrc->index[m] == 0x0 ||
+             tabsrc->index[m] == tabsrc->m_indxs[m]);
+  }
+#endif
+
+  if (!share) return tabcpy(1, tabsrc, tabdst);
+
+  /* Release any memory tabdst owns, then allocate all but the arrays. */
+  if (tabdst->flag != -1 && tabdst->m_flag == TABSET) {
+    tabfree(tabdst);
+  }
+
+  if ((status = tabini(1, M, 0x0, tabdst))) {
+    return status;
+  }
+
+  /* Substitute the counter of tabsrc for the one tabini() allocated. */
+  tab_refs(tabsrc->m_refs, 1);
+  free(tabdst->m_refs);
+  tabdst->m_refs = tabsrc->m_refs;
+
+  N = M;
+  for (m = 0; m < M; m++) {
+    tabdst->K[m]     = tabsrc->K[m];
+    tabdst->map[m]   = tabsrc->map[m];
+    tabdst->crval[m] = tabsrc->crval[m];
+    tabdst->index[m]   = tabsrc->index[m];
+    tabdst->m_indxs[m] = tabsrc->m_indxs[m];
+    N *= tabsrc->K[m];
+  }
+
+  tabdst->coord = tabdst->m_coord = tabsrc->coord;
+  tabdst->m_N   = N;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int tabown(struct tabprm *tab)
+
+{
+  static const char *function = "tabown";
+
+  int m, M, N, *refs, status;
+  double *coord, **indxs;
+  struct wcserr **err;
+
+  if (tab == 0x0) return TABERR_NULL_POINTER;
+  err = &(tab->err);
+
+  if (tab->flag == -1 || tab->m_flag != TABSET) return 0;
+  if (tab->m_refs == 0x0 || tab_refs(tab->m_refs, 0) < 2) return 0;
+
+  /* Make private copies of the shared arrays. */
+  M = tab->M;
+  N = M;
+  for (m = 0; m < M; m++) {
+    N *= tab->K[m];
+  }
+
+  if (!(refs = malloc(sizeof(int)))) {
+    return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
+  }
+  *refs = 1;
+
+  status = 0;
+  coord  = 0x0;
+  if (!(indxs = calloc(M, sizeof(double *)))) {
+    free(refs);
+    return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
+  }
+
+  for (m = 0; m < M; m++) {
+    if (tab->index[m] && tab->index[m] == tab->m_indxs[m] && tab->K[m]) {
+      if (!(indxs[m] = malloc(tab->K[m]*sizeof(double)))) {
+        status = 1;
+        break;
+      }
+
+      memcpy(indxs[m], tab->m_indxs[m], tab->K[m]*sizeof(double));
+    }
+  }
+
+  if (status == 0 && tab->m_coord && N) {
+    if ((coord = malloc(N*sizeof(double)))) {
+      memcpy(coord, tab->m_coord, N*sizeof(double));
+    } else {
+      status = 1;
+    }
+  }
+
+  if (status) {
+    for (m = 0; m < M; m++) {
+      if (indxs[m]) free(indxs[m]);
+    }
+    free(indxs);
+    free(refs);
+
+    return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
+  }
+
+  /* Release the shared arrays, freeing them if the others have gone. */
+  if (tab_refs(tab->m_refs, -1) == 0) {
+    for (m = 0; m < M; m++) {
+      if (tab->m_indxs[m]) free(tab->m_indxs[m]);
+    }
+    if (tab->m_coord) free(tab->m_coord);
+    free(tab->m_refs);
+  }
+
+  for (m = 0; m < M; m++) {
+    if (tab->index[m] == tab->m_indxs[m]) tab->index[m] = indxs[m];
+    tab->m_indxs[m] = indxs[m];
+  }
+  free(indxs);
+
+  if (tab->coord == tab->m_coord) tab->coord = coord;
+  tab->m_coord = coord;
+  tab->m_refs  = refs;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
 int tabfree(struct tabprm *tab)
 
 {
@@ -433,6 +635,18 @@ int tabfree(struct tabprm *tab)
       if (tab->index == tab->m_index) tab->index = 0x0;
       if (tab->coord == tab->m_coord) tab->coord = 0x0;
 
+      /* Arrays shared with a copy are left to the last one to go. */
+      if (tab->m_refs) {
+        if (tab_refs(tab->m_refs, -1)) {
+          for (m = 0; m < tab->m_M && tab->m_indxs; m++) {
+            tab->m_indxs[m] = 0x0;
+          }
+          tab->m_coord = 0x0;
+        } else {
+          free(tab->m_refs);
+        }
+      }
+
       if (tab->m_K)     free(tab->m_K);
       if (tab->m_map)   free(tab->m_map);
       if (tab->m_crval) free(tab->m_crval);
@@ -453,6 +667,8 @@ int tabfree(struct tabprm *tab)
     if (tab->p0)      free(tab->p0);
     if (tab->delta)   free(tab->delta);
     if (tab->extrema) free(tab->extrema);
+    if (tab->grid)    free(tab->grid);
+    if (tab->gridbox) free(tab->gridbox);
   }
 
   tab->m_flag  = 0;
@@ -464,11 +680,14 @@ int tabfree(struct tabprm *tab)
   tab->m_index = 0x0;
   tab->m_indxs = 0x0;
   tab->m_coord = 0x0;
+  tab->m_refs  = 0x0;
 
   tab->sense   = 0x0;
   tab->p0      = 0x0;
   tab->delta   = 0x0;
   tab->extrema = 0x0;
+  tab->grid    = 0x0;
+  tab->gridbox = 0x0;
   tab->set_M   = 0;
 
   if (tab->err) {
@@ -612,6 +831,25 @@ int tabprt(const struct tabprm *tab)
     wcsprintf("\n");
   }
 
+  WCSPRINTF_PTR("       grid: ", tab->grid, "\n");
+  if (tab->grid) {
+    wcsprintf("            ");
+    for (m = 0; m < tab->M; m++) {
+      wcsprintf("%6d", tab->grid[m]);
+    }
+    wcsprintf("\n");
+  }
+
+  WCSPRINTF_PTR("    gridbox: ", tab->gridbox, "\n");
+  if (tab->gridbox) {
+    wcsprintf("            ");
+    for (m = 0; m < 2*tab->M; m++) {
+      if (m == tab->M) wcsprintf("->  ");
+      wcsprintf("  %- 11.5g", tab->gridbox[m]);
+    }
+    wcsprintf("\n");
+  }
+
   WCSPRINTF_PTR("        err: ", tab->err, "\n");
   if (tab->err) {
     wcserr_prt(tab->err, "             ");
@@ -648,6 +886,10 @@ int tabprt(const struct tabprm *tab)
   if (tab->m_coord == tab->coord) wcsprintf("  (= coord)");
   wcsprintf("\n");
 
+  WCSPRINTF_PTR("     m_refs: ", tab->m_refs, "");
+  if (tab->m_refs) wcsprintf("  (%d)", *(tab->m_refs));
+  wcsprintf("\n");
+
   return 0;
 }
 
@@ -658,7 +900,7 @@ int tabset(struct tabprm *tab)
 {
   static const char *function = "tabset";
 
-  int i, ic, k, *Km, m, M, ne;
+  int i, ic, k, *Km, m, M, ne, status;
   double *dcrd, *dmax, *dmin, dPsi, dval, *Psi;
   struct wcserr **err;
 
@@ -737,7 +979,7 @@ int tabset(struct tabprm *tab)
       return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
     }
 
-    if (!(tab->p0 = calloc(M, sizeof(int)))) {
+    if (!(tab->p0 = calloc(M+1, sizeof(int)))) {
       free(tab->sense);
       return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
     }
@@ -878,6 +1120,11 @@ int tabset(struct tabprm *tab)
     dmax += 2*M;
   }
 
+  /* Bucket the voxels of multi-dimensional tables for tabs2x(). */
+  if ((status = tab_grid(tab))) {
+    return wcserr_set(TAB_ERRMSG(status));
+  }
+
   tab->flag = TABSET;
 
   return 0;
@@ -894,26 +1141,56 @@ int tabx2s(
   int stat[])
 
 {
-  static const char *function = "tabx2s";
+  int status;
+
+  if (tab == 0x0) return TABERR_NULL_POINTER;
 
-  int i, iv, k, *Km, m, M, n, nv, offset, p1, status;
+  /* Initialize if required. */
+  if (tab->flag != TABSET) {
+    if ((status = tabset(tab))) return status;
+  }
+
+  return tabx2sr(tab, ncoord, nelem, x, world, stat, tab->p0, tab->delta,
+                 &(tab->err));
+}
+
+/*--------------------------------------------------------------------------*/
+
+int tabx2sr(
+  const struct tabprm *tab,
+  int ncoord,
+  int nelem,
+  const double x[],
+  double world[],
+  int stat[],
+  int p0[],
+  double delta[],
+  struct wcserr **err)
+
+{
+  static const char *function = "tabx2sr";
+
+  int hints, i, iv, k, *Km, m, M, n, nv, offset, p1, status;
   double *coord, *Psi, psi_m, upsilon, wgt;
   register int *statp;
   register const double *xp;
   register double *wp;
-  struct wcserr **err;
 
   if (tab == 0x0) return TABERR_NULL_POINTER;
-  err = &(tab->err);
 
-  /* Initialize if required. */
   if (tab->flag != TABSET) {
-    if ((status = tabset(tab))) return status;
+    return wcserr_set(WCSERR_SET(TABERR_BAD_PARAMS),
+      "The tabprm struct has not been set up");
   }
 
   /* This is used a lot. */
   M = tab->M;
 
+  /* Bit m is set once p0[m] has been computed for this call, whereupon it
+     serves as a hint for locating the next coordinate in the index vector.
+     p0[] may be uninitialized on entry. */
+  hints = 0;
+
   status = 0;
   xp = x;
   wp = world;
@@ -975,17 +1252,8 @@ int tabx2s(
               }
 
             } else {
-              for (k = 1; k < *Km; k++) {
-                if (psi_m < Psi[k]) {
-                  continue;
-                }
-                if (Psi[k] == psi_m && psi_m < Psi[k+1]) {
-                  break;
-                }
-                if (Psi[k] < psi_m && psi_m <= Psi[k+1]) {
-                  break;
-                }
-              }
+              k = tab_cell(Psi, *Km, 1, psi_m,
+                           (m < 31 && (hints & (1 << m))) ? p0[m]+1 : 0);
             }
 
           } else {
@@ -1015,17 +1283,8 @@ int tabx2s(
               }
 
             } else {
-              for (k = 1; k < *Km; k++) {
-                if (psi_m > Psi[k]) {
-                  continue;
-                }
-                if (Psi[k] == psi_m && psi_m > Psi[k+1]) {
-                  break;
-                }
-                if (Psi[k] > psi_m && psi_m >= Psi[k+1]) {
-                  break;
-                }
-              }
+              k = tab_cell(Psi, *Km, -1, psi_m,
+                           (m < 31 && (hints & (1 << m))) ? p0[m]+1 : 0);
             }
           }
 
@@ -1041,55 +1300,63 @@ int tabx2s(
       }
 
       /* Fiducial array indices and fractional offset.
-         p1 is 1-relative while tab::p0 is 0-relative. */
+         p1 is 1-relative while p0 is 0-relative. */
       p1 = (int)floor(upsilon);
-      tab->p0[m] = p1 - 1;
-      tab->delta[m] = upsilon - p1;
+      p0[m] = p1 - 1;
+      delta[m] = upsilon - p1;
 
       if (p1 == 0) {
-        tab->p0[m] += 1;
-        tab->delta[m] -= 1.0;
+        p0[m] += 1;
+        delta[m] -= 1.0;
       } else if (p1 == *Km && *Km > 1) {
-        tab->p0[m] -= 1;
-        tab->delta[m] += 1.0;
+        p0[m] -= 1;
+        delta[m] += 1.0;
       }
+
+      if (m < 31) hints |= 1 << m;
     }
 
 
     /* Now interpolate in the coordinate array; the M-dimensional linear  */
     /* interpolation algorithm is described in Sect. 3.4 of WCS Paper IV. */
-    for (m = 0; m < M; m++) {
-     i = tab->map[m];
-     *(wp+i) = 0.0;
-    }
+    if (M <= 3) {
+      /* Unrolled for the common one- to three-dimensional tables. */
+      tab_lerp(tab, p0, delta, wp);
 
-    /* Loop over the 2^M vertices surrounding P. */
-    nv = 1 << M;
-    for (iv = 0; iv < nv; iv++) {
-      /* Locate vertex in the coordinate array and compute its weight. */
-      offset = 0;
-      wgt = 1.0;
-      for (m = M-1; m >= 0; m--) {
-        offset *= tab->K[m];
-        offset += tab->p0[m];
-        if (iv & (1 << m)) {
-          if (tab->K[m] > 1) offset++;
-          wgt *= tab->delta[m];
-        } else {
-          wgt *= 1.0 - tab->delta[m];
-        }
+    } else {
+      for (m = 0; m < M; m++) {
+       i = tab->map[m];
+       *(wp+i) = 0.0;
       }
 
-      if (wgt == 0.0) continue;
+      /* Loop over the 2^M vertices surrounding P. */
+      nv = 1 << M;
+      for (iv = 0; iv < nv; iv++) {
+        /* Locate vertex in the coordinate array and compute its weight. */
+        offset = 0;
+        wgt = 1.0;
+        for (m = M-1; m >= 0; m--) {
+          offset *= tab->K[m];
+          offset += p0[m];
+          if (iv & (1 << m)) {
+            if (tab->K[m] > 1) offset++;
+            wgt *= delta[m];
+          } else {
+            wgt *= 1.0 - delta[m];
+          }
+        }
 
-      /* Add the contribution from this vertex to each element. */
-      coord = tab->coord + offset*M;
-      for (m = 0; m < M; m++) {
-        i = tab->map[m];
-        *(wp+i) += *(coord++) * wgt;
-      }
+        if (wgt == 0.0) continue;
 
-      if (wgt == 1.0) break;
+        /* Add the contribution from this vertex to each element. */
+        coord = tab->coord + offset*M;
+        for (m = 0; m < M; m++) {
+          i = tab->map[m];
+          *(wp+i) += *(coord++) * wgt;
+        }
+
+        if (wgt == 1.0) break;
+      }
     }
 
     *statp = 0;
@@ -1116,15 +1383,8 @@ int tabs2x(
 {
   static const char *function = "tabs2x";
 
-  int tabedge(struct tabprm *);
-  int tabrow(struct tabprm *, const double *);
-  int tabvox(struct tabprm *, const double *, int, double **, unsigned int *);
-
-  int edge, i, ic, iv, k, *Km, M, m, n, nv, offset, status;
-  double *dcrd, delta, *Psi, psi_m, **tabcoord, upsilon;
-  register int *statp;
-  register const double *wp;
-  register double *xp;
+  int status;
+  double **tabcoord, *tabcrd[256];
   struct wcserr **err;
 
   if (tab == 0x0) return TABERR_NULL_POINTER;
@@ -1135,16 +1395,61 @@ int tabs2x(
     if ((status = tabset(tab))) return status;
   }
 
-  /* This is used a lot. */
-  M = tab->M;
+  /* Voxel corner addresses; only very large M needs the heap. */
+  tabcoord = tabcrd;
+  if (tab->M > 8) {
+    if (!(tabcoord = calloc(1 << tab->M, sizeof(double *)))) {
+      return wcserr_set(TAB_ERRMSG(TABERR_MEMORY));
+    }
+  }
+
+  status = tabs2xr(tab, ncoord, nelem, world, x, stat, tab->p0, tab->delta,
+                   tabcoord, err);
+
+  if (tabcoord != tabcrd) free(tabcoord);
+
+  return status;
+}
 
-  tabcoord = 0x0;
-  nv = 0;
-  if (M > 1) {
-    nv = 1 << M;
-    tabcoord = calloc(nv, sizeof(double *));
+/*--------------------------------------------------------------------------*/
+
+int tabs2xr(
+  const struct tabprm* tab,
+  int ncoord,
+  int nelem,
+  const double world[],
+  double x[],
+  int stat[],
+  int p0[],
+  double delta[],
+  double *tabcoord[],
+  struct wcserr **err)
+
+{
+  static const char *function = "tabs2xr";
+
+  int tabedge(const struct tabprm *, int *);
+  int tabrow(const struct tabprm *, const int *, const double *);
+  int tabvox(const struct tabprm *, const double *, int, double **,
+             unsigned int *, double *);
+
+  int edge, i, ic, k, *Km, M, m, n, nvl, status;
+  const int *vlist;
+  double *dcrd, dlt, *Psi, psi_m, upsilon;
+  register int *statp;
+  register const double *wp;
+  register double *xp;
+
+  if (tab == 0x0) return TABERR_NULL_POINTER;
+
+  if (tab->flag != TABSET) {
+    return wcserr_set(WCSERR_SET(TABERR_BAD_PARAMS),
+      "The tabprm struct has not been set up");
   }
 
+  /* This is used a lot. */
+  M = tab->M;
+
 
   status = 0;
   wp = world;
@@ -1154,66 +1459,77 @@ int tabs2x(
     /* Locate this coordinate in the coordinate array. */
     edge = 0;
     for (m = 0; m < M; m++) {
-      tab->p0[m] = 0;
+      p0[m] = 0;
     }
 
-    for (ic = 0; ic < tab->nc; ic++) {
-      if (tab->p0[0] == 0) {
-        /* New row, could it contain a solution? */
-        if (edge || tabrow(tab, wp)) {
-          /* No, skip it. */
-          ic += tab->K[0];
-          tab->p0[1]++;
-          edge = tabedge(tab);
-
-          /* Because ic will be incremented when the loop is reentered. */
-          ic--;
-          continue;
+    vlist = 0x0;
+    nvl = -1;
+    if (tab->grid) {
+      /* Examine only those voxels that the grid says might contain it, */
+      /* in the same order as the exhaustive search below.              */
+      nvl = tab_bucket(tab, wp, &vlist);
+
+      ic = tab->nc;
+      for (i = 0; i < nvl; i++) {
+        tab_p0(tab, vlist[i], p0);
+        tab_vcrd(tab, p0, tabcoord);
+        if (tabvox(tab, wp, 0, tabcoord, 0x0, delta) == 0) {
+          ic = vlist[i];
+          break;
         }
       }
 
-      if (M == 1) {
-        /* Deal with the one-dimensional case separately for efficiency. */
-        if (*wp == tab->coord[0]) {
-          tab->p0[0] = 0;
-          tab->delta[0] = 0.0;
-          break;
-
-        } else if (ic < tab->nc - 1) {
-          if (((tab->coord[ic] <= *wp && *wp <= tab->coord[ic+1]) ||
-               (tab->coord[ic] >= *wp && *wp >= tab->coord[ic+1])) &&
-               (tab->index[0] == 0x0 ||
-                tab->index[0][ic] != tab->index[0][ic+1])) {
-            tab->p0[0] = ic;
-            tab->delta[0] = (*wp - tab->coord[ic]) /
-                            (tab->coord[ic+1] - tab->coord[ic]);
-            break;
+    } else {
+      for (ic = 0; ic < tab->nc; ic++) {
+        if (p0[0] == 0) {
+          /* New row, could it contain a solution? */
+          if (edge || tabrow(tab, p0, wp)) {
+            /* No, skip it. */
+            ic += tab->K[0];
+            p0[1]++;
+            edge = tabedge(tab, p0);
+
+            /* Because ic will be incremented when the loop is reentered. */
+            ic--;
+            continue;
           }
         }
 
-      } else {
-        /* Multi-dimensional tables are harder. */
-        if (!edge) {
-          /* Addresses of the coordinates for each corner of the "voxel". */
-          for (iv = 0; iv < nv; iv++) {
-            offset = 0;
-            for (m = M-1; m >= 0; m--) {
-              offset *= tab->K[m];
-              offset += tab->p0[m];
-              if ((iv & (1 << m)) && (tab->K[m] > 1)) offset++;
+        if (M == 1) {
+          /* Deal with the one-dimensional case separately for efficiency. */
+          if (*wp == tab->coord[0]) {
+            p0[0] = 0;
+            delta[0] = 0.0;
+            break;
+
+          } else if (ic < tab->nc - 1) {
+            if (((tab->coord[ic] <= *wp && *wp <= tab->coord[ic+1]) ||
+                 (tab->coord[ic] >= *wp && *wp >= tab->coord[ic+1])) &&
+                 (tab->index[0] == 0x0 ||
+                  tab->index[0][ic] != tab->index[0][ic+1])) {
+              p0[0] = ic;
+              delta[0] = (*wp - tab->coord[ic]) /
+                              (tab->coord[ic+1] - tab->coord[ic]);
+              break;
             }
-            tabcoord[iv] = tab->coord + offset*M;
           }
 
-          if (tabvox(tab, wp, 0, tabcoord, 0x0) == 0) {
-            /* Found a solution. */
-            break;
+        } else {
+          /* Multi-dimensional tables are harder. */
+          if (!edge) {
+            /* Addresses of the coordinates for each corner of the "voxel". */
+            tab_vcrd(tab, p0, tabcoord);
+
+            if (tabvox(tab, wp, 0, tabcoord, 0x0, delta) == 0) {
+              /* Found a solution. */
+              break;
+            }
           }
-        }
 
-        /* Next voxel. */
-        tab->p0[0]++;
-        edge = tabedge(tab);
+          /* Next voxel. */
+          p0[0]++;
+          edge = tabedge(tab, p0);
+        }
       }
     }
 
@@ -1227,19 +1543,19 @@ int tabs2x(
           for (i = 0; i < 2; i++) {
             if (i) dcrd += tab->K[0] - 2;
 
-            delta = (*wp - *dcrd) / (*(dcrd+1) - *dcrd);
+            dlt = (*wp - *dcrd) / (*(dcrd+1) - *dcrd);
 
             if (i == 0) {
-              if (-0.5 <= delta && delta <= 0.0) {
-                tab->p0[0] = 0;
-                tab->delta[0] = delta;
+              if (-0.5 <= dlt && dlt <= 0.0) {
+                p0[0] = 0;
+                delta[0] = dlt;
                 ic = 0;
                 break;
               }
             } else {
-              if (1.0 <= delta && delta <= 1.5) {
-                tab->p0[0] = tab->K[0] - 1;
-                tab->delta[0] = delta - 1.0;
+              if (1.0 <= dlt && dlt <= 1.5) {
+                p0[0] = tab->K[0] - 1;
+                delta[0] = dlt - 1.0;
                 ic = 0;
               }
             }
@@ -1247,8 +1563,11 @@ int tabs2x(
         }
 
       } else {
-        /* Multi-dimensional tables. */
-        /* >>> TBD <<< */
+        /* Multi-dimensional tables; allow extrapolation by up to half a */
+        /* voxel beyond the edges of the coordinate array.               */
+        if (tab_xtrap(tab, wp, vlist, nvl, p0, delta, tabcoord) == 0) {
+          ic = 0;
+        }
       }
     }
 
@@ -1262,7 +1581,7 @@ int tabs2x(
       Km = tab->K;
       for (m = 0; m < M; m++, Km++) {
         /* N.B. Upsilon_m and psi_m are 1-relative FITS indexes. */
-        upsilon = (tab->p0[m] + 1) + tab->delta[m];
+        upsilon = (p0[m] + 1) + delta[m];
 
         if (upsilon < 0.5 || upsilon > *Km + 0.5) {
           /* Index out of range. */
@@ -1284,6 +1603,12 @@ int tabs2x(
             if (*Km == 1) {
               /* Degenerate index vector. */
               psi_m = Psi[1];
+            } else if (upsilon < 1.0) {
+              /* Extrapolated. */
+              psi_m = Psi[1] + (upsilon - 1.0) * (Psi[2] - Psi[1]);
+            } else if (upsilon > *Km) {
+              /* Extrapolated. */
+              psi_m = Psi[*Km] + (upsilon - *Km) * (Psi[*Km] - Psi[*Km-1]);
             } else {
               k = (int)(upsilon);
               psi_m = Psi[k];
@@ -1305,16 +1630,14 @@ int tabs2x(
     statp++;
   }
 
-  if (tabcoord) free(tabcoord);
-
   return status;
 }
 
 /*----------------------------------------------------------------------------
-* Convenience routine to deal with of edge effects in tabprm::p0.
+* Convenience routine to deal with of edge effects in p0.
 *---------------------------------------------------------------------------*/
 
-int tabedge(struct tabprm* tab)
+int tabedge(const struct tabprm* tab, int *p0)
 
 {
   int edge, *Km, m;
@@ -1322,12 +1645,12 @@ int tabedge(struct tabprm* tab)
   edge = 0;
   Km = tab->K;
   for (m = 0; m < tab->M; m++, Km++) {
-    if (tab->p0[m] == *Km) {
+    if (p0[m] == *Km) {
       /* p0 has been incremented beyond the end of the row, point it to the
          next one. */
-      tab->p0[m] = 0;
-      tab->p0[m+1]++;
-    } else if (tab->p0[m] == *Km - 1 && *Km > 1) {
+      p0[m] = 0;
+      p0[m+1]++;
+    } else if (p0[m] == *Km - 1 && *Km > 1) {
       /* p0 is sitting at the end of a non-degenerate row. */
       edge = 1;
     }
@@ -1338,10 +1661,10 @@ int tabedge(struct tabprm* tab)
 
 /*----------------------------------------------------------------------------
 * Quick test to see whether the world coordinate indicated by wp could lie
-* somewhere along (or near) the row of the image indexed by tabprm::p0.
+* somewhere along (or near) the row of the image indexed by p0.
 * Return 0 if so, 1 otherwise.
 *
-* tabprm::p0 selects a particular row of the image, p0[0] being ignored (i.e.
+* p0 selects a particular row of the image, p0[0] being ignored (i.e.
 * treated as zero).  Adjacent rows that delimit a row of "voxels" are formed
 * by incrementing elements other than p0[0] in all binary combinations.  N.B.
 * these are not the same as the voxels (pixels) that are indexed by, and
@@ -1365,7 +1688,7 @@ int tabedge(struct tabprm* tab)
 * dimension, then the maximum.
 *---------------------------------------------------------------------------*/
 
-int tabrow(struct tabprm* tab, const double *wp)
+int tabrow(const struct tabprm* tab, const int *p0, const double *wp)
 
 {
   int iv, M, m, nv, offset;
@@ -1388,7 +1711,7 @@ int tabrow(struct tabprm* tab, const double *wp)
     offset = 0;
     for (m = M-1; m > 0; m--) {
       offset *= tab->K[m];
-      offset += tab->p0[m];
+      offset += p0[m];
 
       /* Select the row. */
       if (iv & (1 << m)) {
@@ -1439,11 +1762,11 @@ int tabrow(struct tabprm* tab, const double *wp)
 
 /*----------------------------------------------------------------------------
 * Does the world coordinate indicated by wp lie within the voxel indexed by
-* tabprm::p0?  If so, do a binary chop of the interior of the voxel to find
-* it and return 0, with tabprm::delta set to the solution.  Else return 1.
+* p0?  If so, do a binary chop of the interior of the voxel to find it and
+* return 0, with delta set to the solution.  Else return 1.
 *
 * As in tabrow(), a "voxel" is formed by incrementing the elements of
-* tabprm::p0 in all binary combinations.  Note that these are not the same as
+* p0 in all binary combinations.  Note that these are not the same as
 * the voxels (pixels) that are indexed by, and centred on, integral pixel
 * coordinates in FITS.
 *
@@ -1458,11 +1781,12 @@ int tabrow(struct tabprm* tab, const double *wp)
 ----------------------------------------------------------------------------*/
 
 int tabvox(
-  struct tabprm* tab,
+  const struct tabprm* tab,
   const double *wp,
   int level,
   double **tabcoord,
-  unsigned int *vox)
+  unsigned int *vox,
+  double *delta)
 
 {
   int i, iv, jv, M, m, nv;
@@ -1490,10 +1814,10 @@ int tabvox(
     /* Select a corner of the sub-voxel. */
     for (m = 0; m < M; m++) {
       coord[m] = 0.0;
-      tab->delta[m] = level ? dv*vox[m] : 0.0;
+      delta[m] = level ? dv*vox[m] : 0.0;
 
       if (iv & (1 << m)) {
-        tab->delta[m] += dv;
+        delta[m] += dv;
       }
     }
 
@@ -1505,9 +1829,9 @@ int tabvox(
       wgt = 1.0;
       for (m = 0; m < M; m++) {
         if (jv & (1 << m)) {
-          wgt *= tab->delta[m];
+          wgt *= delta[m];
         } else {
-          wgt *= 1.0 - tab->delta[m];
+          wgt *= 1.0 - delta[m];
         }
       }
 
@@ -1555,7 +1879,7 @@ int tabvox(
       /* We have a solution, squeeze out the last bit of juice. */
       dv /= 2.0;
       for (m = 0; m < M; m++) {
-        tab->delta[m] = dv * (2.0*vox[m] + 1.0);
+        delta[m] = dv * (2.0*vox[m] + 1.0);
       }
 
       return 0;
@@ -1572,7 +1896,7 @@ int tabvox(
       }
 
       /* Recurse. */
-      if (tabvox(tab, wp, level+1, tabcoord, vox2) == 0) {
+      if (tabvox(tab, wp, level+1, tabcoord, vox2, delta) == 0) {
         return 0;
       }
     }
@@ -1581,3 +1905,676 @@ int tabvox(
   /* No solution in this sub-voxel. */
   return 1;
 }
+
+/*----------------------------------------------------------------------------
+* Locate psi_m, known to lie within the range of the 1-relative index vector
+* Psi[1..K] with the given sense, returning the 1-relative k of the interval
+* [Psi[k],Psi[k+1]] that contains it.  Where psi_m coincides with a node the
+* interval below it is preferred, zero-length intervals being skipped, so the
+* result is identical to that of a linear scan from k = 1.
+*
+* The interval given by hint, if valid, and its successor are tested first
+* so that an input stream that moves slowly through the index vector costs
+* O(1).  Otherwise
+* the search starts from a guess interpolated between the end-points, which
+* is exact for uniformly spaced index values and close for smoothly varying
+* ones.  An exponential search then brackets psi_m, followed by a binary
+* search, so that in the worst case the cost is O(log K).
+*---------------------------------------------------------------------------*/
+
+int tab_cell(
+  const double Psi[],
+  int K,
+  int sense,
+  double psi_m,
+  int hint)
+
+{
+  int hi, k, lo, step;
+  double s, t;
+
+  /* Compare s*Psi[k] with s*psi_m so as to handle both senses alike; */
+  /* negation is exact.                                              */
+  s = (double)sense;
+  psi_m *= s;
+
+  /* Find the first k such that Psi[k+1] >= psi_m, for increasing sense. */
+  k = 0;
+  if (1 <= hint && hint < K) {
+    /* Try the hinted interval and its successor. */
+    if (psi_m <= s*Psi[hint+1]) {
+      if (hint == 1 || s*Psi[hint] < psi_m) k = hint;
+    } else if (hint+1 < K && psi_m <= s*Psi[hint+2]) {
+      k = hint + 1;
+    }
+  }
+
+  if (k == 0) {
+    /* Interpolate a starting guess; this also weeds out NaN. */
+    t = (psi_m - s*Psi[1]) / (s*Psi[K] - s*Psi[1]) * (K - 1);
+    if (!(t >= 0.0)) {
+      k = 1;
+    } else if (t >= (double)(K - 1)) {
+      k = K - 1;
+    } else {
+      k = 1 + (int)t;
+      if (k > K - 1) k = K - 1;
+    }
+
+    if (psi_m <= s*Psi[k+1]) {
+      /* Search downwards; lo = 0 acts as a sentinel. */
+      hi = k;
+      step = 1;
+      while ((lo = hi - step) >= 1 && psi_m <= s*Psi[lo+1]) {
+        hi = lo;
+        step *= 2;
+      }
+      if (lo < 0) lo = 0;
+
+    } else {
+      /* Search upwards; psi_m <= Psi[K] so hi = K-1 terminates it. */
+      lo = k;
+      step = 1;
+      while ((hi = lo + step) < K - 1 && !(psi_m <= s*Psi[hi+1])) {
+        lo = hi;
+        step *= 2;
+      }
+      if (hi > K - 1) hi = K - 1;
+    }
+
+    /* Binary search for the bracket. */
+    while (hi - lo > 1) {
+      k = lo + (hi - lo)/2;
+      if (psi_m <= s*Psi[k+1]) {
+        hi = k;
+      } else {
+        lo = k;
+      }
+    }
+
+    k = hi;
+  }
+
+  /* Skip zero-length intervals on which psi_m lies. */
+  while (k < K && !(s*Psi[k] <= psi_m && psi_m <= s*Psi[k+1] &&
+                    Psi[k] != Psi[k+1])) {
+    k++;
+  }
+
+  return k;
+}
+
+/*----------------------------------------------------------------------------
+* Build the bucket grid used by tabs2xr() to search a multi-dimensional
+* coordinate array.  The range of each element of the coordinate vector is
+* divided into cells, about as many in all as there are voxels, and each
+* voxel is listed, in order, in every cell overlapped by its bounding box.
+* The bounding box is that of the corners of the voxel, widened by twice the
+* tolerance used by tabvox() and, for voxels on the edge of the coordinate
+* array, extended by the half voxel allowed by tab_xtrap().  Thus the list
+* for the cell containing a world coordinate includes every voxel that could
+* contain it, or be extrapolated to it.
+*
+* tabprm::grid holds the number of cells on each axis, then for each cell the
+* offset into tabprm::grid of its list, plus one more for the end of the last
+* list, then the lists.  tabprm::gridbox holds the lower and upper bounds of
+* the grid on each axis and then the number of cells per unit.
+*
+* The grid is not built for one-dimensional tables, those with M > 16 (see
+* tabvox()), those with non-finite coordinates, or those so large that the
+* lists could not be indexed, whence tabs2xr() searches the coordinate array
+* exhaustively.  Returns 0 or TABERR_MEMORY.
+*---------------------------------------------------------------------------*/
+
+int tab_grid(struct tabprm *tab)
+
+{
+  const double pad = 2e-10;
+
+  int c, cidx[16], cmax[16], cmin[16], *count, *grid, i, ic, icell, M, m,
+      ncell, nlist, nvox, p0[17], pass, status;
+  double **tabcoord, dcell, gmax[16], gmin[16], hi[16], lo[16], nsum,
+         umax[16], umin[16], vmax[16], vmin[16], *xcrd;
+
+  if (tab->grid)    free(tab->grid);
+  if (tab->gridbox) free(tab->gridbox);
+  tab->grid    = 0x0;
+  tab->gridbox = 0x0;
+
+  if ((M = tab->M) < 2 || M > 16) return 0;
+
+  for (i = 0; i < tab->nc*M; i++) {
+    if (!(fabs(tab->coord[i]) <= DBL_MAX)) return 0;
+  }
+
+  if (!(tabcoord = calloc(1 << M, sizeof(double *)))) {
+    return TABERR_MEMORY;
+  }
+
+  xcrd = 0x0;
+  if (M <= TAB_XMAX) {
+    if (!(xcrd = calloc(M << M, sizeof(double)))) {
+      free(tabcoord);
+      return TABERR_MEMORY;
+    }
+  }
+
+  /* Pass 0 finds the bounds of the grid, pass 1 counts the entries in each
+     cell, and pass 2 lists them. */
+  status = 0;
+  count = 0x0;
+  ncell = 0;
+  for (pass = 0; pass < 3; pass++) {
+    nvox = 0;
+    for (ic = 0; ic < tab->nc; ic++) {
+      if (tab_vbox(tab, ic, p0, tabcoord, lo, hi, xcrd, vmin, vmax)) {
+        continue;
+      }
+
+      if (pass == 0) {
+        for (m = 0; m < M; m++) {
+          if (nvox == 0 || vmin[m] < umin[m]) umin[m] = vmin[m];
+          if (nvox == 0 || vmax[m] > umax[m]) umax[m] = vmax[m];
+        }
+
+        nvox++;
+        continue;
+      }
+
+      /* The range of cells overlapped by the voxel. */
+      for (m = 0; m < M; m++) {
+        for (i = 0; i < 2; i++) {
+          dcell = ((i ? vmax[m] + pad : vmin[m] - pad) - gmin[m]) *
+                  tab->gridbox[2*M+m];
+          c = (dcell < tab->grid[m]) ? (int)dcell : tab->grid[m] - 1;
+          if (i) {
+            cmax[m] = c;
+          } else {
+            cmin[m] = c;
+          }
+        }
+        cidx[m] = cmin[m];
+      }
+
+      /* Visit each cell. */
+      while (1) {
+        icell = 0;
+        for (m = M-1; m >= 0; m--) {
+          icell = icell*tab->grid[m] + cidx[m];
+        }
+
+        if (pass == 1) {
+          count[icell]++;
+        } else {
+          tab->grid[count[icell]++] = ic;
+        }
+
+        for (m = 0; m < M; m++) {
+          if (++cidx[m] <= cmax[m]) break;
+          cidx[m] = cmin[m];
+        }
+        if (m == M) break;
+      }
+    }
+
+    if (pass == 0) {
+      if (nvox == 0) break;
+
+      if (!(tab->gridbox = calloc(3*M, sizeof(double)))) {
+        status = TABERR_MEMORY;
+        break;
+      }
+
+      /* Cells per axis, about the M'th root of the number of voxels. */
+      i = 0;
+      for (m = 0; m < M; m++) {
+        if (umin[m] < umax[m]) i++;
+      }
+
+      c = (int)ceil(pow((double)nvox, 1.0/(i ? i : 1)));
+      dcell = 1.0;
+      for (m = 0; m < M; m++) {
+        gmin[m] = umin[m] - pad;
+        gmax[m] = umax[m] + pad;
+        tab->gridbox[m]   = gmin[m];
+        tab->gridbox[M+m] = gmax[m];
+
+        cidx[m] = (umin[m] < umax[m]) ? c : 1;
+        tab->gridbox[2*M+m] = (umin[m] < umax[m]) ?
+                                cidx[m] / (gmax[m] - gmin[m]) : 0.0;
+        dcell *= cidx[m];
+      }
+
+      if (dcell > INT_MAX/4) break;
+      ncell = (int)dcell;
+
+      /* Temporarily, just the number of cells per axis. */
+      if (!(tab->grid = calloc(M, sizeof(int)))) {
+        status = TABERR_MEMORY;
+        break;
+      }
+      for (m = 0; m < M; m++) {
+        tab->grid[m] = cidx[m];
+      }
+
+      if (!(count = calloc(ncell, sizeof(int)))) {
+        status = TABERR_MEMORY;
+        break;
+      }
+
+    } else if (pass == 1) {
+      /* Offsets of the lists. */
+      nsum = M + ncell + 1.0;
+      for (icell = 0; icell < ncell; icell++) {
+        nsum += count[icell];
+      }
+
+      if (nsum > INT_MAX) break;
+
+      nlist = (int)nsum;
+      if (!(grid = realloc(tab->grid, nlist*sizeof(int)))) {
+        status = TABERR_MEMORY;
+        break;
+      }
+      tab->grid = grid;
+
+      nlist = M + ncell + 1;
+      for (icell = 0; icell < ncell; icell++) {
+        tab->grid[M+icell] = nlist;
+        nlist += count[icell];
+        count[icell] = tab->grid[M+icell];
+      }
+      tab->grid[M+ncell] = nlist;
+    }
+  }
+
+  free(tabcoord);
+  if (xcrd)  free(xcrd);
+  if (count) free(count);
+
+  if (pass < 3) {
+    /* Memory allocation failed, or the grid would be unusable. */
+    if (tab->grid)    free(tab->grid);
+    if (tab->gridbox) free(tab->gridbox);
+    tab->grid    = 0x0;
+    tab->gridbox = 0x0;
+  }
+
+  return status;
+}
+
+/*----------------------------------------------------------------------------
+* Compute the bounding box of the voxel whose first corner is the coordinate
+* vector with index ic in the coordinate array, extended for extrapolation
+* as in tab_xtrap() if xcrd, a work array of length M*2**M, is given.  p0,
+* tabcoord, lo and hi are work arrays, as in tab_xvox().  Returns 1 if ic
+* does not index a voxel, else 0.
+*---------------------------------------------------------------------------*/
+
+int tab_vbox(
+  const struct tabprm *tab,
+  int ic,
+  int *p0,
+  double **tabcoord,
+  double *lo,
+  double *hi,
+  double *xcrd,
+  double *vmin,
+  double *vmax)
+
+{
+  int ext, iv, M, m, nv;
+  const double *cp;
+
+  if (tab_p0(tab, ic, p0)) return 1;
+  tab_vcrd(tab, p0, tabcoord);
+
+  M  = tab->M;
+  nv = 1 << M;
+
+  ext = xcrd && tab_xvox(tab, p0, tabcoord, lo, hi, xcrd);
+  for (iv = 0; iv < nv; iv++) {
+    cp = ext ? xcrd + iv*M : tabcoord[iv];
+    for (m = 0; m < M; m++) {
+      if (iv == 0 || cp[m] < vmin[m]) vmin[m] = cp[m];
+      if (iv == 0 || cp[m] > vmax[m]) vmax[m] = cp[m];
+    }
+  }
+
+  return 0;
+}
+
+/*----------------------------------------------------------------------------
+* Find the cell of the bucket grid (see tab_grid()) that contains the world
+* coordinate indicated by wp.  Returns the length of its list of voxels, with
+* vlist set to the address of the first, or 0 if wp lies outside the grid.
+*---------------------------------------------------------------------------*/
+
+int tab_bucket(const struct tabprm *tab, const double *wp, const int **vlist)
+
+{
+  int c, icell, M, m;
+  const int *grid;
+  double dcell, w;
+  const double *gridbox;
+
+  M = tab->M;
+  grid = tab->grid;
+  gridbox = tab->gridbox;
+
+  icell = 0;
+  for (m = M-1; m >= 0; m--) {
+    w = wp[tab->map[m]];
+    if (!(gridbox[m] <= w && w <= gridbox[M+m])) return 0;
+
+    dcell = (w - gridbox[m]) * gridbox[2*M+m];
+    c = (dcell < grid[m]) ? (int)dcell : grid[m] - 1;
+    icell = icell*grid[m] + c;
+  }
+
+  grid += M + icell;
+  *vlist = tab->grid + grid[0];
+  return grid[1] - grid[0];
+}
+
+/*----------------------------------------------------------------------------
+* Set p0 to the indices in the coordinate array of the coordinate vector with
+* index ic.  Returns 1 if it lies at the end of a non-degenerate row on any
+* axis, and so is not the first corner of a voxel, else 0.
+*---------------------------------------------------------------------------*/
+
+int tab_p0(const struct tabprm *tab, int ic, int *p0)
+
+{
+  int m;
+
+  for (m = 0; m < tab->M; m++) {
+    p0[m] = ic % tab->K[m];
+    ic /= tab->K[m];
+
+    if (p0[m] == tab->K[m] - 1 && tab->K[m] > 1) return 1;
+  }
+
+  return 0;
+}
+
+/*----------------------------------------------------------------------------
+* Set tabcoord to the addresses of the coordinates for each corner of the
+* voxel indexed by p0.
+*---------------------------------------------------------------------------*/
+
+void tab_vcrd(const struct tabprm *tab, const int *p0, double **tabcoord)
+
+{
+  int iv, m, M, nv, offset;
+
+  M  = tab->M;
+  nv = 1 << M;
+
+  for (iv = 0; iv < nv; iv++) {
+    offset = 0;
+    for (m = M-1; m >= 0; m--) {
+      offset *= tab->K[m];
+      offset += p0[m];
+      if ((iv & (1 << m)) && (tab->K[m] > 1)) offset++;
+    }
+    tabcoord[iv] = tab->coord + offset*M;
+  }
+}
+
+/*----------------------------------------------------------------------------
+* For a voxel indexed by p0 that lies on the edge of the coordinate array,
+* with tabcoord the addresses of its corners, extend it by half a voxel
+* outwards on each axis on which it lies on the edge.  lo and hi are
+* returned with the range of the extended voxel in units of the original,
+* and xcrd, of length M*2**M, with the coordinates of its corners, obtained
+* by linear extrapolation using the weighting algorithm described in Sect.
+* 3.4 of WCS Paper IV.  Returns 1 if the voxel was extended, else 0.
+*---------------------------------------------------------------------------*/
+
+int tab_xvox(
+  const struct tabprm *tab,
+  const int *p0,
+  double *const *tabcoord,
+  double *lo,
+  double *hi,
+  double *xcrd)
+
+{
+  int ext, iv, jv, M, m, nv;
+  double dm, wgt, *xp;
+
+  M = tab->M;
+
+  ext = 0;
+  for (m = 0; m < M; m++) {
+    lo[m] = 0.0;
+    hi[m] = 1.0;
+    if (tab->K[m] > 1) {
+      if (p0[m] == 0) {
+        lo[m] = -0.5;
+        ext = 1;
+      }
+      if (p0[m] == tab->K[m] - 2) {
+        hi[m] = 1.5;
+        ext = 1;
+      }
+    }
+  }
+
+  if (!ext) return 0;
+
+  nv = 1 << M;
+  xp = xcrd;
+  for (iv = 0; iv < nv; iv++, xp += M) {
+    for (m = 0; m < M; m++) {
+      xp[m] = 0.0;
+    }
+
+    for (jv = 0; jv < nv; jv++) {
+      wgt = 1.0;
+      for (m = 0; m < M; m++) {
+        dm = (iv & (1 << m)) ? hi[m] : lo[m];
+        wgt *= (jv & (1 << m)) ? dm : 1.0 - dm;
+      }
+
+      if (wgt == 0.0) continue;
+
+      for (m = 0; m < M; m++) {
+        xp[m] += wgt * tabcoord[jv][m];
+      }
+    }
+  }
+
+  return 1;
+}
+
+/*----------------------------------------------------------------------------
+* Having failed to find the world coordinate indicated by wp within the
+* coordinate array, look for it within half a voxel beyond its edges.  This
+* is the multi-dimensional analogue of the extrapolation allowed for
+* one-dimensional tables; each edge voxel is extended by tab_xvox() and the
+* extended voxels are searched in order.  Only the nvl voxels in vlist are
+* considered, or all of them if nvl < 0.  p0, delta and tabcoord are
+* as for tabvox().  Returns 0 if a solution was found, else 1.
+*
+* Extrapolation is limited to M <= TAB_XMAX.
+*---------------------------------------------------------------------------*/
+
+int tab_xtrap(
+  const struct tabprm *tab,
+  const double *wp,
+  const int *vlist,
+  int nvl,
+  int *p0,
+  double *delta,
+  double **tabcoord)
+
+{
+  int tabvox(const struct tabprm *, const double *, int, double **,
+             unsigned int *, double *);
+
+  int i, ic, iv, M, m, n, nv;
+  double hi[TAB_XMAX], lo[TAB_XMAX], xcrd[TAB_XMAX << TAB_XMAX];
+
+  if ((M = tab->M) > TAB_XMAX) return 1;
+  nv = 1 << M;
+
+  n = (nvl < 0) ? tab->nc : nvl;
+  for (i = 0; i < n; i++) {
+    ic = (nvl < 0) ? i : vlist[i];
+    if (tab_p0(tab, ic, p0)) continue;
+
+    tab_vcrd(tab, p0, tabcoord);
+    if (!tab_xvox(tab, p0, tabcoord, lo, hi, xcrd)) continue;
+
+    for (iv = 0; iv < nv; iv++) {
+      tabcoord[iv] = xcrd + iv*M;
+    }
+
+    if (tabvox(tab, wp, 0, tabcoord, 0x0, delta) == 0) {
+      for (m = 0; m < M; m++) {
+        delta[m] = lo[m] + delta[m]*(hi[m] - lo[m]);
+      }
+
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/*----------------------------------------------------------------------------
+* Multilinear interpolation in the coordinate array for M <= 3, with the
+* vertex offsets and weights of tabx2sr()'s generic loop written out and the
+* sums accumulated in registers.  The weights are formed in the same order,
+* and vertices are visited in the same order with the same tests for zero and
+* unit weight, so that the result is bit-for-bit identical.
+*---------------------------------------------------------------------------*/
+
+void tab_lerp(
+  const struct tabprm *tab,
+  const int *p0,
+  const double *delta,
+  double *wp)
+
+{
+  int iv, M, offset[8], s0, s1, s2;
+  double a0, a1, a2, *coord, g0, g1, g2, w, wgt[8];
+
+  M = tab->M;
+
+  /* Vertex strides in the coordinate array; zero on a degenerate axis. */
+  s0 = (tab->K[0] > 1) ? M : 0;
+  g0 = 1.0 - delta[0];
+
+  a0 = a1 = a2 = 0.0;
+  switch (M) {
+  case 1:
+    coord = tab->coord + p0[0];
+    if (g0 != 0.0) {
+      a0 += coord[0] * g0;
+      if (g0 == 1.0) break;
+    }
+    if (delta[0] != 0.0) {
+      a0 += coord[s0] * delta[0];
+    }
+    break;
+
+  case 2:
+    s1 = (tab->K[1] > 1) ? M*tab->K[0] : 0;
+    offset[0] = M*(p0[1]*tab->K[0] + p0[0]);
+    offset[1] = offset[0] + s0;
+    offset[2] = offset[0] + s1;
+    offset[3] = offset[2] + s0;
+
+    g1 = 1.0 - delta[1];
+    wgt[0] = g1*g0;
+    wgt[1] = g1*delta[0];
+    wgt[2] = delta[1]*g0;
+    wgt[3] = delta[1]*delta[0];
+
+    for (iv = 0; iv < 4; iv++) {
+      if ((w = wgt[iv]) == 0.0) continue;
+
+      coord = tab->coord + offset[iv];
+      a0 += coord[0] * w;
+      a1 += coord[1] * w;
+
+      if (w == 1.0) break;
+    }
+    break;
+
+  default:
+    s1 = (tab->K[1] > 1) ? M*tab->K[0] : 0;
+    s2 = (tab->K[2] > 1) ? M*tab->K[0]*tab->K[1] : 0;
+    offset[0] = M*((p0[2]*tab->K[1] + p0[1])*tab->K[0] + p0[0]);
+    offset[1] = offset[0] + s0;
+    offset[2] = offset[0] + s1;
+    offset[3] = offset[2] + s0;
+    offset[4] = offset[0] + s2;
+    offset[5] = offset[1] + s2;
+    offset[6] = offset[2] + s2;
+    offset[7] = offset[3] + s2;
+
+    g1 = 1.0 - delta[1];
+    g2 = 1.0 - delta[2];
+    wgt[0] = g2*g1*g0;
+    wgt[1] = g2*g1*delta[0];
+    wgt[2] = g2*delta[1]*g0;
+    wgt[3] = g2*delta[1]*delta[0];
+    wgt[4] = delta[2]*g1*g0;
+    wgt[5] = delta[2]*g1*delta[0];
+    wgt[6] = delta[2]*delta[1]*g0;
+    wgt[7] = delta[2]*delta[1]*delta[0];
+
+    for (iv = 0; iv < 8; iv++) {
+      if ((w = wgt[iv]) == 0.0) continue;
+
+      coord = tab->coord + offset[iv];
+      a0 += coord[0] * w;
+      a1 += coord[1] * w;
+      a2 += coord[2] * w;
+
+      if (w == 1.0) break;
+    }
+    break;
+  }
+
+  wp[tab->map[0]] = a0;
+  if (M > 1) wp[tab->map[1]] = a1;
+  if (M > 2) wp[tab->map[2]] = a2;
+}
+
+/*----------------------------------------------------------------------------
+* Add incr to the count of tabprm structs that share a set of index and
+* coordinate arrays, returning the new count.  The update is atomic, or else
+* made under a lock, as copies of a struct may be made and freed in different
+* threads.  Failing both, tabshr() does not share and the count stays at one.
+*---------------------------------------------------------------------------*/
+
+#if !defined(__GNUC__) && defined(HAVE_PTHREAD)
+static pthread_mutex_t tab_refs_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+int tab_refs(int *refs, int incr)
+
+{
+#if defined(__GNUC__)
+  return __sync_add_and_fetch(refs, incr);
+#else
+  int n;
+
+#ifdef HAVE_PTHREAD
+  pthread_mutex_lock(&tab_refs_lock);
+#endif
+
+  n = (*refs += incr);
+
+#ifdef HAVE_PTHREAD
+  pthread_mutex_unlock(&tab_refs_lock);
+#endif
+
+  return n;
+#endif
+}
@@ -50,8 +50,9 @@
 * some members that must be set by the user, and others that are maintained
 * by these routines, somewhat like a C++ class but with no encapsulation.
 *
-* tabini(), tabmem(), tabcpy(), and tabfree() are provided to manage the
-* tabprm struct, and another, tabprt(), to print its contents.
+* tabini(), tabmem(), tabcpy(), tabshr(), tabown(), and tabfree() are
+* provided to manage the tabprm struct, and another, tabprt(), to print its
+* contents.
 *
 * A setup routine, tabset(), computes intermediate values in the tabprm struct
 * from parameters in it that were supplied by the user.  The struct always
@@ -59,6 +60,9 @@
 * to the explanation of tabprm::flag.
 *
 * tabx2s() and tabs2x() implement the WCS tabular coordinate transformations.
+* tabx2sr() and tabs2xr() are reentrant forms of these that take the struct
+* as read-only and keep their scratch state in caller-supplied work arrays so
+* that one tabprm struct may be shared between threads.
 *
 * Accuracy:
 * ---------
@@ -151,7 +155,8 @@
 * tabcpy() does a deep copy of one tabprm struct to another, using tabini() to
 * allocate memory for its arrays if required.  Only the "information to be
 * provided" part of the struct is copied; a call to tabset() is required to
-* set up the remainder.
+* set up the remainder.  Use tabshr() to share the index vectors and
+* coordinate array instead.
 *
 * Given:
 *   alloc     int       If true, allocate memory unconditionally for arrays in
@@ -183,11 +188,73 @@
 *                       wcserr_enable().
 *
 *
+* tabshr() - Copy routine for the tabprm struct, sharing its arrays
+* -----------------------------------------------------------------
+* tabshr() is the same as tabcpy() with alloc true, except that if tabsrc
+* owns its index vectors and coordinate array, i.e. they were allocated by
+* tabini() or taken over by tabset() or tabmem(), tabdst shares them rather
+* than receiving copies, so that copying a large table takes constant time
+* and memory.  Otherwise, or if WCSLIB was compiled without support for
+* atomic operations or POSIX threads, the arrays are copied.
+*
+* The shared arrays are reference-counted and freed by tabfree() on the last
+* struct that uses them, so the copies may be freed in any order and in any
+* thread.  tabsrc itself is not modified.  The shared arrays must be treated
+* as read-only; tabown() must be called on a struct before its index vectors
+* or coordinate array are modified, else the change will be seen by the other
+* structs.
+*
+* Given:
+*   tabsrc    const struct tabprm*
+*                       Struct to copy from.
+*
+* Given and returned:
+*   tabdst    struct tabprm*
+*                       Struct to copy to.  tabprm::flag should be set to -1
+*                       if tabdst was not previously initialized.  Any memory
+*                       previously allocated for it by tabini() is freed.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null tabprm pointer passed.
+*                         2: Memory allocation failed.
+*
+*                       For returns > 1, a detailed error message is set in
+*                       tabprm::err (associated with tabdst) if enabled, see
+*                       wcserr_enable().
+*
+*
+* tabown() - Take sole ownership of the tabprm arrays
+* ---------------------------------------------------
+* tabown() gives a tabprm struct private copies of any index vectors and
+* coordinate array that it shares with copies made by tabshr(), so that they
+* may be modified without affecting the other structs.  It does nothing if
+* the arrays are not shared.
+*
+* Note that tabini() releases shared arrays itself before reinitializing
+* them.
+*
+* Given and returned:
+*   tab       struct tabprm*
+*                       Tabular transformation parameters.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null tabprm pointer passed.
+*                         2: Memory allocation failed.
+*
+*                       For returns > 1, a detailed error message is set in
+*                       tabprm::err if enabled, see wcserr_enable().
+*
+*
 * tabfree() - Destructor for the tabprm struct
 * --------------------------------------------
 * tabfree() frees memory allocated for the tabprm arrays by tabini().
 * tabini() records the memory it allocates and tabfree() will only attempt to
-* free this.
+* free this.  Index vectors and coordinate arrays shared by tabshr() are only
+* freed with the last struct that uses them.
 *
 * PLEASE NOTE: tabfree() must not be invoked on a tabprm struct that was not
 * initialized by tabini().
@@ -220,7 +287,9 @@
 * tabset() - Setup routine for the tabprm struct
 * -----------------------------------------------
 * tabset() allocates memory for work arrays in the tabprm struct and sets up
-* the struct according to information supplied within it.
+* the struct according to information supplied within it.  For
+* multi-dimensional tables this includes the bucket grid used by tabs2x() to
+* search the coordinate array (see tabprm::grid).
 *
 * Note that this routine need not be called directly; it will be invoked by
 * tabx2s() and tabs2x() if tabprm::flag is anything other than a predefined
@@ -234,6 +303,7 @@
 *             int       Status return value:
 *                         0: Success.
 *                         1: Null tabprm pointer passed.
+*                         2: Memory allocation failed.
 *                         3: Invalid tabular parameters.
 *
 *                       For returns > 1, a detailed error message is set in
@@ -282,6 +352,10 @@
 * ----------------------------------------
 * tabs2x() transforms world coordinates to intermediate world coordinates.
 *
+* World coordinates that lie beyond the edges of the coordinate array, but
+* within half a voxel of them, are obtained by linear extrapolation of the
+* edge voxels.  For multi-dimensional tables this is done for M <= 8 only.
+*
 * Given and returned:
 *   tab       struct tabprm*
 *                       Tabular transformation parameters.
@@ -313,6 +387,107 @@
 *                       tabprm::err if enabled, see wcserr_enable().
 *
 *
+* tabx2sr() - Reentrant pixel-to-world transformation
+* ---------------------------------------------------
+* tabx2sr() is a reentrant form of tabx2s().  The tabprm struct is not
+* modified; the indices and increments normally returned in tabprm::p0 and
+* tabprm::delta are written to work arrays supplied by the caller instead.
+* Unlike tabx2s(), tabx2sr() will not invoke tabset(), the struct must
+* already have been set up.
+*
+* Given:
+*   tab       const struct tabprm*
+*                       Tabular transformation parameters, set up by
+*                       tabset().
+*
+*   ncoord,
+*   nelem     int       The number of coordinates, each of vector length
+*                       nelem.
+*
+*   x         const double[ncoord][nelem]
+*                       Array of intermediate world coordinates, SI units.
+*
+* Returned:
+*   world     double[ncoord][nelem]
+*                       Array of world coordinates, in SI units.
+*
+*   stat      int[ncoord]
+*                       Status return value status for each coordinate:
+*                         0: Success.
+*                         1: Invalid intermediate world coordinate.
+*
+*   p0        int[M+1]  Work array used in place of tabprm::p0.
+*
+*   delta     double[M] Work array used in place of tabprm::delta.
+*
+*   err       struct wcserr **
+*                       If enabled, for function return values > 1, this
+*                       struct will contain a detailed error message, see
+*                       wcserr_enable().  May be NULL if an error message is
+*                       not desired.  Otherwise, the user is responsible for
+*                       deleting the memory allocated for the wcserr struct.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null tabprm pointer passed.
+*                         3: Invalid tabular parameters, or the tabprm struct
+*                            has not been set up.
+*                         4: One or more of the x coordinates were invalid,
+*                            as indicated by the stat vector.
+*
+*
+* tabs2xr() - Reentrant world-to-pixel transformation
+* ---------------------------------------------------
+* tabs2xr() is a reentrant form of tabs2x().  The tabprm struct is not
+* modified and no memory is allocated; scratch state is kept in work arrays
+* supplied by the caller.  The struct must already have been set up by
+* tabset().
+*
+* Given:
+*   tab       const struct tabprm*
+*                       Tabular transformation parameters, set up by
+*                       tabset().
+*
+*   ncoord,
+*   nelem     int       The number of coordinates, each of vector length
+*                       nelem.
+*   world     const double[ncoord][nelem]
+*                       Array of world coordinates, in SI units.
+*
+* Returned:
+*   x         double[ncoord][nelem]
+*                       Array of intermediate world coordinates, SI units.
+*   stat      int[ncoord]
+*                       Status return value status for each vector element:
+*                         0: Success.
+*                         1: Invalid world coordinate.
+*
+*   p0        int[M+1]  Work array used in place of tabprm::p0.
+*
+*   delta     double[M] Work array used in place of tabprm::delta.
+*
+*   tabcoord  double*[2**M]
+*                       Work array of pointers used for multi-dimensional
+*                       tables (M > 1); may be NULL if M == 1.
+*
+*   err       struct wcserr **
+*                       If enabled, for function return values > 1, this
+*                       struct will contain a detailed error message, see
+*                       wcserr_enable().  May be NULL if an error message is
+*                       not desired.  Otherwise, the user is responsible for
+*                       deleting the memory allocated for the wcserr struct.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null tabprm pointer passed.
+*                         3: Invalid tabular parameters, or the tabprm struct
+*                            has not been set up.
+*                         5: One or more of the world coordinates were
+*                            invalid, as indicated by the stat vector.
+*
+*
 * tabprm struct - Tabular transformation parameters
 * -------------------------------------------------
 * The tabprm struct contains information required to transform tabular
@@ -438,6 +613,23 @@
 *     compressed K_1 dimension, then the maximum.  This array is used by the
 *     inverse table lookup function, tabs2x(), to speed up table searches.
 *
+*   int *grid
+*     (Returned) For multi-dimensional tables (M > 1), pointer to the first
+*     element of a bucket grid that divides the range of each element of the
+*     coordinate vector into cells, about as many in all as there are voxels
+*     in the coordinate array.  The first M elements record the number of
+*     cells on each axis, followed by a list of the voxels whose extent
+*     overlaps each cell.  tabs2x() uses this to search only those voxels
+*     that might contain a world coordinate, so that its cost is more or less
+*     independent of the size of the table.  If NULL, as for
+*     one-dimensional tables, tabs2x() searches the coordinate array
+*     exhaustively.
+*
+*   double *gridbox
+*     (Returned) Pointer to the first element of an array of length 3*M that
+*     records the lower and upper bounds of the bucket grid for each element
+*     of the coordinate vector, then its number of cells per unit.
+*
 *   struct wcserr *err
 *     (Returned) If enabled, when an error status is returned this struct
 *     contains detailed information about the error, see wcserr_enable().
@@ -462,6 +654,8 @@
 *     (For internal use only.)
 *   int m_coord
 *     (For internal use only.)
+*   int m_refs
+*     (For internal use only.)
 *
 *
 * Global variable: const char *tab_errmsg[] - Status return messages
@@ -528,6 +722,9 @@ struct tabprm {
   double *delta;		/* Vector of M increments.                  */
   double *extrema;		/* (1+M)-dimensional array of coordinate    */
 				/* extrema.                                 */
+  int    *grid;			/* Bucket grid of the voxels of the         */
+				/* coordinate array.                        */
+  double *gridbox;		/* Bounds and scale of the bucket grid.     */
 
   /* Error handling                                                         */
   /*------------------------------------------------------------------------*/
@@ -539,6 +736,7 @@ struct tabprm {
   int    set_M;
   int    *m_K, *m_map;
   double *m_crval, **m_index, **m_indxs, *m_coord;
+  int    *m_refs;
 };
 
 /* Size of the tabprm struct in int units, used by the Fortran wrappers. */
@@ -551,6 +749,10 @@ int tabmem(struct tabprm *tab);
 
 int tabcpy(int alloc, const struct tabprm *tabsrc, struct tabprm *tabdst);
 
+int tabshr(const struct tabprm *tabsrc, struct tabprm *tabdst);
+
+int tabown(struct tabprm *tab);
+
 int tabfree(struct tabprm *tab);
 
 int tabprt(const struct tabprm *tab);
@@ -563,6 +765,14 @@ int tabx2s(struct tabprm *tab, int ncoord, int nelem, const double x[],
 int tabs2x(struct tabprm *tab, int ncoord, int nelem, const double world[],
            double x[], int stat[]);
 
+int tabx2sr(const struct tabprm *tab, int ncoord, int nelem, const double x[],
+            double world[], int stat[], int p0[], double delta[],
+            struct wcserr **err);
+
+int tabs2xr(const struct tabprm *tab, int ncoord, int nelem,
+            const double world[], double x[], int stat[], int p0[],
+            double delta[], double *tabcoord[], struct wcserr **err);
+
 
 /* Deprecated. */
 #define tabini_errmsg tab_errmsg
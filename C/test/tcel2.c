@@ -569,9 +569,14 @@ int main()
         crval2_i  = 45;
       }
     }
+
+    celfree(&native);
+    celfree(&celestial);
   }
 
 end:
+  celfree(&native);
+  celfree(&celestial);
   cpgask(0);
   cpgend();
 
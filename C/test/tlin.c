@@ -25,10 +25,14 @@
   $Id: tlin.c,v 4.22 2014/04/12 15:03:53 mcalabre Exp $
 *=============================================================================
 *
-*  tlin tests the linear transformation routines supplied with WCSLIB.
+*  tlin tests the linear transformation routines supplied with WCSLIB,
+*  including the single-precision forms, linp2xf() and linx2pf(), the
+*  fixed-dimension forms used for two to four axes, and the row form,
+*  linp2xr().
 *
 *---------------------------------------------------------------------------*/
 
+#include <float.h>
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -52,12 +56,17 @@ double pix0[2][9] = {{303.0, 265.0, 112.4, 144.5,  28.2, 0.0, 0.0, 0.0, 0.0},
 
 const double tol = 1.0e-13;
 
+/* Row length for linp2xr(). */
+#define NROW 1000
+double rowimg[NROW][9], rowpix[NROW][9];
+
 
 int main()
 
 {
-  int i, j, k, nFail, status;
-  double img[2][9], *pcij, pix[2][9], resid, residmax;
+  int i, iaxis, j, k, n, nFail, status;
+  float  imgf[2][9], pixf[2][9];
+  double img[2][9], *pcij, pix[2][9], ref, resid, residmax, tolf;
   struct linprm lin;
 
 
@@ -66,7 +75,7 @@ int main()
 
   /* List status return messages. */
   printf("\nList of lin status return values:\n");
-  for (status = 1; status <= 3; status++) {
+  for (status = 1; status <= 4; status++) {
     printf("%4d: %s.\n", status, lin_errmsg[status]);
   }
 
@@ -133,9 +142,128 @@ int main()
   printf("\nlinp2x/linx2p: Maximum closure residual = %.1e pixel.\n",
     residmax);
 
+  /* Single precision, compared with double precision applied to the same */
+  /* coordinates.                                                         */
+  for (k = 0; k < NCOORD; k++) {
+    for (j = 0; j < NELEM; j++) {
+      pixf[k][j] = (float)pix0[k][j];
+      pix[k][j]  = pixf[k][j];
+    }
+  }
+
+  if ((status = linp2xf(&lin, NCOORD, NELEM, pixf[0], imgf[0])) ||
+      (status = linp2x(&lin, NCOORD, NELEM, pix[0], img[0]))) {
+    printf("linp2xf ERROR %d\n", status);
+    return 1;
+  }
+
+  for (k = 0; k < NCOORD; k++) {
+    for (j = 0; j < NAXIS; j++) {
+      tolf = FLT_EPSILON*(fabs(img[k][j]) > 1.0 ? fabs(img[k][j]) : 1.0);
+      if (fabs(imgf[k][j] - img[k][j]) > tolf) nFail++;
+      img[k][j] = imgf[k][j];
+    }
+  }
+
+  if ((status = linx2pf(&lin, NCOORD, NELEM, imgf[0], pixf[0])) ||
+      (status = linx2p(&lin, NCOORD, NELEM, img[0], pix[0]))) {
+    printf("linx2pf ERROR %d\n", status);
+    return 1;
+  }
+
+  for (k = 0; k < NCOORD; k++) {
+    for (j = 0; j < NAXIS; j++) {
+      tolf = FLT_EPSILON*(fabs(pix[k][j]) > 1.0 ? fabs(pix[k][j]) : 1.0);
+      if (fabs(pixf[k][j] - pix[k][j]) > tolf) nFail++;
+    }
+  }
+
   linfree(&lin);
 
 
+  /* Two to four axes, using the leading elements of the above. */
+  for (n = 2; n <= 4; n++) {
+    lin.flag = -1;
+    linini(1, n, &lin);
+
+    for (i = 0; i < n; i++) {
+      lin.crpix[i] = CRPIX[i];
+      for (j = 0; j < n; j++) {
+        lin.pc[i*n + j] = PC[i][j];
+      }
+      lin.cdelt[i] = CDELT[i];
+    }
+
+    if ((status = linp2x(&lin, NCOORD, NELEM, pix0[0], img[0])) ||
+        (status = linx2p(&lin, NCOORD, NELEM, img[0], pix[0]))) {
+      printf("linp2x/linx2p ERROR %d for NAXIS = %d\n", status, n);
+      return 1;
+    }
+
+    residmax = 0.0;
+    for (k = 0; k < NCOORD; k++) {
+      for (i = 0; i < n; i++) {
+        ref = 0.0;
+        for (j = 0; j < n; j++) {
+          ref += lin.piximg[i*n + j] * (pix0[k][j] - CRPIX[j]);
+        }
+
+        if (fabs(img[k][i] - ref) > tol*(fabs(ref) > 1.0 ? fabs(ref) : 1.0)) {
+          nFail++;
+        }
+
+        resid = fabs(pix[k][i] - pix0[k][i]);
+        if (residmax < resid) residmax = resid;
+        if (resid > tol) nFail++;
+      }
+    }
+
+    printf("NAXIS = %d: Maximum closure residual = %.1e pixel.\n", n,
+      residmax);
+
+    /* Rows along each axis, relative to the magnitude of the result. */
+    residmax = 0.0;
+    for (iaxis = 0; iaxis < n; iaxis++) {
+      for (k = 0; k < NROW; k++) {
+        for (j = 0; j < NELEM; j++) {
+          rowpix[k][j] = pix0[1][j];
+        }
+        rowpix[k][iaxis] += k;
+      }
+
+      if ((status = linp2xr(&lin, NROW, NELEM, iaxis, rowpix[0],
+                            rowimg[0])) ||
+          (status = linp2x(&lin, NROW, NELEM, rowpix[0], rowpix[0]))) {
+        printf("linp2xr ERROR %d for NAXIS = %d\n", status, n);
+        return 1;
+      }
+
+      for (k = 0; k < NROW; k++) {
+        for (i = 0; i < n; i++) {
+          ref = fabs(rowpix[k][i]);
+          resid = fabs(rowimg[k][i] - rowpix[k][i]) / (ref > 1.0 ? ref : 1.0);
+          if (residmax < resid) residmax = resid;
+          if (resid > 1.0e-12) nFail++;
+        }
+      }
+    }
+
+    printf("NAXIS = %d: Maximum linp2xr discrepancy = %.1e.\n", n,
+      residmax);
+
+    /* The row must lie along one of the pixel axes. */
+    if (linp2xr(&lin, NROW, NELEM, -1, rowpix[0], rowimg[0]) !=
+          LINERR_BAD_PARAM ||
+        linp2xr(&lin, NROW, NELEM, n, rowpix[0], rowimg[0]) !=
+          LINERR_BAD_PARAM) {
+      printf("linp2xr did not reject an invalid iaxis for NAXIS = %d\n", n);
+      nFail++;
+    }
+
+    linfree(&lin);
+  }
+
+
   if (nFail) {
     printf("\nFAIL: %d closure residuals exceed reporting tolerance.\n",
       nFail);
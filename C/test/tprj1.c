@@ -39,6 +39,9 @@
 
 int projex(char pcode[4], struct prjprm *prj, int north, int south,
            double tol);
+int simdex(char pcode[4], struct prjprm *prj, double tol);
+int tabex(char pcode[4], struct prjprm *prj, double tol);
+int hpxex(int nside, struct prjprm *prj, double tol);
 
 int main()
 
@@ -99,6 +102,7 @@ int main()
   prj.pv[7] = -0.00019;
   prj.pv[8] =  0.00000;
   prj.pv[9] =  0.00000;
+  nFail += tabex("ZPN", &prj, 1.0e-10);
   nFail += projex("ZPN", &prj, 90, 10, tol);
 
   /* ZEA: zenithal/azimuthal equal area. */
@@ -106,6 +110,7 @@ int main()
 
   /* AIR: Airy's zenithal projection. */
   prj.pv[1] = 45.0;
+  nFail += tabex("AIR", &prj, 1.0e-9);
   nFail += projex("AIR", &prj, 90, -85, tol);
 
   /* CYP: cylindrical perspective. */
@@ -130,6 +135,7 @@ int main()
   nFail += projex("PAR", &prj, 90, -90, tol);
 
   /* MOL: Mollweide's projection. */
+  nFail += tabex("MOL", &prj, 1.0e-10);
   nFail += projex("MOL", &prj, 90, -90, tol);
 
   /* AIT: Hammer-Aitoff. */
@@ -160,6 +166,7 @@ int main()
   nFail += projex("BON", &prj, 90, -90, tol);
 
   /* PCO: polyconic. */
+  nFail += tabex("PCO", &prj, 1.0e-10);
   nFail += projex("PCO", &prj, 90, -90, tol);
 
   /* TSC: tangential spherical cube. */
@@ -179,6 +186,69 @@ int main()
   /* XPH: HEALPix polar, aka "butterfly" projection. */
   nFail += projex("XPH", &prj, 90, -90, tol);
 
+  /* HEALPix pixel indices. */
+  printf("\n");
+  prjini(&prj);
+  strcpy(prj.code, "HPX");
+  prj.pv[1] = 4.0;
+  prj.pv[2] = 3.0;
+  nFail += hpxex(1, &prj, 1.0e-10);
+  nFail += hpxex(2, &prj, 1.0e-10);
+  nFail += hpxex(3, &prj, 1.0e-10);
+  nFail += hpxex(64, &prj, 1.0e-10);
+  nFail += hpxex(1000, &prj, 1.0e-10);
+  nFail += hpxex(1 << 29, &prj, 1.0e-10);
+  strcpy(prj.code, "XPH");
+  prj.flag = 0;
+  nFail += hpxex(16, &prj, 1.0e-10);
+  prjfree(&prj);
+
+
+  /* Compare the SIMD kernels with the scalar code. */
+  if (prjsimd(-1)) {
+    printf("\n");
+    prjini(&prj);
+    prj.pv[1] = 0.0;
+    prj.pv[2] = 0.0;
+    nFail += simdex("TAN", &prj, 1.0e-10);
+    nFail += simdex("STG", &prj, 1.0e-10);
+    nFail += simdex("SIN", &prj, 1.0e-10);
+    nFail += simdex("ARC", &prj, 1.0e-10);
+    nFail += simdex("ZEA", &prj, 1.0e-10);
+    nFail += simdex("TSC", &prj, 1.0e-10);
+    nFail += simdex("QSC", &prj, 1.0e-10);
+
+    /* Likewise with reduced-accuracy trigonometric functions, except for */
+    /* the quadcubes whose face may differ on the boundaries.             */
+    printf("\nWith reduced-accuracy trigonometric functions:\n");
+    prj.fast = 1;
+    nFail += simdex("TAN", &prj, 1.0e-8);
+    nFail += simdex("STG", &prj, 1.0e-8);
+    nFail += simdex("SIN", &prj, 1.0e-8);
+    nFail += simdex("ARC", &prj, 1.0e-8);
+    nFail += simdex("ZEA", &prj, 1.0e-8);
+
+    /* Closure to within the accuracy promised for wcsprm::accuracy, which */
+    /* allows for ill-conditioning; projex() reinitializes prj.            */
+    prj.fast = 1;
+    nFail += projex("TAN", &prj, 90,   5, 1.0e-7);
+    prj.fast = 1;
+    nFail += projex("STG", &prj, 90, -85, 1.0e-7);
+    prj.fast = 1;
+    nFail += projex("SIN", &prj, 90,  10, 1.0e-7);
+    prj.fast = 1;
+    nFail += projex("ARC", &prj, 90, -90, 1.0e-7);
+    prj.fast = 1;
+    nFail += projex("ZEA", &prj, 90, -85, 1.0e-7);
+    prj.fast = 1;
+    nFail += projex("TSC", &prj, 90, -90, 1.0e-7);
+    prj.fast = 1;
+    nFail += projex("QSC", &prj, 90, -90, 1.0e-7);
+    prjfree(&prj);
+  } else {
+    printf("\nSIMD kernels not available, comparison skipped.\n");
+  }
+
 
   if (nFail) {
     printf("\nFAIL: %d closure residuals exceed reporting tolerance.\n",
@@ -343,7 +413,475 @@ int projex(
     printf("             Maximum residual (ref):  dR%8.1e\n", drmax);
   }
 
+  prjfree(prj);
   prjini(prj);
 
   return nFail;
 }
+
+/*----------------------------------------------------------------------------
+*   simdex() compares the results of the SIMD kernels with those of the
+*   scalar code on the 1 degree graticule, in grid mode with interleaved
+*   (x,y), and on its inverse, including points beyond the boundary of the
+*   projection, in vector mode.
+*
+*   Given:
+*      pcode[4]  char     Projection code.
+*      tol       double   Reporting tolerance, degrees for (phi,theta), and
+*                         relative to max(1,r) for (x,y).
+*
+*   Given and returned:
+*      prj       prjprm*  Projection parameters.
+*
+*   Function return value:
+*                int      Number of results exceeding reporting tolerance,
+*                         or with differing status values.
+*---------------------------------------------------------------------------*/
+
+int simdex(
+  char pcode[4],
+  struct prjprm *prj,
+  double tol)
+
+{
+  int    nFail = 0, nStat = 0, status[2];
+  register int i, j, k;
+  int    *stat[2];
+  double d, dmax = 0.0, r, *phi[2], *theta[2], *xy[2];
+  const int nphi = 361, ntheta = 181, ncoord = 361*181;
+
+  strcpy(prj->code, pcode);
+  prj->flag = 0;
+  prjset(prj);
+
+  printf("Comparing SIMD kernels for %s with the scalar code, reporting "
+    "tolerance%8.1e.\n", pcode, tol);
+
+  for (k = 0; k < 2; k++) {
+    phi[k]   = malloc(ncoord*sizeof(double));
+    theta[k] = malloc(ncoord*sizeof(double));
+    xy[k]    = malloc(2*ncoord*sizeof(double));
+    stat[k]  = malloc(ncoord*sizeof(int));
+  }
+
+  for (i = 0; i < nphi; i++) {
+    phi[0][i] = (double)(i - 180);
+  }
+  for (j = 0; j < ntheta; j++) {
+    theta[0][j] = (double)(90 - j);
+  }
+
+  /* Spherical-to-Cartesian, k = 0 for SIMD, 1 for scalar. */
+  for (k = 0; k < 2; k++) {
+    prjsimd(k == 0);
+    status[k] = prj->prjs2x(prj, nphi, ntheta, 1, 2, phi[0], theta[0],
+                            xy[k], xy[k]+1, stat[k]);
+  }
+
+  if (status[0] != status[1]) nStat++;
+  for (i = 0; i < ncoord; i++) {
+    if (stat[0][i] != stat[1][i]) nStat++;
+    r = sqrt(xy[1][2*i]*xy[1][2*i] + xy[1][2*i+1]*xy[1][2*i+1]);
+    if (r < 1.0) r = 1.0;
+    for (j = 0; j < 2; j++) {
+      d = fabs(xy[0][2*i+j] - xy[1][2*i+j])/r;
+      if (d > dmax) dmax = d;
+    }
+  }
+
+  printf("  (x,y):       maximum relative difference%8.1e.\n", dmax);
+  if (dmax > tol) nFail++;
+
+  /* Cartesian-to-spherical, scaling every fourth point outwards. */
+  for (i = 0; i < ncoord; i++) {
+    if (stat[1][i]) {
+      xy[1][2*i]   = 0.0;
+      xy[1][2*i+1] = 0.0;
+    } else if (i%4 == 3) {
+      xy[1][2*i]   *= 1.5;
+      xy[1][2*i+1] *= 1.5;
+    }
+  }
+
+  for (k = 0; k < 2; k++) {
+    prjsimd(k == 0);
+    for (i = 0; i < ncoord; i++) {
+      theta[k][i] = 999.0;
+    }
+    status[k] = prj->prjx2s(prj, ncoord, 0, 2, 1, xy[1], xy[1]+1, phi[k],
+                            theta[k], stat[k]);
+  }
+  prjsimd(1);
+
+  dmax = 0.0;
+  if (status[0] != status[1]) nStat++;
+  for (i = 0; i < ncoord; i++) {
+    if (stat[0][i] != stat[1][i]) nStat++;
+    d = fabs(phi[0][i] - phi[1][i]);
+    if (d > dmax) dmax = d;
+    d = fabs(theta[0][i] - theta[1][i]);
+    if (d > dmax) dmax = d;
+  }
+
+  printf("  (phi,theta): maximum difference%8.1e deg.\n", dmax);
+  if (dmax > tol) nFail++;
+
+  if (nStat) {
+    printf("  %d status values differ.\n", nStat);
+    nFail += nStat;
+  }
+
+  for (k = 0; k < 2; k++) {
+    free(phi[k]);
+    free(theta[k]);
+    free(xy[k]);
+    free(stat[k]);
+  }
+
+  return nFail;
+}
+
+/*----------------------------------------------------------------------------
+*   tabex() compares the results of those projections whose inverse is
+*   tabulated by the initialization routine with those of the iterative
+*   solution, obtained by setting prj->m to zero.  The comparison is made for
+*   the deprojection of the projected 1 degree graticule, except for MOL,
+*   whose table serves the projection, and for which it is made between
+*   latitudes +60 and -60 where the iterative solution is precise.  Finally,
+*   the struct is set up for TAN and then again for pcode, checking that the
+*   table is released and recomputed (leaks being detected by running under a
+*   leak checker).
+*
+*   Given:
+*      pcode[4]  char     Projection code.
+*      tol       double   Reporting tolerance, degrees for (phi,theta), and
+*                         relative to r0 for (x,y).
+*
+*   Given and returned:
+*      prj       prjprm*  Projection parameters, pv[] already set.
+*
+*   Function return value:
+*                int      Number of results exceeding reporting tolerance,
+*                         or with differing status values.
+*---------------------------------------------------------------------------*/
+
+int tabex(
+  char pcode[4],
+  struct prjprm *prj,
+  double tol)
+
+{
+  int    m, mol, nFail = 0, nStat = 0;
+  register int i, j, k;
+  int    *stat[2];
+  double d, dmax = 0.0, *phi[2], phi0, pv[PVN], *theta[2], theta0, *x[2],
+         *y[2];
+  const int nphi = 361, ntheta = 181, ncoord = 361*181;
+
+  strcpy(prj->code, pcode);
+  prj->flag = 0;
+  if (prjset(prj)) {
+    printf("\nFAIL: prjset() failed for %s.\n", pcode);
+    return 1;
+  }
+
+  printf("\nComparing the tabulated inverse for %s with the iterative "
+    "solution, reporting\ntolerance%8.1e.\n", pcode, tol);
+  if (prj->m == 0) {
+    printf("  No table was computed.\n");
+    nFail++;
+  }
+
+  for (k = 0; k < 2; k++) {
+    phi[k]   = malloc(ncoord*sizeof(double));
+    theta[k] = malloc(ncoord*sizeof(double));
+    x[k]     = malloc(ncoord*sizeof(double));
+    y[k]     = malloc(ncoord*sizeof(double));
+    stat[k]  = malloc(ncoord*sizeof(int));
+  }
+
+  for (j = 0, k = 0; j < ntheta; j++) {
+    for (i = 0; i < nphi; i++, k++) {
+      phi[0][k]   = (double)(i - 180);
+      theta[0][k] = (double)(90 - j);
+    }
+  }
+
+  /* k = 0 for the table, 1 for the iterative solution. */
+  m = prj->m;
+  mol = (strcmp(pcode, "MOL") == 0);
+  if (mol) {
+    for (k = 0; k < 2; k++) {
+      prj->m = k ? 0 : m;
+      prj->prjs2x(prj, ncoord, 0, 1, 1, phi[0], theta[0], x[k], y[k],
+                  stat[k]);
+    }
+
+    for (i = 0; i < ncoord; i++) {
+      if (stat[0][i] != stat[1][i]) {
+        nStat++;
+      } else if (stat[0][i] == 0 && fabs(theta[0][i]) <= 60.0) {
+        d = fabs(x[0][i] - x[1][i])/prj->r0;
+        if (d > dmax) dmax = d;
+        d = fabs(y[0][i] - y[1][i])/prj->r0;
+        if (d > dmax) dmax = d;
+      }
+    }
+
+    printf("  (x,y):       maximum relative difference%8.1e.\n", dmax);
+
+  } else {
+    prj->m = m;
+    prj->prjs2x(prj, ncoord, 0, 1, 1, phi[0], theta[0], x[0], y[0], stat[0]);
+
+    for (k = 0; k < 2; k++) {
+      prj->m = k ? 0 : m;
+      prj->prjx2s(prj, ncoord, 0, 1, 1, x[0], y[0], phi[k], theta[k],
+                  stat[k]);
+    }
+
+    for (i = 0; i < ncoord; i++) {
+      if (stat[0][i] != stat[1][i]) {
+        nStat++;
+      } else if (stat[0][i] == 0) {
+        d = fabs(phi[0][i] - phi[1][i]);
+        if (d > dmax) dmax = d;
+        d = fabs(theta[0][i] - theta[1][i]);
+        if (d > dmax) dmax = d;
+      }
+    }
+
+    printf("  (phi,theta): maximum difference%8.1e deg.\n", dmax);
+  }
+  prj->m = m;
+
+  if (dmax > tol) nFail++;
+
+  if (nStat) {
+    printf("  %d status values differ.\n", nStat);
+    nFail += nStat;
+  }
+
+  for (k = 0; k < 2; k++) {
+    free(phi[k]);
+    free(theta[k]);
+    free(x[k]);
+    free(y[k]);
+    free(stat[k]);
+  }
+
+  /* Recoding the projection must release the table, and reverting it */
+  /* must recompute it.                                                */
+  for (k = 0; k < PVN; k++) pv[k] = prj->pv[k];
+  phi0   = prj->phi0;
+  theta0 = prj->theta0;
+  strcpy(prj->code, "TAN");
+  prj->phi0   =  0.0;
+  prj->theta0 = 90.0;
+  prj->flag = 0;
+  if (prjset(prj) || prj->wtab || prj->m) {
+    printf("  prjset() did not release the table for TAN.\n");
+    nFail++;
+  }
+
+  strcpy(prj->code, pcode);
+  for (k = 0; k < PVN; k++) prj->pv[k] = pv[k];
+  prj->phi0   = phi0;
+  prj->theta0 = theta0;
+  prj->flag = 0;
+  if (prjset(prj) || prj->wtab == 0x0 || prj->m != m) {
+    printf("  The table was not recomputed by prjset().\n");
+    nFail++;
+  }
+
+  return nFail;
+}
+
+/*----------------------------------------------------------------------------
+*   hpxex() exercises hpxs2p() and hpxp2s().  The RING pixel centres are
+*   checked against the defining equations of Gorski et al. (2005), with
+*   the latitude in the polar caps in half-angle form for precision, and the
+*   NESTED pixel centres, by computing their RING indices.  Both schemes are
+*   checked for closure on the pixel centres, and the SIMD and scalar results
+*   are compared for pseudo-random points.  All pixels are tested for small
+*   nside, otherwise those nearest the poles and a uniform sample of the rest.
+*
+*   Given:
+*      nside     int      Resolution parameter, NESTED tests are made only if
+*                         it is a power of 2.
+*      tol       double   Reporting tolerance, degrees.
+*
+*   Given and returned:
+*      prj       prjprm*  Projection parameters.
+*
+*   Function return value:
+*                int      Number of results exceeding reporting tolerance,
+*                         or with incorrect pixel indices.
+*---------------------------------------------------------------------------*/
+
+int hpxex(
+  int nside,
+  struct prjprm *prj,
+  double tol)
+
+{
+  int    nFail = 0, nPix = 0, nested, *stat;
+  register int i, k;
+  long   ir, j, *ipix, *jpix, *kpix, ncap, npix, nsidel, pix;
+  double d, dmax = 0.0, ns, *phi, *phi2, phic, *theta, *theta2, thetac;
+  const int nsamp = 12000;
+
+  nsidel = nside;
+  npix = 12*nsidel*nsidel;
+  ncap = 2*nsidel*(nsidel - 1);
+  ns   = nside;
+  nested = !(nside & (nside - 1));
+
+  printf("Testing %s pixel indices for nside =%10d, reporting tolerance"
+    "%8.1e.\n", prj->code, nside, tol);
+
+  ipix   = malloc(nsamp*sizeof(long));
+  jpix   = malloc(nsamp*sizeof(long));
+  kpix   = malloc(nsamp*sizeof(long));
+  phi    = malloc(nsamp*sizeof(double));
+  theta  = malloc(nsamp*sizeof(double));
+  phi2   = malloc(nsamp*sizeof(double));
+  theta2 = malloc(nsamp*sizeof(double));
+  stat   = malloc(nsamp*sizeof(int));
+
+  for (i = 0; i < nsamp; i++) {
+    if (npix <= nsamp) {
+      ipix[i] = i%npix;
+    } else if (i < nsamp/4) {
+      ipix[i] = i;
+    } else if (i < nsamp/2) {
+      ipix[i] = npix - nsamp/2 + i;
+    } else {
+      ipix[i] = (long)((npix - 1)*((i - nsamp/2)/(nsamp/2 - 1.0)));
+      if (ipix[i] >= npix) ipix[i] = npix - 1;
+    }
+  }
+
+  /* RING pixel centres. */
+  if (hpxp2s(prj, nside, 0, nsamp, 1, 1, ipix, phi, theta, stat)) {
+    printf("  hpxp2s() failed for the RING scheme.\n");
+    nFail++;
+  }
+
+  for (i = 0; i < nsamp; i++) {
+    pix = ipix[i];
+    if (pix < ncap) {
+      /* North polar cap, ring ir counted from the north pole. */
+      ir = (long)sqrt(pix/2.0);
+      while (2*ir*(ir + 1) <= pix) ir++;
+      while (ir > 1 && 2*ir*(ir - 1) > pix) ir--;
+      j = pix - 2*ir*(ir - 1);
+      thetac = 90.0 - 2.0*asind(ir/(ns*sqrt(6.0)));
+      phic = (j + 0.5)*90.0/ir;
+
+    } else if (pix < npix - ncap) {
+      /* Equatorial region. */
+      ir = (pix - ncap)/(4*nsidel) + nsidel;
+      j  = (pix - ncap)%(4*nsidel);
+      thetac = asind((2.0*ns - ir)/(1.5*ns));
+      phic = (j + ((ir - nsidel)%2 ? 0.0 : 0.5))*90.0/ns;
+
+    } else {
+      /* South polar cap, ring ir counted from the south pole. */
+      pix = npix - pix;
+      ir = (long)sqrt(pix/2.0);
+      while (2*ir*(ir + 1) < pix) ir++;
+      while (ir > 1 && 2*ir*(ir - 1) >= pix) ir--;
+      j = 4*ir - (pix - 2*ir*(ir - 1));
+      thetac = 2.0*asind(ir/(ns*sqrt(6.0))) - 90.0;
+      phic = (j + 0.5)*90.0/ir;
+    }
+
+    if (phic > 180.0) phic -= 360.0;
+    d = fabs(phi[i] - phic);
+    if (d > dmax) dmax = d;
+    d = fabs(theta[i] - thetac);
+    if (d > dmax) dmax = d;
+  }
+
+  printf("  RING centres:   maximum difference%8.1e deg.\n", dmax);
+  if (dmax > tol) nFail++;
+
+  /* RING closure. */
+  hpxs2p(prj, nside, 0, nsamp, 0, 1, 1, phi, theta, jpix, stat);
+  for (i = 0; i < nsamp; i++) {
+    if (jpix[i] != ipix[i]) nPix++;
+  }
+
+  if (nested) {
+    /* NESTED pixel centres and closure. */
+    hpxp2s(prj, nside, 1, nsamp, 1, 1, ipix, phi, theta, stat);
+    hpxs2p(prj, nside, 1, nsamp, 0, 1, 1, phi, theta, jpix, stat);
+    for (i = 0; i < nsamp; i++) {
+      if (jpix[i] != ipix[i]) nPix++;
+    }
+
+    /* The centres of NESTED pixels are RING pixel centres. */
+    dmax = 0.0;
+    hpxs2p(prj, nside, 0, nsamp, 0, 1, 1, phi, theta, kpix, stat);
+    hpxp2s(prj, nside, 0, nsamp, 1, 1, kpix, phi2, theta2, stat);
+    for (i = 0; i < nsamp; i++) {
+      d = fabs(phi[i] - phi2[i]);
+      if (d > dmax) dmax = d;
+      d = fabs(theta[i] - theta2[i]);
+      if (d > dmax) dmax = d;
+    }
+
+    printf("  NESTED centres: maximum difference%8.1e deg.\n", dmax);
+    if (dmax > tol) nFail++;
+  }
+
+  if (nPix) {
+    printf("  %d pixel indices failed closure.\n", nPix);
+    nFail += nPix;
+  }
+
+  /* Compare SIMD and scalar results for pseudo-random points. */
+  if (prjsimd(-1)) {
+    nPix = 0;
+    for (i = 0; i < nsamp; i++) {
+      phi[i]   = 720.0*((i*7919)%nsamp)/nsamp - 360.0;
+      theta[i] = asind(2.0*((i*104729L)%nsamp + 0.5)/nsamp - 1.0);
+    }
+
+    for (k = 0; k <= nested; k++) {
+      prjsimd(0);
+      hpxs2p(prj, nside, k, nsamp, 0, 1, 1, phi, theta, jpix, stat);
+      hpxp2s(prj, nside, k, nsamp, 1, 1, jpix, phi2, theta2, stat);
+      prjsimd(1);
+      hpxs2p(prj, nside, k, nsamp, 0, 1, 1, phi, theta, kpix, stat);
+      hpxp2s(prj, nside, k, nsamp, 1, 1, kpix, phi, theta, stat);
+
+      for (i = 0; i < nsamp; i++) {
+        if (jpix[i] != kpix[i] || fabs(phi[i] - phi2[i]) > tol ||
+            fabs(theta[i] - theta2[i]) > tol) nPix++;
+      }
+
+      for (i = 0; i < nsamp; i++) {
+        phi[i]   = 720.0*((i*7919)%nsamp)/nsamp - 360.0;
+        theta[i] = asind(2.0*((i*104729L)%nsamp + 0.5)/nsamp - 1.0);
+      }
+    }
+
+    if (nPix) {
+      printf("  %d SIMD results differ.\n", nPix);
+      nFail += nPix;
+    }
+  }
+
+  free(ipix);
+  free(jpix);
+  free(kpix);
+  free(phi);
+  free(theta);
+  free(phi2);
+  free(theta2);
+  free(stat);
+
+  return nFail;
+}
@@ -467,6 +467,7 @@ struct prjprm *prj;
   cpgask(1);
   cpgpage();
 
+  prjfree(prj);
   prjini(prj);
 
   return;
@@ -34,15 +34,18 @@
 #include <stdio.h>
 
 #include <sph.h>
+#include <wcsmath.h>
 #include <wcstrig.h>
 
 
 int main()
 
 {
-  int   j, lat, lng, nFail = 0;
-  double coslat, dlat, dlatmx, dlng, dlngmx, lng1[361], lng2[361], eul[5],
-         lat1, lat2[361], phi[361], theta[361], zeta;
+  int   icen[361], icen2[361], j, k, lat, lng, nFail = 0, nmiss, simd;
+  double coslat, dlat, dlatmx, dlng, dlngmx, dphi, eul[5], lat1, lat2[361],
+         lat3[361], lng1[361], lng2[361], lng3[361], phi[361], phi2[361],
+         rmat[9], theta[361], theta2[361], vcel[3], vec[361][3], vntv[3],
+         *dist, lat0[19], lng0[19], *pa, zeta;
   const double tol = 1.0e-12;
 
 
@@ -127,10 +130,212 @@ int main()
     }
   }
 
+
+  /* Test closure in grid mode for a simple change in the origin of
+     longitude, for which latitude is given once per row. */
+  eul[1] = 0.0;
+  eul[3] = 1.0;
+  eul[4] = 0.0;
+
+  for (j = 0, lng = -180; lng <= 180; lng++, j++) {
+    lng1[j] = (double)lng;
+  }
+
+  for (lat = 90; lat >= -90; lat -= 10) {
+    lat1 = (double)lat;
+    coslat = cosd(lat1);
+
+    sphs2x(eul, 361, 1, 1, 1, lng1, &lat1, phi, theta);
+    sphx2s(eul, 361, 1, 1, 1, phi, theta, lng2, lat2);
+
+    for (j = 0; j <= 360; j++) {
+      dlng = fabs(lng2[j] - lng1[j]);
+      if (dlng > 180.0) dlng = fabs(dlng-360.0);
+      dlng *= coslat;
+      dlat = fabs(lat2[j]-lat1);
+
+      if (dlng > dlngmx) dlngmx = dlng;
+      if (dlat > dlatmx) dlatmx = dlat;
+
+      if (dlng > tol || dlat > tol) {
+        nFail++;
+        printf("Unclosed: lng1 =%20.15f  lat1 =%20.15f\n", lng1[j], lat1);
+        printf("           phi =%20.15f theta =%20.15f\n", phi[j], theta[0]);
+        printf("          lng2 =%20.15f  lat2 =%20.15f\n", lng2[j], lat2[j]);
+      }
+    }
+  }
+
   printf("\nsphs2x/sphx2s: Maximum closure residual = %.1e (lng), %.1e (lat) "
     "deg.\n", dlngmx, dlatmx);
 
 
+  /* Compare the SIMD kernel, if any, with the scalar code, and the rotation
+     matrix with the Euler angles, over a grid of native coordinates.  The
+     unit vector forms are tested alternately with and without SIMD. */
+  eul[0] = 266.4;
+  eul[1] = 118.9;
+  eul[2] = 192.9;
+  eul[3] = cosd(eul[1]);
+  eul[4] = sind(eul[1]);
+  sphmat(eul, rmat);
+
+  simd = sphsimd(-1);
+  for (j = 0, lng = -180; lng <= 180; lng++, j++) {
+    phi[j] = (double)lng;
+  }
+
+  dlngmx = 0.0;
+  dlatmx = 0.0;
+  for (lat = 90; lat >= -90; lat--) {
+    for (j = 0; j <= 360; j++) {
+      theta[j] = (double)lat;
+    }
+
+    sphx2s(eul, 361, 0, 1, 1, phi, theta, lng2, lat2);
+    sphsimd(0);
+    sphx2s(eul, 361, 0, 1, 1, phi, theta, lng3, lat3);
+    if (lat%2 == 0) sphsimd(simd);
+    sphx2v(rmat, 361, 1, 3, phi, theta, vec[0]);
+    sphv2x(rmat, 361, 3, 1, vec[0], phi2, theta2);
+    sphsimd(simd);
+
+    for (j = 0; j <= 360; j++) {
+      dlng = fabs(lng2[j] - lng3[j]);
+      if (dlng > 180.0) dlng = fabs(dlng-360.0);
+      dlng *= cosd(lat3[j]);
+      dlat = fabs(lat2[j] - lat3[j]);
+
+      vntv[0] = cosd(theta[j])*cosd(phi[j]);
+      vntv[1] = cosd(theta[j])*sind(phi[j]);
+      vntv[2] = sind(theta[j]);
+      sphrot(rmat, 0, 1, 3, vntv, vcel);
+
+      vcel[0] -= cosd(lat3[j])*cosd(lng3[j]);
+      vcel[1] -= cosd(lat3[j])*sind(lng3[j]);
+      vcel[2] -= sind(lat3[j]);
+      for (k = 0; k < 3; k++) {
+        if (fabs(vcel[k])*R2D > dlng) dlng = fabs(vcel[k])*R2D;
+      }
+
+      vcel[0] = vec[j][0] - cosd(lat3[j])*cosd(lng3[j]);
+      vcel[1] = vec[j][1] - cosd(lat3[j])*sind(lng3[j]);
+      vcel[2] = vec[j][2] - sind(lat3[j]);
+      for (k = 0; k < 3; k++) {
+        if (fabs(vcel[k])*R2D > dlng) dlng = fabs(vcel[k])*R2D;
+      }
+
+      /* Closure of sphx2v() and sphv2x(). */
+      dphi = fabs(phi2[j] - phi[j]);
+      if (dphi > 180.0) dphi = fabs(dphi-360.0);
+      dphi *= cosd(theta[j]);
+      if (dphi > dlng) dlng = dphi;
+      if (fabs(theta2[j] - theta[j]) > dlat) {
+        dlat = fabs(theta2[j] - theta[j]);
+      }
+
+      if (dlng > dlngmx) dlngmx = dlng;
+      if (dlat > dlatmx) dlatmx = dlat;
+
+      if (dlng > tol || dlat > tol) {
+        nFail++;
+        printf("Mismatch:  phi =%20.15f theta =%20.15f\n", phi[j], theta[j]);
+        printf("          lng2 =%20.15f  lat2 =%20.15f\n", lng2[j], lat2[j]);
+        printf("          lng3 =%20.15f  lat3 =%20.15f\n", lng3[j], lat3[j]);
+      }
+    }
+  }
+
+  printf("\nSIMD/scalar, sphrot and sphx2v/sphv2x: Maximum discrepancy = "
+    "%.1e (lng), %.1e (lat) deg.\n", dlngmx, dlatmx);
+
+
+  /* Batched distances and position angles against sphdpa(). */
+  for (j = 0; j <= 360; j++) {
+    lng1[j] = (double)(j - 180);
+    lat2[j] = 89.0*sind(7.0*j);
+  }
+
+  for (k = 0; k < 19; k++) {
+    lng0[k] = 37.0*k;
+    lat0[k] = 10.0*k - 90.0;
+  }
+
+  dist = malloc(2*19*361*sizeof(double));
+  pa   = dist + 19*361;
+
+  dlngmx = 0.0;
+  dlatmx = 0.0;
+  for (simd = 1; simd >= 0; simd--) {
+    sphsimd(simd);
+    sphdpam(19, lng0, lat0, 361, lng1, lat2, 1+simd, dist, pa);
+
+    for (k = 0; k < 19; k++) {
+      sphdpa(361, lng0[k], lat0[k], lng1, lat2, lng3, lat3);
+
+      for (j = 0; j <= 360; j++) {
+        dlng = fabs(dist[k*361+j] - lng3[j]);
+        if (dlng > dlngmx) dlngmx = dlng;
+
+        /* Position angle residual as an arc, it degenerates at the */
+        /* point and its antipode.                                  */
+        dlat = fabs(pa[k*361+j] - lat3[j]);
+        if (dlat > 180.0) dlat = fabs(dlat-360.0);
+        dlat *= sind(lng3[j]);
+        if (dlat > dlatmx) dlatmx = dlat;
+
+        if (dlng > tol || dlat > tol) {
+          nFail++;
+          printf("Mismatch:  lng0 =%20.15f  lat0 =%20.15f\n", lng0[k], lat0[k]);
+          printf("            lng =%20.15f   lat =%20.15f\n", lng1[j], lat2[j]);
+          printf("         sphdpa =%20.15f%20.15f\n", lng3[j], lat3[j]);
+          printf("        sphdpam =%20.15f%20.15f\n", dist[k*361+j],
+            pa[k*361+j]);
+        }
+      }
+    }
+  }
+  sphsimd(1);
+
+  printf("\nsphdpam: Maximum discrepancy = %.1e (dist), %.1e (pa) deg.\n",
+    dlngmx, dlatmx);
+
+
+  /* Cone search against brute force. */
+  for (nmiss = 0, j = 0; j <= 360; j++) {
+    sphcone(19, lng0, lat0, 25.0, 1, lng1+j, lat2+j, 1, icen+j, dist+j);
+
+    lat1 = 999.0;
+    for (k = 0, lng = -1; k < 19; k++) {
+      sphdpa(1, lng0[k], lat0[k], lng1+j, lat2+j, lng3, lat3);
+      if (lng3[0] <= 25.0 && lng3[0] < lat1) {
+        lat1 = lng3[0];
+        lng  = k;
+      }
+    }
+
+    if (icen[j] != lng || (lng >= 0 && fabs(dist[j] - lat1) > tol)) {
+      nFail++;
+      nmiss++;
+      printf("Mismatch:  lng =%20.15f   lat =%20.15f\n", lng1[j], lat2[j]);
+      printf("         centre %d (brute force), %d (sphcone)\n", lng,
+        icen[j]);
+    }
+  }
+
+  /* Once more in bulk, with threads. */
+  sphcone(19, lng0, lat0, 25.0, 361, lng1, lat2, 0, icen2, dist);
+  for (j = 0; j <= 360; j++) {
+    if (icen2[j] != icen[j]) {
+      nFail++;
+      nmiss++;
+    }
+  }
+
+  printf("\nsphcone: %d mismatches against brute force.\n", nmiss);
+  free(dist);
+
+
   if (nFail) {
     printf("\nFAIL: %d closure residuals exceed reporting tolerance.\n",
       nFail);
@@ -34,6 +34,9 @@
 
 #include <tab.h>
 
+/* Length of the long index vector. */
+#define NLONG 1000
+
 /* Reporting tolerance. */
 const double tol = 1.0e-8;
 
@@ -42,11 +45,12 @@ int main()
 {
   char   nl;
   int    i, j, K[2], K1, K2, k, k1, k2, M, m, map[2], n, nFail = 0,
-         stat0[128], stat1[128], status, status0, status1;
+         stat0[128], stat1[128], statl[NLONG], status, status0, status1;
   double crpix, crval[2], epsilon, *index[1], psi_0, psi_1, resid, residmax,
-         s[16], world[11][11][2], xt0[16], xt1[16], x0[11][11][2],
-         x1[11][11][2], z;
-  struct tabprm tab;
+         s[16], sl[NLONG], sw[NLONG][2], world[11][11][2], xl0[NLONG],
+         xl1[NLONG], xt0[16], xt1[16], xw0[NLONG][2], xw1[NLONG][2],
+         x0[11][11][2], x1[11][11][2], z;
+  struct tabprm tab, tabs[3];
 
   printf(
     "Testing closure of WCSLIB tabular coordinate routines (ttab1.c)\n"
@@ -408,6 +412,204 @@ int main()
   tabfree(&tab);
 
 
+  /* A long, non-uniform, decreasing index vector with a flat run.  Where */
+  /* x coincides with an index value the interval below it is preferred.  */
+  printf("\n\nOne-dimensional test with a long index:\n");
+  M = 1;
+  K[0] = NLONG;
+
+  tab.flag  = -1;
+  if ((status = tabini(1, M, K, &tab))) {
+    printf("tabini ERROR %d: %s.\n", status, tab_errmsg[status]);
+    return 1;
+  }
+
+  tab.M = M;
+  tab.K[0] = K[0];
+  tab.map[0] = 0;
+  tab.crval[0] = 0.0;
+
+  for (k = 0; k < NLONG; k++) {
+    tab.index[0][k] = 2000.0 - (k + 0.002*k*k);
+    tab.coord[k] = 3.0*k + 0.5;
+  }
+
+  for (k = 401; k < 410; k++) {
+    tab.index[0][k] = tab.index[0][400];
+  }
+
+  /* Hit each index value in forward, reverse and scattered order. */
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < NLONG; j++) {
+      k = (i == 0) ? j : ((i == 1) ? NLONG-1-j : (379*j)%NLONG);
+      xl0[j] = tab.index[0][k];
+    }
+
+    if ((status0 = tabx2s(&tab, NLONG, 1, xl0, sl, statl))) {
+      printf("tabx2s ERROR %d: %s.\n", status0, tab_errmsg[status0]);
+      nFail++;
+      break;
+    }
+
+    for (j = 0; j < NLONG; j++) {
+      k = (i == 0) ? j : ((i == 1) ? NLONG-1-j : (379*j)%NLONG);
+      if (401 <= k && k < 410) k = 400;
+
+      if (sl[j] != tab.coord[k]) {
+        nFail++;
+        printf("   Index error: x = %20.15f -> s = %20.15f, expected "
+          "%20.15f\n", xl0[j], sl[j], tab.coord[k]);
+      }
+    }
+  }
+
+  /* Closure, at points scattered between the index values. */
+  for (j = 0; j < NLONG; j++) {
+    z = fmod(0.6180339887*j, 1.0);
+    xl0[j] = tab.index[0][NLONG-1] +
+             z*(tab.index[0][0] - tab.index[0][NLONG-1]);
+  }
+
+  status0 = tabx2s(&tab, NLONG, 1, xl0, sl, statl);
+  status1 = tabs2x(&tab, NLONG, 1, sl, xl1, statl);
+  if (status0 || status1) {
+    printf("tabx2s/tabs2x ERROR %d/%d.\n", status0, status1);
+    nFail++;
+  }
+
+  residmax = 0.0;
+  for (j = 0; j < NLONG; j++) {
+    resid = fabs(xl1[j] - xl0[j]);
+    if (resid > residmax) residmax = resid;
+
+    if (resid > tol) {
+      nFail++;
+      printf("   Closure error:\n");
+      printf("      x = %20.15f\n", xl0[j]);
+      printf("   -> s = %20.15f\n", sl[j]);
+      printf("   -> x = %20.15f\n", xl1[j]);
+    }
+  }
+
+  printf("tabx2s/tabs2x: Maximum closure residual = %.1e\n", residmax);
+
+  tabfree(&tab);
+
+
+  /* A larger, distorted 2-dimensional table, with extrapolation by up to */
+  /* half a voxel beyond its edges on each axis.                          */
+  printf("\n\nTwo-dimensional test with extrapolation:\n");
+  M = 2;
+  K[0] = K1 = 60;
+  K[1] = K2 = 40;
+
+  tab.flag = -1;
+  if ((status = tabini(1, M, K, &tab))) {
+    printf("tabini ERROR %d: %s.\n", status, tab_errmsg[status]);
+    return 1;
+  }
+
+  tab.M = M;
+  for (m = 0; m < tab.M; m++) {
+    tab.map[m] = m;
+    tab.crval[m] = 0.0;
+    tab.index[m] = 0x0;
+  }
+
+  n = 0;
+  for (k2 = 0; k2 < K2; k2++) {
+    for (k1 = 0; k1 < K1; k1++) {
+      tab.coord[n++] = 2.0*k1 + 0.3*k2 + 0.002*k1*k2 + 0.1*sin(0.3*k2);
+      tab.coord[n++] = 1.5*k2 - 0.2*k1 + 0.1*cos(0.2*k1);
+    }
+  }
+
+  /* Scatter points over the table and the margin around it. */
+  for (j = 0; j < NLONG; j++) {
+    xw0[j][0] = 0.5 + K1*fmod(0.6180339887*j, 1.0);
+    xw0[j][1] = 0.5 + K2*fmod(0.7548776662*j, 1.0);
+  }
+
+  status0 = tabx2s(&tab, NLONG, 2, (double *)xw0, (double *)sw, statl);
+  status1 = tabs2x(&tab, NLONG, 2, (double *)sw, (double *)xw1, statl);
+  if (status0 || status1) {
+    printf("tabx2s/tabs2x ERROR %d/%d.\n", status0, status1);
+    nFail++;
+  }
+
+  residmax = 0.0;
+  for (j = 0; j < NLONG; j++) {
+    resid = fabs(xw1[j][0] - xw0[j][0]);
+    if (fabs(xw1[j][1] - xw0[j][1]) > resid) {
+      resid = fabs(xw1[j][1] - xw0[j][1]);
+    }
+    if (resid > residmax) residmax = resid;
+
+    if (resid > tol) {
+      nFail++;
+      printf("   Closure error:\n");
+      printf("      x = (%20.15f,%20.15f)\n", xw0[j][0], xw0[j][1]);
+      printf("   -> s = (%20.15f,%20.15f)\n", sw[j][0], sw[j][1]);
+      printf("   -> x = (%20.15f,%20.15f)\n", xw1[j][0], xw1[j][1]);
+    }
+  }
+
+  printf("tabx2s/tabs2x: Maximum closure residual = %.1e\n", residmax);
+
+  /* Beyond the margin. */
+  sw[0][0] = tab.coord[0] - 2.0;
+  sw[0][1] = tab.coord[1] - 2.0;
+  if (tabs2x(&tab, 1, 2, (double *)sw, (double *)xw1, statl) == 0) {
+    nFail++;
+    printf("   tabs2x failed to reject s = (%.1f,%.1f).\n", sw[0][0],
+      sw[0][1]);
+  }
+
+  /* tabcpy() copies the arrays, whereas tabshr() shares them until a copy */
+  /* asks for its own, and its copies outlive the original.               */
+  tabx2s(&tab, NLONG, 2, (double *)xw0, (double *)sw, statl);
+
+  for (i = 0; i < 3; i++) {
+    tabs[i].flag = -1;
+  }
+
+  status  = tabcpy(1, &tab, tabs);
+  status |= tabshr(&tab, tabs + 1);
+  status |= tabshr(&tab, tabs + 2);
+  status |= tabown(tabs + 2);
+  if (status || tabs[0].coord == tab.coord || tabs[1].coord != tab.coord ||
+      tabs[2].coord == tab.coord || tabs[1].index[0] != 0x0 ||
+      *(tab.m_refs) != 2) {
+    nFail++;
+    printf("   tabcpy/tabshr/tabown failed to copy, share or unshare the "
+      "arrays.\n");
+  }
+
+  z = tab.coord[0];
+  tabs[0].coord[0] += 1.0;
+  tabs[2].coord[0] += 2.0;
+  tabfree(&tab);
+
+  status0 = tabx2s(tabs + 1, NLONG, 2, (double *)xw0, (double *)xw1, statl);
+  for (j = 0; j < NLONG; j++) {
+    if (status0 || xw1[j][0] != sw[j][0] || xw1[j][1] != sw[j][1]) {
+      nFail++;
+      printf("   Shared copy differs from the original.\n");
+      break;
+    }
+  }
+
+  if (tabs[0].coord[0] != z + 1.0 || tabs[1].coord[0] != z ||
+      tabs[2].coord[0] != z + 2.0) {
+    nFail++;
+    printf("   tabcpy() or tabown() failed to make a private copy.\n");
+  }
+
+  for (i = 0; i < 3; i++) {
+    tabfree(tabs + i);
+  }
+
+
   if (nFail) {
     printf("\nFAIL: %d closure residuals exceed reporting tolerance.\n",
       nFail);
@@ -0,0 +1,236 @@
+/*============================================================================
+
+  WCSLIB 4.22 - an implementation of the FITS WCS standard.
+  Copyright (C) 1995-2014, Mark Calabretta
+
+  This file is part of WCSLIB.
+
+  WCSLIB is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or (at your option)
+  any later version.
+
+  WCSLIB is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+  more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with WCSLIB.  If not, see http://www.gnu.org/licenses.
+
+  Direct correspondence concerning WCSLIB to mark@calabretta.id.au
+
+  Author: Mark Calabretta, Australia Telescope National Facility, CSIRO.
+  http://www.atnf.csiro.au/people/Mark.Calabretta
+  $Id: ttrig.c,v 4.22 2014/04/12 15:03:53 mcalabre Exp $
+*=============================================================================
+*
+* ttrig tests the vector trigd functions against the scalar ones, for each
+* instruction set available.
+*
+*---------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdio.h>
+
+#include <wcstrig.h>
+
+
+#define NARG 3001
+
+int check(const char *func, int n, const int exact[], const double arg[],
+          const double vec[], const double sca[], double tol);
+
+/* Relative tolerance, except absolute for results less than one. */
+const double tol = 1.0e-14;
+
+
+int main()
+
+{
+  int    exact[NARG], i, isa, isas[4] = {512, 256, 128, 0}, j, k, nFail = 0,
+         prev;
+  double a[NARG], b[NARG], s1[NARG], s2[NARG], v1[NARG], v2[NARG], x[NARG],
+         y[NARG];
+
+
+  printf(
+    "Testing WCSLIB vector trigd functions (ttrig.c)\n"
+    "-----------------------------------------------\n");
+
+  printf("\nReporting tolerance:%8.1e (relative to max(1,|result|)).\n", tol);
+
+  /* Angles: multiples of 22.5 degrees, then general and special values. */
+  for (j = 0; j < 129; j++) {
+    a[j] = 22.5*(j - 64);
+  }
+  for (; j < NARG-4; j++) {
+    a[j] = -720.0 + 0.48013*(j - 129);
+  }
+  a[j++] = 1.0e7;
+  a[j++] = -3.0e9;
+  a[j++] = HUGE_VAL;
+  a[j++] = -HUGE_VAL;
+
+  /* Inverse sine and cosine: special values, then [-1,1]. */
+  x[0] =  0.0;
+  x[1] =  1.0;
+  x[2] = -1.0;
+  x[3] =  1.0 + 5.0e-11;
+  x[4] = -1.0 - 5.0e-11;
+  x[5] =  1.5;
+  x[6] = -1.0 - 1.0e-9;
+  for (j = 7; j < NARG; j++) {
+    x[j] = -1.0 + 2.0*(j - 7)/(NARG - 8);
+  }
+
+  /* Inverse tangent: tangents of the angles. */
+  for (j = 0; j < NARG; j++) {
+    b[j] = tand(a[j]);
+  }
+
+  /* Polar angle: scaled sines and permuted cosines of the angles. */
+  for (j = 0; j < NARG; j++) {
+    y[j]  = 3.0*sind(a[j]);
+    s2[j] = cosd(a[(7*j)%NARG]);
+  }
+
+  prev = trigdsimd(-1);
+  printf("Default instruction set: %d.\n", prev);
+
+  for (k = 0; k < 4; k++) {
+    /* Skip those not supported by the library or processor. */
+    trigdsimd(isas[k]);
+    if ((isa = trigdsimd(-1)) != isas[k]) continue;
+
+    printf("\nInstruction set %d:\n", isa);
+
+    /* Sine and cosine are exact for multiples of 90 degrees. */
+    for (j = 0; j < NARG; j++) {
+      exact[j] = (fmod(a[j], 90.0) == 0.0);
+    }
+
+    cosdv(NARG, a, v1);
+    for (j = 0; j < NARG; j++) x[j] = cosd(a[j]);
+    nFail += check("cosd", NARG, exact, a, v1, x, tol);
+
+    sindv(NARG, a, v1);
+    for (j = 0; j < NARG; j++) x[j] = sind(a[j]);
+    nFail += check("sind", NARG, exact, a, v1, x, tol);
+
+    sincosdv(NARG, a, v1, v2);
+    for (j = 0; j < NARG; j++) sincosd(a[j], x+j, s1+j);
+    nFail += check("sincosd(sin)", NARG, exact, a, v1, x, tol);
+    nFail += check("sincosd(cos)", NARG, exact, a, v2, s1, tol);
+
+    /* Tangent is exact for multiples of 45 degrees, except odd multiples */
+    /* of 90 degrees, where it is merely large.                          */
+    for (j = 0; j < NARG; j++) {
+      exact[j] = (fmod(a[j], 45.0) == 0.0 &&
+                  fabs(fmod(a[j], 180.0)) != 90.0);
+    }
+
+    tandv(NARG, a, v1);
+    for (j = 0; j < NARG; j++) x[j] = tand(a[j]);
+    nFail += check("tand", NARG, exact, a, v1, x, tol);
+
+    /* Inverse functions. */
+    for (j = 0; j < NARG; j++) {
+      x[j] = (j < 7) ? 0.0 : -1.0 + 2.0*(j - 7)/(NARG - 8);
+      exact[j] = (j < 7);
+    }
+    x[1] =  1.0;
+    x[2] = -1.0;
+    x[3] =  1.0 + 5.0e-11;
+    x[4] = -1.0 - 5.0e-11;
+    x[5] =  1.5;
+    x[6] = -1.0 - 1.0e-9;
+
+    acosdv(NARG, x, v1);
+    for (j = 0; j < NARG; j++) s1[j] = acosd(x[j]);
+    nFail += check("acosd", NARG, exact, x, v1, s1, tol);
+
+    asindv(NARG, x, v1);
+    for (j = 0; j < NARG; j++) s1[j] = asind(x[j]);
+    nFail += check("asind", NARG, exact, x, v1, s1, tol);
+
+    for (j = 0; j < NARG; j++) {
+      exact[j] = (b[j] == 0.0 || fabs(b[j]) == 1.0);
+    }
+
+    atandv(NARG, b, v1);
+    for (j = 0; j < NARG; j++) s1[j] = atand(b[j]);
+    nFail += check("atand", NARG, exact, b, v1, s1, tol);
+
+    for (j = 0; j < NARG; j++) {
+      exact[j] = (y[j] == 0.0 || s2[j] == 0.0);
+    }
+
+    atan2dv(NARG, y, s2, v1);
+    for (j = 0; j < NARG; j++) s1[j] = atan2d(y[j], s2[j]);
+    nFail += check("atan2d", NARG, exact, y, v1, s1, tol);
+
+    /* Short arrays, in place. */
+    for (j = 1; j <= 17; j++) {
+      for (i = 0; i < j; i++) v1[i] = a[129+i];
+      sindv(j, v1, v1);
+      for (i = 0; i < j; i++) s1[i] = sind(a[129+i]);
+      nFail += check(0x0, j, 0x0, a+129, v1, s1, tol);
+    }
+  }
+
+  trigdsimd(prev);
+
+
+  if (nFail) {
+    printf("\nFAIL: %d discrepancies exceed reporting tolerance.\n", nFail);
+  } else {
+    printf("\nPASS: All vector results are within reporting tolerance.\n");
+  }
+
+  return nFail;
+}
+
+/*----------------------------------------------------------------------------
+* Compare vector and scalar results, which must be identical where flagged
+* as exact, and report the maximum discrepancy if func is given.
+*---------------------------------------------------------------------------*/
+
+int check(
+  const char *func,
+  int n,
+  const int exact[],
+  const double arg[],
+  const double vec[],
+  const double sca[],
+  double tol)
+
+{
+  int j, nFail = 0;
+  double d, dmax;
+
+  dmax = 0.0;
+  for (j = 0; j < n; j++) {
+    if (vec[j] == sca[j] || (isnan(vec[j]) && isnan(sca[j]))) {
+      continue;
+    } else if ((exact && exact[j]) || isnan(vec[j]) || isnan(sca[j])) {
+      d = HUGE_VAL;
+    } else {
+      d = fabs(vec[j] - sca[j]);
+      if (fabs(sca[j]) > 1.0) d /= fabs(sca[j]);
+    }
+
+    if (d > dmax) dmax = d;
+    if (d > tol) {
+      nFail++;
+      printf("  Mismatch: %s(%.17g) = %.17g, expected %.17g.\n",
+        func ? func : "sindv", arg[j], vec[j], sca[j]);
+    }
+  }
+
+  if (func) {
+    printf("  %-13s Maximum discrepancy = %.1e.\n", func, dmax);
+  }
+
+  return nFail;
+}
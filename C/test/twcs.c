@@ -27,22 +27,50 @@
 *=============================================================================
 *
 * twcs tests wcss2p() and wcsp2s() for closure on an oblique 2-D slice through
-* a 4-D image with celestial, spectral and logarithmic coordinate axes.
+* a 4-D image with celestial, spectral and logarithmic coordinate axes.  It
+* also checks that wcsplns2p() and wcsplnp2s(), the work array forms of all
+* four routines, and the multi-threaded wcss2pt() and wcsp2st() reproduce
+* their results, also in child processes forked after the worker threads have
+* been started and while another thread is using them, and that wcsp2sg() reproduces that of wcsp2s() for regular
+* pixel grids, including cylindrical projections.  Finally, it checks that
+* wcsp2v() and wcsv2p() agree with wcsp2s() and wcss2p() for celestial unit
+* vectors, that setting wcsprm::accuracy to WCS_FASTACC preserves closure
+* and agreement with the full-accuracy results to within that tolerance, and
+* that wcss2pf() and wcsp2sf() agree with wcss2p() and wcsp2s() to within
+* single precision, and that wcsp2sb() agrees with wcsp2s() for boxes of
+* pixels.
 *
 *---------------------------------------------------------------------------*/
 
+#include <float.h>
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include <wcslib.h>
 #include <wcsconfig_tests.h>
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 
 void parser(struct wcsprm *);
 int  check_error(struct wcsprm *, int, int, char *);
 int  test_errors();
+int  test_fork(struct wcsprm *);
+void *fork_busy(void *);
+int  test_grid(struct wcsprm *);
+int  grid_cmp(struct wcsprm *, int, int, const double[], const char *);
+int  test_vec(struct wcsprm *);
+int  test_fast(struct wcsprm *);
+int  test_float(struct wcsprm *);
+int  float_cmp(int, const float[], const double[], const char *);
+int  test_box(struct wcsprm *);
+int  box_cmp(struct wcsprm *, const int[], const double[], const char *);
 
 /* Reporting tolerance. */
 const double tol = 1.0e-10;
@@ -70,17 +98,24 @@ struct pvcard PV[3];		/* Projection parameters are set in main(). */
 
 int itest = 0;
 
+volatile int fork_stop = 0;
+
 int main()
 
 {
 #define NELEM 9
 
   char   ok[] = "", mismatch[] = " (WARNING, mismatch)", *s;
-  int    i, k, lat, lng, nFail1 = 0, nFail2 = 0, stat[361], status;
-  double freq, img[361][NELEM], lat1, lng1, phi[361], pixel1[361][NELEM],
-         pixel2[361][NELEM], r, resid, residmax, theta[361], time,
-         world1[361][NELEM], world2[361][NELEM];
+  int    i, k, lat, lng, nFail1 = 0, nFail2 = 0, nFail3 = 0,
+         nFail4 = 0, nFail5 = 0, nFail6 = 0, nFail7 = 0, nFail8 = 0,
+         nwrk,
+         stat[361], stat3[361], status, status3;
+  double *wrk, freq, img[361][NELEM], lat1, lng1, phi[361], pixel1[361][NELEM],
+         pixel2[361][NELEM], pixel3[361][NELEM], r, resid, residmax,
+         theta[361], time, world1[361][NELEM], world2[361][NELEM],
+         world3[361][NELEM];
   struct wcsprm *wcs;
+  struct wcsplan plan;
 
 
   printf("Testing closure of WCSLIB world coordinate transformation "
@@ -180,6 +215,13 @@ int main()
 
   printf("\nReporting tolerance %5.1g pixel.\n", tol);
 
+  /* Compile a plan for the reentrant routines. */
+  if (wcscompile(wcs, &plan)) {
+    printf("wcscompile ERROR:\n");
+    wcsperr(&(plan.wcs), "  ");
+    nFail3++;
+  }
+
 
   /* Initialize non-celestial world coordinates. */
   time = 1.0;
@@ -197,6 +239,10 @@ int main()
     freq += 62500.0;
   }
 
+  /* Unused elements are compared below. */
+  memset(pixel1, 0, sizeof(pixel1));
+  memset(pixel3, 0, sizeof(pixel3));
+
   residmax = 0.0;
   for (lat = 90; lat >= -90; lat--) {
     lat1 = (double)lat;
@@ -208,15 +254,53 @@ int main()
       world1[k][wcs->lat] = lat1;
     }
 
-    if (wcss2p(wcs, 361, NELEM, world1[0], phi, theta, img[0], pixel1[0],
-               stat)) {
+    status  = wcss2p(wcs, 361, NELEM, world1[0], phi, theta, img[0],
+                     pixel1[0], stat);
+    status3 = wcsplns2p(&plan, 361, NELEM, world1[0], phi, theta, img[0],
+                        pixel3[0], stat3, 0x0);
+    if (status3 != status ||
+        memcmp(pixel3, pixel1, sizeof(pixel1)) ||
+        memcmp(stat3, stat, sizeof(stat))) {
+      printf("  wcsplns2p differs from wcss2p with lat1 == %f\n", lat1);
+      nFail3++;
+    }
+
+    status3 = wcss2pt(wcs, 4, 50, 361, NELEM, world1[0], phi, theta, img[0],
+                      pixel3[0], stat3);
+    if (status3 != status ||
+        memcmp(pixel3, pixel1, sizeof(pixel1)) ||
+        memcmp(stat3, stat, sizeof(stat))) {
+      printf("  wcss2pt differs from wcss2p with lat1 == %f\n", lat1);
+      nFail3++;
+    }
+
+    if (status) {
       printf("  At wcss2p#1 with lat1 == %f\n", lat1);
       wcsperr(wcs, "  ");
       continue;
     }
 
-    if (wcsp2s(wcs, 361, NELEM, pixel1[0], img[0], phi, theta, world2[0],
-               stat)) {
+    status  = wcsp2s(wcs, 361, NELEM, pixel1[0], img[0], phi, theta,
+                     world2[0], stat);
+    status3 = wcsplnp2s(&plan, 361, NELEM, pixel1[0], img[0], phi, theta,
+                        world3[0], stat3, 0x0);
+    if (status3 != status ||
+        memcmp(world3, world2, sizeof(world2)) ||
+        memcmp(stat3, stat, sizeof(stat))) {
+      printf("  wcsplnp2s differs from wcsp2s with lat1 == %f\n", lat1);
+      nFail3++;
+    }
+
+    status3 = wcsp2st(wcs, 4, 50, 361, NELEM, pixel1[0], img[0], phi, theta,
+                      world3[0], stat3);
+    if (status3 != status ||
+        memcmp(world3, world2, sizeof(world2)) ||
+        memcmp(stat3, stat, sizeof(stat))) {
+      printf("  wcsp2st differs from wcsp2s with lat1 == %f\n", lat1);
+      nFail3++;
+    }
+
+    if (status) {
       printf("  At wcsp2s with lat1 == %f\n", lat1);
       wcsperr(wcs, "  ");
       continue;
@@ -257,6 +341,88 @@ int main()
   printf("wcsp2s/wcss2p: Maximum closure residual = %.1e pixel.\n", residmax);
 
 
+  /* The work array forms must reproduce the last row exactly. */
+  wcswrksz(wcs, 361, &nwrk);
+  wrk = malloc(nwrk*sizeof(double));
+
+  status  = wcss2p(wcs, 361, NELEM, world1[0], phi, theta, img[0],
+                   pixel1[0], stat);
+  status3 = wcss2pw(wcs, 361, NELEM, world1[0], phi, theta, img[0],
+                    pixel3[0], stat3, nwrk, wrk);
+  if (status3 != status || memcmp(pixel3, pixel1, sizeof(pixel1)) ||
+      memcmp(stat3, stat, sizeof(stat))) {
+    printf("  wcss2pw differs from wcss2p.\n");
+    nFail3++;
+  }
+
+  status3 = wcsplns2pw(&plan, 361, NELEM, world1[0], phi, theta, img[0],
+                       pixel3[0], stat3, nwrk, wrk, 0x0);
+  if (status3 != status || memcmp(pixel3, pixel1, sizeof(pixel1)) ||
+      memcmp(stat3, stat, sizeof(stat))) {
+    printf("  wcsplns2pw differs from wcss2p.\n");
+    nFail3++;
+  }
+
+  status  = wcsp2s(wcs, 361, NELEM, pixel1[0], img[0], phi, theta,
+                   world2[0], stat);
+  status3 = wcsp2sw(wcs, 361, NELEM, pixel1[0], img[0], phi, theta,
+                    world3[0], stat3, nwrk, wrk);
+  if (status3 != status || memcmp(world3, world2, sizeof(world2)) ||
+      memcmp(stat3, stat, sizeof(stat))) {
+    printf("  wcsp2sw differs from wcsp2s.\n");
+    nFail3++;
+  }
+
+  status3 = wcsplnp2sw(&plan, 361, NELEM, pixel1[0], img[0], phi, theta,
+                       world3[0], stat3, nwrk, wrk, 0x0);
+  if (status3 != status || memcmp(world3, world2, sizeof(world2)) ||
+      memcmp(stat3, stat, sizeof(stat))) {
+    printf("  wcsplnp2sw differs from wcsp2s.\n");
+    nFail3++;
+  }
+
+  if (wcsplnp2sw(&plan, 361, NELEM, pixel1[0], img[0], phi, theta,
+                 world3[0], stat3, nwrk-1, wrk, 0x0) != WCSERR_BAD_PARAM) {
+    printf("  wcsplnp2sw accepted a short work array.\n");
+    nFail3++;
+  }
+
+  /* An invalid (log) coordinate in one chunk must be reported as by
+     wcss2p(). */
+  world1[200][2] = -1.0;
+  status  = wcss2p(wcs, 361, NELEM, world1[0], phi, theta, img[0],
+                   pixel1[0], stat);
+  status3 = wcss2pt(wcs, 4, 50, 361, NELEM, world1[0], phi, theta, img[0],
+                    pixel3[0], stat3);
+  if (status != WCSERR_BAD_WORLD || status3 != status ||
+      memcmp(stat3, stat, sizeof(stat))) {
+    printf("  wcss2pt status differs from wcss2p.\n");
+    nFail3++;
+  }
+
+  /* The thread pool must survive a fork(). */
+  nFail3 += test_fork(wcs);
+
+  free(wrk);
+  wcsplnfree(&plan);
+
+
+  /* Regular pixel grids. */
+  nFail4 = test_grid(wcs);
+
+  /* Celestial unit vectors. */
+  nFail5 = test_vec(wcs);
+
+  /* Reduced-accuracy mode. */
+  nFail6 = test_fast(wcs);
+
+  /* Single-precision coordinates. */
+  nFail7 = test_float(wcs);
+
+  /* Boxes of pixels. */
+  nFail8 = test_box(wcs);
+
+
   /* Test wcserr and wcsprintf() as well. */
   nFail2 = 0;
   wcsprintf_set(stdout);
@@ -274,7 +440,8 @@ int main()
   nFail2 += test_errors();
 
 
-  if (nFail1 || nFail2) {
+  if (nFail1 || nFail2 || nFail3 || nFail4 || nFail5 || nFail6 ||
+      nFail7 || nFail8) {
     if (nFail1) {
       printf("\nFAIL: %d closure residuals exceed reporting tolerance.\n",
         nFail1);
@@ -283,9 +450,47 @@ int main()
     if (nFail2) {
       printf("FAIL: %d error messages differ from that expected.\n", nFail2);
     }
+
+    if (nFail3) {
+      printf("FAIL: %d wcsplan results differ from wcsprm results.\n",
+        nFail3);
+    }
+
+    if (nFail4) {
+      printf("FAIL: %d wcsp2sg results differ from wcsp2s results.\n",
+        nFail4);
+    }
+
+    if (nFail5) {
+      printf("FAIL: %d wcsp2v/wcsv2p results differ from wcsp2s/wcss2p "
+        "results.\n", nFail5);
+    }
+
+    if (nFail6) {
+      printf("FAIL: %d reduced-accuracy results exceed WCS_FASTACC.\n",
+        nFail6);
+    }
+
+    if (nFail7) {
+      printf("FAIL: %d wcsp2sf/wcss2pf results differ from wcsp2s/wcss2p "
+        "results.\n", nFail7);
+    }
+
+    if (nFail8) {
+      printf("FAIL: %d wcsp2sb results differ from wcsp2s results.\n",
+        nFail8);
+    }
   } else {
     printf("\nPASS: All closure residuals are within reporting tolerance.\n");
     printf("PASS: All error messages reported as expected.\n");
+    printf("PASS: All wcsplan results agree with wcsprm results.\n");
+    printf("PASS: All wcsp2sg results agree with wcsp2s results.\n");
+    printf("PASS: All wcsp2v/wcsv2p results agree with wcsp2s/wcss2p "
+      "results.\n");
+    printf("PASS: All reduced-accuracy results are within WCS_FASTACC.\n");
+    printf("PASS: All wcsp2sf/wcss2pf results agree with wcsp2s/wcss2p "
+      "results.\n");
+    printf("PASS: All wcsp2sb results agree with wcsp2s results.\n");
   }
 
 
@@ -293,7 +498,8 @@ int main()
   wcsfree(wcs);
   free(wcs);
 
-  return nFail1 + nFail2;
+  return nFail1 + nFail2 + nFail3 + nFail4 + nFail5 + nFail6 + nFail7 +
+         nFail8;
 }
 
 /*--------------------------------------------------------------------------*/
@@ -433,3 +639,722 @@ int test_errors()
 
   return nFail;
 }
+
+/*--------------------------------------------------------------------------*/
+
+int test_grid(struct wcsprm *wcs)
+
+{
+  const char *(ctype[3]) = {"RA---CAR", "FREQ", "DEC--CAR"};
+  const double pix0[4] = {1.0, 1.0, 1.0, 1.0};
+  int i, nFail = 0;
+  struct wcsprm grid;
+
+  /* Non-cylindrical, transformed a row at a time. */
+  nFail += grid_cmp(wcs, 7, 5, pix0, "BON");
+
+  /* All-sky cylindrical projections with a spectral axis. */
+  grid.flag = -1;
+  wcsini(1, 3, &grid);
+  for (i = 0; i < 3; i++) {
+    strcpy(grid.ctype[i], ctype[i]);
+  }
+  grid.crpix[0] = 180.5;
+  grid.crpix[1] =   1.0;
+  grid.crpix[2] = 100.5;
+  grid.cdelt[0] =  -1.0;
+  grid.cdelt[1] =   1.0e6;
+  grid.cdelt[2] =   1.0;
+  grid.crval[1] =   1.42e9;
+  nFail += grid_cmp(&grid, 360, 200, pix0, "CAR");
+
+  /* Oblique. */
+  grid.crval[0] = 30.0;
+  grid.crval[2] = 40.0;
+  grid.flag = 0;
+  nFail += grid_cmp(&grid, 360, 200, pix0, "oblique CAR");
+
+  /* Rows beyond the poles are invalid. */
+  strcpy(grid.ctype[0], "RA---CEA");
+  strcpy(grid.ctype[2], "DEC--CEA");
+  grid.flag = 0;
+  nFail += grid_cmp(&grid, 360, 200, pix0, "oblique CEA");
+
+  /* A rotated PC matrix. */
+  grid.pc[2] = 0.1;
+  grid.flag = 0;
+  nFail += grid_cmp(&grid, 360, 200, pix0, "rotated CEA");
+
+  wcsfree(&grid);
+
+  return nFail;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int grid_cmp(
+  struct wcsprm *wcs,
+  int nx,
+  int ny,
+  const double pix0[],
+  const char *label)
+
+{
+  int    ix, iy, j, k, lat, lng, m, n, nelem, *stat1, *stat2, status1,
+         status2;
+  double *img1, *img2, *phi1, *phi2, *pixcrd, *theta1, *theta2, *world1,
+         *world2;
+
+  wcsset(wcs);
+  nelem = wcs->naxis;
+  lng = wcs->lng;
+  lat = wcs->lat;
+
+  n = nx*ny;
+  m = n*nelem;
+  pixcrd = malloc((5*m + 4*n)*sizeof(double));
+  img1   = pixcrd + m;
+  img2   = img1 + m;
+  world1 = img2 + m;
+  world2 = world1 + m;
+  phi1   = world2 + m;
+  phi2   = phi1 + n;
+  theta1 = phi2 + n;
+  theta2 = theta1 + n;
+  stat1  = malloc(2*n*sizeof(int));
+  stat2  = stat1 + n;
+
+  k = 0;
+  for (iy = 0; iy < ny; iy++) {
+    for (ix = 0; ix < nx; ix++, k += nelem) {
+      for (j = 0; j < nelem; j++) {
+        pixcrd[k+j] = pix0[j];
+      }
+      pixcrd[k+lng] += ix;
+      pixcrd[k+lat] += iy;
+    }
+  }
+
+  status1 = wcsp2s(wcs, n, nelem, pixcrd, img1, phi1, theta1, world1, stat1);
+  status2 = wcsp2sg(wcs, nx, ny, nelem, pix0, img2, phi2, theta2, world2,
+                    stat2);
+
+  printf("wcsp2sg: %dx%d %s grid, status %d.\n", nx, ny, label, status2);
+
+  k = (status2 != status1 ||
+       memcmp(img2,   img1,   m*sizeof(double)) ||
+       memcmp(world2, world1, m*sizeof(double)) ||
+       memcmp(phi2,   phi1,   n*sizeof(double)) ||
+       memcmp(theta2, theta1, n*sizeof(double)) ||
+       memcmp(stat2,  stat1,  n*sizeof(int)));
+  if (k) {
+    printf("  wcsp2sg differs from wcsp2s for the %s grid.\n", label);
+  }
+
+  free(stat1);
+  free(pixcrd);
+
+  return k;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int test_fork(struct wcsprm *wcs)
+
+{
+  int    ifork, k, nFail, stat1[361], stat2[361], status, status1, status2;
+  double img[361][NELEM], phi[361], pixel[361][NELEM], theta[361],
+         world1[361][NELEM], world2[361][NELEM];
+  pid_t  pid;
+#ifdef HAVE_PTHREAD
+  pthread_t tid;
+  struct wcsprm busy;
+#endif
+
+  memset(pixel, 0, sizeof(pixel));
+  for (k = 0; k < 361; k++) {
+    pixel[k][0] = 1.0 + k;
+    pixel[k][1] = 1.0 + 0.5*k;
+    pixel[k][2] = 1.0 + 0.25*k;
+    pixel[k][3] = 1.0 - 0.5*k;
+  }
+
+  status1 = wcsp2s(wcs, 361, NELEM, pixel[0], img[0], phi, theta,
+                   world1[0], stat1);
+
+  /* Keep the thread pool busy in another thread while forking. */
+  busy.flag = -1;
+#ifdef HAVE_PTHREAD
+  if (wcscopy(1, wcs, &busy) || pthread_create(&tid, 0x0, fork_busy, &busy)) {
+    printf("  Failed to start a thread in test_fork.\n");
+    wcsfree(&busy);
+    return 1;
+  }
+#endif
+
+  nFail = 0;
+  for (ifork = 0; ifork < 20; ifork++) {
+    /* Any output pending would be written by both processes. */
+    fflush(stdout);
+
+    if ((pid = fork()) == -1) {
+      printf("  fork() failed in test_fork.\n");
+      nFail++;
+      break;
+    }
+
+    if (pid == 0) {
+      /* The child is killed if wcsp2st() waits on a pool that it lacks. */
+      alarm(30);
+
+      status2 = wcsp2st(wcs, 4, 50, 361, NELEM, pixel[0], img[0], phi,
+                        theta, world2[0], stat2);
+      _exit(status2 != status1 ||
+            memcmp(world2, world1, sizeof(world1)) ||
+            memcmp(stat2, stat1, sizeof(stat1)));
+    }
+
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+      printf("  wcsp2st failed to complete in a forked child.\n");
+      nFail++;
+      break;
+    } else if (WEXITSTATUS(status)) {
+      printf("  wcsp2st differs from wcsp2s in a forked child.\n");
+      nFail++;
+      break;
+    }
+  }
+
+#ifdef HAVE_PTHREAD
+  fork_stop = 1;
+  pthread_join(tid, 0x0);
+  wcsfree(&busy);
+#endif
+
+  /* The parent's pool must still be usable. */
+  status2 = wcsp2st(wcs, 4, 50, 361, NELEM, pixel[0], img[0], phi, theta,
+                    world2[0], stat2);
+  if (status2 != status1 ||
+      memcmp(world2, world1, sizeof(world1)) ||
+      memcmp(stat2, stat1, sizeof(stat1))) {
+    printf("  wcsp2st differs from wcsp2s after a fork.\n");
+    nFail++;
+  }
+
+  return nFail;
+}
+
+/* Run wcsp2st() repeatedly until fork_stop is set. */
+void *fork_busy(void *arg)
+
+{
+  int    k, stat[361];
+  double img[361][NELEM], phi[361], pixel[361][NELEM], theta[361],
+         world[361][NELEM];
+  struct wcsprm *wcs = arg;
+
+  memset(pixel, 0, sizeof(pixel));
+  for (k = 0; k < 361; k++) {
+    pixel[k][0] = 1.0 + k;
+  }
+
+  while (!fork_stop) {
+    wcsp2st(wcs, 4, 50, 361, NELEM, pixel[0], img[0], phi, theta, world[0],
+            stat);
+  }
+
+  return 0x0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int test_vec(struct wcsprm *wcs)
+
+{
+  int    i, k, lat, lng, nFail = 0, stat1[361], stat2[361], status1,
+         status2;
+  double coslat, dv, img[361][NELEM], phi[361], pixel1[361][NELEM],
+         pixel2[361][NELEM], r, resid, theta[361], vec[361][3],
+         world1[361][NELEM], world2[361][NELEM];
+
+  wcsset(wcs);
+  lng = wcs->lng;
+  lat = wcs->lat;
+
+  /* Pixel coordinates from a row of constant latitude. */
+  memset(world1, 0, sizeof(world1));
+  for (k = 0; k < 361; k++) {
+    world1[k][lng] = k - 180.0;
+    world1[k][lat] = 40.0;
+    world1[k][2] = 1.0 + k;
+    world1[k][wcs->spec] = 0.21 + k*1.0e-5;
+  }
+
+  if (wcss2p(wcs, 361, NELEM, world1[0], phi, theta, img[0], pixel1[0],
+             stat1)) {
+    printf("  At wcss2p in test_vec.\n");
+    wcsperr(wcs, "  ");
+    return 1;
+  }
+
+  /* The unit vectors must agree with the longitude and latitude, and the
+     other world coordinates must be identical. */
+  status1 = wcsp2s(wcs, 361, NELEM, pixel1[0], img[0], phi, theta, world1[0],
+                   stat1);
+  memcpy(world2, world1, sizeof(world2));
+  status2 = wcsp2v(wcs, 361, NELEM, pixel1[0], img[0], phi, theta, world2[0],
+                   vec[0], stat2);
+  if (status1 || status2 || memcmp(stat1, stat2, sizeof(stat1))) {
+    printf("  wcsp2v status differs from wcsp2s.\n");
+    return 1;
+  }
+
+  for (k = 0; k < 361; k++) {
+    coslat = cosd(world1[k][lat]);
+    dv = fabs(vec[k][0] - coslat*cosd(world1[k][lng])) +
+         fabs(vec[k][1] - coslat*sind(world1[k][lng])) +
+         fabs(vec[k][2] - sind(world1[k][lat]));
+
+    for (i = 0; i < NELEM; i++) {
+      if (world2[k][i] != world1[k][i]) dv = 1.0;
+    }
+
+    if (dv > 1.0e-12) {
+      printf("  wcsp2v differs from wcsp2s at element %d.\n", k);
+      nFail++;
+    }
+  }
+
+  /* The celestial elements of world[] must be ignored by wcsv2p(). */
+  for (k = 0; k < 361; k++) {
+    world2[k][lng] = world2[k][lat] = UNDEFINED;
+  }
+
+  status2 = wcsv2p(wcs, 361, NELEM, world2[0], vec[0], phi, theta, img[0],
+                   pixel2[0], stat2);
+  if (status2 || memcmp(stat1, stat2, sizeof(stat1))) {
+    printf("  wcsv2p status differs from wcss2p.\n");
+    return nFail + 1;
+  }
+
+  for (k = 0; k < 361; k++) {
+    resid = 0.0;
+    for (i = 0; i < NAXIS; i++) {
+      r = pixel2[k][i] - pixel1[k][i];
+      resid += r*r;
+    }
+
+    if (sqrt(resid) > tol) {
+      printf("  wcsv2p differs from wcss2p at element %d.\n", k);
+      nFail++;
+    }
+  }
+
+  /* A constant vector must be replicated. */
+  for (k = 0; k < 361; k++) {
+    for (i = 0; i < NELEM; i++) {
+      pixel2[k][i] = pixel1[0][i];
+    }
+  }
+
+  wcsp2v(wcs, 361, NELEM, pixel2[0], img[0], phi, theta, world2[0], vec[0],
+         stat2);
+  wcsv2p(wcs, 361, NELEM, world2[0], vec[0], phi, theta, img[0], pixel2[0],
+         stat2);
+  for (k = 0; k < 361; k++) {
+    if (vec[k][0] != vec[0][0] || vec[k][1] != vec[0][1] ||
+        vec[k][2] != vec[0][2] || pixel2[k][0] != pixel2[0][0]) {
+      printf("  wcsp2v/wcsv2p constant vector not replicated.\n");
+      nFail++;
+      break;
+    }
+  }
+
+  return nFail;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int test_fast(struct wcsprm *wcs)
+
+{
+  int    i, k, lat, lng, nFail = 0, stat1[361], stat2[361];
+  double dlng, dmax, img[361][NELEM], lat1, phi[361], pixel1[361][NELEM],
+         pixel2[361][NELEM], r, resid, rmax, theta[361], world1[361][NELEM],
+         world2[361][NELEM];
+
+  lng = wcs->lng;
+  lat = wcs->lat;
+
+  memset(world1, 0, sizeof(world1));
+  for (k = 0; k < 361; k++) {
+    world1[k][lng] = k - 180.0;
+    world1[k][2] = 1.0 + k;
+    world1[k][wcs->spec] = 0.21 + k*1.0e-5;
+  }
+
+  dmax = 0.0;
+  rmax = 0.0;
+  for (lat1 = 90.0; lat1 >= -90.0; lat1 -= 1.0) {
+    for (k = 0; k < 361; k++) {
+      world1[k][lat] = lat1;
+    }
+
+    /* Full accuracy. */
+    wcs->accuracy = 0.0;
+    wcs->flag = 0;
+    if (wcss2p(wcs, 361, NELEM, world1[0], phi, theta, img[0], pixel1[0],
+               stat1)) {
+      printf("  At wcss2p#1 in test_fast with lat1 == %f\n", lat1);
+      wcsperr(wcs, "  ");
+      continue;
+    }
+
+    /* Reduced accuracy. */
+    wcs->accuracy = WCS_FASTACC;
+    wcs->flag = 0;
+    if (wcss2p(wcs, 361, NELEM, world1[0], phi, theta, img[0], pixel2[0],
+               stat2) ||
+        wcsp2s(wcs, 361, NELEM, pixel2[0], img[0], phi, theta, world2[0],
+               stat2)) {
+      printf("  At wcss2p#2 in test_fast with lat1 == %f\n", lat1);
+      wcsperr(wcs, "  ");
+      nFail++;
+      continue;
+    }
+
+    if (!wcs->cel.fast) {
+      printf("  wcsset did not select the reduced-accuracy mode.\n");
+      nFail++;
+      break;
+    }
+
+    for (k = 0; k < 361; k++) {
+      if (stat1[k] || stat2[k]) continue;
+
+      /* Agreement with the full-accuracy result (1 pixel = 1 deg). */
+      resid = 0.0;
+      for (i = 0; i < NAXIS; i++) {
+        r = pixel2[k][i] - pixel1[k][i];
+        resid += r*r;
+      }
+      resid = sqrt(resid);
+      if (resid > rmax) rmax = resid;
+
+      /* Closure, on the sky. */
+      dlng = fabs(world2[k][lng] - world1[k][lng]);
+      if (dlng > 180.0) dlng = fabs(dlng - 360.0);
+      dlng *= cosd(lat1);
+      r = sqrt(dlng*dlng + (world2[k][lat] - lat1)*(world2[k][lat] - lat1));
+      if (r > dmax) dmax = r;
+
+      if (resid > WCS_FASTACC || r > WCS_FASTACC) {
+        nFail++;
+        printf("  Reduced-accuracy error at (%.1f,%.1f): pixel %.1e, "
+          "closure %.1e.\n", world1[k][lng], lat1, resid, r);
+      }
+    }
+  }
+
+  printf("\nReduced accuracy (WCS_FASTACC = %.0e deg):\n", WCS_FASTACC);
+  printf("  Maximum difference from full accuracy = %.1e pixel.\n", rmax);
+  printf("  Maximum closure residual = %.1e deg.\n", dmax);
+
+  wcs->accuracy = 0.0;
+  wcs->flag = 0;
+
+  return nFail;
+}
+
+/*----------------------------------------------------------------------------
+* Check that wcss2pf() and wcsp2sf() agree with wcss2p() and wcsp2s(), applied
+* to the same coordinates, to within the rounding of the results to float.
+* 361 coordinates span more than one of the tiles in which they are
+* converted.
+*---------------------------------------------------------------------------*/
+
+int test_float(struct wcsprm *wcs)
+
+{
+  int    i, k, lat, lng, nFail = 0, stat1[361], stat2[361];
+  double img[361][NELEM], lat1, phi[361], pixel[361][NELEM], theta[361],
+         world[361][NELEM];
+  float  imgf[361][NELEM], phif[361], pixelf[361][NELEM], thetaf[361],
+         worldf[361][NELEM];
+
+  lng = wcs->lng;
+  lat = wcs->lat;
+
+  memset(worldf, 0, sizeof(worldf));
+  for (k = 0; k < 361; k++) {
+    worldf[k][lng] = (float)(k - 180.0);
+    worldf[k][2] = (float)(1.0 + k);
+    worldf[k][wcs->spec] = (float)(0.21 + k*1.0e-5);
+  }
+
+  for (lat1 = 90.0; lat1 >= -90.0; lat1 -= 5.0) {
+    for (k = 0; k < 361; k++) {
+      worldf[k][lat] = (float)lat1;
+      for (i = 0; i < NELEM; i++) {
+        world[k][i] = worldf[k][i];
+      }
+    }
+
+    if (wcss2p(wcs, 361, NELEM, world[0], phi, theta, img[0], pixel[0],
+               stat1)) {
+      printf("  At wcss2p in test_float with lat1 == %f\n", lat1);
+      wcsperr(wcs, "  ");
+      continue;
+    }
+
+    if (wcss2pf(wcs, 361, NELEM, worldf[0], phif, thetaf, imgf[0],
+                pixelf[0], stat2)) {
+      printf("  At wcss2pf in test_float with lat1 == %f\n", lat1);
+      wcsperr(wcs, "  ");
+      nFail++;
+      continue;
+    }
+
+    for (k = 0; k < 361; k++) {
+      if (stat1[k] != stat2[k]) {
+        printf("  wcss2pf: stat differs at (%.1f,%.1f).\n",
+          world[k][lng], lat1);
+        nFail++;
+      }
+      if (stat1[k]) continue;
+
+      nFail += float_cmp(NAXIS, pixelf[k], pixel[k], "wcss2pf");
+      nFail += float_cmp(NAXIS, imgf[k], img[k], "wcss2pf");
+      nFail += float_cmp(1, phif+k, phi+k, "wcss2pf");
+      nFail += float_cmp(1, thetaf+k, theta+k, "wcss2pf");
+    }
+
+    /* Pixel-to-world, from the single-precision pixel coordinates. */
+    for (k = 0; k < 361; k++) {
+      for (i = 0; i < NELEM; i++) {
+        pixel[k][i] = pixelf[k][i];
+      }
+    }
+
+    if (wcsp2s(wcs, 361, NELEM, pixel[0], img[0], phi, theta, world[0],
+               stat1)) {
+      printf("  At wcsp2s in test_float with lat1 == %f\n", lat1);
+      wcsperr(wcs, "  ");
+      continue;
+    }
+
+    if (wcsp2sf(wcs, 361, NELEM, pixelf[0], imgf[0], phif, thetaf,
+                worldf[0], stat2)) {
+      printf("  At wcsp2sf in test_float with lat1 == %f\n", lat1);
+      wcsperr(wcs, "  ");
+      nFail++;
+      continue;
+    }
+
+    for (k = 0; k < 361; k++) {
+      if (stat1[k] != stat2[k]) {
+        printf("  wcsp2sf: stat differs at (%.1f,%.1f).\n",
+          world[k][lng], lat1);
+        nFail++;
+      }
+      if (stat1[k]) continue;
+
+      nFail += float_cmp(NAXIS, worldf[k], world[k], "wcsp2sf");
+      nFail += float_cmp(NAXIS, imgf[k], img[k], "wcsp2sf");
+      nFail += float_cmp(1, phif+k, phi+k, "wcsp2sf");
+      nFail += float_cmp(1, thetaf+k, theta+k, "wcsp2sf");
+    }
+
+    /* Restore the input for the next latitude. */
+    for (k = 0; k < 361; k++) {
+      worldf[k][lng] = (float)(k - 180.0);
+      worldf[k][2] = (float)(1.0 + k);
+      worldf[k][wcs->spec] = (float)(0.21 + k*1.0e-5);
+    }
+  }
+
+  return nFail;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int float_cmp(
+  int n,
+  const float f[],
+  const double d[],
+  const char *func)
+
+{
+  int i, nFail = 0;
+  double tolf;
+
+  for (i = 0; i < n; i++) {
+    /* One unit in the last place, relative to max(1,|d|). */
+    tolf = FLT_EPSILON*(fabs(d[i]) > 1.0 ? fabs(d[i]) : 1.0);
+    if (fabs(f[i] - d[i]) > tolf) {
+      printf("  %s: %.9g differs from %.17g.\n", func, f[i], d[i]);
+      nFail++;
+    }
+  }
+
+  return nFail;
+}
+
+/*----------------------------------------------------------------------------
+* Check that wcsp2sb() agrees with wcsp2s() applied to the pixel coordinates
+* of the box, for celestial axes with separable spectral and logarithmic
+* axes varying along and across the rows, and with none.
+*---------------------------------------------------------------------------*/
+
+int test_box(struct wcsprm *wcs)
+
+{
+  const char *(ctype[3]) = {"RA---CEA", "FREQ", "DEC--CEA"};
+  const double pix0[4] = {1.0, 1.0, 1.0, 1.0};
+  const int dims1[4] = {7, 5, 3, 4}, dims2[3] = {36, 10, 20},
+            dims3[3] = {50, 8, 6}, dims4[3] = {50, 1, 6};
+  int i, nFail = 0;
+  struct wcsprm box;
+
+  /* The test header, a logarithmic axis across the rows. */
+  nFail += box_cmp(wcs, dims1, pix0, "BON");
+
+  /* A spectral axis across the rows, with invalid pixels. */
+  box.flag = -1;
+  wcsini(1, 3, &box);
+  for (i = 0; i < 3; i++) {
+    strcpy(box.ctype[i], ctype[i]);
+  }
+  box.crpix[0] =  18.5;
+  box.crpix[1] =   1.0;
+  box.crpix[2] =  10.5;
+  box.cdelt[0] = -10.0;
+  box.cdelt[1] =   1.0e6;
+  box.cdelt[2] =  10.0;
+  box.crval[0] =  30.0;
+  box.crval[1] =   1.42e9;
+  box.crval[2] =  40.0;
+  nFail += box_cmp(&box, dims2, pix0, "oblique CEA");
+
+  /* A spectral axis along the rows. */
+  strcpy(box.ctype[0], "FREQ");
+  strcpy(box.ctype[1], "RA---TAN");
+  strcpy(box.ctype[2], "DEC--TAN");
+  strcpy(box.cunit[0], "Hz");
+  strcpy(box.cunit[1], "deg");
+  box.crpix[0] =   1.0;
+  box.crpix[1] =   4.5;
+  box.cdelt[0] =   1.0e6;
+  box.cdelt[1] =  -0.1;
+  box.cdelt[2] =   0.1;
+  box.crval[0] =   1.42e9;
+  box.crval[1] =  30.0;
+  box.pc[5] = 0.1;
+  box.flag = 0;
+  nFail += box_cmp(&box, dims3, pix0, "TAN");
+  nFail += box_cmp(&box, dims4, pix0, "TAN plane");
+
+  /* No separable axes. */
+  box.pc[3] = 0.01;
+  box.flag = 0;
+  nFail += box_cmp(&box, dims3, pix0, "coupled TAN");
+
+  wcsfree(&box);
+
+  return nFail;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int box_cmp(
+  struct wcsprm *wcs,
+  const int dims[],
+  const double pix0[],
+  const char *label)
+
+{
+  int    i, *idx, j, k, m, n, naxis, nFail, *stat1, *stat2, status1,
+         status2;
+  double d, dmax, *img1, *img2, *phi1, *phi2, *pixcrd, *theta1, *theta2,
+         *world1, *world2;
+
+  wcsset(wcs);
+  naxis = wcs->naxis;
+
+  n = 1;
+  for (j = 0; j < naxis; j++) {
+    n *= dims[j];
+  }
+
+  m = n*naxis;
+  pixcrd = malloc((5*m + 4*n)*sizeof(double));
+  img1   = pixcrd + m;
+  img2   = img1 + m;
+  world1 = img2 + m;
+  world2 = world1 + m;
+  phi1   = world2 + m;
+  phi2   = phi1 + n;
+  theta1 = phi2 + n;
+  theta2 = theta1 + n;
+  stat1  = malloc((2*n + naxis)*sizeof(int));
+  stat2  = stat1 + n;
+  idx    = stat2 + n;
+
+  /* Pixel coordinates in FITS order. */
+  for (j = 0; j < naxis; j++) {
+    idx[j] = 0;
+  }
+
+  for (k = 0; k < n; k++) {
+    for (j = 0; j < naxis; j++) {
+      pixcrd[k*naxis + j] = pix0[j] + idx[j];
+    }
+
+    for (j = 0; j < naxis; j++) {
+      if (++idx[j] < dims[j]) break;
+      idx[j] = 0;
+    }
+  }
+
+  status1 = wcsp2s(wcs, n, naxis, pixcrd, img1, phi1, theta1, world1, stat1);
+  status2 = wcsp2sb(wcs, naxis, pix0, dims, img2, phi2, theta2, world2,
+                    stat2);
+
+  nFail = (status2 != status1);
+  dmax = 0.0;
+  for (k = 0; k < n; k++) {
+    if (stat2[k] != stat1[k]) {
+      nFail++;
+      continue;
+    }
+
+    for (i = 0; i < naxis; i++) {
+      d = fabs(img2[k*naxis + i] - img1[k*naxis + i]);
+      if (dmax < d) dmax = d;
+
+      if (stat1[k] & (1 << i)) continue;
+      d = fabs(world2[k*naxis + i] - world1[k*naxis + i]);
+      if (fabs(world1[k*naxis + i]) > 1.0) d /= fabs(world1[k*naxis + i]);
+      if (dmax < d) dmax = d;
+    }
+
+    if (stat1[k] & ((1 << wcs->lng) | (1 << wcs->lat))) continue;
+    d = fabs(phi2[k] - phi1[k]);
+    if (dmax < d) dmax = d;
+    d = fabs(theta2[k] - theta1[k]);
+    if (dmax < d) dmax = d;
+  }
+
+  if (dmax > tol) nFail++;
+
+  printf("wcsp2sb: %d-pixel %s box, status %d, maximum discrepancy "
+    "%.1e.\n", n, label, status2, dmax);
+  if (nFail) {
+    printf("  wcsp2sb differs from wcsp2s for the %s box.\n", label);
+  }
+
+  free(stat1);
+  free(pixcrd);
+
+  return nFail;
+}
@@ -26,7 +26,8 @@
 *=============================================================================
 *
 * twcssub tests wcssub() which extracts the coordinate description for a
-* subimage from a wcsprm struct.
+* subimage from a wcsprm struct, and wcsshr() which does so sharing the lookup
+* tables.
 *
 *---------------------------------------------------------------------------*/
 
@@ -60,6 +61,8 @@ int NPS, NPV;
 struct pvcard PV[10];
 struct pscard PS[10];
 
+void shrtest(void);
+
 
 int main()
 
@@ -184,5 +187,101 @@ int main()
   wcsfree(&wcs);
   wcsfree(&wcsext);
 
+
+  shrtest();
+
   return 0;
 }
+
+/*----------------------------------------------------------------------------
+* shrtest() checks that wcsshr() shares the lookup table of a -TAB axis, that
+* wcssub() copies it, and that the shared copy gives identical results and
+* outlives the original.
+*---------------------------------------------------------------------------*/
+
+void shrtest(void)
+
+{
+  const int K[1] = {5};
+  const double pixcrd[5] = {1.0, 1.5, 2.5, 3.5, 5.0};
+  int k, nFail = 0, stat[5];
+  double imgcrd[5], phi[5], theta[5], world[2][5];
+  struct tabprm tab;
+  struct wcsprm wcs, wcscpy, wcsown, wcsshd;
+
+  printf("\n\nLookup table sharing by wcsshr():\n");
+
+  tab.flag = -1;
+  tabini(1, 1, K, &tab);
+  tab.map[0]   = 0;
+  tab.crval[0] = 1.0;
+  for (k = 0; k < K[0]; k++) {
+    tab.index[0][k] = k + 1.0;
+    tab.coord[k] = 1.0e-6*(1.0 + 0.1*k*k);
+  }
+
+  wcs.flag = -1;
+  wcsini(1, 1, &wcs);
+  wcs.crpix[0] = 1.0;
+  wcs.cdelt[0] = 1.0;
+  wcs.crval[0] = 1.0;
+  strcpy(wcs.ctype[0], "WAVE-TAB");
+  strcpy(wcs.cunit[0], "m");
+  wcs.ntab = 1;
+  wcs.tab  = &tab;
+
+  wcscpy.flag = -1;
+  wcsown.flag = -1;
+  wcsshd.flag = -1;
+  if (wcsp2s(&wcs, 5, 1, pixcrd, imgcrd, phi, theta, world[0], stat) ||
+      wcssub(1, &wcs, 0x0, 0x0, &wcscpy) ||
+      wcsshr(1, &wcs, 0x0, 0x0, &wcsown) ||
+      wcsshr(1, &wcs, 0x0, 0x0, &wcsshd) ||
+      tabown(wcsown.tab)) {
+    printf("ERROR: wcssub(), wcsshr() or tabown() failed.\n");
+    return;
+  }
+
+  if (wcscpy.tab[0].coord == tab.coord) {
+    nFail++;
+    printf("ERROR: wcssub() shared the lookup table.\n");
+  }
+
+  if (wcsshd.tab[0].coord != tab.coord ||
+      wcsshd.tab[0].index[0] != tab.index[0]) {
+    nFail++;
+    printf("ERROR: wcsshr() did not share the lookup table.\n");
+  }
+
+  if (wcsown.tab[0].coord == tab.coord ||
+      wcsown.tab[0].coord[K[0]-1] != tab.coord[K[0]-1]) {
+    nFail++;
+    printf("ERROR: tabown() did not make a private copy.\n");
+  }
+
+  /* The shared table must outlive the original. */
+  wcsfree(&wcs);
+  tabfree(&tab);
+
+  if (wcsp2s(&wcsshd, 5, 1, pixcrd, imgcrd, phi, theta, world[1], stat)) {
+    nFail++;
+    wcsperr(&wcsshd, "");
+  } else {
+    for (k = 0; k < 5; k++) {
+      if (world[1][k] != world[0][k]) {
+        nFail++;
+        printf("ERROR: wcsp2s() results differ for the shared table.\n");
+        break;
+      }
+    }
+  }
+
+  if (nFail == 0) {
+    printf("wcsshr() shares the lookup table, wcssub() copies it, and "
+           "the results agree.\n");
+  }
+
+  wcsfree(&wcscpy);
+  wcsfree(&wcsown);
+  wcsfree(&wcsshd);
+}
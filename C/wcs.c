@@ -25,6 +25,7 @@
   $Id: wcs.c,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
 *===========================================================================*/
 
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -75,9 +76,47 @@ const char *wcs_errmsg[] = {
 #define signbit(X) ((X) < 0.0 ? 1 : 0)
 #endif
 
+/* Number of coordinates per tile converted to double precision by
+   wcsp2sf() and wcss2pf(). */
+#define WCS_NFLT 256
+
 /* Internal helper functions, not for general use. */
+static int wcs_sub(const char *, int, int, const struct wcsprm *, int *,
+                   int[], struct wcsprm *);
 static int wcs_types(struct wcsprm *);
 static int wcs_units(struct wcsprm *);
+static int wcs_p2s(struct wcsprm *, struct celprm *, struct spcprm *, int,
+                   int, const double[], double[], double[], double[],
+                   double[], double[], int[], int[], int[], double[],
+                   struct wcserr **);
+static int wcs_x2s(struct wcsprm *, struct celprm *, struct spcprm *, int,
+                   int, int, double[], double[], double[], double[],
+                   double[], int[], int[], int[], double[],
+                   struct wcserr **);
+static int wcs_groups(const struct wcsprm *, int[], int[]);
+static void wcs_merge(int, int[], int[], int, int);
+static int wcs_box(struct wcsprm *, int, const double[], const int[], int,
+                   int, double[], double[], double[], double[], int[],
+                   int[], int[], double[], struct wcserr **);
+static int wcs_s2p(struct wcsprm *, struct celprm *, struct spcprm *, int,
+                   int, const double[], const double[], double[], double[],
+                   double[], double[], int[], int[], int[], double[],
+                   double *[], struct wcserr **);
+static int wcs_wrk(const struct wcsprm *, int, double[], int **, int **,
+                   double **, double ***);
+static int wcs_thr(struct wcsprm *, int, int, int, int, int, const double[],
+                   double[], double[], double[], double[], int[]);
+static void wcs_thrtask(void *, int);
+
+/* A multi-threaded transformation, split into chunks for wcs_thrtask(). */
+struct wcs_thrjob {
+  struct wcsprm *wcs;
+  int    p2s, ncoord, nelem, nchunk, nwrk;
+  const double *in;
+  double *imgcrd, *phi, *theta, *out, *wrk;
+  int    *stat, *status;
+  struct wcserr **err;
+};
 
 /*--------------------------------------------------------------------------*/
 
@@ -105,12 +144,14 @@ int wcsini(int alloc, int naxis, struct wcsprm *wcs)
     if (wcs->cel.err) free(wcs->cel.err);
     if (wcs->spc.err) free(wcs->spc.err);
     if (wcs->cel.prj.err) free(wcs->cel.prj.err);
+    if (wcs->cel.prj.wtab) free(wcs->cel.prj.wtab);
   }
   wcs->err = 0x0;
   wcs->lin.err = 0x0;
   wcs->cel.err = 0x0;
   wcs->spc.err = 0x0;
   wcs->cel.prj.err = 0x0;
+  wcs->cel.prj.wtab = 0x0;
 
 
   /* Initialize pointers. */
@@ -488,6 +529,7 @@ int wcsini(int alloc, int naxis, struct wcsprm *wcs)
   }
   wcs->altlin = 0;
   wcs->velref = 0;
+  wcs->accuracy = 0.0;
 
   /* Defaults for auxiliary coordinate system information. */
   memset(wcs->alt, 0, 4);
@@ -545,8 +587,37 @@ int wcssub(
   struct wcsprm *wcsdst)
 
 {
-  static const char *function = "wcssub";
+  return wcs_sub("wcssub", alloc, 0, wcssrc, nsub, axes, wcsdst);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsshr(
+  int alloc,
+  const struct wcsprm *wcssrc,
+  int *nsub,
+  int axes[],
+  struct wcsprm *wcsdst)
+
+{
+  return wcs_sub("wcsshr", alloc, 1, wcssrc, nsub, axes, wcsdst);
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
 
+/* Common code for wcssub() and wcsshr(), the tabprm structs being copied by
+   tabshr() if share is true, else by tabcpy(). */
+
+int wcs_sub(
+  const char *function,
+  int alloc,
+  int share,
+  const struct wcsprm *wcssrc,
+  int *nsub,
+  int axes[],
+  struct wcsprm *wcsdst)
+
+{
   char *c, ctypei[16];
   int  axis, cubeface, dealloc, dummy, i, itab, j, k, latitude, longitude, m,
        *map = 0x0, msub, naxis, npv, nps, other, spectral, status, stokes;
@@ -885,6 +956,7 @@ int wcssub(
 
   wcsdst->altlin = wcssrc->altlin;
   wcsdst->velref = wcssrc->velref;
+  wcsdst->accuracy = wcssrc->accuracy;
 
   /* Auxiliary coordinate system information. */
   strncpy(wcsdst->alt, wcssrc->alt, 4);
@@ -927,7 +999,7 @@ int wcssub(
     for (m = 0; m < wcssrc->tab[itab].M; m++) {
       i = wcssrc->tab[itab].map[m];
 
-      if (map[i-1]) {
+      if (map[i]) {
         wcsdst->ntab++;
         break;
       }
@@ -951,12 +1023,23 @@ int wcssub(
     for (m = 0; m < wcssrc->tab[itab].M; m++) {
       i = wcssrc->tab[itab].map[m];
 
-      if (map[i-1]) {
-        if ((status = tabcpy(1, wcssrc->tab + itab, tabp))) {
+      if (map[i]) {
+        if (share) {
+          status = tabshr(wcssrc->tab + itab, tabp);
+        } else {
+          status = tabcpy(1, wcssrc->tab + itab, tabp);
+        }
+
+        if (status) {
           wcserr_set(WCS_ERRMSG(status));
           goto cleanup;
         }
 
+        /* Renumber the table axes (0-relative) for the subimage. */
+        for (m = 0; m < tabp->M; m++) {
+          if ((k = map[tabp->map[m]])) tabp->map[m] = k - 1;
+        }
+
         tabp++;
         break;
       }
@@ -1191,6 +1274,7 @@ int wcsprt(const struct wcsprm *wcs)
 
   wcsprintf("     altlin: %d\n", wcs->altlin);
   wcsprintf("     velref: %d\n", wcs->velref);
+  wcsprintf("   accuracy: %g\n", wcs->accuracy);
 
 
 
@@ -1513,6 +1597,8 @@ int wcsset(struct wcsprm *wcs)
   struct celprm *wcscel = &(wcs->cel);
   struct prjprm *wcsprj = &(wcscel->prj);
   struct spcprm *wcsspc = &(wcs->spc);
+  struct tabprm *tab;
+  struct wtbarr *wtbp;
   struct wcserr **err;
 
 
@@ -1532,6 +1618,8 @@ int wcsset(struct wcsprm *wcs)
 
   /* Non-linear celestial axes present? */
   if (wcs->lng >= 0 && wcs->types[wcs->lng] == 2200) {
+    /* Release any table from a previous invocation. */
+    if (wcsprj->wtab) free(wcsprj->wtab);
     celini(wcscel);
 
     /* CRVALia, LONPOLEa, and LATPOLEa keyvalues. */
@@ -1610,6 +1698,7 @@ int wcsset(struct wcsprm *wcs)
 
     /* Initialize the celestial transformation routines. */
     wcsprj->r0 = 0.0;
+    wcscel->fast = (wcs->accuracy >= WCS_FASTACC);
     if ((status = celset(wcscel))) {
       return wcserr_set(WCS_ERRMSG(status+3));
     }
@@ -1678,6 +1767,25 @@ int wcsset(struct wcsprm *wcs)
 
 
   /* Tabular axes present? */
+  for (k = 0, wtbp = wcs->wtb; k < wcs->nwtb; k++, wtbp++) {
+    if (wtbp->kind != 'C' && wtbp->kind != 'I') continue;
+
+    /* Cancel wcstab()'s signal for tabset() to take mapped memory. */
+    for (j = 0; j < wcs->ntab; j++) {
+      tab = wcs->tab + j;
+      if (wtbp->arrayp == &(tab->coord) && tab->m_coord == (double *)0x1) {
+        tab->m_coord = 0x0;
+      }
+
+      for (m = 0; m < tab->m_M && tab->m_indxs; m++) {
+        if (wtbp->arrayp == tab->index + m &&
+            tab->m_indxs[m] == (double *)0x1) {
+          tab->m_indxs[m] = 0x0;
+        }
+      }
+    }
+  }
+
   for (j = 0; j < wcs->ntab; j++) {
     if ((status = tabset(wcs->tab + j))) {
       return wcserr_set(WCS_ERRMSG(status+3));
@@ -2095,12 +2203,7 @@ int wcsp2s(
 {
   static const char *function = "wcsp2s";
 
-  int    bits, face, i, iso_x, iso_y, istat, *istatp, itab, k, m, nx, ny,
-        *statp, status, type;
-  double crvali, offset;
-  register double *img, *wrl;
-  struct celprm *wcscel = &(wcs->cel);
-  struct prjprm *wcsprj = &(wcscel->prj);
+  int    *istatp, status;
   struct wcserr **err;
 
   /* Initialize if required. */
@@ -2117,23 +2220,105 @@ int wcsp2s(
       "ncoord and/or nelem inconsistent with the wcsprm");
   }
 
+  /* Initialize status vectors. */
+  if (!(istatp = calloc(ncoord, sizeof(int)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+
+  status = wcs_p2s(wcs, &(wcs->cel), &(wcs->spc), ncoord, nelem, pixcrd,
+                   imgcrd, phi, theta, world, 0x0, stat, istatp, 0x0, 0x0,
+                   err);
+
+  free(istatp);
+  return status;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Transformation engine for wcsp2s() and wcsplnp2s().  The wcsprm struct must
+   have been set up and the arguments checked by the caller.  Only wcscel,
+   wcsspc, the work arrays and err are written to if tabp0 is non-zero, in
+   which case the tabprm structs are accessed via tabx2sr() using tabp0 and
+   tabdelta as scratch.  If vec is non-zero, the celestial coordinates are
+   returned in it as unit vectors, for wcsp2v(), rather than in world. */
+
+int wcs_p2s(
+  struct wcsprm *wcs,
+  struct celprm *wcscel,
+  struct spcprm *wcsspc,
+  int ncoord,
+  int nelem,
+  const double pixcrd[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  double vec[],
+  int stat[],
+  int istatp[],
+  int tabp0[],
+  double tabdelta[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcsp2s";
+
+  int status;
 
   /* Apply pixel-to-world linear transformation. */
   if ((status = linp2x(&(wcs->lin), ncoord, nelem, pixcrd, imgcrd))) {
     return wcserr_set(WCS_ERRMSG(status));
   }
 
-  /* Initialize status vectors. */
-  if (!(istatp = calloc(ncoord, sizeof(int)))) {
-    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
-  }
+  return wcs_x2s(wcs, wcscel, wcsspc, ncoord, nelem, 0, imgcrd, phi, theta,
+                 world, vec, stat, istatp, tabp0, tabdelta, err);
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* The second half of wcs_p2s(), transforming the intermediate world
+   coordinates in imgcrd to world coordinates.  World axes flagged in the
+   skip bit mask are not computed and their world coordinates and stat bits
+   are left for the caller, wcs_box().  The celestial axes, and the axes of
+   each table, must be skipped together or not at all. */
+
+int wcs_x2s(
+  struct wcsprm *wcs,
+  struct celprm *wcscel,
+  struct spcprm *wcsspc,
+  int ncoord,
+  int nelem,
+  int skip,
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  double vec[],
+  int stat[],
+  int istatp[],
+  int tabp0[],
+  double tabdelta[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcsp2s";
 
+  int    bits, face, i, iso_x, iso_y, istat, itab, k, m, nx, ny, *statp,
+         status, type;
+  double crvali, offset;
+  register double *img, *wrl;
+  struct prjprm *wcsprj = &(wcscel->prj);
+
+
+  status = 0;
   stat[0] = 0;
   wcsutil_setAli(ncoord, 1, stat);
 
 
   /* Convert intermediate world coordinates to world coordinates. */
   for (i = 0; i < wcs->naxis; i++) {
+    if (skip & (1 << i)) continue;
+
     /* Extract the second digit of the axis type code. */
     type = (wcs->types[i] / 100) % 10;
 
@@ -2212,9 +2397,16 @@ int wcsp2s(
       }
 
       /* Transform projection plane coordinates to celestial coordinates. */
-      if ((istat = celx2s(wcscel, nx, ny, nelem, nelem, imgcrd+i,
-                          imgcrd+wcs->lat, phi, theta, world+i,
-                          world+wcs->lat, istatp))) {
+      if (vec) {
+        istat = celx2v(wcscel, nx, ny, nelem, 3, imgcrd+i, imgcrd+wcs->lat,
+                       phi, theta, vec, istatp);
+      } else {
+        istat = celx2s(wcscel, nx, ny, nelem, nelem, imgcrd+i,
+                       imgcrd+wcs->lat, phi, theta, world+i, world+wcs->lat,
+                       istatp);
+      }
+
+      if (istat) {
         if (istat == CELERR_BAD_PIX) {
           status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_PIX));
         } else {
@@ -2225,8 +2417,14 @@ int wcsp2s(
 
       /* If x and y were both constant, replicate values. */
       if (iso_x && iso_y) {
-        wcsutil_setAll(ncoord, nelem, world+i);
-        wcsutil_setAll(ncoord, nelem, world+wcs->lat);
+        if (vec) {
+          wcsutil_setAll(ncoord, 3, vec);
+          wcsutil_setAll(ncoord, 3, vec+1);
+          wcsutil_setAll(ncoord, 3, vec+2);
+        } else {
+          wcsutil_setAll(ncoord, nelem, world+i);
+          wcsutil_setAll(ncoord, nelem, world+wcs->lat);
+        }
         wcsutil_setAll(ncoord, 1, phi);
         wcsutil_setAll(ncoord, 1, theta);
         wcsutil_setAli(ncoord, 1, istatp);
@@ -2247,8 +2445,7 @@ int wcsp2s(
       istat = 0;
       if (wcs->types[i] == 3300) {
         /* Spectral coordinates. */
-        istat = spcx2s(&(wcs->spc), nx, nelem, nelem, imgcrd+i, world+i,
-                       istatp);
+        istat = spcx2s(wcsspc, nx, nelem, nelem, imgcrd+i, world+i, istatp);
         if (istat == SPCERR_BAD_X) {
           status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_PIX));
         } else if (istat) {
@@ -2260,7 +2457,7 @@ int wcsp2s(
         istat = logx2s(wcs->crval[i], nx, nelem, nelem, imgcrd+i, world+i,
                        istatp);
         if (istat == LOGERR_BAD_X) {
-          if (*err == 0x0) {
+          if (err == 0x0 || *err == 0x0) {
             wcserr_set(WCS_ERRMSG(WCSERR_BAD_PIX));
           }
         } else if (istat == LOGERR_BAD_LOG_REF_VAL) {
@@ -2284,7 +2481,14 @@ int wcsp2s(
 
   /* Do tabular coordinates. */
   for (itab = 0; itab < wcs->ntab; itab++) {
-    istat = tabx2s(wcs->tab + itab, ncoord, nelem, imgcrd, world, istatp);
+    if (skip & (1 << wcs->tab[itab].map[0])) continue;
+
+    if (tabp0) {
+      istat = tabx2sr(wcs->tab + itab, ncoord, nelem, imgcrd, world, istatp,
+                      tabp0, tabdelta, 0x0);
+    } else {
+      istat = tabx2s(wcs->tab + itab, ncoord, nelem, imgcrd, world, istatp);
+    }
 
     if (istat == TABERR_BAD_X) {
       status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_PIX));
@@ -2310,7 +2514,6 @@ int wcsp2s(
   }
 
 cleanup:
-  free(istatp);
   return status;
 }
 
@@ -2330,13 +2533,7 @@ int wcss2p(
 {
   static const char *function = "wcss2p";
 
-  int    bits, i, isolat, isolng, isospec, istat, *istatp, itab, k, m, nlat,
-         nlng, nwrld, status, type;
-  double crvali, offset;
-  register const double *wrl;
-  register double *img;
-  struct celprm *wcscel = &(wcs->cel);
-  struct prjprm *wcsprj = &(wcscel->prj);
+  int    *istatp, status;
   struct wcserr **err;
 
 
@@ -2359,6 +2556,51 @@ int wcss2p(
     return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
   }
 
+  status = wcs_s2p(wcs, &(wcs->cel), &(wcs->spc), ncoord, nelem, world, 0x0,
+                   phi, theta, imgcrd, pixcrd, stat, istatp, 0x0, 0x0, 0x0,
+                   err);
+
+  free(istatp);
+  return status;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Transformation engine for wcss2p() and wcsplns2p(), see wcs_p2s().  For
+   multi-dimensional tables, tabcoord must also be supplied with tabp0.  If
+   vec is non-zero, the celestial coordinates are taken from it as unit
+   vectors, for wcsv2p(), rather than from world. */
+
+int wcs_s2p(
+  struct wcsprm *wcs,
+  struct celprm *wcscel,
+  struct spcprm *wcsspc,
+  int ncoord,
+  int nelem,
+  const double world[],
+  const double vec[],
+  double phi[],
+  double theta[],
+  double imgcrd[],
+  double pixcrd[],
+  int stat[],
+  int istatp[],
+  int tabp0[],
+  double tabdelta[],
+  double *tabcoord[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcss2p";
+
+  int    bits, i, isolat, isolng, isospec, istat, itab, k, m, nlat, nlng,
+         nwrld, status, type;
+  double crvali, offset;
+  register const double *wrl;
+  register double *img;
+  struct prjprm *wcsprj = &(wcscel->prj);
+
+
   status = 0;
   stat[0] = 0;
   wcsutil_setAli(ncoord, 1, stat);
@@ -2381,22 +2623,38 @@ int wcss2p(
       }
 
     } else if (wcs->types[i] == 2200) {
-      /* Celestial coordinates; check for constant lng and/or lat. */
-      nlng = ncoord;
-      nlat = 0;
+      if (vec) {
+        /* Celestial unit vectors; check for constancy. */
+        nlng = ncoord;
+        isolng = isolat = wcsutil_allEq(ncoord, 3, vec) &&
+                          wcsutil_allEq(ncoord, 3, vec+1) &&
+                          wcsutil_allEq(ncoord, 3, vec+2);
+        if (isolng) nlng = 1;
+
+        /* Transform celestial coordinates to projection plane coordinates. */
+        istat = celv2x(wcscel, nlng, 3, nelem, vec, phi, theta, imgcrd+i,
+                       imgcrd+wcs->lat, istatp);
 
-      if ((isolng = wcsutil_allEq(ncoord, nelem, world+i))) {
-        nlng = 1;
-        nlat = ncoord;
-      }
-      if ((isolat = wcsutil_allEq(ncoord, nelem, world+wcs->lat))) {
-        nlat = 1;
+      } else {
+        /* Celestial coordinates; check for constant lng and/or lat. */
+        nlng = ncoord;
+        nlat = 0;
+
+        if ((isolng = wcsutil_allEq(ncoord, nelem, world+i))) {
+          nlng = 1;
+          nlat = ncoord;
+        }
+        if ((isolat = wcsutil_allEq(ncoord, nelem, world+wcs->lat))) {
+          nlat = 1;
+        }
+
+        /* Transform celestial coordinates to projection plane coordinates. */
+        istat = cels2x(wcscel, nlng, nlat, nelem, nelem, world+i,
+                       world+wcs->lat, phi, theta, imgcrd+i, imgcrd+wcs->lat,
+                       istatp);
       }
 
-      /* Transform celestial coordinates to projection plane coordinates. */
-      if ((istat = cels2x(wcscel, nlng, nlat, nelem, nelem, world+i,
-                          world+wcs->lat, phi, theta, imgcrd+i,
-                          imgcrd+wcs->lat, istatp))) {
+      if (istat) {
         if (istat == CELERR_BAD_WORLD) {
           status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_WORLD));
         } else {
@@ -2464,8 +2722,8 @@ int wcss2p(
       istat = 0;
       if (wcs->types[i] == 3300) {
         /* Spectral coordinates. */
-        istat = spcs2x(&(wcs->spc), nwrld, nelem, nelem, world+i,
-                       imgcrd+i, istatp);
+        istat = spcs2x(wcsspc, nwrld, nelem, nelem, world+i, imgcrd+i,
+                       istatp);
         if (istat == SPCERR_BAD_SPEC) {
           status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_WORLD));
         } else if (istat) {
@@ -2500,7 +2758,12 @@ int wcss2p(
 
   /* Do tabular coordinates. */
   for (itab = 0; itab < wcs->ntab; itab++) {
-    istat = tabs2x(wcs->tab + itab, ncoord, nelem, world, imgcrd, istatp);
+    if (tabp0) {
+      istat = tabs2xr(wcs->tab + itab, ncoord, nelem, world, imgcrd, istatp,
+                      tabp0, tabdelta, tabcoord, 0x0);
+    } else {
+      istat = tabs2x(wcs->tab + itab, ncoord, nelem, world, imgcrd, istatp);
+    }
 
     if (istat == TABERR_BAD_WORLD) {
       status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_WORLD));
@@ -2533,42 +2796,27 @@ int wcss2p(
   }
 
 cleanup:
-  free(istatp);
   return status;
 }
 
 /*--------------------------------------------------------------------------*/
 
-int wcsmix(
+int wcsp2v(
   struct wcsprm *wcs,
-  int mixpix,
-  int mixcel,
-  const double vspan[2],
-  double vstep,
-  int viter,
-  double world[],
+  int ncoord,
+  int nelem,
+  const double pixcrd[],
+  double imgcrd[],
   double phi[],
   double theta[],
-  double imgcrd[],
-  double pixcrd[])
+  double world[],
+  double vec[],
+  int stat[])
 
 {
-  static const char *function = "wcsmix";
+  static const char *function = "wcsp2v";
 
-  const int niter = 60;
-  int    crossed, istep, iter, j, k, nstep, retry, stat[1], status;
-  const double tol  = 1.0e-10;
-  const double tol2 = 100.0*tol;
-  double *worldlat, *worldlng;
-  double lambda, span[2], step;
-  double pixmix;
-  double dlng, lng, lng0, lng0m, lng1, lng1m;
-  double dlat, lat, lat0, lat0m, lat1, lat1m;
-  double d, d0, d0m, d1, d1m, dx = 0.0;
-  double dabs, dmin, lmin;
-  double dphi, phi0, phi1;
-  struct celprm *wcscel = &(wcs->cel);
-  struct wcsprm wcs0;
+  int    *istatp, status;
   struct wcserr **err;
 
   /* Initialize if required. */
@@ -2579,71 +2827,1224 @@ int wcsmix(
     if ((status = wcsset(wcs))) return status;
   }
 
-  worldlng = world + wcs->lng;
-  worldlat = world + wcs->lat;
-
-
-  /* Check vspan. */
-  if (vspan[0] <= vspan[1]) {
-    span[0] = vspan[0];
-    span[1] = vspan[1];
-  } else {
-    /* Swap them. */
-    span[0] = vspan[1];
-    span[1] = vspan[0];
+  /* Sanity check. */
+  if (wcs->lng < 0 || wcs->types[wcs->lng] != 2200) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "wcsp2v() requires projected celestial axes");
   }
 
-  /* Check vstep. */
-  step = fabs(vstep);
-  if (step == 0.0) {
-    step = (span[1] - span[0])/10.0;
-    if (step > 1.0 || step == 0.0) step = 1.0;
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
   }
 
-  /* Check viter. */
-  nstep = viter;
-  if (nstep < 5) {
-    nstep = 5;
-  } else if (nstep > 10) {
-    nstep = 10;
+  /* Initialize status vectors. */
+  if (!(istatp = calloc(ncoord, sizeof(int)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
   }
 
-  /* Given pixel element. */
-  pixmix = pixcrd[mixpix];
+  status = wcs_p2s(wcs, &(wcs->cel), &(wcs->spc), ncoord, nelem, pixcrd,
+                   imgcrd, phi, theta, world, vec, stat, istatp, 0x0, 0x0,
+                   err);
 
-  /* Iterate on the step size. */
-  for (istep = 0; istep <= nstep; istep++) {
-    if (istep) step /= 2.0;
+  free(istatp);
+  return status;
+}
 
-    /* Iterate on the sky coordinate between the specified range. */
-    if (mixcel == 1) {
-      /* Celestial longitude is given. */
+/*--------------------------------------------------------------------------*/
 
-      /* Check whether the solution interval is a crossing interval. */
-      lat0 = span[0];
-      *worldlat = lat0;
-      if ((status = wcss2p(wcs, 1, 0, world, phi, theta, imgcrd, pixcrd,
-                           stat))) {
-        if (status == WCSERR_BAD_WORLD) {
-          status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_WORLD_COORD));
-        }
-        return status;
-      }
-      d0 = pixcrd[mixpix] - pixmix;
+int wcsv2p(
+  struct wcsprm *wcs,
+  int ncoord,
+  int nelem,
+  const double world[],
+  const double vec[],
+  double phi[],
+  double theta[],
+  double imgcrd[],
+  double pixcrd[],
+  int stat[])
 
-      dabs = fabs(d0);
-      if (dabs < tol) return 0;
+{
+  static const char *function = "wcsv2p";
 
-      lat1 = span[1];
-      *worldlat = lat1;
-      if ((status = wcss2p(wcs, 1, 0, world, phi, theta, imgcrd, pixcrd,
-                           stat))) {
-        if (status == WCSERR_BAD_WORLD) {
-          status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_WORLD_COORD));
-        }
-        return status;
-      }
-      d1 = pixcrd[mixpix] - pixmix;
+  int    *istatp, status;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  if (wcs->lng < 0 || wcs->types[wcs->lng] != 2200) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "wcsv2p() requires projected celestial axes");
+  }
+
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  /* Initialize status vectors. */
+  if (!(istatp = calloc(ncoord, sizeof(int)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+
+  status = wcs_s2p(wcs, &(wcs->cel), &(wcs->spc), ncoord, nelem, world, vec,
+                   phi, theta, imgcrd, pixcrd, stat, istatp, 0x0, 0x0, 0x0,
+                   err);
+
+  free(istatp);
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcswrksz(const struct wcsprm *wcs, int ncoord, int *nwrk)
+
+{
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+
+  *nwrk = wcs_wrk(wcs, ncoord, 0x0, 0x0, 0x0, 0x0, 0x0);
+
+  return 0;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Return the length, in doubles, of the work array required for ncoord
+   coordinates and, if wrk is non-zero, partition it into the status vector
+   and the scratch arrays used by tabx2sr() and tabs2xr().  The doubles and
+   pointers come first to keep them aligned. */
+
+int wcs_wrk(
+  const struct wcsprm *wcs,
+  int ncoord,
+  double wrk[],
+  int **istatp,
+  int **tabp0,
+  double **tabdelta,
+  double ***tabcoord)
+
+{
+  int itab, Mmax, nint, nptr;
+
+  /* Tabular scratch is sized for the largest table. */
+  Mmax = 0;
+  for (itab = 0; itab < wcs->ntab; itab++) {
+    if (Mmax < wcs->tab[itab].M) Mmax = wcs->tab[itab].M;
+  }
+
+  if (ncoord < 1) ncoord = 1;
+  nptr = ((1 << Mmax)*sizeof(double *) + sizeof(double) - 1) /
+           sizeof(double);
+  nint = ((ncoord + Mmax + 1)*sizeof(int) + sizeof(double) - 1) /
+           sizeof(double);
+
+  if (wrk) {
+    *tabdelta = wrk;
+    *tabcoord = (double **)(wrk + Mmax + 1);
+    *tabp0    = (int *)(wrk + Mmax + 1 + nptr);
+    *istatp   = *tabp0 + Mmax + 1;
+  }
+
+  return (Mmax + 1) + nptr + nint;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsp2sw(
+  struct wcsprm *wcs,
+  int ncoord,
+  int nelem,
+  const double pixcrd[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  int stat[],
+  int nwrk,
+  double wrk[])
+
+{
+  static const char *function = "wcsp2sw";
+
+  int    *istatp, need, status, *tabp0;
+  double **tabcoord, *tabdelta;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  if (nwrk < (need = wcs_wrk(wcs, ncoord, 0x0, 0x0, 0x0, 0x0, 0x0))) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "Work array too small (need %d, got %d)", need, nwrk);
+  }
+  wcs_wrk(wcs, ncoord, wrk, &istatp, &tabp0, &tabdelta, &tabcoord);
+
+  return wcs_p2s(wcs, &(wcs->cel), &(wcs->spc), ncoord, nelem, pixcrd,
+                 imgcrd, phi, theta, world, 0x0, stat, istatp, tabp0,
+                 tabdelta, err);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcss2pw(
+  struct wcsprm *wcs,
+  int ncoord,
+  int nelem,
+  const double world[],
+  double phi[],
+  double theta[],
+  double imgcrd[],
+  double pixcrd[],
+  int stat[],
+  int nwrk,
+  double wrk[])
+
+{
+  static const char *function = "wcss2pw";
+
+  int    *istatp, need, status, *tabp0;
+  double **tabcoord, *tabdelta;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  if (nwrk < (need = wcs_wrk(wcs, ncoord, 0x0, 0x0, 0x0, 0x0, 0x0))) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "Work array too small (need %d, got %d)", need, nwrk);
+  }
+  wcs_wrk(wcs, ncoord, wrk, &istatp, &tabp0, &tabdelta, &tabcoord);
+
+  return wcs_s2p(wcs, &(wcs->cel), &(wcs->spc), ncoord, nelem, world, 0x0,
+                 phi, theta, imgcrd, pixcrd, stat, istatp, tabp0, tabdelta,
+                 tabcoord, err);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsp2sf(
+  struct wcsprm *wcs,
+  int ncoord,
+  int nelem,
+  const float pixcrd[],
+  float imgcrd[],
+  float phi[],
+  float theta[],
+  float world[],
+  int stat[])
+
+{
+  static const char *function = "wcsp2sf";
+
+  int    i, istat, k, n, naxis, nwrk, status;
+  double *img, *pix, *phib, *thetab, *wrk, *wrl;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  /* Double precision buffers for one tile, followed by the work array. */
+  naxis = wcs->naxis;
+  n = (ncoord < WCS_NFLT) ? ncoord : WCS_NFLT;
+  nwrk = wcs_wrk(wcs, n, 0x0, 0x0, 0x0, 0x0, 0x0);
+  if (!(pix = malloc((n*(3*naxis + 2) + nwrk)*sizeof(double)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+  img    = pix + n*naxis;
+  wrl    = img + n*naxis;
+  phib   = wrl + n*naxis;
+  thetab = phib + n;
+  wrk    = thetab + n;
+
+  status = 0;
+  for (k = 0; k < ncoord; k += n) {
+    if (n > ncoord - k) n = ncoord - k;
+
+    for (i = 0; i < n*naxis; i++) {
+      pix[i] = pixcrd[(k + i/naxis)*nelem + i%naxis];
+    }
+
+    istat = wcsp2sw(wcs, n, naxis, pix, img, phib, thetab, wrl, stat + k,
+                    nwrk, wrk);
+    if (istat) {
+      if (istat != WCSERR_BAD_PIX) {
+        free(pix);
+        return istat;
+      }
+      status = WCSERR_BAD_PIX;
+    }
+
+    for (i = 0; i < n*naxis; i++) {
+      imgcrd[(k + i/naxis)*nelem + i%naxis] = (float)img[i];
+      world[(k + i/naxis)*nelem + i%naxis]  = (float)wrl[i];
+    }
+
+    for (i = 0; i < n; i++) {
+      phi[k+i]   = (float)phib[i];
+      theta[k+i] = (float)thetab[i];
+    }
+  }
+
+  free(pix);
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcss2pf(
+  struct wcsprm *wcs,
+  int ncoord,
+  int nelem,
+  const float world[],
+  float phi[],
+  float theta[],
+  float imgcrd[],
+  float pixcrd[],
+  int stat[])
+
+{
+  static const char *function = "wcss2pf";
+
+  int    i, istat, k, n, naxis, nwrk, status;
+  double *img, *pix, *phib, *thetab, *wrk, *wrl;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  /* Double precision buffers for one tile, followed by the work array. */
+  naxis = wcs->naxis;
+  n = (ncoord < WCS_NFLT) ? ncoord : WCS_NFLT;
+  nwrk = wcs_wrk(wcs, n, 0x0, 0x0, 0x0, 0x0, 0x0);
+  if (!(wrl = malloc((n*(3*naxis + 2) + nwrk)*sizeof(double)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+  img    = wrl + n*naxis;
+  pix    = img + n*naxis;
+  phib   = pix + n*naxis;
+  thetab = phib + n;
+  wrk    = thetab + n;
+
+  status = 0;
+  for (k = 0; k < ncoord; k += n) {
+    if (n > ncoord - k) n = ncoord - k;
+
+    for (i = 0; i < n*naxis; i++) {
+      wrl[i] = world[(k + i/naxis)*nelem + i%naxis];
+    }
+
+    istat = wcss2pw(wcs, n, naxis, wrl, phib, thetab, img, pix, stat + k,
+                    nwrk, wrk);
+    if (istat) {
+      if (istat != WCSERR_BAD_WORLD) {
+        free(wrl);
+        return istat;
+      }
+      status = WCSERR_BAD_WORLD;
+    }
+
+    for (i = 0; i < n*naxis; i++) {
+      imgcrd[(k + i/naxis)*nelem + i%naxis] = (float)img[i];
+      pixcrd[(k + i/naxis)*nelem + i%naxis] = (float)pix[i];
+    }
+
+    for (i = 0; i < n; i++) {
+      phi[k+i]   = (float)phib[i];
+      theta[k+i] = (float)thetab[i];
+    }
+  }
+
+  free(wrl);
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsp2sg(
+  struct wcsprm *wcs,
+  int nx,
+  int ny,
+  int nelem,
+  const double pixcrd[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  int stat[])
+
+{
+  static const char *function = "wcsp2sg";
+
+  int    bits, fast, i, istat, *istatp, ix, iy, j, k, lat, lng, naxis,
+         ncoord, stat0, status;
+  double phi0, theta0, *img, *img0, *pix, *world0;
+  register double *imgp, *pixp, *wrlp;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  naxis = wcs->naxis;
+  lng = wcs->lng;
+  lat = wcs->lat;
+  if (lng < 0 || lat < 0) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "wcsp2sg() requires celestial axes");
+  }
+
+  if (nx < 1 || ny < 1 || nelem < naxis) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "nx, ny and/or nelem inconsistent with the wcsprm");
+  }
+
+  /* For a cylindrical projection, if the celestial pixel axes contribute
+     nothing to any other intermediate world coordinate, phi depends only on
+     the column and theta only on the row. */
+  fast = (wcs->cel.prj.category == CYLINDRICAL && wcs->cubeface == -1);
+  for (i = 0; fast && i < naxis; i++) {
+    if (i != lng && wcs->lin.pc[i*naxis + lng] != 0.0) fast = 0;
+    if (i != lat && wcs->lin.pc[i*naxis + lat] != 0.0) fast = 0;
+  }
+
+  status = 0;
+  bits = (1 << lng) | (1 << lat);
+
+  if (!fast) {
+    /* Transform the grid a row at a time. */
+    if (!(pix = calloc(nx*nelem, sizeof(double)))) {
+      return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+    }
+
+    if (!(istatp = calloc(nx, sizeof(int)))) {
+      free(pix);
+      return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+    }
+
+    for (iy = 0; iy < ny; iy++) {
+      pixp = pix;
+      for (ix = 0; ix < nx; ix++, pixp += nelem) {
+        for (j = 0; j < naxis; j++) {
+          pixp[j] = pixcrd[j];
+        }
+        pixp[lng] += ix;
+        pixp[lat] += iy;
+      }
+
+      k = iy*nx;
+      istat = wcs_p2s(wcs, &(wcs->cel), &(wcs->spc), nx, nelem, pix,
+                      imgcrd + k*nelem, phi + k, theta + k, world + k*nelem,
+                      0x0, stat + k, istatp, 0x0, 0x0, err);
+      if (istat) {
+        status = istat;
+        if (istat != WCSERR_BAD_PIX) break;
+      }
+    }
+
+    free(istatp);
+    free(pix);
+    return status;
+  }
+
+
+  /* Pixel coordinates along the first row followed by the first column. */
+  ncoord = nx + ny;
+  if (!(pix = calloc(2*(ncoord + 1)*nelem, sizeof(double)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+  img    = pix + ncoord*nelem;
+  img0   = img + ncoord*nelem;
+  world0 = img0 + nelem;
+
+  pixp = pix;
+  for (k = 0; k < ncoord; k++, pixp += nelem) {
+    for (j = 0; j < naxis; j++) {
+      pixp[j] = pixcrd[j];
+    }
+
+    if (k < nx) {
+      pixp[lng] += k;
+    } else {
+      pixp[lat] += k - nx;
+    }
+  }
+
+  /* The linear transformation is separable so this gives the intermediate
+     world coordinates exactly as wcsp2s() would. */
+  if ((status = linp2x(&(wcs->lin), ncoord, nelem, pix, img))) {
+    status = wcserr_set(WCS_ERRMSG(status));
+    goto cleanup;
+  }
+
+  /* The other world coordinates are constant over the grid. */
+  if ((istat = wcsp2s(wcs, 1, nelem, pixcrd, img0, &phi0, &theta0, world0,
+                      &stat0))) {
+    if (istat != WCSERR_BAD_PIX) {
+      status = istat;
+      goto cleanup;
+    }
+  }
+
+  if ((stat0 &= ~bits)) {
+    status = WCSERR_BAD_PIX;
+  }
+
+  imgp = imgcrd;
+  wrlp = world;
+  for (iy = 0; iy < ny; iy++) {
+    for (ix = 0; ix < nx; ix++) {
+      for (j = 0; j < naxis; j++) {
+        imgp[j] = img[ix*nelem + j];
+      }
+      imgp[lat] = img[(nx + iy)*nelem + lat];
+
+      for (j = 0; j < nelem; j++) {
+        wrlp[j] = world0[j];
+      }
+
+      imgp += nelem;
+      wrlp += nelem;
+    }
+  }
+
+  /* Transform the celestial coordinates as a grid of nx columns by ny rows;
+     the projection is computed only once per column and row. */
+  if ((istat = celx2s(&(wcs->cel), nx, ny, nelem, nelem, img + lng,
+                      img + nx*nelem + lat, phi, theta, world + lng,
+                      world + lat, stat))) {
+    if (istat == CELERR_BAD_PIX) {
+      status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_PIX));
+    } else {
+      status = wcserr_set(WCS_ERRMSG(istat+3));
+      goto cleanup;
+    }
+  }
+
+  ncoord = nx*ny;
+  for (k = 0; k < ncoord; k++) {
+    stat[k] = (stat[k] ? bits : 0) | stat0;
+  }
+
+cleanup:
+  free(pix);
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsp2sb(
+  struct wcsprm *wcs,
+  int nelem,
+  const double pix0[],
+  const int dims[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  int stat[])
+
+{
+  static const char *function = "wcsp2sb";
+
+  int    all, *axes, gdir, *gpix, *gwrl, i, *idx, igrp, istat, *istatp, j,
+         k, m, naxis, ncoord, ngrp, nmax, nsub, s, *stride, *tstat,
+         status;
+  double *pixr, *tbuf, *timg, *tphi, *ttheta, *twrl;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  naxis = wcs->naxis;
+  if (naxis < 1 || nelem < naxis) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "nelem inconsistent with the wcsprm");
+  }
+
+  /* Axes are recorded in bit masks. */
+  if (naxis > 30) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "wcsp2sb() handles at most 30 axes");
+  }
+
+  ncoord = 1;
+  for (j = 0; j < naxis; j++) {
+    if (dims[j] < 1 || ncoord > INT_MAX/dims[j]) {
+      return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+        "Invalid pixel box dimensions");
+    }
+    ncoord *= dims[j];
+  }
+
+  if (!(gwrl = calloc(6*naxis, sizeof(int)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+  gpix   = gwrl + naxis;
+  idx    = gpix + naxis;
+  stride = idx  + naxis;
+  axes   = stride + naxis;
+  tstat  = 0x0;
+  tbuf   = 0x0;
+
+  /* Partition the axes into independent groups.  Pixel axes of length 1
+     belong to every group, and a group that then spans the whole box is
+     transformed directly into the output arrays. */
+  all  = (1 << naxis) - 1;
+  ngrp = wcs_groups(wcs, gwrl, gpix);
+
+  gdir = -1;
+  nmax = dims[0];
+  nsub = 1;
+  for (igrp = 0; igrp < ngrp; igrp++) {
+    m = 1;
+    for (j = 0; j < naxis; j++) {
+      if (dims[j] == 1) gpix[igrp] |= 1 << j;
+      if (gpix[igrp] & (1 << j)) {
+        m *= dims[j];
+        if (nmax < dims[j]) nmax = dims[j];
+      }
+    }
+
+    if (gpix[igrp] == all) {
+      gdir = igrp;
+    } else if (nsub < m) {
+      nsub = m;
+    }
+  }
+
+  /* Scratch for the groups that must be replicated over the box. */
+  if (!(tbuf = calloc((2*nelem + 2)*nsub + nelem, sizeof(double))) ||
+      !(tstat = calloc(nsub + nmax, sizeof(int)))) {
+    status = wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+    goto cleanup;
+  }
+  timg   = tbuf;
+  twrl   = timg + nelem*nsub;
+  tphi   = twrl + nelem*nsub;
+  ttheta = tphi + nsub;
+  pixr   = ttheta + nsub;
+  istatp = tstat + nsub;
+
+  status = 0;
+  if (gdir >= 0) {
+    istat = wcs_box(wcs, nelem, pix0, dims, all, all & ~gwrl[gdir], imgcrd,
+                    phi, theta, world, stat, istatp, idx, pixr, err);
+    if (istat) {
+      status = istat;
+      if (istat != WCSERR_BAD_PIX) goto cleanup;
+    }
+
+  } else {
+    for (k = 0; k < ncoord; k++) {
+      stat[k] = 0;
+    }
+
+    for (i = naxis; i < nelem; i++) {
+      world[i] = 0.0;
+      wcsutil_setAll(ncoord, nelem, world+i);
+    }
+  }
+
+  for (igrp = 0; igrp < ngrp; igrp++) {
+    if (igrp == gdir) continue;
+
+    /* Transform the group over its own pixel axes only... */
+    istat = wcs_box(wcs, nelem, pix0, dims, gpix[igrp], all & ~gwrl[igrp],
+                    timg, tphi, ttheta, twrl, tstat, istatp, idx, pixr, err);
+    if (istat) {
+      status = istat;
+      if (istat != WCSERR_BAD_PIX) goto cleanup;
+    }
+
+    /* ...and replicate the results over the others. */
+    m = 0;
+    for (i = 0; i < naxis; i++) {
+      if (gwrl[igrp] & (1 << i)) axes[m++] = i;
+    }
+
+    s = 1;
+    for (j = 0; j < naxis; j++) {
+      idx[j] = 0;
+      stride[j] = 0;
+      if (gpix[igrp] & (1 << j)) {
+        stride[j] = s;
+        s *= dims[j];
+      }
+    }
+
+    s = 0;
+    for (k = 0; k < ncoord; k++) {
+      for (i = 0; i < m; i++) {
+        imgcrd[k*nelem + axes[i]] = timg[s*nelem + axes[i]];
+        world[k*nelem + axes[i]]  = twrl[s*nelem + axes[i]];
+      }
+      stat[k] |= tstat[s] & gwrl[igrp];
+
+      if (wcs->lng >= 0 && (gwrl[igrp] & (1 << wcs->lng))) {
+        phi[k]   = tphi[s];
+        theta[k] = ttheta[s];
+      }
+
+      for (j = 0; j < naxis; j++) {
+        s += stride[j];
+        if (++idx[j] < dims[j]) break;
+        s -= stride[j]*dims[j];
+        idx[j] = 0;
+      }
+    }
+  }
+
+cleanup:
+  if (tstat) free(tstat);
+  if (tbuf)  free(tbuf);
+  free(gwrl);
+  return status;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Partition the world axes into groups that depend on disjoint sets of pixel
+   axes, returned as bit masks in gwrl[] and gpix[], and return the number of
+   groups.  Celestial axes, including CUBEFACE, and the axes of each table
+   are kept together, as are all world axes that depend on no pixel axis. */
+
+int wcs_groups(
+  const struct wcsprm *wcs,
+  int gwrl[],
+  int gpix[])
+
+{
+  int changed, i, i2, itab, j, m, naxis, ngrp;
+
+  naxis = wcs->naxis;
+
+  /* Start with one group per world axis, alive while gwrl is non-zero. */
+  for (i = 0; i < naxis; i++) {
+    gwrl[i] = 1 << i;
+    gpix[i] = 0;
+    for (j = 0; j < naxis; j++) {
+      if (wcs->lin.pc[i*naxis + j] != 0.0) gpix[i] |= 1 << j;
+    }
+  }
+
+  /* Axes that are transformed together. */
+  if (wcs->lng >= 0) {
+    wcs_merge(naxis, gwrl, gpix, wcs->lng, wcs->lat);
+    if (wcs->cubeface >= 0) {
+      wcs_merge(naxis, gwrl, gpix, wcs->lng, wcs->cubeface);
+    }
+  }
+
+  for (itab = 0; itab < wcs->ntab; itab++) {
+    for (m = 1; m < wcs->tab[itab].M; m++) {
+      wcs_merge(naxis, gwrl, gpix, wcs->tab[itab].map[0],
+                wcs->tab[itab].map[m]);
+    }
+  }
+
+  /* Merge groups that share a pixel axis, or that have none. */
+  do {
+    changed = 0;
+    for (i = 0; i < naxis; i++) {
+      for (i2 = i+1; gwrl[i] && i2 < naxis; i2++) {
+        if (gwrl[i2] == 0) continue;
+        if ((gpix[i] & gpix[i2]) || (gpix[i] == 0 && gpix[i2] == 0)) {
+          wcs_merge(naxis, gwrl, gpix, i, i2);
+          changed = 1;
+        }
+      }
+    }
+  } while (changed);
+
+  /* Compact. */
+  ngrp = 0;
+  for (i = 0; i < naxis; i++) {
+    if (gwrl[i] == 0) continue;
+    gwrl[ngrp] = gwrl[i];
+    gpix[ngrp] = gpix[i];
+    ngrp++;
+  }
+
+  return ngrp;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Merge the groups containing world axes i1 and i2, see wcs_groups(). */
+
+void wcs_merge(int naxis, int gwrl[], int gpix[], int i1, int i2)
+
+{
+  int g1, g2, i;
+
+  g1 = g2 = -1;
+  for (i = 0; i < naxis; i++) {
+    if (gwrl[i] & (1 << i1)) g1 = i;
+    if (gwrl[i] & (1 << i2)) g2 = i;
+    if (g1 >= 0 && g2 >= 0) break;
+  }
+
+  if (g1 == g2) return;
+  if (g2 < g1) {
+    i = g1; g1 = g2; g2 = i;
+  }
+
+  gwrl[g1] |= gwrl[g2];
+  gpix[g1] |= gpix[g2];
+  gwrl[g2] = 0;
+  gpix[g2] = 0;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Transform a box of pixels in FITS order via linp2xr() and wcs_x2s(), the
+   box being spanned by the pixel axes in bit mask pmask, with the others
+   fixed at pix0.  World axes in bit mask skip are not computed.  idx[naxis]
+   and pixr[nelem] are scratch, and istatp must hold the longest row. */
+
+int wcs_box(
+  struct wcsprm *wcs,
+  int nelem,
+  const double pix0[],
+  const int dims[],
+  int pmask,
+  int skip,
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  int stat[],
+  int istatp[],
+  int idx[],
+  double pixr[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcsp2sb";
+
+  int iaxis, istat, j, k, n, naxis, nrow, nx, row, status;
+
+  naxis = wcs->naxis;
+
+  /* The rows lie along the first pixel axis of the box, if any. */
+  iaxis = 0;
+  nx = 1;
+  for (j = 0; j < naxis; j++) {
+    if (pmask & (1 << j)) {
+      iaxis = j;
+      nx = dims[j];
+      break;
+    }
+  }
+
+  n = 1;
+  for (j = 0; j < naxis; j++) {
+    idx[j] = 0;
+    if (pmask & (1 << j)) n *= dims[j];
+  }
+  nrow = n / nx;
+
+  status = 0;
+  for (row = 0; row < nrow; row++) {
+    k = row*nx;
+
+    for (j = 0; j < naxis; j++) {
+      pixr[j] = pix0[j] + idx[j];
+    }
+
+    if ((istat = linp2xr(&(wcs->lin), nx, nelem, iaxis, pixr,
+                         imgcrd + k*nelem))) {
+      return wcserr_set(WCS_ERRMSG(istat));
+    }
+
+    istat = wcs_x2s(wcs, &(wcs->cel), &(wcs->spc), nx, nelem, skip,
+                    imgcrd + k*nelem, phi + k, theta + k, world + k*nelem,
+                    0x0, stat + k, istatp, 0x0, 0x0, err);
+    if (istat) {
+      if (istat != WCSERR_BAD_PIX) return istat;
+      status = WCSERR_BAD_PIX;
+    }
+
+    /* Next row. */
+    for (j = iaxis+1; j < naxis; j++) {
+      if (!(pmask & (1 << j))) continue;
+      if (++idx[j] < dims[j]) break;
+      idx[j] = 0;
+    }
+  }
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsp2st(
+  struct wcsprm *wcs,
+  int nthread,
+  int nchunk,
+  int ncoord,
+  int nelem,
+  const double pixcrd[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  int stat[])
+
+{
+  return wcs_thr(wcs, 1, nthread, nchunk, ncoord, nelem, pixcrd, imgcrd, phi,
+                 theta, world, stat);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcss2pt(
+  struct wcsprm *wcs,
+  int nthread,
+  int nchunk,
+  int ncoord,
+  int nelem,
+  const double world[],
+  double phi[],
+  double theta[],
+  double imgcrd[],
+  double pixcrd[],
+  int stat[])
+
+{
+  return wcs_thr(wcs, 0, nthread, nchunk, ncoord, nelem, world, imgcrd, phi,
+                 theta, pixcrd, stat);
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+/* Driver for wcsp2st() (p2s true) and wcss2pt().  Each chunk of nchunk
+   coordinates is transformed by the shared engine with its own work array
+   and celprm, spcprm and wcserr structs.  The chunks' statuses are merged
+   to give that of the serial routine: any status other than success or
+   invalid coordinates is fatal and taken from the first chunk to report
+   one, as the serial routine would have stopped there. */
+
+int wcs_thr(
+  struct wcsprm *wcs,
+  int p2s,
+  int nthread,
+  int nchunk,
+  int ncoord,
+  int nelem,
+  const double in[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double out[],
+  int stat[])
+
+{
+  const char *function = p2s ? "wcsp2st" : "wcss2pt";
+
+  int    bad, ichunk, jchunk, ntask, status;
+  struct wcs_thrjob job;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  /* Sanity check. */
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  if (nthread < 1) nthread = wcsutil_ncpu();
+  if (nchunk < 1) {
+    /* A few chunks per thread for load balancing, but not too small. */
+    nchunk = (ncoord + 4*nthread - 1) / (4*nthread);
+    if (nchunk < 256) nchunk = 256;
+  }
+
+  ntask = (ncoord + nchunk - 1) / nchunk;
+  if (nthread == 1 || ntask == 1) {
+    if (p2s) {
+      return wcsp2s(wcs, ncoord, nelem, in, imgcrd, phi, theta, out, stat);
+    } else {
+      return wcss2p(wcs, ncoord, nelem, in, phi, theta, imgcrd, out, stat);
+    }
+  }
+
+  job.wcs    = wcs;
+  job.p2s    = p2s;
+  job.ncoord = ncoord;
+  job.nelem  = nelem;
+  job.nchunk = nchunk;
+  job.nwrk   = wcs_wrk(wcs, nchunk, 0x0, 0x0, 0x0, 0x0, 0x0);
+  job.in     = in;
+  job.imgcrd = imgcrd;
+  job.phi    = phi;
+  job.theta  = theta;
+  job.out    = out;
+  job.stat   = stat;
+
+  job.wrk    = malloc(ntask*job.nwrk*sizeof(double));
+  job.status = malloc(ntask*sizeof(int));
+  job.err    = calloc(ntask, sizeof(struct wcserr *));
+  if (job.wrk == 0x0 || job.status == 0x0 || job.err == 0x0) {
+    if (job.wrk)    free(job.wrk);
+    if (job.status) free(job.status);
+    if (job.err)    free(job.err);
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+
+  wcsutil_pool(nthread, ntask, wcs_thrtask, &job);
+
+  /* Merge the chunk statuses. */
+  bad = p2s ? WCSERR_BAD_PIX : WCSERR_BAD_WORLD;
+  status = 0;
+  jchunk = -1;
+  for (ichunk = 0; ichunk < ntask; ichunk++) {
+    if (job.status[ichunk] && job.status[ichunk] != bad) {
+      status = job.status[ichunk];
+      jchunk = ichunk;
+      break;
+    }
+
+    if (job.status[ichunk] == bad && status == 0) {
+      status = bad;
+      jchunk = ichunk;
+    }
+  }
+
+  if (jchunk >= 0 && job.err[jchunk]) {
+    if (*err == 0x0) *err = calloc(1, sizeof(struct wcserr));
+    wcserr_copy(job.err[jchunk], *err);
+  }
+
+  for (ichunk = 0; ichunk < ntask; ichunk++) {
+    if (job.err[ichunk]) free(job.err[ichunk]);
+  }
+  free(job.err);
+  free(job.status);
+  free(job.wrk);
+
+  return status;
+}
+
+/* : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : : :  */
+
+void wcs_thrtask(void *arg, int ichunk)
+
+{
+  int    k0, n, *istatp, *tabp0;
+  double **tabcoord, *tabdelta;
+  struct celprm cel;
+  struct spcprm spc;
+  struct wcs_thrjob *job = (struct wcs_thrjob *)arg;
+  struct wcsprm *wcs = job->wcs;
+
+  k0 = ichunk*job->nchunk;
+  n  = job->ncoord - k0;
+  if (n > job->nchunk) n = job->nchunk;
+
+  wcs_wrk(wcs, n, job->wrk + ichunk*job->nwrk, &istatp, &tabp0, &tabdelta,
+          &tabcoord);
+
+  cel = wcs->cel;
+  cel.err = 0x0;
+  cel.prj.err = 0x0;
+  spc = wcs->spc;
+  spc.err = 0x0;
+
+  if (job->p2s) {
+    job->status[ichunk] = wcs_p2s(wcs, &cel, &spc, n, job->nelem,
+      job->in + k0*job->nelem, job->imgcrd + k0*job->nelem, job->phi + k0,
+      job->theta + k0, job->out + k0*job->nelem, 0x0, job->stat + k0,
+      istatp, tabp0, tabdelta, job->err + ichunk);
+  } else {
+    job->status[ichunk] = wcs_s2p(wcs, &cel, &spc, n, job->nelem,
+      job->in + k0*job->nelem, 0x0, job->phi + k0, job->theta + k0,
+      job->imgcrd + k0*job->nelem, job->out + k0*job->nelem, job->stat + k0,
+      istatp, tabp0, tabdelta, tabcoord, job->err + ichunk);
+  }
+
+  if (cel.err) free(cel.err);
+  if (cel.prj.err) free(cel.prj.err);
+  if (spc.err) free(spc.err);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsmix(
+  struct wcsprm *wcs,
+  int mixpix,
+  int mixcel,
+  const double vspan[2],
+  double vstep,
+  int viter,
+  double world[],
+  double phi[],
+  double theta[],
+  double imgcrd[],
+  double pixcrd[])
+
+{
+  static const char *function = "wcsmix";
+
+  const int niter = 60;
+  int    crossed, istep, iter, j, k, nstep, retry, stat[1], status;
+  const double tol  = 1.0e-10;
+  const double tol2 = 100.0*tol;
+  double *worldlat, *worldlng;
+  double lambda, span[2], step;
+  double pixmix;
+  double dlng, lng, lng0, lng0m, lng1, lng1m;
+  double dlat, lat, lat0, lat0m, lat1, lat1m;
+  double d, d0, d0m, d1, d1m, dx = 0.0;
+  double dabs, dmin, lmin;
+  double dphi, phi0, phi1;
+  struct celprm *wcscel = &(wcs->cel);
+  struct wcsprm wcs0;
+  struct wcserr **err;
+
+  /* Initialize if required. */
+  if (wcs == 0x0) return WCSERR_NULL_POINTER;
+  err = &(wcs->err);
+
+  if (wcs->flag != WCSSET) {
+    if ((status = wcsset(wcs))) return status;
+  }
+
+  worldlng = world + wcs->lng;
+  worldlat = world + wcs->lat;
+
+
+  /* Check vspan. */
+  if (vspan[0] <= vspan[1]) {
+    span[0] = vspan[0];
+    span[1] = vspan[1];
+  } else {
+    /* Swap them. */
+    span[0] = vspan[1];
+    span[1] = vspan[0];
+  }
+
+  /* Check vstep. */
+  step = fabs(vstep);
+  if (step == 0.0) {
+    step = (span[1] - span[0])/10.0;
+    if (step > 1.0 || step == 0.0) step = 1.0;
+  }
+
+  /* Check viter. */
+  nstep = viter;
+  if (nstep < 5) {
+    nstep = 5;
+  } else if (nstep > 10) {
+    nstep = 10;
+  }
+
+  /* Given pixel element. */
+  pixmix = pixcrd[mixpix];
+
+  /* Iterate on the step size. */
+  for (istep = 0; istep <= nstep; istep++) {
+    if (istep) step /= 2.0;
+
+    /* Iterate on the sky coordinate between the specified range. */
+    if (mixcel == 1) {
+      /* Celestial longitude is given. */
+
+      /* Check whether the solution interval is a crossing interval. */
+      lat0 = span[0];
+      *worldlat = lat0;
+      if ((status = wcss2p(wcs, 1, 0, world, phi, theta, imgcrd, pixcrd,
+                           stat))) {
+        if (status == WCSERR_BAD_WORLD) {
+          status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_WORLD_COORD));
+        }
+        return status;
+      }
+      d0 = pixcrd[mixpix] - pixmix;
+
+      dabs = fabs(d0);
+      if (dabs < tol) return 0;
+
+      lat1 = span[1];
+      *worldlat = lat1;
+      if ((status = wcss2p(wcs, 1, 0, world, phi, theta, imgcrd, pixcrd,
+                           stat))) {
+        if (status == WCSERR_BAD_WORLD) {
+          status = wcserr_set(WCS_ERRMSG(WCSERR_BAD_WORLD_COORD));
+        }
+        return status;
+      }
+      d1 = pixcrd[mixpix] - pixmix;
 
       dabs = fabs(d1);
       if (dabs < tol) return 0;
@@ -3247,3 +4648,254 @@ int wcssptr(
 
   return 0;
 }
+
+/*--------------------------------------------------------------------------*/
+
+int wcscompile(const struct wcsprm *wcs, struct wcsplan *plan)
+
+{
+  int status;
+
+  if (wcs == 0x0 || plan == 0x0) return WCSERR_NULL_POINTER;
+
+  plan->flag = 0;
+
+  /* Take a private deep copy and set it up. */
+  plan->wcs.flag = -1;
+  if ((status = wcssub(1, wcs, 0x0, 0x0, &(plan->wcs)))) {
+    return status;
+  }
+
+  if ((status = wcsset(&(plan->wcs)))) {
+    return status;
+  }
+
+  /* wcsset() resets bounds checking, preserve that set by wcsbchk(). */
+  if (wcs->flag == WCSSET) {
+    plan->wcs.cel.prj.bounds = wcs->cel.prj.bounds;
+  }
+
+  plan->flag = WCSSET;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsplnfree(struct wcsplan *plan)
+
+{
+  if (plan == 0x0) return WCSERR_NULL_POINTER;
+
+  wcsfree(&(plan->wcs));
+  plan->flag = 0;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsplnp2s(
+  const struct wcsplan *plan,
+  int ncoord,
+  int nelem,
+  const double pixcrd[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  int stat[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcsplnp2s";
+
+  int    nwrk, status;
+  double *wrk;
+
+  if (plan == 0x0) return WCSERR_NULL_POINTER;
+
+  if (plan->flag != WCSSET) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "The wcsplan struct has not been compiled");
+  }
+
+  nwrk = wcs_wrk(&(plan->wcs), ncoord, 0x0, 0x0, 0x0, 0x0, 0x0);
+  if (!(wrk = malloc(nwrk*sizeof(double)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+
+  status = wcsplnp2sw(plan, ncoord, nelem, pixcrd, imgcrd, phi, theta, world,
+                      stat, nwrk, wrk, err);
+
+  free(wrk);
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsplnp2sw(
+  const struct wcsplan *plan,
+  int ncoord,
+  int nelem,
+  const double pixcrd[],
+  double imgcrd[],
+  double phi[],
+  double theta[],
+  double world[],
+  int stat[],
+  int nwrk,
+  double wrk[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcsplnp2sw";
+
+  int    *istatp, need, status, *tabp0;
+  double **tabcoord, *tabdelta;
+  struct celprm cel;
+  struct spcprm spc;
+  struct wcsprm *wcs;
+
+  if (plan == 0x0) return WCSERR_NULL_POINTER;
+
+  if (plan->flag != WCSSET) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "The wcsplan struct has not been compiled");
+  }
+
+  /* The plan is never modified; the engine only writes via the private
+     celprm and spcprm copies below and the work array. */
+  wcs = (struct wcsprm *)&(plan->wcs);
+
+  /* Sanity check. */
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  if (nwrk < (need = wcs_wrk(wcs, ncoord, 0x0, 0x0, 0x0, 0x0, 0x0))) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "Work array too small (need %d, got %d)", need, nwrk);
+  }
+  wcs_wrk(wcs, ncoord, wrk, &istatp, &tabp0, &tabdelta, &tabcoord);
+
+  /* Private copies for the error messages written by the lower levels. */
+  cel = wcs->cel;
+  cel.err = 0x0;
+  cel.prj.err = 0x0;
+  spc = wcs->spc;
+  spc.err = 0x0;
+
+  status = wcs_p2s(wcs, &cel, &spc, ncoord, nelem, pixcrd, imgcrd, phi,
+                   theta, world, 0x0, stat, istatp, tabp0, tabdelta, err);
+
+  if (cel.err) free(cel.err);
+  if (cel.prj.err) free(cel.prj.err);
+  if (spc.err) free(spc.err);
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsplns2p(
+  const struct wcsplan *plan,
+  int ncoord,
+  int nelem,
+  const double world[],
+  double phi[],
+  double theta[],
+  double imgcrd[],
+  double pixcrd[],
+  int stat[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcsplns2p";
+
+  int    nwrk, status;
+  double *wrk;
+
+  if (plan == 0x0) return WCSERR_NULL_POINTER;
+
+  if (plan->flag != WCSSET) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "The wcsplan struct has not been compiled");
+  }
+
+  nwrk = wcs_wrk(&(plan->wcs), ncoord, 0x0, 0x0, 0x0, 0x0, 0x0);
+  if (!(wrk = malloc(nwrk*sizeof(double)))) {
+    return wcserr_set(WCS_ERRMSG(WCSERR_MEMORY));
+  }
+
+  status = wcsplns2pw(plan, ncoord, nelem, world, phi, theta, imgcrd, pixcrd,
+                      stat, nwrk, wrk, err);
+
+  free(wrk);
+  return status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+int wcsplns2pw(
+  const struct wcsplan *plan,
+  int ncoord,
+  int nelem,
+  const double world[],
+  double phi[],
+  double theta[],
+  double imgcrd[],
+  double pixcrd[],
+  int stat[],
+  int nwrk,
+  double wrk[],
+  struct wcserr **err)
+
+{
+  static const char *function = "wcsplns2pw";
+
+  int    *istatp, need, status, *tabp0;
+  double **tabcoord, *tabdelta;
+  struct celprm cel;
+  struct spcprm spc;
+  struct wcsprm *wcs;
+
+  if (plan == 0x0) return WCSERR_NULL_POINTER;
+
+  if (plan->flag != WCSSET) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "The wcsplan struct has not been compiled");
+  }
+
+  /* See wcsplnp2sw(). */
+  wcs = (struct wcsprm *)&(plan->wcs);
+
+  /* Sanity check. */
+  if (ncoord < 1 || (ncoord > 1 && nelem < wcs->naxis)) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_CTYPE),
+      "ncoord and/or nelem inconsistent with the wcsprm");
+  }
+
+  if (nwrk < (need = wcs_wrk(wcs, ncoord, 0x0, 0x0, 0x0, 0x0, 0x0))) {
+    return wcserr_set(WCSERR_SET(WCSERR_BAD_PARAM),
+      "Work array too small (need %d, got %d)", need, nwrk);
+  }
+  wcs_wrk(wcs, ncoord, wrk, &istatp, &tabp0, &tabdelta, &tabcoord);
+
+  cel = wcs->cel;
+  cel.err = 0x0;
+  cel.prj.err = 0x0;
+  spc = wcs->spc;
+  spc.err = 0x0;
+
+  status = wcs_s2p(wcs, &cel, &spc, ncoord, nelem, world, 0x0, phi, theta,
+                   imgcrd, pixcrd, stat, istatp, tabp0, tabdelta, tabcoord,
+                   err);
+
+  if (cel.err) free(cel.err);
+  if (cel.prj.err) free(cel.prj.err);
+  if (spc.err) free(spc.err);
+
+  return status;
+}
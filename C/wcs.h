@@ -57,7 +57,8 @@
 * description of the wcsprm struct for an explanation of the anticipated usage
 * of these routines.  wcscopy(), which does a deep copy of one wcsprm struct
 * to another, is defined as a preprocessor macro function that invokes
-* wcssub().
+* wcssub().  wcsshr() is a form of wcssub() that shares rather than copies
+* the lookup tables.
 *
 * wcsperr() prints the error message(s) (if any) stored in a wcsprm struct,
 * and the linprm, celprm, prjprm, spcprm, and tabprm structs that it contains.
@@ -76,6 +77,36 @@
 * pixel coordinate a hybrid routine, wcsmix(), iteratively solves for the
 * unknown elements.
 *
+* wcsp2s() and wcss2p() may modify the wcsprm struct, even when it has already
+* been set up, so a wcsprm struct may not be shared between threads.
+* wcscompile() freezes a copy of a wcsprm struct into a read-only wcsplan
+* struct which is used by wcsplnp2s() and wcsplns2p(); these may be invoked
+* concurrently on the one wcsplan.  wcsplnfree() releases it.
+*
+* wcsp2s(), wcss2p(), wcsplnp2s() and wcsplns2p() allocate work arrays on
+* each call.  wcsp2sw(), wcss2pw(), wcsplnp2sw() and wcsplns2pw() take a
+* caller-supplied work array instead, of length given by wcswrksz(), and do
+* no memory allocation in the course of a successful transformation.
+*
+* wcsp2v() and wcsv2p() are forms of wcsp2s() and wcss2p() that return or
+* take the celestial coordinates as Cartesian unit vectors rather than as
+* longitude and latitude, via celx2v() and celv2x().
+*
+* wcsp2st() and wcss2pt() are multi-threaded forms of wcsp2s() and wcss2p()
+* that divide the coordinates into chunks and transform them concurrently on
+* a pool of POSIX threads.
+*
+* wcsp2sf() and wcss2pf() are forms of wcsp2s() and wcss2p() for coordinates
+* stored in single precision; the transformations themselves are computed in
+* double precision.
+*
+* wcsp2sg() transforms a regular grid of pixel coordinates spanning the
+* celestial axes.  For cylindrical projections with separable celestial pixel
+* axes it computes the linear transformation and the projection only once per
+* column and row.  wcsp2sb() transforms an N-dimensional box of pixels
+* without the need to construct their pixel coordinates, transforming each
+* independent group of axes only over its own pixel axes.
+*
 * wcssptr() translates the spectral axis in a wcsprm struct.  For example, a
 * 'FREQ' axis may be translated into 'ZOPT-F2W' and vice versa.
 *
@@ -319,6 +350,28 @@
 * wcssub() with the nsub and axes pointers both set to zero.
 *
 *
+* wcsshr() - Subimage extraction sharing the lookup tables
+* --------------------------------------------------------
+* wcsshr() is the same as wcssub() except that the tabprm structs are copied
+* by tabshr() rather than tabcpy(), so that wcsdst shares the index vectors
+* and coordinate arrays of the lookup tables of wcssrc (where it owns them)
+* rather than receiving copies of them.  Extracting a subimage, or copying a
+* wcsprm struct (with nsub and axes both set to zero), then takes constant
+* time and memory regardless of the size of the tables.
+*
+* The shared arrays are freed by wcsfree() on the last struct that uses them,
+* so the structs may be freed in any order and in any thread.  However, they
+* must be treated as read-only; tabown() must be invoked on each of the
+* tabprm structs in wcsprm::tab before its index vectors or coordinate array
+* are modified, else the change will be seen by the other structs.
+*
+* Given and returned:
+*   See wcssub().
+*
+* Function return value:
+*             int       Status return value, as for wcssub().
+*
+*
 * wcsfree() - Destructor for the wcsprm struct
 * --------------------------------------------
 * wcsfree() frees memory allocated for the wcsprm arrays by wcsini() and/or
@@ -574,6 +627,610 @@
 *                       wcsprm::err if enabled, see wcserr_enable().
 *
 *
+* wcsp2v() - Pixel-to-world transformation to celestial unit vectors
+* -------------------------------------------------------------------
+* wcsp2v() is the same as wcsp2s() except that the celestial coordinates are
+* returned as Cartesian unit vectors (direction cosines) in vec[] and the
+* celestial elements of world[] are not set.  Celestial longitude and
+* latitude are not computed, saving the inverse trigonometric functions in
+* the spherical rotation, see celx2v().  The other world coordinates are
+* returned in world[] as usual.
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.  These must
+*                       contain celestial axes with a spherical projection,
+*                       i.e. not -TAB.
+*
+* Given:
+*   ncoord,
+*   nelem,
+*   pixcrd              As for wcsp2s().
+*
+* Returned:
+*   imgcrd,
+*   phi,theta,
+*   world               As for wcsp2s(), except for the celestial elements of
+*                       world[].
+*
+*   vec       double[ncoord][3]
+*                       Celestial unit vectors.
+*
+*   stat                As for wcsp2s().
+*
+* Function return value:
+*             int       Status return value as for wcsp2s().
+*
+*
+* wcsv2p() - World-to-pixel transformation from celestial unit vectors
+* --------------------------------------------------------------------
+* wcsv2p() is the same as wcss2p() except that the celestial coordinates are
+* taken as Cartesian unit vectors from vec[] and the celestial elements of
+* world[] are ignored.  This saves the trigonometric functions of celestial
+* longitude and latitude in the spherical rotation, see celv2x().
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters, as for
+*                       wcsp2v().
+*
+* Given:
+*   ncoord,
+*   nelem,
+*   world               As for wcss2p(), except for the celestial elements.
+*
+*   vec       const double[ncoord][3]
+*                       Celestial unit vectors.  These need not be
+*                       normalized.
+*
+* Returned:
+*   phi,theta,
+*   imgcrd,
+*   pixcrd,
+*   stat                As for wcss2p().
+*
+* Function return value:
+*             int       Status return value as for wcss2p().
+*
+*
+* wcswrksz() - Work array size for wcsp2sw() and wcss2pw()
+* ---------------------------------------------------------
+* wcswrksz() returns the length of the work array required by wcsp2sw(),
+* wcss2pw(), wcsplnp2sw(), and wcsplns2pw() to transform ncoord coordinates.
+* For the latter two, the size computed for the wcsprm struct from which the
+* plan was compiled applies.  A work array sized for ncoord coordinates may
+* be used for any smaller number of them.
+*
+* Given:
+*   wcs       const struct wcsprm*
+*                       Coordinate transformation parameters.  These need not
+*                       have been set up but wcsprm::ntab and wcsprm::tab
+*                       must be valid.
+*
+*   ncoord    int       The number of coordinates.
+*
+* Returned:
+*   nwrk      int*      Required length of the work array, in doubles.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null wcsprm pointer passed.
+*
+*
+* wcsp2sw() - Pixel-to-world transformation with a work array
+* ------------------------------------------------------------
+* wcsp2sw() is the same as wcsp2s() except that it uses the work array
+* supplied rather than allocating its own.  Note also that it uses tabx2sr()
+* for tabular axes so tabprm::p0 and tabprm::delta are not returned.
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.
+*
+* Given:
+*   ncoord,
+*   nelem,
+*   pixcrd              As for wcsp2s().
+*
+* Returned:
+*   imgcrd,
+*   phi,theta,
+*   world,
+*   stat                As for wcsp2s().
+*
+* Given:
+*   nwrk      int       Length of the work array, at least that returned by
+*                       wcswrksz() for ncoord.
+*
+*   wrk       double[nwrk]
+*                       Work array, its contents on entry and return are
+*                       undefined.
+*
+* Function return value:
+*             int       Status return value as for wcsp2s() except that
+*                       status 5 is also returned if nwrk is too small.
+*
+*
+* wcss2pw() - World-to-pixel transformation with a work array
+* ------------------------------------------------------------
+* wcss2pw() is the same as wcss2p() except that it uses the work array
+* supplied rather than allocating its own, see wcsp2sw().
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.
+*
+* Given:
+*   ncoord,
+*   nelem,
+*   world               As for wcss2p().
+*
+* Returned:
+*   phi,theta,
+*   imgcrd,
+*   pixcrd,
+*   stat                As for wcss2p().
+*
+* Given:
+*   nwrk,
+*   wrk                 As for wcsp2sw().
+*
+* Function return value:
+*             int       Status return value as for wcss2p() except that
+*                       status 5 is also returned if nwrk is too small.
+*
+*
+* wcsp2sf() - Single-precision pixel-to-world transformation
+* -----------------------------------------------------------
+* wcsp2sf() is the same as wcsp2s() except that the coordinate arrays are of
+* type float.  The coordinates are converted to double precision in tiles of
+* 256 and transformed by wcsp2sw(), and the results rounded to float, so the
+* accuracy is limited only by the storage precision (about 0.02 arcsec in
+* celestial coordinates of several hundred degrees).  As for wcsp2sw(),
+* tabprm::p0 and tabprm::delta are not returned.
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.
+*
+* Given:
+*   ncoord,
+*   nelem     int       As for wcsp2s().
+*
+*   pixcrd    const float[ncoord][nelem]
+*                       Array of pixel coordinates.
+*
+* Returned:
+*   imgcrd    float[ncoord][nelem]
+*                       Array of intermediate world coordinates.
+*
+*   phi,theta float[ncoord]
+*                       Longitude and latitude in the native coordinate
+*                       system of the projection [deg].
+*
+*   world     float[ncoord][nelem]
+*                       Array of world coordinates.
+*
+*   stat      int[ncoord]
+*                       Status return value for each coordinate, as for
+*                       wcsp2s().
+*
+* Function return value:
+*             int       Status return value as for wcsp2s().
+*
+*
+* wcss2pf() - Single-precision world-to-pixel transformation
+* -----------------------------------------------------------
+* wcss2pf() is the same as wcss2p() except that the coordinate arrays are of
+* type float, see wcsp2sf().
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.
+*
+* Given:
+*   ncoord,
+*   nelem     int       As for wcss2p().
+*
+*   world     const float[ncoord][nelem]
+*                       Array of world coordinates.
+*
+* Returned:
+*   phi,theta float[ncoord]
+*                       Longitude and latitude in the native coordinate
+*                       system of the projection [deg].
+*
+*   imgcrd    float[ncoord][nelem]
+*                       Array of intermediate world coordinates.
+*
+*   pixcrd    float[ncoord][nelem]
+*                       Array of pixel coordinates.
+*
+*   stat      int[ncoord]
+*                       Status return value for each coordinate, as for
+*                       wcss2p().
+*
+* Function return value:
+*             int       Status return value as for wcss2p().
+*
+*
+* wcsp2sg() - Pixel-to-world transformation of a regular grid
+* ------------------------------------------------------------
+* wcsp2sg() transforms a regular grid of pixel coordinates, nx columns by ny
+* rows, to world coordinates.  The grid is formed by stepping the pixel
+* coordinate for the celestial longitude axis, wcs.lng, by 1 from column to
+* column, and that for the latitude axis, wcs.lat, by 1 from row to row,
+* starting from a given pixel coordinate.  The pixel coordinates for all
+* other axes are the same for all points in the grid.
+*
+* The results are the same as those of wcsp2s() applied to the grid.
+* However, for the cylindrical projections, when neither celestial pixel axis
+* contributes to any other intermediate world coordinate (in particular when
+* the PC matrix is unrotated), phi depends only on the column and theta only
+* on the row.  The linear transformation and the projection are then computed
+* only nx + ny times, and the remaining world coordinates only once, rather
+* than nx*ny times; celx2s() is invoked for the grid as a whole.  Otherwise
+* the grid is transformed a row at a time.
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.  These must
+*                       contain celestial axes.
+*
+* Given:
+*   nx,ny     int       The number of columns and rows in the grid.
+*
+*   nelem     int       The vector length of each coordinate; it must equal
+*                       or exceed wcs.naxis.
+*
+*   pixcrd    const double[nelem]
+*                       Pixel coordinates of the first point in the grid.
+*
+* Returned:
+*   imgcrd    double[ny][nx][nelem]
+*                       Array of intermediate world coordinates, as for
+*                       wcsp2s().
+*
+*   phi,theta double[ny][nx]
+*                       Longitude and latitude in the native coordinate
+*                       system of the projection [deg].
+*
+*   world     double[ny][nx][nelem]
+*                       Array of world coordinates, as for wcsp2s().
+*
+*   stat      int[ny][nx]
+*                       Status return value for each coordinate, as for
+*                       wcsp2s().
+*
+* Function return value:
+*             int       Status return value as for wcsp2s().
+*
+*
+* wcsp2sb() - Pixel-to-world transformation of a box of pixels
+* -------------------------------------------------------------
+* wcsp2sb() transforms an N-dimensional box of pixels, with dims[j] pixels
+* along pixel axis j stepping by 1 from pix0[j], to world coordinates.  The
+* coordinates are returned in FITS order, the first pixel axis varying
+* fastest, so an image, or any rectangular section of it, may be transformed
+* without constructing its pixel coordinates.  Memory is bounded by
+* transforming a large image one box (tile) at a time.
+*
+* The axes are partitioned into independent groups according to the
+* non-zero elements of the PCi_ja matrix, the celestial axes (with CUBEFACE)
+* and the axes of each table being kept together.  Each group is transformed
+* only over the sub-box spanned by its own pixel axes and the results
+* replicated over the others.  Thus, for a spectral cube with no coupling
+* between the spatial and spectral axes, the celestial coordinates are
+* computed once per spatial pixel, and the spectral coordinates once per
+* channel.  Each (sub-)box is transformed a row at a time, the linear
+* transformation being evaluated incrementally via linp2xr().  The results
+* differ from those of wcsp2s() for the same pixels only by rounding error
+* in the linear transformation.
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.
+*
+* Given:
+*   nelem     int       The vector length of each coordinate; it must equal
+*                       or exceed wcs.naxis.
+*
+*   pix0      const double[naxis]
+*                       Pixel coordinates of the first pixel in the box.
+*
+*   dims      const int[naxis]
+*                       Number of pixels along each pixel axis, each at least
+*                       1.  Their product, the number of pixels in the box,
+*                       ncoord, must be representable as an int.
+*
+* Returned:
+*   imgcrd    double[ncoord][nelem]
+*                       Array of intermediate world coordinates, as for
+*                       wcsp2s().
+*
+*   phi,theta double[ncoord]
+*                       Longitude and latitude in the native coordinate
+*                       system of the projection [deg].
+*
+*   world     double[ncoord][nelem]
+*                       Array of world coordinates, as for wcsp2s().
+*
+*   stat      int[ncoord]
+*                       Status return value for each coordinate, as for
+*                       wcsp2s().
+*
+* Function return value:
+*             int       Status return value as for wcsp2s().
+*
+*
+* wcsp2st() - Multi-threaded pixel-to-world transformation
+* ---------------------------------------------------------
+* wcsp2st() is a multi-threaded form of wcsp2s().  The coordinates are divided
+* into chunks which are transformed concurrently by a pool of worker threads
+* together with the calling thread.  The worker threads are created on first
+* use and persist for the life of the process; the child of a fork() starts
+* with none and creates its own.
+*
+* There is only one pool per process.  Concurrent calls of wcsp2st() and
+* wcss2pt() from different application threads are serialized on it, each
+* waiting for the one before to complete, so nothing is gained by calling
+* them from several threads at once.
+*
+* The results, including stat[] and the function return value, are the same
+* as those of wcsp2s().  If more than one chunk reports an error, the error
+* status and message returned are those of the first chunk, in coordinate
+* order, that would have caused wcsp2s() to stop; otherwise, if invalid
+* pixel coordinates were found in any chunk, status 8 is returned.  As for
+* wcsp2sw(), tabprm::p0 and tabprm::delta are not returned.
+*
+* If WCSLIB was built without POSIX threads, or only one chunk or thread is
+* required, wcsp2st() simply invokes wcsp2s().
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.  The struct is
+*                       set up, if required, before any threads are started.
+*
+* Given:
+*   nthread   int       Maximum number of threads to use, including the
+*                       calling thread.  If less than 1, the number of
+*                       processors online is used.
+*
+*   nchunk    int       Number of coordinates per chunk.  If less than 1, a
+*                       default is chosen that gives each thread several
+*                       chunks, subject to a minimum of 256 coordinates.
+*
+*   ncoord,
+*   nelem,
+*   pixcrd              As for wcsp2s().
+*
+* Returned:
+*   imgcrd,
+*   phi,theta,
+*   world,
+*   stat                As for wcsp2s().
+*
+* Function return value:
+*             int       Status return value as for wcsp2s().
+*
+*
+* wcss2pt() - Multi-threaded world-to-pixel transformation
+* --------------------------------------------------------
+* wcss2pt() is a multi-threaded form of wcss2p(), see wcsp2st().  It uses
+* the same pool of worker threads, and concurrent calls from different
+* application threads are likewise serialized.  Status 9 is returned if
+* invalid world coordinates were found in any chunk.
+*
+* Given and returned:
+*   wcs       struct wcsprm*
+*                       Coordinate transformation parameters.
+*
+* Given:
+*   nthread,
+*   nchunk              As for wcsp2st().
+*
+*   ncoord,
+*   nelem,
+*   world               As for wcss2p().
+*
+* Returned:
+*   phi,theta,
+*   imgcrd,
+*   pixcrd,
+*   stat                As for wcss2p().
+*
+* Function return value:
+*             int       Status return value as for wcss2p().
+*
+*
+* wcscompile() - Compile a wcsprm struct into a transformation plan
+* -----------------------------------------------------------------
+* wcscompile() takes a deep copy of a wcsprm struct, via wcscopy(), and sets
+* it up by calling wcsset() to produce a wcsplan struct for use by
+* wcsplnp2s() and wcsplns2p().  Bounds checking set via wcsbchk() on the
+* input struct is retained.  Subsequent changes to the wcsprm struct do not
+* affect the plan.
+*
+* Given:
+*   wcs       const struct wcsprm*
+*                       Coordinate transformation parameters.  These need not
+*                       have been set up.
+*
+* Returned:
+*   plan      struct wcsplan*
+*                       The compiled plan.  It must be released by
+*                       wcsplnfree() before it is recompiled, and also if
+*                       wcscompile() fails.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null wcsprm or wcsplan pointer passed.
+*                         2: Memory allocation failed.
+*                         3: Linear transformation matrix is singular.
+*                         4: Inconsistent or unrecognized coordinate axis
+*                            types.
+*                         5: Invalid parameter value.
+*                         6: Invalid coordinate transformation parameters.
+*                         7: Ill-conditioned coordinate transformation
+*                            parameters.
+*
+*                       For returns > 1, a detailed error message is set in
+*                       the private wcsplan::wcs.err if enabled, see
+*                       wcserr_enable().
+*
+*
+* wcsplnfree() - Destructor for the wcsplan struct
+* ------------------------------------------------
+* wcsplnfree() frees the memory held by a wcsplan struct that was compiled by
+* wcscompile().
+*
+* Given and returned:
+*   plan      struct wcsplan*
+*                       Plan to be freed.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null wcsplan pointer passed.
+*
+*
+* wcsplnp2s() - Reentrant pixel-to-world transformation
+* -----------------------------------------------------
+* wcsplnp2s() is the equivalent of wcsp2s() for a compiled plan.  The plan is
+* not modified so any number of threads may use it concurrently; results,
+* including stat[] and the function return value, are identical to those of
+* wcsp2s() on the wcsprm struct from which the plan was compiled.
+*
+* Given:
+*   plan      const struct wcsplan*
+*                       Plan compiled by wcscompile().
+*
+*   ncoord,
+*   nelem,
+*   pixcrd              As for wcsp2s().
+*
+* Returned:
+*   imgcrd,
+*   phi,theta,
+*   world,
+*   stat                As for wcsp2s().
+*
+*   err       struct wcserr **
+*                       If enabled, for function return values > 1, this
+*                       struct will contain a detailed error message, see
+*                       wcserr_enable().  May be NULL if an error message is
+*                       not desired.  Otherwise, the user is responsible for
+*                       deleting the memory allocated for the wcserr struct.
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null wcsplan pointer passed.
+*                         2: Memory allocation failed.
+*                         4: ncoord and/or nelem inconsistent with the plan.
+*                         5: Invalid parameter value, or the plan has not
+*                            been compiled.
+*                         6: Invalid coordinate transformation parameters.
+*                         8: One or more of the pixel coordinates were
+*                            invalid, as indicated by the stat vector.
+*
+*
+* wcsplns2p() - Reentrant world-to-pixel transformation
+* -----------------------------------------------------
+* wcsplns2p() is the equivalent of wcss2p() for a compiled plan, see
+* wcsplnp2s().
+*
+* Given:
+*   plan      const struct wcsplan*
+*                       Plan compiled by wcscompile().
+*
+*   ncoord,
+*   nelem,
+*   world               As for wcss2p().
+*
+* Returned:
+*   phi,theta,
+*   imgcrd,
+*   pixcrd,
+*   stat                As for wcss2p().
+*
+*   err       struct wcserr **
+*                       As for wcsplnp2s().
+*
+* Function return value:
+*             int       Status return value:
+*                         0: Success.
+*                         1: Null wcsplan pointer passed.
+*                         2: Memory allocation failed.
+*                         4: ncoord and/or nelem inconsistent with the plan.
+*                         5: Invalid parameter value, or the plan has not
+*                            been compiled.
+*                         6: Invalid coordinate transformation parameters.
+*                         9: One or more of the world coordinates were
+*                            invalid, as indicated by the stat vector.
+*
+*
+* wcsplnp2sw() - Reentrant pixel-to-world transformation with a work array
+* ------------------------------------------------------------------------
+* wcsplnp2sw() is the same as wcsplnp2s() except that it uses the work array
+* supplied rather than allocating its own.  Each concurrent invokation must
+* have its own work array.
+*
+* Given:
+*   plan,
+*   ncoord,
+*   nelem,
+*   pixcrd              As for wcsplnp2s().
+*
+* Returned:
+*   imgcrd,
+*   phi,theta,
+*   world,
+*   stat                As for wcsplnp2s().
+*
+* Given:
+*   nwrk,
+*   wrk                 As for wcsp2sw().
+*
+* Returned:
+*   err                 As for wcsplnp2s().
+*
+* Function return value:
+*             int       Status return value as for wcsplnp2s().  Status 5
+*                       is also returned if nwrk is too small.
+*
+*
+* wcsplns2pw() - Reentrant world-to-pixel transformation with a work array
+* ------------------------------------------------------------------------
+* wcsplns2pw() is the same as wcsplns2p() except that it uses the work array
+* supplied rather than allocating its own, see wcsplnp2sw().
+*
+* Given:
+*   plan,
+*   ncoord,
+*   nelem,
+*   world               As for wcsplns2p().
+*
+* Returned:
+*   phi,theta,
+*   imgcrd,
+*   pixcrd,
+*   stat                As for wcsplns2p().
+*
+* Given:
+*   nwrk,
+*   wrk                 As for wcsp2sw().
+*
+* Returned:
+*   err                 As for wcsplnp2s().
+*
+* Function return value:
+*             int       Status return value as for wcsplns2p().  Status 5
+*                       is also returned if nwrk is too small.
+*
+*
 * wcsmix() - Hybrid coordinate transformation
 * -------------------------------------------
 * wcsmix(), given either the celestial longitude or latitude plus an element
@@ -766,7 +1423,8 @@
 *       - wcsprm::ps,
 *       - wcsprm::cd,
 *       - wcsprm::crota,
-*       - wcsprm::altlin.
+*       - wcsprm::altlin,
+*       - wcsprm::accuracy.
 *
 *     This signals the initialization routine, wcsset(), to recompute the
 *     returned members of the celprm struct.  celset() will reset flag to
@@ -994,6 +1652,16 @@
 *   int velref
 *     (Given) AIPS velocity code VELREF, refer to spcaips().
 *
+*   double accuracy
+*     (Given) The error [deg] that may be tolerated in the celestial
+*     coordinates in exchange for speed.  If it is at least WCS_FASTACC,
+*     wcsset() sets celprm::fast so that the SIMD kernels of the celestial
+*     transformation use faster, reduced-accuracy trigonometric functions,
+*     whereupon the celestial coordinates computed by wcsp2s() and wcss2p()
+*     are accurate, and close, to within WCS_FASTACC.  Otherwise, as by
+*     default (0.0, set by wcsini()), the full accuracy of the library is
+*     retained.  The spectral and tabular coordinates are unaffected.
+*
 *   char alt[4]
 *     (Given, auxiliary) Character code for alternate coordinate descriptions
 *     (i.e. the 'a' in keyword names such as CTYPEia).  This is blank for the
@@ -1290,6 +1958,9 @@
 *     (Given) Character identifying the wcstab array type:
 *       - c: coordinate array,
 *       - i: index vector.
+*     (Returned) Set to upper case, 'C' or 'I', by a routine that returns a
+*     memory-mapped array, e.g. fits_map_wcstab(), in which case wcsset() does
+*     not take control of the array memory.
 *
 *   char extnam[72]
 *     (Given) EXTNAME identifying the binary table extension.
@@ -1319,6 +1990,20 @@
 *     user and into which the wcstab array is to be written.
 *
 *
+* wcsplan struct - Compiled coordinate transformation plan
+* --------------------------------------------------------
+* The wcsplan struct is produced by wcscompile() and used by wcsplnp2s() and
+* wcsplns2p().  All members are private and must not be modified by the user.
+*
+*   int flag
+*     (For internal use only.)
+*   int padding
+*     (An unused variable inserted for alignment purposes only.)
+*   struct wcsprm wcs
+*     (For internal use only.)  Private copy of the wcsprm struct, set up by
+*     wcsset().
+*
+*
 * Global variable: const char *wcs_errmsg[] - Status return messages
 * ------------------------------------------------------------------
 * Error messages to match the status value returned from each function.
@@ -1345,6 +2030,10 @@ extern "C" {
 #define WCSSUB_SPECTRAL  0x1008
 #define WCSSUB_STOKES    0x1010
 
+/* Celestial accuracy [deg] guaranteed by the reduced-accuracy mode, see
+   wcsprm::accuracy. */
+#define WCS_FASTACC 1.0e-7
+
 
 extern const char *wcs_errmsg[];
 
@@ -1449,6 +2138,7 @@ struct wcsprm {
 				/*   Bit 1: CDi_ja  is present,             */
 				/*   Bit 2: CROTAia is present.             */
   int    velref;		/* AIPS velocity code, VELREF.              */
+  double accuracy;		/* Tolerable celestial error [deg].         */
 
   /* Auxiliary coordinate system information, not used by WCSLIB.           */
   char   alt[4];
@@ -1517,6 +2207,15 @@ struct wcsprm {
 #define WCSLEN (sizeof(struct wcsprm)/sizeof(int))
 
 
+struct wcsplan {
+  /* Private - for internal use only.                                       */
+  /*------------------------------------------------------------------------*/
+  int    flag;			/* Set by wcscompile().                     */
+  int    padding;		/* (Dummy inserted for alignment purposes.) */
+  struct wcsprm wcs;		/* Set-up copy of the wcsprm struct.        */
+};
+
+
 int wcsnpv(int n);
 
 int wcsnps(int n);
@@ -1526,6 +2225,9 @@ int wcsini(int alloc, int naxis, struct wcsprm *wcs);
 int wcssub(int alloc, const struct wcsprm *wcssrc, int *nsub, int axes[],
            struct wcsprm *wcsdst);
 
+int wcsshr(int alloc, const struct wcsprm *wcssrc, int *nsub, int axes[],
+           struct wcsprm *wcsdst);
+
 int wcsfree(struct wcsprm *wcs);
 
 int wcsprt(const struct wcsprm *wcs);
@@ -1544,12 +2246,78 @@ int wcss2p(struct wcsprm *wcs, int ncoord, int nelem, const double world[],
            double phi[], double theta[], double imgcrd[], double pixcrd[],
            int stat[]);
 
+int wcsp2v(struct wcsprm *wcs, int ncoord, int nelem, const double pixcrd[],
+           double imgcrd[], double phi[], double theta[], double world[],
+           double vec[], int stat[]);
+
+int wcsv2p(struct wcsprm *wcs, int ncoord, int nelem, const double world[],
+           const double vec[], double phi[], double theta[], double imgcrd[],
+           double pixcrd[], int stat[]);
+
+int wcswrksz(const struct wcsprm *wcs, int ncoord, int *nwrk);
+
+int wcsp2sw(struct wcsprm *wcs, int ncoord, int nelem, const double pixcrd[],
+            double imgcrd[], double phi[], double theta[], double world[],
+            int stat[], int nwrk, double wrk[]);
+
+int wcss2pw(struct wcsprm *wcs, int ncoord, int nelem, const double world[],
+            double phi[], double theta[], double imgcrd[], double pixcrd[],
+            int stat[], int nwrk, double wrk[]);
+
+int wcsp2sf(struct wcsprm *wcs, int ncoord, int nelem, const float pixcrd[],
+            float imgcrd[], float phi[], float theta[], float world[],
+            int stat[]);
+
+int wcss2pf(struct wcsprm *wcs, int ncoord, int nelem, const float world[],
+            float phi[], float theta[], float imgcrd[], float pixcrd[],
+            int stat[]);
+
+int wcsp2sg(struct wcsprm *wcs, int nx, int ny, int nelem,
+            const double pixcrd[], double imgcrd[], double phi[],
+            double theta[], double world[], int stat[]);
+
+int wcsp2sb(struct wcsprm *wcs, int nelem, const double pix0[],
+            const int dims[], double imgcrd[], double phi[], double theta[],
+            double world[], int stat[]);
+
+int wcsp2st(struct wcsprm *wcs, int nthread, int nchunk, int ncoord,
+            int nelem, const double pixcrd[], double imgcrd[], double phi[],
+            double theta[], double world[], int stat[]);
+
+int wcss2pt(struct wcsprm *wcs, int nthread, int nchunk, int ncoord,
+            int nelem, const double world[], double phi[], double theta[],
+            double imgcrd[], double pixcrd[], int stat[]);
+
 int wcsmix(struct wcsprm *wcs, int mixpix, int mixcel, const double vspan[],
            double vstep, int viter, double world[], double phi[],
            double theta[], double imgcrd[], double pixcrd[]);
 
 int wcssptr(struct wcsprm *wcs, int *i, char ctype[9]);
 
+int wcscompile(const struct wcsprm *wcs, struct wcsplan *plan);
+
+int wcsplnfree(struct wcsplan *plan);
+
+int wcsplnp2s(const struct wcsplan *plan, int ncoord, int nelem,
+              const double pixcrd[], double imgcrd[], double phi[],
+              double theta[], double world[], int stat[],
+              struct wcserr **err);
+
+int wcsplns2p(const struct wcsplan *plan, int ncoord, int nelem,
+              const double world[], double phi[], double theta[],
+              double imgcrd[], double pixcrd[], int stat[],
+              struct wcserr **err);
+
+int wcsplnp2sw(const struct wcsplan *plan, int ncoord, int nelem,
+               const double pixcrd[], double imgcrd[], double phi[],
+               double theta[], double world[], int stat[], int nwrk,
+               double wrk[], struct wcserr **err);
+
+int wcsplns2pw(const struct wcsplan *plan, int ncoord, int nelem,
+               const double world[], double phi[], double theta[],
+               double imgcrd[], double pixcrd[], int stat[], int nwrk,
+               double wrk[], struct wcserr **err);
+
 /* Defined mainly for backwards compatibility, use wcssub() instead. */
 #define wcscopy(alloc, wcssrc, wcsdst) wcssub(alloc, wcssrc, 0x0, 0x0, wcsdst)
 
@@ -751,7 +751,9 @@
 * fits_read_wcstab(), has been provided for this purpose, see getwcstab.h.
 * wcsset() will automatically take control of this allocated memory, in
 * particular causing it to be free'd by wcsfree(); the user must not attempt
-* to free it after wcsset() has been called.
+* to free it after wcsset() has been called.  The exception is arrays marked
+* as memory-mapped by an upper case wtbarr::kind, such as those returned by
+* fits_map_wcstab(), which remain the property of the user.
 *
 * Note that wcspih() and wcsbth() automatically invoke wcstab() on each of the
 * wcsprm structs that they return.
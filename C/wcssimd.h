@@ -0,0 +1,1019 @@
+/*============================================================================
+
+  WCSLIB 4.22 - an implementation of the FITS WCS standard.
+  Copyright (C) 1995-2014, Mark Calabretta
+
+  This file is part of WCSLIB.
+
+  WCSLIB is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or (at your option)
+  any later version.
+
+  WCSLIB is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+  more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with WCSLIB.  If not, see http://www.gnu.org/licenses.
+
+  Direct correspondence concerning WCSLIB to mark@calabretta.id.au
+
+  Author: Mark Calabretta, Australia Telescope National Facility, CSIRO.
+  http://www.atnf.csiro.au/people/Mark.Calabretta
+  $Id: wcssimd.h,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
+*=============================================================================
+*
+* Summary of the wcssimd routines
+* -------------------------------
+* Inline SIMD vector primitives and trigonometric functions for internal use
+* only by WCSLIB.  They are documented here solely as an aid to understanding
+* the code.  They are not intended for external use - the API may change
+* without notice!
+*
+* The instruction set is chosen at compile time from the macros predefined
+* by the compiler:
+*
+*   WCSSIMD == 512: AVX-512F, 8 doubles per vector (e.g. -mavx512f).
+*   WCSSIMD == 256: AVX2,     4 doubles per vector (e.g. -mavx2 -mfma).
+*   WCSSIMD == 128: SSE2,     2 doubles per vector (any x86-64 compiler).
+*
+* WCSSIMD is left undefined, and callers must fall back to scalar code, if
+* none of these is available, if the compiler is not GCC-compatible, if
+* WCSTRIG_MACRO is defined (so that the scalar trigd functions lack the
+* special-case handling reproduced here), or if WCSSIMD_DISABLE is defined.
+* WCSSIMD_NLANE is the number of doubles per vector.
+*
+* With GCC, a translation unit may raise the instruction set beyond that of
+* the compiler options via "#pragma GCC target", provided that it precedes
+* the inclusion of this header; wcstrigv.c and its companions use this to
+* compile the vector trigd functions of wcstrig.h once for each instruction
+* set and select between them at run time.
+*
+* Vectors are of type wcsvd and comparison masks of type wcsvm.  The
+* primitives, wcsv_add(), wcsv_cmplt(), wcsv_sel(), etc., are thin wrappers
+* on the intrinsics; wcsv_sel(m,a,b) returns a where the mask is set and b
+* elsewhere, and wcsv_mbits() returns the mask as a bit pattern with bit i
+* corresponding to lane i.  Comparisons follow the C operators for NaNs, i.e.
+* wcsv_cmpne() is true and all others false.
+*
+*
+* Vector trigonometric functions in degrees
+* -----------------------------------------
+* INTERNAL USE ONLY.
+*
+* wcsv_sincosd(), wcsv_tand(), wcsv_atan2d(), wcsv_atand(), wcsv_asind(),
+* and wcsv_acosd() are vector versions of sincosd(), tand(), atan2d(),
+* atand(), asind(), and acosd() declared in wcstrig.h.  They reproduce the
+* special-case handling of the scalar functions exactly, e.g. sincosd() of
+* an exact multiple of 90 degrees, tand() of an exact multiple of 45 degrees
+* (other than an odd multiple of 90), or atan2d() with a zero argument,
+* returns the exact result, as do asind() and acosd() for arguments within
+* WCSTRIG_TOL of +/-1.  Otherwise they evaluate the Cody & Waite range reduction and the
+* Cephes rational approximations (S.L. Moshier, "Methods and Programs for
+* Mathematical Functions", 1989) in double precision.  Lanes with arguments
+* for which the range reduction is not valid, including infinities and NaNs,
+* are passed to the scalar functions so that these edge cases are also
+* handled identically.
+*
+* wcsv_fsincosd(), wcsv_fatan2d(), wcsv_fatand(), wcsv_fasind(), and
+* wcsv_facosd() take an additional first argument, fast.  If it is zero they
+* simply call the corresponding function above.  Otherwise they evaluate
+* reduced-accuracy approximations that avoid most of the divisions and the
+* multi-part range reduction: sine and cosine reduce the angle exactly by
+* multiples of 90 degrees, the arctangent is computed from the ratio of the
+* smaller to the larger argument with a single polynomial, and the arcsine
+* and arccosine reduce to a single polynomial on [0,1/2] via a square root.
+* The special cases and the handling of non-finite arguments are the same
+* as for the full-accuracy functions, but elsewhere the results are in error
+* by up to WCSSIMD_FASTERR: the sine and cosine by that absolute amount, and
+* the inverse functions by that many radians (i.e. WCSSIMD_FASTERR*R2D
+* degrees).
+*
+* In the general case, the results differ from those of the scalar functions
+* (with the system's libm) by at most WCSSIMD_ULP units in the last place,
+* as measured over the ranges used by the projection routines.  In
+* particular, the sign of sind() and cosd(), and whether they are zero, is
+* the same as for the scalar functions.
+*
+*===========================================================================*/
+
+#ifndef WCSLIB_WCSSIMD
+#define WCSLIB_WCSSIMD
+
+#include <math.h>
+
+#include "wcsmath.h"
+#include "wcstrig.h"
+
+#if defined(__GNUC__) && !defined(WCSTRIG_MACRO) && !defined(WCSSIMD_DISABLE)
+#if defined(__AVX512F__)
+#define WCSSIMD 512
+#elif defined(__AVX2__)
+#define WCSSIMD 256
+#elif defined(__SSE2__)
+#define WCSSIMD 128
+#endif
+#endif
+
+#ifdef WCSSIMD
+
+#include <immintrin.h>
+
+/* Maximum difference from the scalar trigd functions, in ulp. */
+#define WCSSIMD_ULP 3
+
+/* Maximum error of the reduced-accuracy functions. */
+#define WCSSIMD_FASTERR 1.0e-10
+
+/* Maximum absolute argument for the sine and cosine range reduction [deg]. */
+#define WCSSIMD_TRIGMAX 1.0e6
+
+#define WCSV_INLINE static __inline__ __attribute__((always_inline))
+
+
+/*----------------------------------------------------------------------------
+* Primitives.
+*---------------------------------------------------------------------------*/
+
+#if WCSSIMD == 512
+
+#define WCSSIMD_NLANE 8
+typedef __m512d  wcsvd;
+typedef __mmask8 wcsvm;
+
+WCSV_INLINE wcsvd wcsv_set1(double a) { return _mm512_set1_pd(a); }
+WCSV_INLINE wcsvd wcsv_load(const double *p) { return _mm512_loadu_pd(p); }
+WCSV_INLINE void  wcsv_store(double *p, wcsvd a) { _mm512_storeu_pd(p, a); }
+
+WCSV_INLINE wcsvd wcsv_add(wcsvd a, wcsvd b) { return _mm512_add_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_sub(wcsvd a, wcsvd b) { return _mm512_sub_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_mul(wcsvd a, wcsvd b) { return _mm512_mul_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_div(wcsvd a, wcsvd b) { return _mm512_div_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_sqrt(wcsvd a) { return _mm512_sqrt_pd(a); }
+WCSV_INLINE wcsvd wcsv_rint(wcsvd a)
+  { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT); }
+
+WCSV_INLINE wcsvd wcsv_xor(wcsvd a, wcsvd b)
+  { return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a),
+                                                _mm512_castpd_si512(b))); }
+WCSV_INLINE wcsvd wcsv_andnot(wcsvd a, wcsvd b)
+  { return _mm512_castsi512_pd(_mm512_andnot_si512(_mm512_castpd_si512(a),
+                                                   _mm512_castpd_si512(b))); }
+
+WCSV_INLINE wcsvm wcsv_cmpeq(wcsvd a, wcsvd b)
+  { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+WCSV_INLINE wcsvm wcsv_cmpne(wcsvd a, wcsvd b)
+  { return _mm512_cmp_pd_mask(a, b, _CMP_NEQ_UQ); }
+WCSV_INLINE wcsvm wcsv_cmplt(wcsvd a, wcsvd b)
+  { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+WCSV_INLINE wcsvm wcsv_cmple(wcsvd a, wcsvd b)
+  { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+WCSV_INLINE wcsvm wcsv_cmpgt(wcsvd a, wcsvd b)
+  { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+WCSV_INLINE wcsvm wcsv_cmpge(wcsvd a, wcsvd b)
+  { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+
+WCSV_INLINE wcsvm wcsv_mand(wcsvm m, wcsvm n) { return m & n; }
+WCSV_INLINE wcsvm wcsv_mor(wcsvm m, wcsvm n)  { return m | n; }
+WCSV_INLINE wcsvm wcsv_mnot(wcsvm m) { return (wcsvm)~m; }
+WCSV_INLINE int   wcsv_mbits(wcsvm m) { return (int)m; }
+WCSV_INLINE wcsvd wcsv_sel(wcsvm m, wcsvd a, wcsvd b)
+  { return _mm512_mask_blend_pd(m, b, a); }
+
+#ifdef __FMA__
+#define WCSSIMD_FMA
+#endif
+WCSV_INLINE wcsvd wcsv_fma(wcsvd a, wcsvd b, wcsvd c)
+  { return _mm512_fmadd_pd(a, b, c); }
+
+#elif WCSSIMD == 256
+
+#define WCSSIMD_NLANE 4
+typedef __m256d wcsvd;
+typedef __m256d wcsvm;
+
+WCSV_INLINE wcsvd wcsv_set1(double a) { return _mm256_set1_pd(a); }
+WCSV_INLINE wcsvd wcsv_load(const double *p) { return _mm256_loadu_pd(p); }
+WCSV_INLINE void  wcsv_store(double *p, wcsvd a) { _mm256_storeu_pd(p, a); }
+
+WCSV_INLINE wcsvd wcsv_add(wcsvd a, wcsvd b) { return _mm256_add_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_sub(wcsvd a, wcsvd b) { return _mm256_sub_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_mul(wcsvd a, wcsvd b) { return _mm256_mul_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_div(wcsvd a, wcsvd b) { return _mm256_div_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_sqrt(wcsvd a) { return _mm256_sqrt_pd(a); }
+WCSV_INLINE wcsvd wcsv_rint(wcsvd a)
+  { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC); }
+
+WCSV_INLINE wcsvd wcsv_xor(wcsvd a, wcsvd b) { return _mm256_xor_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_andnot(wcsvd a, wcsvd b)
+  { return _mm256_andnot_pd(a, b); }
+
+WCSV_INLINE wcsvm wcsv_cmpeq(wcsvd a, wcsvd b)
+  { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+WCSV_INLINE wcsvm wcsv_cmpne(wcsvd a, wcsvd b)
+  { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+WCSV_INLINE wcsvm wcsv_cmplt(wcsvd a, wcsvd b)
+  { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+WCSV_INLINE wcsvm wcsv_cmple(wcsvd a, wcsvd b)
+  { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+WCSV_INLINE wcsvm wcsv_cmpgt(wcsvd a, wcsvd b)
+  { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+WCSV_INLINE wcsvm wcsv_cmpge(wcsvd a, wcsvd b)
+  { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+
+WCSV_INLINE wcsvm wcsv_mand(wcsvm m, wcsvm n) { return _mm256_and_pd(m, n); }
+WCSV_INLINE wcsvm wcsv_mor(wcsvm m, wcsvm n)  { return _mm256_or_pd(m, n); }
+WCSV_INLINE wcsvm wcsv_mnot(wcsvm m)
+  { return _mm256_xor_pd(m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+WCSV_INLINE int   wcsv_mbits(wcsvm m) { return _mm256_movemask_pd(m); }
+WCSV_INLINE wcsvd wcsv_sel(wcsvm m, wcsvd a, wcsvd b)
+  { return _mm256_blendv_pd(b, a, m); }
+
+#ifdef __FMA__
+#define WCSSIMD_FMA
+WCSV_INLINE wcsvd wcsv_fma(wcsvd a, wcsvd b, wcsvd c)
+  { return _mm256_fmadd_pd(a, b, c); }
+#else
+WCSV_INLINE wcsvd wcsv_fma(wcsvd a, wcsvd b, wcsvd c)
+  { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+
+#else
+
+#define WCSSIMD_NLANE 2
+typedef __m128d wcsvd;
+typedef __m128d wcsvm;
+
+WCSV_INLINE wcsvd wcsv_set1(double a) { return _mm_set1_pd(a); }
+WCSV_INLINE wcsvd wcsv_load(const double *p) { return _mm_loadu_pd(p); }
+WCSV_INLINE void  wcsv_store(double *p, wcsvd a) { _mm_storeu_pd(p, a); }
+
+WCSV_INLINE wcsvd wcsv_add(wcsvd a, wcsvd b) { return _mm_add_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_sub(wcsvd a, wcsvd b) { return _mm_sub_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_mul(wcsvd a, wcsvd b) { return _mm_mul_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_div(wcsvd a, wcsvd b) { return _mm_div_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_sqrt(wcsvd a) { return _mm_sqrt_pd(a); }
+
+#ifdef __SSE4_1__
+WCSV_INLINE wcsvd wcsv_rint(wcsvd a)
+  { return _mm_round_pd(a, _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC); }
+#else
+/* Valid for |a| < 2^51, which is all that is required here. */
+WCSV_INLINE wcsvd wcsv_rint(wcsvd a)
+  { const __m128d big = _mm_set1_pd(6755399441055744.0);
+    return _mm_sub_pd(_mm_add_pd(a, big), big); }
+#endif
+
+WCSV_INLINE wcsvd wcsv_xor(wcsvd a, wcsvd b) { return _mm_xor_pd(a, b); }
+WCSV_INLINE wcsvd wcsv_andnot(wcsvd a, wcsvd b) { return _mm_andnot_pd(a, b); }
+
+WCSV_INLINE wcsvm wcsv_cmpeq(wcsvd a, wcsvd b) { return _mm_cmpeq_pd(a, b); }
+WCSV_INLINE wcsvm wcsv_cmpne(wcsvd a, wcsvd b) { return _mm_cmpneq_pd(a, b); }
+WCSV_INLINE wcsvm wcsv_cmplt(wcsvd a, wcsvd b) { return _mm_cmplt_pd(a, b); }
+WCSV_INLINE wcsvm wcsv_cmple(wcsvd a, wcsvd b) { return _mm_cmple_pd(a, b); }
+WCSV_INLINE wcsvm wcsv_cmpgt(wcsvd a, wcsvd b) { return _mm_cmpgt_pd(a, b); }
+WCSV_INLINE wcsvm wcsv_cmpge(wcsvd a, wcsvd b) { return _mm_cmpge_pd(a, b); }
+
+WCSV_INLINE wcsvm wcsv_mand(wcsvm m, wcsvm n) { return _mm_and_pd(m, n); }
+WCSV_INLINE wcsvm wcsv_mor(wcsvm m, wcsvm n)  { return _mm_or_pd(m, n); }
+WCSV_INLINE wcsvm wcsv_mnot(wcsvm m)
+  { return _mm_xor_pd(m, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+WCSV_INLINE int   wcsv_mbits(wcsvm m) { return _mm_movemask_pd(m); }
+WCSV_INLINE wcsvd wcsv_sel(wcsvm m, wcsvd a, wcsvd b)
+  { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+
+WCSV_INLINE wcsvd wcsv_fma(wcsvd a, wcsvd b, wcsvd c)
+  { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+
+#endif
+
+/* Sign bit, absolute value, and negation. */
+WCSV_INLINE wcsvd wcsv_signbit(void) { return wcsv_set1(-0.0); }
+WCSV_INLINE wcsvd wcsv_abs(wcsvd a) { return wcsv_andnot(wcsv_signbit(), a); }
+WCSV_INLINE wcsvd wcsv_neg(wcsvd a) { return wcsv_xor(wcsv_signbit(), a); }
+
+/* Floor, valid for |a| < 2^51. */
+WCSV_INLINE wcsvd wcsv_floor(wcsvd a)
+  { wcsvd r = wcsv_rint(a);
+    return wcsv_sel(wcsv_cmpgt(r, a), wcsv_sub(r, wcsv_set1(1.0)), r); }
+
+/* Degree/radian conversion, evaluated as for the D2R and R2D macros. */
+WCSV_INLINE wcsvd wcsv_d2r(wcsvd a)
+  { return wcsv_div(wcsv_mul(a, wcsv_set1(PI)), wcsv_set1(180.0)); }
+WCSV_INLINE wcsvd wcsv_r2d(wcsvd a)
+  { return wcsv_div(wcsv_mul(a, wcsv_set1(180.0)), wcsv_set1(PI)); }
+
+
+/*----------------------------------------------------------------------------
+* Functions in radians, without special-case handling.
+*---------------------------------------------------------------------------*/
+
+/* Sine and cosine, valid for |x| < 2^29*pi/2. */
+WCSV_INLINE void wcsv_sincos(wcsvd x, wcsvd *s, wcsvd *c)
+
+{
+  wcsvd k, q, r, sr, cr, zz, t;
+  wcsvm swap;
+
+  /* Cody & Waite reduction by pi/2 in three parts, each of which is exact
+     when multiplied by k. */
+  k = wcsv_rint(wcsv_mul(x, wcsv_set1(6.36619772367581343076e-1)));
+  r = wcsv_sub(x, wcsv_mul(k, wcsv_set1(1.57079625129699707031e+0)));
+  r = wcsv_sub(r, wcsv_mul(k, wcsv_set1(7.54978941586159635335e-8)));
+  r = wcsv_sub(r, wcsv_mul(k, wcsv_set1(5.39030285815811905290e-15)));
+
+  zz = wcsv_mul(r, r);
+
+  t  = wcsv_fma(wcsv_set1( 1.58962301576546568060e-10), zz,
+                wcsv_set1(-2.50507477628578072866e-8));
+  t  = wcsv_fma(t, zz, wcsv_set1( 2.75573136213857245213e-6));
+  t  = wcsv_fma(t, zz, wcsv_set1(-1.98412698295895385996e-4));
+  t  = wcsv_fma(t, zz, wcsv_set1( 8.33333333332211858878e-3));
+  t  = wcsv_fma(t, zz, wcsv_set1(-1.66666666666666307295e-1));
+  sr = wcsv_fma(wcsv_mul(r, zz), t, r);
+
+  t  = wcsv_fma(wcsv_set1(-1.13585365213876817300e-11), zz,
+                wcsv_set1( 2.08757008419747316778e-9));
+  t  = wcsv_fma(t, zz, wcsv_set1(-2.75573141792967388112e-7));
+  t  = wcsv_fma(t, zz, wcsv_set1( 2.48015872888517045348e-5));
+  t  = wcsv_fma(t, zz, wcsv_set1(-1.38888888888730564116e-3));
+  t  = wcsv_fma(t, zz, wcsv_set1( 4.16666666666665929218e-2));
+  cr = wcsv_fma(wcsv_mul(zz, zz), t,
+                wcsv_sub(wcsv_set1(1.0), wcsv_mul(wcsv_set1(0.5), zz)));
+
+  /* Quadrant, q = k mod 4, in [0,3]. */
+  q = wcsv_sub(k, wcsv_mul(wcsv_set1(4.0),
+        wcsv_rint(wcsv_sub(wcsv_mul(k, wcsv_set1(0.25)), wcsv_set1(0.375)))));
+
+  swap = wcsv_mor(wcsv_cmpeq(q, wcsv_set1(1.0)),
+                  wcsv_cmpeq(q, wcsv_set1(3.0)));
+  *s = wcsv_sel(swap, cr, sr);
+  *c = wcsv_sel(swap, sr, cr);
+  *s = wcsv_sel(wcsv_cmpge(q, wcsv_set1(2.0)), wcsv_neg(*s), *s);
+  *c = wcsv_sel(wcsv_mor(wcsv_cmpeq(q, wcsv_set1(1.0)),
+                         wcsv_cmpeq(q, wcsv_set1(2.0))), wcsv_neg(*c), *c);
+}
+
+/* Arctangent of a non-negative argument. */
+WCSV_INLINE wcsvd wcsv_atanp(wcsvd x)
+
+{
+  wcsvd y, z, zz, p, q, xr;
+  wcsvm big, mid;
+
+  /* Reduce the argument to |x| <= 0.66. */
+  big = wcsv_cmpgt(x, wcsv_set1(2.41421356237309504880));
+  mid = wcsv_mand(wcsv_mnot(big), wcsv_cmpgt(x, wcsv_set1(0.66)));
+
+  xr = wcsv_sel(big, wcsv_neg(wcsv_div(wcsv_set1(1.0), x)), x);
+  xr = wcsv_sel(mid, wcsv_div(wcsv_sub(x, wcsv_set1(1.0)),
+                              wcsv_add(x, wcsv_set1(1.0))), xr);
+  y  = wcsv_sel(big, wcsv_set1(1.57079632679489661923),
+       wcsv_sel(mid, wcsv_set1(7.85398163397448309616e-1), wcsv_set1(0.0)));
+
+  zz = wcsv_mul(xr, xr);
+  p = wcsv_fma(wcsv_set1(-8.750608600031904122785e-1), zz,
+               wcsv_set1(-1.615753718733365076637e+1));
+  p = wcsv_fma(p, zz, wcsv_set1(-7.500855792314704667340e+1));
+  p = wcsv_fma(p, zz, wcsv_set1(-1.228866684490136173410e+2));
+  p = wcsv_fma(p, zz, wcsv_set1(-6.485021904942025371773e+1));
+
+  q = wcsv_add(zz, wcsv_set1(2.485846490142306297962e+1));
+  q = wcsv_fma(q, zz, wcsv_set1(1.650270098316988542046e+2));
+  q = wcsv_fma(q, zz, wcsv_set1(4.328810604912902668951e+2));
+  q = wcsv_fma(q, zz, wcsv_set1(4.853903996359136964868e+2));
+  q = wcsv_fma(q, zz, wcsv_set1(1.945506571482613964425e+2));
+
+  z = wcsv_fma(xr, wcsv_div(wcsv_mul(zz, p), q), xr);
+  z = wcsv_add(z, wcsv_sel(big, wcsv_set1(6.123233995736765886130e-17),
+                  wcsv_sel(mid, wcsv_set1(3.061616997868382943065e-17),
+                                wcsv_set1(0.0))));
+
+  return wcsv_add(y, z);
+}
+
+/* Arctangent, atan2(y,x), for finite non-zero x and y. */
+WCSV_INLINE wcsvd wcsv_atan2(wcsvd y, wcsvd x)
+
+{
+  wcsvd a, ax, ay, z;
+  wcsvm swap;
+
+  /* Reduce to the first octant. */
+  ax = wcsv_abs(x);
+  ay = wcsv_abs(y);
+  swap = wcsv_cmpgt(ay, ax);
+  a = wcsv_atanp(wcsv_div(wcsv_sel(swap, ax, ay), wcsv_sel(swap, ay, ax)));
+
+  /* Reflect, adding multiples of pi/2 in two parts. */
+  z = wcsv_sub(wcsv_set1(7.85398163397448278999e-01), a);
+  z = wcsv_add(wcsv_add(z, wcsv_set1(7.85398163397448278999e-01)),
+               wcsv_set1(6.12323399573676603587e-17));
+  a = wcsv_sel(swap, z, a);
+
+  z = wcsv_sub(wcsv_set1(1.57079632679489655800e+00), a);
+  z = wcsv_add(wcsv_add(z, wcsv_set1(1.57079632679489655800e+00)),
+               wcsv_set1(1.22464679914735317720e-16));
+  a = wcsv_sel(wcsv_cmplt(x, wcsv_set1(0.0)), z, a);
+
+  return wcsv_sel(wcsv_cmplt(y, wcsv_set1(0.0)), wcsv_neg(a), a);
+}
+
+/* Arcsine of a non-negative argument not greater than 1. */
+WCSV_INLINE wcsvd wcsv_asinp(wcsvd a)
+
+{
+  wcsvd p, q, r, s, z, zz, z1, z2;
+  wcsvm big;
+
+  /* arcsin(1-x) = pi/2 - sqrt(2x)(1+R(x)) near 1. */
+  zz = wcsv_sub(wcsv_set1(1.0), a);
+  r = wcsv_fma(wcsv_set1(2.967721961301243206100e-3), zz,
+               wcsv_set1(-5.634242780008963776856e-1));
+  r = wcsv_fma(r, zz, wcsv_set1( 6.968710824104713396794e+0));
+  r = wcsv_fma(r, zz, wcsv_set1(-2.556901049652824852289e+1));
+  r = wcsv_fma(r, zz, wcsv_set1( 2.853665548261061424989e+1));
+  s = wcsv_add(zz, wcsv_set1(-2.194779531642920639778e+1));
+  s = wcsv_fma(s, zz, wcsv_set1( 1.470656354026814941758e+2));
+  s = wcsv_fma(s, zz, wcsv_set1(-3.838770957603691357202e+2));
+  s = wcsv_fma(s, zz, wcsv_set1( 3.424398657913078477438e+2));
+  p  = wcsv_div(wcsv_mul(zz, r), s);
+  zz = wcsv_sqrt(wcsv_add(zz, zz));
+  z1 = wcsv_sub(wcsv_set1(7.85398163397448309616e-1), zz);
+  zz = wcsv_sub(wcsv_mul(zz, p), wcsv_set1(6.123233995736765886130e-17));
+  z1 = wcsv_add(wcsv_sub(z1, zz), wcsv_set1(7.85398163397448309616e-1));
+
+  /* Rational approximation elsewhere. */
+  zz = wcsv_mul(a, a);
+  p = wcsv_fma(wcsv_set1(4.253011369004428248960e-3), zz,
+               wcsv_set1(-6.019598008014123785661e-1));
+  p = wcsv_fma(p, zz, wcsv_set1( 5.444622390564711410273e+0));
+  p = wcsv_fma(p, zz, wcsv_set1(-1.626247967210700244449e+1));
+  p = wcsv_fma(p, zz, wcsv_set1( 1.956261983317594739197e+1));
+  p = wcsv_fma(p, zz, wcsv_set1(-8.198089802484824371615e+0));
+  q = wcsv_add(zz, wcsv_set1(-1.474091372988853791896e+1));
+  q = wcsv_fma(q, zz, wcsv_set1( 7.049610280856842141659e+1));
+  q = wcsv_fma(q, zz, wcsv_set1(-1.471791292232726029859e+2));
+  q = wcsv_fma(q, zz, wcsv_set1( 1.395105614657485689735e+2));
+  q = wcsv_fma(q, zz, wcsv_set1(-4.918853881490881290097e+1));
+  z2 = wcsv_fma(a, wcsv_div(wcsv_mul(zz, p), q), a);
+
+  big = wcsv_cmpgt(a, wcsv_set1(0.625));
+  z = wcsv_sel(big, z1, z2);
+
+  return z;
+}
+
+/* Arcsine, for |a| <= 1. */
+WCSV_INLINE wcsvd wcsv_asin(wcsvd a)
+
+{
+  wcsvd z;
+
+  z = wcsv_asinp(wcsv_abs(a));
+  return wcsv_sel(wcsv_cmplt(a, wcsv_set1(0.0)), wcsv_neg(z), z);
+}
+
+/* Arccosine, for |a| <= 1. */
+WCSV_INLINE wcsvd wcsv_acos(wcsvd a)
+
+{
+  wcsvd h, z, zh, zm;
+  wcsvm hi, lo;
+
+  lo = wcsv_cmplt(a, wcsv_set1(-0.5));
+  hi = wcsv_cmpgt(a, wcsv_set1( 0.5));
+
+  /* acos(a) = 2 asin(sqrt((1-|a|)/2)), reflected for a < 0. */
+  h  = wcsv_sqrt(wcsv_mul(wcsv_set1(0.5),
+                          wcsv_sub(wcsv_set1(1.0), wcsv_abs(a))));
+  zh = wcsv_mul(wcsv_set1(2.0), wcsv_asinp(h));
+  zh = wcsv_sel(lo, wcsv_sub(wcsv_set1(3.14159265358979323846), zh), zh);
+
+  /* acos(a) = pi/2 - asin(a) elsewhere. */
+  zm = wcsv_sub(wcsv_set1(7.85398163397448309616e-1), wcsv_asin(a));
+  zm = wcsv_add(zm, wcsv_set1(6.123233995736765886130e-17));
+  zm = wcsv_add(zm, wcsv_set1(7.85398163397448309616e-1));
+
+  z = wcsv_sel(wcsv_mor(lo, hi), zh, zm);
+  return z;
+}
+
+
+/*----------------------------------------------------------------------------
+* Functions in degrees, matching those in wcstrig.h.
+*---------------------------------------------------------------------------*/
+
+WCSV_INLINE void wcsv_sincosd(wcsvd angle, wcsvd *s, wcsvd *c)
+
+{
+  int   bits, i;
+  double as[WCSSIMD_NLANE], cs[WCSSIMD_NLANE], ss[WCSSIMD_NLANE];
+  wcsvd q, sq, cq;
+  wcsvm exact, odd;
+
+  wcsv_sincos(wcsv_d2r(angle), s, c);
+
+  /* Exact multiples of 90 degrees. */
+  q = wcsv_rint(wcsv_mul(angle, wcsv_set1(1.0/90.0)));
+  exact = wcsv_cmpeq(wcsv_mul(q, wcsv_set1(90.0)), angle);
+  if (wcsv_mbits(exact)) {
+    q = wcsv_sub(q, wcsv_mul(wcsv_set1(4.0),
+          wcsv_rint(wcsv_sub(wcsv_mul(q, wcsv_set1(0.25)),
+                             wcsv_set1(0.375)))));
+    odd = wcsv_mor(wcsv_cmpeq(q, wcsv_set1(1.0)),
+                   wcsv_cmpeq(q, wcsv_set1(3.0)));
+    sq = wcsv_sel(wcsv_cmpeq(q, wcsv_set1(1.0)), wcsv_set1(1.0),
+                                                 wcsv_set1(-1.0));
+    cq = wcsv_sel(wcsv_cmpeq(q, wcsv_set1(0.0)), wcsv_set1(1.0),
+                                                 wcsv_set1(-1.0));
+    sq = wcsv_sel(odd, sq, wcsv_set1(0.0));
+    cq = wcsv_sel(odd, wcsv_set1(0.0), cq);
+    *s = wcsv_sel(exact, sq, *s);
+    *c = wcsv_sel(exact, cq, *c);
+  }
+
+  /* Scalar code for large and non-finite arguments. */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(wcsv_abs(angle),
+                                         wcsv_set1(WCSSIMD_TRIGMAX))));
+  if (bits) {
+    wcsv_store(as, angle);
+    wcsv_store(ss, *s);
+    wcsv_store(cs, *c);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) sincosd(as[i], ss+i, cs+i);
+    }
+    *s = wcsv_load(ss);
+    *c = wcsv_load(cs);
+  }
+}
+
+
+WCSV_INLINE wcsvd wcsv_tand(wcsvd angle)
+
+{
+  int   bits, i;
+  double as[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd c, q, s, z;
+  wcsvm exact;
+
+  wcsv_sincos(wcsv_d2r(angle), &s, &c);
+  z = wcsv_div(s, c);
+
+  /* Exact multiples of 45 degrees, except odd multiples of 90. */
+  q = wcsv_rint(wcsv_mul(angle, wcsv_set1(1.0/45.0)));
+  exact = wcsv_cmpeq(wcsv_mul(q, wcsv_set1(45.0)), angle);
+  if (wcsv_mbits(exact)) {
+    q = wcsv_sub(q, wcsv_mul(wcsv_set1(4.0),
+          wcsv_rint(wcsv_sub(wcsv_mul(q, wcsv_set1(0.25)),
+                             wcsv_set1(0.375)))));
+    z = wcsv_sel(wcsv_mand(exact, wcsv_cmpeq(q, wcsv_set1(0.0))),
+                 wcsv_set1(0.0), z);
+    z = wcsv_sel(wcsv_mand(exact, wcsv_cmpeq(q, wcsv_set1(1.0))),
+                 wcsv_set1(1.0), z);
+    z = wcsv_sel(wcsv_mand(exact, wcsv_cmpeq(q, wcsv_set1(3.0))),
+                 wcsv_set1(-1.0), z);
+  }
+
+  /* Scalar code for large and non-finite arguments. */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(wcsv_abs(angle),
+                                         wcsv_set1(WCSSIMD_TRIGMAX))));
+  if (bits) {
+    wcsv_store(as, angle);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = tand(as[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+WCSV_INLINE wcsvd wcsv_atan2d(wcsvd y, wcsvd x)
+
+{
+  int   bits, i;
+  double xs[WCSSIMD_NLANE], ys[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd z, zero;
+  wcsvm xzero, yzero;
+
+  zero = wcsv_set1(0.0);
+  z = wcsv_r2d(wcsv_atan2(y, x));
+
+  xzero = wcsv_cmpeq(x, zero);
+  yzero = wcsv_cmpeq(y, zero);
+  z = wcsv_sel(xzero, wcsv_sel(wcsv_cmpgt(y, zero), wcsv_set1(90.0),
+                               wcsv_set1(-90.0)), z);
+  z = wcsv_sel(wcsv_mand(yzero, wcsv_cmpge(x, zero)), zero, z);
+  z = wcsv_sel(wcsv_mand(yzero, wcsv_cmplt(x, zero)), wcsv_set1(180.0), z);
+
+  /* Scalar code for non-finite arguments. */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_mand(
+           wcsv_cmplt(wcsv_abs(x), wcsv_set1(HUGE_VAL)),
+           wcsv_cmplt(wcsv_abs(y), wcsv_set1(HUGE_VAL)))));
+  if (bits) {
+    wcsv_store(xs, x);
+    wcsv_store(ys, y);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = atan2d(ys[i], xs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+WCSV_INLINE wcsvd wcsv_atand(wcsvd v)
+
+{
+  int   bits, i;
+  double vs[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd a, z;
+
+  a = wcsv_atanp(wcsv_abs(v));
+  z = wcsv_r2d(wcsv_sel(wcsv_cmplt(v, wcsv_set1(0.0)), wcsv_neg(a), a));
+
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1(-1.0)), wcsv_set1(-45.0), z);
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1( 0.0)), wcsv_set1(  0.0), z);
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1( 1.0)), wcsv_set1( 45.0), z);
+
+  /* Scalar code for non-finite arguments. */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(wcsv_abs(v), wcsv_set1(HUGE_VAL))));
+  if (bits) {
+    wcsv_store(vs, v);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = atand(vs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+WCSV_INLINE wcsvd wcsv_asind(wcsvd v)
+
+{
+  int   bits, i;
+  double vs[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd z;
+
+  z = wcsv_r2d(wcsv_asin(v));
+
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1(0.0)), wcsv_set1(0.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmple(v, wcsv_set1(-1.0)),
+               wcsv_cmpgt(wcsv_add(v, wcsv_set1(1.0)),
+                          wcsv_set1(-WCSTRIG_TOL))), wcsv_set1(-90.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmpge(v, wcsv_set1(1.0)),
+               wcsv_cmplt(wcsv_sub(v, wcsv_set1(1.0)),
+                          wcsv_set1(WCSTRIG_TOL))), wcsv_set1(90.0), z);
+
+  /* Scalar code for arguments outside the domain (NaN results). */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(wcsv_abs(v), wcsv_set1(1.0))));
+  bits &= ~wcsv_mbits(wcsv_mor(wcsv_cmpeq(z, wcsv_set1(90.0)),
+                               wcsv_cmpeq(z, wcsv_set1(-90.0))));
+  if (bits) {
+    wcsv_store(vs, v);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = asind(vs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+WCSV_INLINE wcsvd wcsv_acosd(wcsvd v)
+
+{
+  int   bits, i;
+  double vs[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd z;
+
+  z = wcsv_r2d(wcsv_acos(v));
+
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1(0.0)), wcsv_set1(90.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmple(v, wcsv_set1(-1.0)),
+               wcsv_cmpgt(wcsv_add(v, wcsv_set1(1.0)),
+                          wcsv_set1(-WCSTRIG_TOL))), wcsv_set1(180.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmpge(v, wcsv_set1(1.0)),
+               wcsv_cmplt(wcsv_sub(v, wcsv_set1(1.0)),
+                          wcsv_set1(WCSTRIG_TOL))), wcsv_set1(0.0), z);
+
+  /* Scalar code for arguments outside the domain (NaN results). */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(wcsv_abs(v), wcsv_set1(1.0))));
+  bits &= ~wcsv_mbits(wcsv_mor(wcsv_cmpeq(z, wcsv_set1(0.0)),
+                               wcsv_cmpeq(z, wcsv_set1(180.0))));
+  if (bits) {
+    wcsv_store(vs, v);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = acosd(vs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+/*----------------------------------------------------------------------------
+* Selectable reduced-accuracy functions in degrees.
+*---------------------------------------------------------------------------*/
+
+WCSV_INLINE void wcsv_fsincosd(int fast, wcsvd angle, wcsvd *s, wcsvd *c)
+
+{
+  int   bits, i;
+  double as[WCSSIMD_NLANE], cs[WCSSIMD_NLANE], ss[WCSSIMD_NLANE];
+  wcsvd cr, q, r, sr, u, zero;
+  wcsvm swap;
+
+  if (!fast) {
+    wcsv_sincosd(angle, s, c);
+    return;
+  }
+
+  /* Exact reduction by multiples of 90 degrees. */
+  q = wcsv_rint(wcsv_mul(angle, wcsv_set1(1.0/90.0)));
+  r = wcsv_mul(wcsv_sub(angle, wcsv_mul(q, wcsv_set1(90.0))),
+               wcsv_set1(1.74532925199432957692e-2));
+  u = wcsv_mul(r, r);
+
+  sr = wcsv_fma(wcsv_set1( 2.72499636886232159025e-6), u,
+                wcsv_set1(-1.98400870857370887181e-4));
+  sr = wcsv_fma(sr, u, wcsv_set1( 8.33333187551976543872e-3));
+  sr = wcsv_fma(sr, u, wcsv_set1(-1.66666666638580457382e-1));
+  sr = wcsv_fma(wcsv_mul(r, u), sr, r);
+
+  cr = wcsv_fma(wcsv_set1(-2.72371529378390354061e-7), u,
+                wcsv_set1( 2.47998623151587696783e-5));
+  cr = wcsv_fma(cr, u, wcsv_set1(-1.38888850916911660641e-3));
+  cr = wcsv_fma(cr, u, wcsv_set1( 4.16666666373945102086e-2));
+  cr = wcsv_fma(cr, u, wcsv_set1(-4.99999999999639066495e-1));
+  cr = wcsv_fma(cr, u, wcsv_set1(1.0));
+
+  /* Quadrant, q mod 4 in [0,3]; adding zero clears the sign of zeroes. */
+  q = wcsv_sub(q, wcsv_mul(wcsv_set1(4.0),
+        wcsv_rint(wcsv_sub(wcsv_mul(q, wcsv_set1(0.25)), wcsv_set1(0.375)))));
+
+  swap = wcsv_mor(wcsv_cmpeq(q, wcsv_set1(1.0)),
+                  wcsv_cmpeq(q, wcsv_set1(3.0)));
+  *s = wcsv_sel(swap, cr, sr);
+  *c = wcsv_sel(swap, sr, cr);
+  *s = wcsv_sel(wcsv_cmpge(q, wcsv_set1(2.0)), wcsv_neg(*s), *s);
+  *c = wcsv_sel(wcsv_mor(wcsv_cmpeq(q, wcsv_set1(1.0)),
+                         wcsv_cmpeq(q, wcsv_set1(2.0))), wcsv_neg(*c), *c);
+
+  zero = wcsv_set1(0.0);
+  *s = wcsv_add(*s, zero);
+  *c = wcsv_add(*c, zero);
+
+  /* Scalar code for large and non-finite arguments. */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(wcsv_abs(angle),
+                                         wcsv_set1(WCSSIMD_TRIGMAX))));
+  if (bits) {
+    wcsv_store(as, angle);
+    wcsv_store(ss, *s);
+    wcsv_store(cs, *c);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) sincosd(as[i], ss+i, cs+i);
+    }
+    *s = wcsv_load(ss);
+    *c = wcsv_load(cs);
+  }
+}
+
+
+/* Arctangent of t in [0,1]. */
+WCSV_INLINE wcsvd wcsv_fatanp(wcsvd t)
+
+{
+  wcsvd p, u;
+
+  u = wcsv_mul(t, t);
+  p = wcsv_fma(wcsv_set1( 6.08573902864009089880e-4), u,
+               wcsv_set1(-4.30769836064428049416e-3));
+  p = wcsv_fma(p, u, wcsv_set1( 1.42789339063892836701e-2));
+  p = wcsv_fma(p, u, wcsv_set1(-3.01921252722240733568e-2));
+  p = wcsv_fma(p, u, wcsv_set1( 4.75297082355245967267e-2));
+  p = wcsv_fma(p, u, wcsv_set1(-6.25903747279289712768e-2));
+  p = wcsv_fma(p, u, wcsv_set1( 7.59108516918036019261e-2));
+  p = wcsv_fma(p, u, wcsv_set1(-9.07451781233939436255e-2));
+  p = wcsv_fma(p, u, wcsv_set1( 1.11095151240680437010e-1));
+  p = wcsv_fma(p, u, wcsv_set1(-1.42856329384418889727e-1));
+  p = wcsv_fma(p, u, wcsv_set1( 1.99999983606923031898e-1));
+  p = wcsv_fma(p, u, wcsv_set1(-3.33333333278267585076e-1));
+
+  return wcsv_fma(wcsv_mul(t, u), p, t);
+}
+
+
+/* Arcsine of z in [0,0.5]. */
+WCSV_INLINE wcsvd wcsv_fasinp(wcsvd z)
+
+{
+  wcsvd p, u;
+
+  u = wcsv_mul(z, z);
+  p = wcsv_fma(wcsv_set1(3.10856976103968916936e-2), u,
+               wcsv_set1(1.04914750484749706716e-2));
+  p = wcsv_fma(p, u, wcsv_set1(2.36349987467838161537e-2));
+  p = wcsv_fma(p, u, wcsv_set1(3.02661568858508187030e-2));
+  p = wcsv_fma(p, u, wcsv_set1(4.46478368913317408273e-2));
+  p = wcsv_fma(p, u, wcsv_set1(7.49999203844980838474e-2));
+  p = wcsv_fma(p, u, wcsv_set1(1.66666666873339974764e-1));
+
+  return wcsv_fma(wcsv_mul(z, u), p, z);
+}
+
+
+WCSV_INLINE wcsvd wcsv_fatan2d(int fast, wcsvd y, wcsvd x)
+
+{
+  int   bits, i;
+  double xs[WCSSIMD_NLANE], ys[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd a, ax, ay, z, zero;
+  wcsvm swap, xzero, yzero;
+
+  if (!fast) return wcsv_atan2d(y, x);
+
+  /* Reduce to the first octant with a single division. */
+  ax = wcsv_abs(x);
+  ay = wcsv_abs(y);
+  swap = wcsv_cmpgt(ay, ax);
+  a = wcsv_fatanp(wcsv_div(wcsv_sel(swap, ax, ay), wcsv_sel(swap, ay, ax)));
+
+  a = wcsv_sel(swap, wcsv_sub(wcsv_set1(1.57079632679489661923), a), a);
+  zero = wcsv_set1(0.0);
+  a = wcsv_sel(wcsv_cmplt(x, zero),
+               wcsv_sub(wcsv_set1(3.14159265358979323846), a), a);
+  a = wcsv_sel(wcsv_cmplt(y, zero), wcsv_neg(a), a);
+  z = wcsv_mul(a, wcsv_set1(57.2957795130823208768));
+
+  xzero = wcsv_cmpeq(x, zero);
+  yzero = wcsv_cmpeq(y, zero);
+  z = wcsv_sel(xzero, wcsv_sel(wcsv_cmpgt(y, zero), wcsv_set1(90.0),
+                               wcsv_set1(-90.0)), z);
+  z = wcsv_sel(wcsv_mand(yzero, wcsv_cmpge(x, zero)), zero, z);
+  z = wcsv_sel(wcsv_mand(yzero, wcsv_cmplt(x, zero)), wcsv_set1(180.0), z);
+
+  /* Scalar code for non-finite arguments. */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_mand(
+           wcsv_cmplt(ax, wcsv_set1(HUGE_VAL)),
+           wcsv_cmplt(ay, wcsv_set1(HUGE_VAL)))));
+  if (bits) {
+    wcsv_store(xs, x);
+    wcsv_store(ys, y);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = atan2d(ys[i], xs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+WCSV_INLINE wcsvd wcsv_fatand(int fast, wcsvd v)
+
+{
+  int   bits, i;
+  double vs[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd a, av, z;
+  wcsvm big;
+
+  if (!fast) return wcsv_atand(v);
+
+  av  = wcsv_abs(v);
+  big = wcsv_cmpgt(av, wcsv_set1(1.0));
+  a = wcsv_fatanp(wcsv_sel(big, wcsv_div(wcsv_set1(1.0), av), av));
+  a = wcsv_sel(big, wcsv_sub(wcsv_set1(1.57079632679489661923), a), a);
+  a = wcsv_sel(wcsv_cmplt(v, wcsv_set1(0.0)), wcsv_neg(a), a);
+  z = wcsv_mul(a, wcsv_set1(57.2957795130823208768));
+
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1(-1.0)), wcsv_set1(-45.0), z);
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1( 0.0)), wcsv_set1(  0.0), z);
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1( 1.0)), wcsv_set1( 45.0), z);
+
+  /* Scalar code for non-finite arguments. */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(av, wcsv_set1(HUGE_VAL))));
+  if (bits) {
+    wcsv_store(vs, v);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = atand(vs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+WCSV_INLINE wcsvd wcsv_fasind(int fast, wcsvd v)
+
+{
+  int   bits, i;
+  double vs[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd a, av, z;
+  wcsvm big;
+
+  if (!fast) return wcsv_asind(v);
+
+  /* asin(v) = pi/2 - 2 asin(sqrt((1-v)/2)) for v > 1/2. */
+  av  = wcsv_abs(v);
+  big = wcsv_cmpgt(av, wcsv_set1(0.5));
+  a = wcsv_fasinp(wcsv_sel(big, wcsv_sqrt(wcsv_mul(wcsv_set1(0.5),
+                    wcsv_sub(wcsv_set1(1.0), av))), av));
+  a = wcsv_sel(big, wcsv_sub(wcsv_set1(1.57079632679489661923),
+                             wcsv_add(a, a)), a);
+  a = wcsv_sel(wcsv_cmplt(v, wcsv_set1(0.0)), wcsv_neg(a), a);
+  z = wcsv_mul(a, wcsv_set1(57.2957795130823208768));
+
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1(0.0)), wcsv_set1(0.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmple(v, wcsv_set1(-1.0)),
+               wcsv_cmpgt(wcsv_add(v, wcsv_set1(1.0)),
+                          wcsv_set1(-WCSTRIG_TOL))), wcsv_set1(-90.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmpge(v, wcsv_set1(1.0)),
+               wcsv_cmplt(wcsv_sub(v, wcsv_set1(1.0)),
+                          wcsv_set1(WCSTRIG_TOL))), wcsv_set1(90.0), z);
+
+  /* Scalar code for arguments outside the domain (NaN results). */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(av, wcsv_set1(1.0))));
+  bits &= ~wcsv_mbits(wcsv_mor(wcsv_cmpeq(z, wcsv_set1(90.0)),
+                               wcsv_cmpeq(z, wcsv_set1(-90.0))));
+  if (bits) {
+    wcsv_store(vs, v);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = asind(vs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+
+WCSV_INLINE wcsvd wcsv_facosd(int fast, wcsvd v)
+
+{
+  int   bits, i;
+  double vs[WCSSIMD_NLANE], zs[WCSSIMD_NLANE];
+  wcsvd a, av, z;
+  wcsvm big, neg;
+
+  if (!fast) return wcsv_acosd(v);
+
+  /* acos(v) = 2 asin(sqrt((1-v)/2)) for v > 1/2, reflected for v < -1/2, */
+  /* and pi/2 - asin(v) elsewhere.                                        */
+  av  = wcsv_abs(v);
+  big = wcsv_cmpgt(av, wcsv_set1(0.5));
+  neg = wcsv_cmplt(v, wcsv_set1(0.0));
+  a = wcsv_fasinp(wcsv_sel(big, wcsv_sqrt(wcsv_mul(wcsv_set1(0.5),
+                    wcsv_sub(wcsv_set1(1.0), av))), av));
+  a = wcsv_sel(big, wcsv_add(a, a),
+                    wcsv_sub(wcsv_set1(1.57079632679489661923),
+                             wcsv_sel(neg, wcsv_neg(a), a)));
+  a = wcsv_sel(wcsv_mand(big, neg),
+               wcsv_sub(wcsv_set1(3.14159265358979323846), a), a);
+  z = wcsv_mul(a, wcsv_set1(57.2957795130823208768));
+
+  z = wcsv_sel(wcsv_cmpeq(v, wcsv_set1(0.0)), wcsv_set1(90.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmple(v, wcsv_set1(-1.0)),
+               wcsv_cmpgt(wcsv_add(v, wcsv_set1(1.0)),
+                          wcsv_set1(-WCSTRIG_TOL))), wcsv_set1(180.0), z);
+  z = wcsv_sel(wcsv_mand(wcsv_cmpge(v, wcsv_set1(1.0)),
+               wcsv_cmplt(wcsv_sub(v, wcsv_set1(1.0)),
+                          wcsv_set1(WCSTRIG_TOL))), wcsv_set1(0.0), z);
+
+  /* Scalar code for arguments outside the domain (NaN results). */
+  bits = wcsv_mbits(wcsv_mnot(wcsv_cmplt(av, wcsv_set1(1.0))));
+  bits &= ~wcsv_mbits(wcsv_mor(wcsv_cmpeq(z, wcsv_set1(0.0)),
+                               wcsv_cmpeq(z, wcsv_set1(180.0))));
+  if (bits) {
+    wcsv_store(vs, v);
+    wcsv_store(zs, z);
+    for (i = 0; i < WCSSIMD_NLANE; i++) {
+      if (bits & (1 << i)) zs[i] = acosd(vs[i]);
+    }
+    z = wcsv_load(zs);
+  }
+
+  return z;
+}
+
+#endif /* WCSSIMD */
+
+#endif /* WCSLIB_WCSSIMD */
@@ -53,6 +53,18 @@
 * 90 degrees (compile with -DWCSTRIG_MACRO).  These are typically 20% faster
 * but may lead to problems near the poles.
 *
+* Vector forms of each of the trigd functions, cosdv(), sindv(), sincosdv(),
+* tandv(), acosdv(), asindv(), atandv(), and atan2dv(), apply them to an
+* array of arguments.  On x86 processors they use SIMD kernels, compiled for
+* each of the SSE2, AVX2, and AVX-512 instruction sets with GCC (or only for
+* that targeted by the compiler options otherwise), of which the widest
+* supported by the processor is chosen at run time.  Hence the one library
+* runs at the best available speed on any member of a heterogeneous cluster.
+* The kernels keep the exact results of the scalar functions for multiples of
+* 90 degrees (45 degrees for tand()), and elsewhere agree with them to within
+* a few units in the last place.  trigdsimd() may be used to query or
+* restrict the instruction set.
+*
 *
 * cosd() - Cosine of an angle in degrees
 * --------------------------------------
@@ -150,6 +162,148 @@
 * Function return value:
 *             double    Polar angle of (x,y) [deg].
 *
+*
+* cosdv() - Cosine of an array of angles in degrees
+* -------------------------------------------------
+* cosdv() returns the cosines of an array of angles given in degrees,
+* computing each one as for cosd().
+*
+* Given:
+*   n         int       Number of angles.
+*
+*   angle     const double[]
+*                       Angles [deg].
+*
+* Returned:
+*   cos       double[]  Cosines of the angles.  May be the same array as
+*                       angle.
+*
+* Function return value:
+*             void
+*
+*
+* sindv() - Sine of an array of angles in degrees
+* -----------------------------------------------
+* sindv() returns the sines of an array of angles given in degrees, computing
+* each one as for sind().
+*
+* Given and returned:
+*   As for cosdv().
+*
+*
+* sincosdv() - Sine and cosine of an array of angles in degrees
+* -------------------------------------------------------------
+* sincosdv() returns the sines and cosines of an array of angles given in
+* degrees, computing each pair as for sincosd().
+*
+* Given:
+*   n         int       Number of angles.
+*
+*   angle     const double[]
+*                       Angles [deg].
+*
+* Returned:
+*   sin       double[]  Sines of the angles.
+*
+*   cos       double[]  Cosines of the angles.  Either, but not both, of sin
+*                       and cos may be the same array as angle.
+*
+* Function return value:
+*             void
+*
+*
+* tandv() - Tangent of an array of angles in degrees
+* --------------------------------------------------
+* tandv() returns the tangents of an array of angles given in degrees,
+* computing each one as for tand().
+*
+* Given and returned:
+*   As for cosdv().
+*
+*
+* acosdv() - Inverse cosine of an array, returning angles in degrees
+* ------------------------------------------------------------------
+* acosdv() returns the inverse cosines, in degrees, of an array of values,
+* computing each one as for acosd().
+*
+* Given:
+*   n         int       Number of values.
+*
+*   x         const double[]
+*                       Values in the range [-1,1].
+*
+* Returned:
+*   angle     double[]  Inverse cosines of x [deg].  May be the same array as
+*                       x.
+*
+* Function return value:
+*             void
+*
+*
+* asindv() - Inverse sine of an array, returning angles in degrees
+* ----------------------------------------------------------------
+* asindv() returns the inverse sines, in degrees, of an array of values,
+* computing each one as for asind().
+*
+* Given and returned:
+*   As for acosdv().
+*
+*
+* atandv() - Inverse tangent of an array, returning angles in degrees
+* -------------------------------------------------------------------
+* atandv() returns the inverse tangents, in degrees, of an array of values,
+* computing each one as for atand().
+*
+* Given and returned:
+*   As for acosdv(), except that the values are unrestricted.
+*
+*
+* atan2dv() - Polar angles of an array of (x,y), in degrees
+* ---------------------------------------------------------
+* atan2dv() returns the polar angles, in degrees, of an array of Cartesian
+* coordinates (x,y), computing each one as for atan2d().
+*
+* Given:
+*   n         int       Number of coordinate pairs.
+*
+*   y         const double[]
+*                       Cartesian y-coordinates.
+*
+*   x         const double[]
+*                       Cartesian x-coordinates.
+*
+* Returned:
+*   angle     double[]  Polar angles of (x,y) [deg].  May be the same array
+*                       as x or y.
+*
+* Function return value:
+*             void
+*
+*
+* trigdsimd() - Select the instruction set for the vector trigd functions
+* -----------------------------------------------------------------------
+* trigdsimd() restricts the SIMD instruction set used by cosdv(), sindv(),
+* sincosdv(), tandv(), acosdv(), asindv(), atandv(), and atan2dv() for all
+* subsequent calls.  By default they use the widest one supported by both the
+* library and the processor.  This is a global setting; it is intended mainly
+* for testing and benchmarking and should not be changed while other threads
+* are using these routines.
+*
+* Given:
+*   isa       int       Widest instruction set to use, specified by its
+*                       vector width in bits:
+*                         512: AVX-512,
+*                         256: AVX2 (with FMA),
+*                         128: SSE2,
+*                           0: scalar code only, i.e. a loop over the trigd
+*                              functions.
+*                       The widest one available that does not exceed it is
+*                       selected.  If negative, the setting is unchanged.
+*
+* Function return value:
+*             int       The previous selection, as a width in bits, or 0 for
+*                       scalar code.
+*
 *===========================================================================*/
 
 #ifndef WCSLIB_WCSTRIG
@@ -204,6 +358,18 @@ double atan2d(double y, double x);
 
 #endif /* WCSTRIG_MACRO */
 
+/* Vector forms of the trigd functions. */
+void cosdv(int n, const double angle[], double cos[]);
+void sindv(int n, const double angle[], double sin[]);
+void sincosdv(int n, const double angle[], double sin[], double cos[]);
+void tandv(int n, const double angle[], double tan[]);
+void acosdv(int n, const double x[], double angle[]);
+void asindv(int n, const double y[], double angle[]);
+void atandv(int n, const double s[], double angle[]);
+void atan2dv(int n, const double y[], const double x[], double angle[]);
+
+int trigdsimd(int isa);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,234 @@
+/*============================================================================
+
+  WCSLIB 4.22 - an implementation of the FITS WCS standard.
+  Copyright (C) 1995-2014, Mark Calabretta
+
+  This file is part of WCSLIB.
+
+  WCSLIB is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or (at your option)
+  any later version.
+
+  WCSLIB is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+  more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with WCSLIB.  If not, see http://www.gnu.org/licenses.
+
+  Direct correspondence concerning WCSLIB to mark@calabretta.id.au
+
+  Author: Mark Calabretta, Australia Telescope National Facility, CSIRO.
+  http://www.atnf.csiro.au/people/Mark.Calabretta
+  $Id: wcstrigv.c,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
+*===========================================================================*/
+
+#include "wcstrig.h"
+#include "wcssimd.h"
+
+#define WCSTRIGV_KERNEL wcstrigv_base
+#include "wcstrigv.h"
+
+/* Instruction set targeted by the compiler options. */
+#ifdef WCSSIMD
+#define WCSTRIGV_BASE WCSSIMD
+#else
+#define WCSTRIGV_BASE 0
+#endif
+
+/* Selected instruction set, or -1 if not yet determined. */
+static int trigv_isa = -1;
+
+static int  trigv_best(int isa);
+static void trigv(int op, int n, const double a[], const double b[],
+                  double r[], double s[]);
+
+/*--------------------------------------------------------------------------*/
+
+int trigdsimd(int isa)
+
+{
+  int prev;
+
+  if ((prev = trigv_isa) < 0) {
+    prev = trigv_best(512);
+  }
+
+  trigv_isa = (isa < 0) ? prev : trigv_best(isa);
+
+  return prev;
+}
+
+/*--------------------------------------------------------------------------*/
+
+void cosdv(int n, const double angle[], double cos[])
+
+{
+  trigv(WCSTRIGV_COSD, n, angle, 0x0, cos, 0x0);
+}
+
+/*--------------------------------------------------------------------------*/
+
+void sindv(int n, const double angle[], double sin[])
+
+{
+  trigv(WCSTRIGV_SIND, n, angle, 0x0, sin, 0x0);
+}
+
+/*--------------------------------------------------------------------------*/
+
+void sincosdv(int n, const double angle[], double sin[], double cos[])
+
+{
+  trigv(WCSTRIGV_SINCOSD, n, angle, 0x0, sin, cos);
+}
+
+/*--------------------------------------------------------------------------*/
+
+void tandv(int n, const double angle[], double tan[])
+
+{
+  trigv(WCSTRIGV_TAND, n, angle, 0x0, tan, 0x0);
+}
+
+/*--------------------------------------------------------------------------*/
+
+void acosdv(int n, const double x[], double angle[])
+
+{
+  trigv(WCSTRIGV_ACOSD, n, x, 0x0, angle, 0x0);
+}
+
+/*--------------------------------------------------------------------------*/
+
+void asindv(int n, const double y[], double angle[])
+
+{
+  trigv(WCSTRIGV_ASIND, n, y, 0x0, angle, 0x0);
+}
+
+/*--------------------------------------------------------------------------*/
+
+void atandv(int n, const double s[], double angle[])
+
+{
+  trigv(WCSTRIGV_ATAND, n, s, 0x0, angle, 0x0);
+}
+
+/*--------------------------------------------------------------------------*/
+
+void atan2dv(int n, const double y[], const double x[], double angle[])
+
+{
+  trigv(WCSTRIGV_ATAN2D, n, y, x, angle, 0x0);
+}
+
+/*----------------------------------------------------------------------------
+* Widest instruction set, not exceeding isa, supported by both the library
+* and the processor.
+*---------------------------------------------------------------------------*/
+
+int trigv_best(int isa)
+
+{
+#ifdef WCSTRIGV_DISPATCH
+  __builtin_cpu_init();
+
+  if (isa >= 512 && WCSTRIGV_BASE < 512 &&
+      __builtin_cpu_supports("avx512f")) {
+    return 512;
+  }
+
+  if (isa >= 256 && WCSTRIGV_BASE < 256 &&
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return 256;
+  }
+#endif
+
+  return (isa >= WCSTRIGV_BASE) ? WCSTRIGV_BASE : 0;
+}
+
+/*----------------------------------------------------------------------------
+* Apply the trigd function selected by op via the selected kernel.
+*---------------------------------------------------------------------------*/
+
+void trigv(
+  int op,
+  int n,
+  const double a[],
+  const double b[],
+  double r[],
+  double s[])
+
+{
+  int i, isa;
+
+  if ((isa = trigv_isa) < 0) {
+    trigv_isa = isa = trigv_best(512);
+  }
+
+#ifdef WCSTRIGV_DISPATCH
+  if (isa == 512 && WCSTRIGV_BASE < 512) {
+    wcstrigv_512(op, n, a, b, r, s);
+    return;
+  }
+
+  if (isa == 256 && WCSTRIGV_BASE < 256) {
+    wcstrigv_256(op, n, a, b, r, s);
+    return;
+  }
+#endif
+
+#ifdef WCSSIMD
+  if (isa) {
+    wcstrigv_base(op, n, a, b, r, s);
+    return;
+  }
+#endif
+
+  /* Scalar code. */
+  switch (op) {
+  case WCSTRIGV_COSD:
+    for (i = 0; i < n; i++) {
+      r[i] = cosd(a[i]);
+    }
+    break;
+  case WCSTRIGV_SIND:
+    for (i = 0; i < n; i++) {
+      r[i] = sind(a[i]);
+    }
+    break;
+  case WCSTRIGV_SINCOSD:
+    for (i = 0; i < n; i++) {
+      sincosd(a[i], r+i, s+i);
+    }
+    break;
+  case WCSTRIGV_TAND:
+    for (i = 0; i < n; i++) {
+      r[i] = tand(a[i]);
+    }
+    break;
+  case WCSTRIGV_ACOSD:
+    for (i = 0; i < n; i++) {
+      r[i] = acosd(a[i]);
+    }
+    break;
+  case WCSTRIGV_ASIND:
+    for (i = 0; i < n; i++) {
+      r[i] = asind(a[i]);
+    }
+    break;
+  case WCSTRIGV_ATAND:
+    for (i = 0; i < n; i++) {
+      r[i] = atand(a[i]);
+    }
+    break;
+  case WCSTRIGV_ATAN2D:
+    for (i = 0; i < n; i++) {
+      r[i] = atan2d(a[i], b[i]);
+    }
+    break;
+  }
+}
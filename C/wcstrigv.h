@@ -0,0 +1,149 @@
+/*============================================================================
+
+  WCSLIB 4.22 - an implementation of the FITS WCS standard.
+  Copyright (C) 1995-2014, Mark Calabretta
+
+  This file is part of WCSLIB.
+
+  WCSLIB is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or (at your option)
+  any later version.
+
+  WCSLIB is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+  more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with WCSLIB.  If not, see http://www.gnu.org/licenses.
+
+  Direct correspondence concerning WCSLIB to mark@calabretta.id.au
+
+  Author: Mark Calabretta, Australia Telescope National Facility, CSIRO.
+  http://www.atnf.csiro.au/people/Mark.Calabretta
+  $Id: wcstrigv.h,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
+*=============================================================================
+*
+* Summary of the wcstrigv routines
+* --------------------------------
+* Kernels for the vector trigd functions declared in wcstrig.h, for internal
+* use only by WCSLIB.  They are documented here solely as an aid to
+* understanding the code.  They are not intended for external use - the API
+* may change without notice!
+*
+* Each kernel has the form
+*
+=   void kernel(int op, int n, const double a[], const double b[],
+=               double r[], double s[]);
+*
+* and applies the trigd function selected by op, one of the WCSTRIGV_*
+* codes below, to n elements of a (and b for WCSTRIGV_ATAN2D, where a holds
+* y and b holds x), returning the result in r (and the cosine in s for
+* WCSTRIGV_SINCOSD).
+*
+* A kernel is instantiated by defining WCSTRIGV_KERNEL as its name before
+* including this header, after wcssimd.h has been included.  wcstrigv.c
+* instantiates wcstrigv_base() for the instruction set targeted by the
+* compiler options.  With GCC on x86, wcstrigv256.c and wcstrigv512.c raise
+* the target to AVX2 and AVX-512 via "#pragma GCC target" and instantiate
+* wcstrigv_256() and wcstrigv_512(); WCSTRIGV_DISPATCH is then defined and
+* wcstrigv.c chooses between them at run time according to the processor.
+*
+*===========================================================================*/
+
+#ifndef WCSLIB_WCSTRIGV
+#define WCSLIB_WCSTRIGV
+
+#define WCSTRIGV_COSD    0
+#define WCSTRIGV_SIND    1
+#define WCSTRIGV_SINCOSD 2
+#define WCSTRIGV_TAND    3
+#define WCSTRIGV_ACOSD   4
+#define WCSTRIGV_ASIND   5
+#define WCSTRIGV_ATAND   6
+#define WCSTRIGV_ATAN2D  7
+
+#if defined(__GNUC__) && !defined(__clang__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) && \
+    (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(WCSTRIG_MACRO) && !defined(WCSSIMD_DISABLE)
+#define WCSTRIGV_DISPATCH
+
+void wcstrigv_256(int op, int n, const double a[], const double b[],
+                  double r[], double s[]);
+void wcstrigv_512(int op, int n, const double a[], const double b[],
+                  double r[], double s[]);
+#endif
+
+#endif /* WCSLIB_WCSTRIGV */
+
+
+#if defined(WCSTRIGV_KERNEL) && defined(WCSSIMD)
+
+void WCSTRIGV_KERNEL(
+  int op,
+  int n,
+  const double a[],
+  const double b[],
+  double r[],
+  double s[])
+
+{
+  int i, j, m;
+  double bufa[WCSSIMD_NLANE], bufb[WCSSIMD_NLANE], bufr[WCSSIMD_NLANE],
+         bufs[WCSSIMD_NLANE];
+  wcsvd va, vc, vs;
+
+  for (i = 0; i + WCSSIMD_NLANE <= n; i += WCSSIMD_NLANE) {
+    va = wcsv_load(a + i);
+
+    switch (op) {
+    case WCSTRIGV_COSD:
+      wcsv_sincosd(va, &vs, &vc);
+      wcsv_store(r + i, vc);
+      break;
+    case WCSTRIGV_SIND:
+      wcsv_sincosd(va, &vs, &vc);
+      wcsv_store(r + i, vs);
+      break;
+    case WCSTRIGV_SINCOSD:
+      wcsv_sincosd(va, &vs, &vc);
+      wcsv_store(r + i, vs);
+      wcsv_store(s + i, vc);
+      break;
+    case WCSTRIGV_TAND:
+      wcsv_store(r + i, wcsv_tand(va));
+      break;
+    case WCSTRIGV_ACOSD:
+      wcsv_store(r + i, wcsv_acosd(va));
+      break;
+    case WCSTRIGV_ASIND:
+      wcsv_store(r + i, wcsv_asind(va));
+      break;
+    case WCSTRIGV_ATAND:
+      wcsv_store(r + i, wcsv_atand(va));
+      break;
+    case WCSTRIGV_ATAN2D:
+      wcsv_store(r + i, wcsv_atan2d(va, wcsv_load(b + i)));
+      break;
+    }
+  }
+
+  /* Pad the remainder to a full vector. */
+  if ((m = n - i) > 0) {
+    for (j = 0; j < WCSSIMD_NLANE; j++) {
+      bufa[j] = (j < m) ? a[i+j] : 0.0;
+      bufb[j] = (j < m && b) ? b[i+j] : 1.0;
+    }
+
+    WCSTRIGV_KERNEL(op, WCSSIMD_NLANE, bufa, bufb, bufr, bufs);
+
+    for (j = 0; j < m; j++) {
+      r[i+j] = bufr[j];
+      if (op == WCSTRIGV_SINCOSD) s[i+j] = bufs[j];
+    }
+  }
+}
+
+#endif /* WCSTRIGV_KERNEL */
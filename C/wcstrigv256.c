@@ -0,0 +1,39 @@
+/*============================================================================
+
+  WCSLIB 4.22 - an implementation of the FITS WCS standard.
+  Copyright (C) 1995-2014, Mark Calabretta
+
+  This file is part of WCSLIB.
+
+  WCSLIB is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or (at your option)
+  any later version.
+
+  WCSLIB is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+  more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with WCSLIB.  If not, see http://www.gnu.org/licenses.
+
+  Direct correspondence concerning WCSLIB to mark@calabretta.id.au
+
+  Author: Mark Calabretta, Australia Telescope National Facility, CSIRO.
+  http://www.atnf.csiro.au/people/Mark.Calabretta
+  $Id: wcstrigv256.c,v 4.22 2014/04/12 15:03:52 mcalabre Exp $
+*===========================================================================*/
+
+/* AVX2 kernel for the vector trigd functions, see wcstrigv.h. */
+
+#include "wcstrigv.h"
+
+#ifdef WCSTRIGV_DISPATCH
+#pragma GCC target("avx2,fma")
+
+#include "wcssimd.h"
+
+#define WCSTRIGV_KERNEL wcstrigv_256
+#include "wcstrigv.h"
+#endif
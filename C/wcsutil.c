@@ -30,8 +30,14 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "wcsconfig.h"
 #include "wcsutil.h"
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 /*--------------------------------------------------------------------------*/
 
 void wcsutil_blank_fill(int n, char c[])
@@ -251,3 +257,176 @@ void wcsutil_double2str(char *buf, const char *format, double value)
   sprintf(buf, format, value);
   wcsutil_locale_to_dot(buf);
 }
+
+/*--------------------------------------------------------------------------*/
+
+int wcsutil_ncpu(void)
+
+{
+  long ncpu = 1;
+
+#if defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+  ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  if (ncpu < 1) ncpu = 1;
+#endif
+
+  return (int)ncpu;
+}
+
+/*--------------------------------------------------------------------------*/
+
+#ifdef HAVE_PTHREAD
+
+/* The thread pool; all members other than busy are protected by lock.
+   Workers wait on work until a task slot is offered, the submitting thread
+   waits on done until every task has completed. */
+static struct {
+  pthread_mutex_t busy, lock;
+  pthread_cond_t  work, done;
+  int  nworker, nslot;
+  int  ntask, next, ndone;
+  void (*task)(void *, int);
+  void *arg;
+} wcsutil_pl = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+                PTHREAD_COND_INITIALIZER,  PTHREAD_COND_INITIALIZER,
+                0, 0, 0, 0, 0, 0x0, 0x0};
+
+static pthread_once_t wcsutil_pl_once = PTHREAD_ONCE_INIT;
+
+/* fork() handlers.  The pool is quiescent while a fork is in progress, and
+   only the forking thread exists in the child, so the child starts afresh
+   with no workers. */
+static void wcsutil_pool_prepare(void)
+
+{
+  pthread_mutex_lock(&wcsutil_pl.busy);
+  pthread_mutex_lock(&wcsutil_pl.lock);
+}
+
+static void wcsutil_pool_parent(void)
+
+{
+  pthread_mutex_unlock(&wcsutil_pl.lock);
+  pthread_mutex_unlock(&wcsutil_pl.busy);
+}
+
+static void wcsutil_pool_child(void)
+
+{
+  pthread_mutex_init(&wcsutil_pl.busy, 0x0);
+  pthread_mutex_init(&wcsutil_pl.lock, 0x0);
+  pthread_cond_init(&wcsutil_pl.work, 0x0);
+  pthread_cond_init(&wcsutil_pl.done, 0x0);
+
+  wcsutil_pl.nworker = 0;
+  wcsutil_pl.nslot = 0;
+  wcsutil_pl.ntask = 0;
+  wcsutil_pl.next  = 0;
+  wcsutil_pl.ndone = 0;
+  wcsutil_pl.task  = 0x0;
+  wcsutil_pl.arg   = 0x0;
+}
+
+static void wcsutil_pool_atfork(void)
+
+{
+  pthread_atfork(wcsutil_pool_prepare, wcsutil_pool_parent,
+                 wcsutil_pool_child);
+}
+
+/* Claim and run tasks until none remain, called and returning with the lock
+   held.  The job cannot be replaced while any of its tasks is running. */
+static void wcsutil_pool_run(void)
+
+{
+  int  itask;
+  void (*task)(void *, int), *arg;
+
+  while (wcsutil_pl.next < wcsutil_pl.ntask) {
+    itask = wcsutil_pl.next++;
+    task  = wcsutil_pl.task;
+    arg   = wcsutil_pl.arg;
+
+    pthread_mutex_unlock(&wcsutil_pl.lock);
+    task(arg, itask);
+    pthread_mutex_lock(&wcsutil_pl.lock);
+
+    if (++wcsutil_pl.ndone == wcsutil_pl.ntask) {
+      pthread_cond_broadcast(&wcsutil_pl.done);
+    }
+  }
+}
+
+static void *wcsutil_pool_worker(void *dummy)
+
+{
+  pthread_mutex_lock(&wcsutil_pl.lock);
+  for (;;) {
+    while (wcsutil_pl.nslot == 0 || wcsutil_pl.next >= wcsutil_pl.ntask) {
+      pthread_cond_wait(&wcsutil_pl.work, &wcsutil_pl.lock);
+    }
+
+    wcsutil_pl.nslot--;
+    wcsutil_pool_run();
+  }
+
+  return dummy;
+}
+
+#endif
+
+void wcsutil_pool(int nthread, int ntask, void (*task)(void *, int),
+                  void *arg)
+
+{
+  int itask;
+
+#ifdef HAVE_PTHREAD
+  pthread_attr_t attr;
+  pthread_t tid;
+
+  if (nthread > ntask) nthread = ntask;
+
+  if (nthread > 1) {
+    pthread_once(&wcsutil_pl_once, wcsutil_pool_atfork);
+
+    pthread_mutex_lock(&wcsutil_pl.busy);
+    pthread_mutex_lock(&wcsutil_pl.lock);
+
+    /* Start more workers if required; carry on with fewer if we can't. */
+    if (wcsutil_pl.nworker < nthread - 1) {
+      pthread_attr_init(&attr);
+      pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+      while (wcsutil_pl.nworker < nthread - 1) {
+        if (pthread_create(&tid, &attr, wcsutil_pool_worker, 0x0)) break;
+        wcsutil_pl.nworker++;
+      }
+      pthread_attr_destroy(&attr);
+    }
+
+    wcsutil_pl.task  = task;
+    wcsutil_pl.arg   = arg;
+    wcsutil_pl.ntask = ntask;
+    wcsutil_pl.next  = 0;
+    wcsutil_pl.ndone = 0;
+    wcsutil_pl.nslot = nthread - 1;
+    pthread_cond_broadcast(&wcsutil_pl.work);
+
+    /* The calling thread does its share. */
+    wcsutil_pool_run();
+    while (wcsutil_pl.ndone < wcsutil_pl.ntask) {
+      pthread_cond_wait(&wcsutil_pl.done, &wcsutil_pl.lock);
+    }
+
+    wcsutil_pl.nslot = 0;
+    pthread_mutex_unlock(&wcsutil_pl.lock);
+    pthread_mutex_unlock(&wcsutil_pl.busy);
+
+    return;
+  }
+#endif
+
+  for (itask = 0; itask < ntask; itask++) {
+    task(arg, itask);
+  }
+}
@@ -242,6 +242,44 @@
 * Returned:
 *   value     double *  The double value parsed from the string.
 *
+*
+* wcsutil_ncpu() - Number of processors available
+* -----------------------------------------------
+* INTERNAL USE ONLY.
+*
+* wcsutil_ncpu() returns the number of processors currently online, or 1 if
+* this cannot be determined or WCSLIB was built without POSIX threads.
+*
+* Function return value:
+*             int       Number of processors.
+*
+*
+* wcsutil_pool() - Run a set of tasks on a pool of threads
+* --------------------------------------------------------
+* INTERNAL USE ONLY.
+*
+* wcsutil_pool() invokes task(arg, itask) for itask = 0 to ntask-1, spread
+* over at most nthread threads including the calling thread, and returns when
+* all have completed.  The worker threads are created as required on first
+* use and persist for the life of the process, or until it forks; the child
+* of a fork() starts with no workers and creates its own as required.
+* Concurrent invocations are serialized.  The tasks are run serially in the calling thread if nthread
+* <= 1 or WCSLIB was built without POSIX threads.
+*
+* Given:
+*   nthread   int       Maximum number of threads to use.
+*
+*   ntask     int       Number of tasks.
+*
+*   task      void(*)(void *, int)
+*                       Task function.  It must be safe to invoke it
+*                       concurrently for different values of itask.
+*
+*   arg       void*     Argument passed to each invocation of task.
+*
+* Function return value:
+*             void
+*
 *===========================================================================*/
 
 #ifndef WCSLIB_WCSUTIL
@@ -262,6 +300,10 @@ char *wcsutil_fptr2str(int (*func)(void), char hext[19]);
 int  wcsutil_str2double(const char *buf, const char *format, double *value);
 void wcsutil_double2str(char *buf, const char *format, double value);
 
+int  wcsutil_ncpu(void);
+void wcsutil_pool(int nthread, int ntask, void (*task)(void *, int),
+                  void *arg);
+
 #ifdef __cplusplus
 }
 #endif
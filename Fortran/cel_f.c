@@ -53,11 +53,13 @@
 #define CEL_THETA0 103
 #define CEL_REF    104
 #define CEL_PRJ    105
+#define CEL_FAST   106
 
 #define CEL_EULER  200
 #define CEL_LATPRQ 201
 #define CEL_ISOLAT 202
 #define CEL_ERR    203
+#define CEL_RMAT   204
 
 /*--------------------------------------------------------------------------*/
 
@@ -92,6 +94,9 @@ int celput_(int *cel, const int *what, const void *value, const int *i)
   case CEL_OFFSET:
     celp->offset = *ivalp;
     break;
+  case CEL_FAST:
+    celp->fast = *ivalp;
+    break;
   case CEL_PHI0:
     celp->phi0 = *dvalp;
     break;
@@ -153,6 +158,9 @@ int celget_(const int *cel, const int *what, void *value)
   case CEL_OFFSET:
     *ivalp = celp->offset;
     break;
+  case CEL_FAST:
+    *ivalp = celp->fast;
+    break;
   case CEL_PHI0:
     *dvalp = celp->phi0;
     break;
@@ -181,6 +189,11 @@ int celget_(const int *cel, const int *what, void *value)
   case CEL_ISOLAT:
     *ivalp = celp->isolat;
     break;
+  case CEL_RMAT:
+    for (k = 0; k < 9; k++) {
+       *(dvalp++) = celp->rmat[k];
+    }
+    break;
   case CEL_ERR:
     /* Copy the contents of the wcserr struct. */
     if (celp->err) {
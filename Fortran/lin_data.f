@@ -27,7 +27,7 @@
 
       BLOCK DATA LIN_BLOCK_DATA
 
-      CHARACTER LIN_ERRMSG(0:3)*80
+      CHARACTER LIN_ERRMSG(0:4)*80
 
       COMMON /LIN_DATA/ LIN_ERRMSG
 
@@ -35,6 +35,7 @@
      :  'Success',
      :  'Null linprm pointer passed',
      :  'Memory allocation failed',
-     :  'PCi_ja matrix is singular'/
+     :  'PCi_ja matrix is singular',
+     :  'Invalid parameter value'/
 
       END
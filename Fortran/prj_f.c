@@ -38,6 +38,7 @@
 #define prjfree_ F77_FUNC(prjfree, PRJFREE)
 #define prjprt_  F77_FUNC(prjprt,  PRJPRT)
 #define prjbchk_ F77_FUNC(prjbchk, PRJBCHK)
+#define prjsimd_ F77_FUNC(prjsimd, PRJSIMD)
 
 #define prjptc_  F77_FUNC(prjptc,  PRJPTC)
 #define prjptd_  F77_FUNC(prjptd,  PRJPTD)
@@ -53,6 +54,7 @@
 #define PRJ_PHI0      104
 #define PRJ_THETA0    105
 #define PRJ_BOUNDS    106
+#define PRJ_FAST      107
 
 #define PRJ_NAME      200
 #define PRJ_CATEGORY  201
@@ -117,6 +119,9 @@ int prjput_(int *prj, const int *what, const void *value, const int *m)
   case PRJ_BOUNDS:
     prjp->bounds = *ivalp;
     break;
+  case PRJ_FAST:
+    prjp->fast = *ivalp;
+    break;
   default:
     return 1;
   }
@@ -181,6 +186,9 @@ int prjget_(const int *prj, const int *what, void *value)
   case PRJ_BOUNDS:
     *ivalp = prjp->bounds;
     break;
+  case PRJ_FAST:
+    *ivalp = prjp->fast;
+    break;
   case PRJ_NAME:
     strncpy(cvalp, prjp->name, 40);
     break;
@@ -291,6 +299,14 @@ int prjbchk_(
 
 /*--------------------------------------------------------------------------*/
 
+int prjsimd_(const int *enable)
+
+{
+  return prjsimd(*enable);
+}
+
+/*--------------------------------------------------------------------------*/
+
 #define PRJSET_FWRAP(pcode, PCODE) \
   int F77_FUNC(pcode##set, PCODE##SET)(int *prj) \
   {return prjset((struct prjprm *)prj);}
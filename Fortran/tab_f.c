@@ -34,6 +34,8 @@
 #define tabini_  F77_FUNC(tabini,  TABINI)
 #define tabmem_  F77_FUNC(tabmem,  TABMEM)
 #define tabcpy_  F77_FUNC(tabcpy,  TABCPY)
+#define tabshr_  F77_FUNC(tabshr,  TABSHR)
+#define tabown_  F77_FUNC(tabown,  TABOWN)
 #define tabput_  F77_FUNC(tabput,  TABPUT)
 #define tabget_  F77_FUNC(tabget,  TABGET)
 #define tabfree_ F77_FUNC(tabfree, TABFREE)
@@ -88,6 +90,22 @@ int tabcpy_(const int *tabsrc, int *tabdst)
 
 /*--------------------------------------------------------------------------*/
 
+int tabshr_(const int *tabsrc, int *tabdst)
+
+{
+  return tabshr((const struct tabprm *)tabsrc, (struct tabprm *)tabdst);
+}
+
+/*--------------------------------------------------------------------------*/
+
+int tabown_(int *tab)
+
+{
+  return tabown((struct tabprm *)tab);
+}
+
+/*--------------------------------------------------------------------------*/
+
 int tabput_(
   int *tab,
   const int *what,
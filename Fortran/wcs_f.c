@@ -37,6 +37,7 @@
 #define wcsnps_  F77_FUNC(wcsnps,  WCSNPS)
 #define wcsini_  F77_FUNC(wcsini,  WCSINI)
 #define wcssub_  F77_FUNC(wcssub,  WCSSUB)
+#define wcsshr_  F77_FUNC(wcsshr,  WCSSHR)
 #define wcscopy_ F77_FUNC(wcscopy, WCSCOPY)
 #define wcsput_  F77_FUNC(wcsput,  WCSPUT)
 #define wcsget_  F77_FUNC(wcsget,  WCSGET)
@@ -102,6 +103,8 @@
 #define WCS_VELANGL  140
 #define WCS_WCSNAME  141
 
+#define WCS_ACCURACY 142
+
 #define WCS_NTAB     200
 #define WCS_NWTB     201
 #define WCS_TAB      202
@@ -142,6 +145,15 @@ int wcssub_(const int *wcssrc, int *nsub, int axes[], int *wcsdst)
 
 /*--------------------------------------------------------------------------*/
 
+int wcsshr_(const int *wcssrc, int *nsub, int axes[], int *wcsdst)
+
+{
+  return wcsshr(1, (const struct wcsprm *)wcssrc, nsub, axes,
+                (struct wcsprm *)wcsdst);
+}
+
+/*--------------------------------------------------------------------------*/
+
 int wcscopy_(const int *wcssrc, int *wcsdst)
 
 {
@@ -321,6 +333,9 @@ int wcsput_(
     strncpy(wcsp->wcsname, cvalp, 72);
     wcsutil_null_fill(72, wcsp->wcsname);
     break;
+  case WCS_ACCURACY:
+    wcsp->accuracy = *dvalp;
+    break;
   default:
     return 1;
   }
@@ -557,6 +572,9 @@ int wcsget_(const int *wcs, const int *what, void *value)
     strncpy(cvalp, wcsp->wcsname, 72);
     wcsutil_blank_fill(72, cvalp);
     break;
+  case WCS_ACCURACY:
+    *dvalp = wcsp->accuracy;
+    break;
 
   case WCS_NTAB:
     *ivalp = wcsp->ntab;